@@ -10,9 +10,11 @@ flat in int palette_offset;
 flat in int palette_limit;
 flat in int opacity;
 flat in uint options;
+flat in vec2 tex_limits;
 
 uniform sampler2D atlas;
 uniform sampler2D remaps;
+uniform int noise_rows[200]; // see build_opacity_noise() in video/renderers/common.h
 
 in vec4 gl_FragCoord;
 
@@ -24,15 +26,15 @@ bool SPRITE_HAR_QUIRKS = (options & 8u) != 0u;
 bool SPRITE_DARK_TINT = (options & 0x10u) != 0u;
 
 
-float PHI = 1.61803398874989484820459;
 float ATLAS_H = 2048.0;
 vec2 NATIVE_SIZE = vec2(320.0, 200.0);
 
-float noise(in vec2 v) {
+int noise(in vec2 v) {
     // OMF had a fairly random offset for each row, because
     // they applied their noise row by row.
     // they then changed the threshold by 0x6b for each subsequent X.
-    return fract(tan(10 * PHI * v.y) + (float(0x6b) * v.x) / 256.0);
+    // Integer math, so that the software renderer drops the same pixels.
+    return (noise_rows[int(v.y)] + 0x6b * (2 * int(v.x) + 1)) % 512;
 }
 
 vec4 handle(float index) {
@@ -58,9 +60,7 @@ vec4 handle(float index) {
 
 void main() {
     // Don't render if we're decimating due to opacity
-    float decimate_limit = opacity / 255.0;
-    float decimate_value = noise(gl_FragCoord.xy);
-    if (decimate_value > decimate_limit) {
+    if (noise(gl_FragCoord.xy) * 255 > opacity * 512) {
         discard;
     }
 
@@ -69,7 +69,12 @@ void main() {
         int coverage = 0;
         for(int y = 0; y < 4; y++) {
             float offset = float(y - 1) / ATLAS_H;
-            vec4 texel = texture(atlas, tex_coord + vec2(0, offset));
+            vec2 coord = tex_coord + vec2(0, offset);
+            // Samples outside the sprite are transparent, instead of whatever is next to it in the atlas.
+            if(coord.y < tex_limits.x || coord.y > tex_limits.y) {
+                continue;
+            }
+            vec4 texel = texture(atlas, coord);
             int index = int(texel.r * 255.0);
             coverage += int(index != transparency_index);
         }
@@ -9,6 +9,7 @@ layout (location = 5) in int in_palette_offset;
 layout (location = 6) in int in_palette_limit;
 layout (location = 7) in int in_opacity;
 layout (location = 8) in uint in_options;
+layout (location = 9) in vec2 in_tex_limits;
 uniform mat4 projection;
 
 out vec2 tex_coord;
@@ -19,6 +20,7 @@ flat out int palette_offset;
 flat out int palette_limit;
 flat out int opacity;
 flat out uint options;
+flat out vec2 tex_limits;
 
 void main() {
     transparency_index = in_transparency_index;
@@ -28,6 +30,7 @@ void main() {
     remap_rounds = in_remap_rounds;
     opacity = in_opacity;
     options = in_options;
+    tex_limits = in_tex_limits;
     tex_coord = in_tex_coord.xy;
     gl_Position = projection * vec4(in_position.xy, 0.0, 1.0);
 }
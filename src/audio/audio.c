@@ -12,9 +12,15 @@
 #ifdef ENABLE_SDL_AUDIO_BACKEND
 #include "audio/backends/sdl/sdl_backend.h"
 #endif
+#ifdef ENABLE_SOFT_AUDIO_BACKEND
+#include "audio/backends/soft/soft_backend.h"
+#endif
 #ifdef ENABLE_NULL_AUDIO_BACKEND
 #include "audio/backends/null/null_backend.h"
 #endif
+#ifdef ENABLE_OFFLINE_AUDIO_BACKEND
+#include "audio/backends/offline/offline_backend.h"
+#endif
 
 #define MAX_AVAILABLE_BACKENDS 8
 
@@ -26,9 +32,15 @@ static audio_backend_init all_backends[] = {
 #ifdef ENABLE_SDL_AUDIO_BACKEND
     sdl_audio_backend_set_callbacks,
 #endif
+#ifdef ENABLE_SOFT_AUDIO_BACKEND
+    soft_audio_backend_set_callbacks,
+#endif
 #ifdef ENABLE_NULL_AUDIO_BACKEND
     null_audio_backend_set_callbacks,
 #endif
+#ifdef ENABLE_OFFLINE_AUDIO_BACKEND
+    offline_audio_backend_set_callbacks,
+#endif
 };
 static int all_backends_count = N_ELEMENTS(all_backends);
 
@@ -142,6 +154,7 @@ bool audio_init(const char *try_name, int sample_rate, bool mono, int resampler,
     if(!current_backend.setup_context(current_backend.ctx, sample_rate, mono, resampler, music_volume, sound_volume)) {
         goto exit_1;
     }
+    audio_cache_sounds();
     return true;
 
 exit_1:
@@ -157,6 +170,10 @@ void audio_close(void) {
 }
 
 int audio_play_sound(int id, float volume, float panning, int pitch) {
+    return audio_play_sound_offset(id, 0, volume, panning, pitch, 0);
+}
+
+int audio_play_sound_offset(int id, int offset, float volume, float panning, int pitch, int fade) {
     if(id < 0 || id > 299)
         return -1;
 
@@ -168,18 +185,34 @@ int audio_play_sound(int id, float volume, float panning, int pitch) {
         log_error("Requested sound sample %d not found", id);
         return -1;
     }
-    if(src_len == 0) {
+    if(offset < 0 || offset >= src_len) {
         log_debug("Requested sound sample %d has nothing to play", id);
         return -1;
     }
 
     // Tell the backend to play it.
-    return current_backend.play_sound(current_backend.ctx, src_buf, src_len, src_freq, volume, panning, pitch, 0);
+    return current_backend.play_sound(current_backend.ctx, id, src_buf, src_len, offset, src_freq, volume, panning,
+                                      pitch, fade);
 }
 
 int audio_play_sound_buf(char *src_buf, int src_len, int src_freq, float volume, float panning, int pitch, int fade) {
     // Tell the backend to play it.
-    return current_backend.play_sound(current_backend.ctx, src_buf, src_len, src_freq, volume, panning, pitch, fade);
+    return current_backend.play_sound(current_backend.ctx, -1, src_buf, src_len, 0, src_freq, volume, panning, pitch,
+                                      fade);
+}
+
+void audio_cache_sounds(void) {
+    if(current_backend.cache_sound == NULL) {
+        return;
+    }
+    char *src_buf;
+    int src_len;
+    int src_freq;
+    for(int id = 0; id < sounds_loader_count(); id++) {
+        if(sounds_loader_get(id, &src_buf, &src_len, &src_freq) && src_len > 0) {
+            current_backend.cache_sound(current_backend.ctx, id, src_buf, src_len, src_freq, 0);
+        }
+    }
 }
 
 void audio_fade_out(int playback_id, int ms) {
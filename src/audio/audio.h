@@ -41,7 +41,27 @@ void audio_close(void);
 int audio_play_sound(int id, float volume, float panning, int pitch);
 
 /**
- * Plays sound with given parameters from a buffer.
+ * Plays sound with given parameters, starting from the middle of the sample.
+ *
+ * @param id Sound resource identifier
+ * @param offset Offset into the sound data to start from
+ * @param volume Volume 0.0f ... 1.0f
+ * @param panning Sound panning -1.0f ... 1.0f
+ * @param pitch Sound pitch 0.0f ... n
+ * @param fade How many milliseconds to fade in the playback over
+ * @return backend specific reference ID to the playing sound for later use with audio_fade_out or -1 on failure
+ */
+int audio_play_sound_offset(int id, int offset, float volume, float panning, int pitch, int fade);
+
+/**
+ * Prepares all loaded sound samples for playback at the default pitch, if the backend supports it. This is done
+ * automatically by audio_init; call it again after the sounds have been (re)loaded.
+ */
+void audio_cache_sounds(void);
+
+/**
+ * Plays sound with given parameters from a buffer. The buffer is not copied by all backends, so it must stay
+ * valid for as long as the sound plays.
  *
  * @param src_buf Sound data buffer
  * @param src_len Sound data buffer length
@@ -48,9 +48,11 @@ typedef bool (*setup_backend_context_fn)(void *ctx, unsigned sample_rate, bool m
                                          float sound_volume);
 typedef void (*close_backend_context_fn)(void *ctx);
 
-// Playback handling.
-typedef int (*play_sound_fn)(void *ctx, const char *buf, size_t len, int freq, float volume, float panning, int pitch,
-                             int fade);
+// Playback handling. Sounds from the sounds loader are passed with their id, so that backends may keep converted
+// copies of them; other buffers get an id of -1. Playback starts offset bytes into the buffer.
+typedef int (*play_sound_fn)(void *ctx, int id, const char *buf, size_t len, size_t offset, int freq, float volume,
+                             float panning, int pitch, int fade);
+typedef void (*cache_sound_fn)(void *ctx, int id, const char *buf, size_t len, int freq, int pitch);
 typedef void (*play_music_fn)(void *ctx, const music_source *src);
 typedef void (*stop_music_fn)(void *ctx);
 
@@ -74,6 +76,7 @@ struct audio_backend {
     close_backend_context_fn close_context;
 
     play_sound_fn play_sound;
+    cache_sound_fn cache_sound; // Optional; prepares a sound for playback ahead of time.
     play_music_fn play_music;
     stop_music_fn stop_music;
 
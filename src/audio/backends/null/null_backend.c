@@ -41,8 +41,8 @@ static void set_backend_sound_volume(void *userdata, float volume) {
 static void set_backend_music_volume(void *userdata, float volume) {
 }
 
-static int play_sound(void *userdata, const char *src_buf, size_t src_len, int src_freq, float volume, float panning,
-                      int pitch, int fade) {
+static int play_sound(void *userdata, int id, const char *src_buf, size_t src_len, size_t offset, int src_freq,
+                      float volume, float panning, int pitch, int fade) {
     return -1;
 }
 
@@ -0,0 +1,211 @@
+#include "audio/backends/offline/offline_backend.h"
+#include "audio/backends/audio_backend.h"
+#include "audio/mixer.h"
+#include "utils/allocator.h"
+#include "utils/c_array_util.h"
+#include "utils/log.h"
+#include "utils/miscmath.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include <SDL.h>
+
+static const audio_sample_rate supported_sample_rates[] = {
+    {11025, 0, "11025Hz"},
+    {22050, 0, "22050Hz"},
+    {44100, 0, "44100Hz"},
+    {48000, 1, "48000Hz"},
+};
+static const int supported_sample_rate_count = N_ELEMENTS(supported_sample_rates);
+
+typedef struct offline_audio_context {
+    unsigned sample_rate;
+    unsigned channels;
+    int resampler;
+    float music_volume;
+    music_source music;
+    mixer mixer;
+    int next_playback_id;
+    offline_audio_stats stats;
+} offline_audio_context;
+
+// fade_out does not get a context, so keep track of the one that is set up.
+static offline_audio_context *active_ctx = NULL;
+
+static bool is_available(void) {
+    return true; // This is always available if compiled in.
+}
+
+static const char *get_description(void) {
+    return "Offline audio rendering, for exports";
+}
+
+static const char *get_name(void) {
+    return "Offline";
+}
+
+static unsigned int get_sample_rates(const audio_sample_rate **sample_rates) {
+    *sample_rates = supported_sample_rates;
+    return supported_sample_rate_count;
+}
+
+static void create_backend(audio_backend *player) {
+    player->ctx = omf_calloc(1, sizeof(offline_audio_context));
+}
+
+static void destroy_backend(audio_backend *player) {
+    omf_free(player->ctx);
+}
+
+static void set_backend_sound_volume(void *userdata, float volume) {
+    assert(userdata);
+    offline_audio_context *ctx = userdata;
+    mixer_set_volume(&ctx->mixer, volume);
+}
+
+static void set_backend_music_volume(void *userdata, float volume) {
+    assert(userdata);
+    offline_audio_context *ctx = userdata;
+    ctx->music_volume = clampf(volume, VOLUME_MIN, VOLUME_MAX);
+    music_source_set_volume(&ctx->music, ctx->music_volume);
+}
+
+static void get_info(void *userdata, unsigned *sample_rate, unsigned *channels, unsigned *resampler) {
+    assert(userdata);
+    offline_audio_context *ctx = userdata;
+    if(sample_rate != NULL)
+        *sample_rate = ctx->sample_rate;
+    if(channels != NULL)
+        *channels = ctx->channels;
+    if(resampler != NULL)
+        *resampler = ctx->resampler;
+}
+
+static int play_sound(void *userdata, int id, const char *src_buf, size_t src_len, size_t offset, int src_freq,
+                      float volume, float panning, int pitch, int fade) {
+    assert(userdata);
+    offline_audio_context *ctx = userdata;
+    int playback_id = ctx->next_playback_id++;
+    if(!mixer_play(&ctx->mixer, playback_id, src_buf + offset, src_len - offset, src_freq, volume, panning, pitch,
+                   fade, volume)) {
+        return -1;
+    }
+    return playback_id;
+}
+
+static void fade_out(int playback_id, int ms) {
+    if(active_ctx != NULL) {
+        mixer_fade_out(&active_ctx->mixer, playback_id, ms);
+    }
+}
+
+static void stop_music(void *userdata) {
+    assert(userdata);
+    offline_audio_context *ctx = userdata;
+    music_source_close(&ctx->music);
+}
+
+static void play_music(void *userdata, const music_source *src) {
+    assert(userdata);
+    offline_audio_context *ctx = userdata;
+    stop_music(ctx);
+    memcpy(&ctx->music, src, sizeof(music_source));
+    music_source_set_volume(&ctx->music, ctx->music_volume);
+}
+
+bool offline_audio_backend_get_format(unsigned *sample_rate, unsigned *channels) {
+    if(active_ctx == NULL) {
+        return false;
+    }
+    get_info(active_ctx, sample_rate, channels, NULL);
+    return true;
+}
+
+unsigned offline_audio_backend_render(int16_t *dst, unsigned frames) {
+    if(active_ctx == NULL) {
+        return 0;
+    }
+    offline_audio_context *ctx = active_ctx;
+    int bytes = frames * ctx->channels * sizeof(int16_t);
+    uint64_t start = SDL_GetPerformanceCounter();
+    memset(dst, 0, bytes);
+    music_source_render(&ctx->music, (char *)dst, bytes);
+    uint64_t music_done = SDL_GetPerformanceCounter();
+    mixer_render(&ctx->mixer, dst, frames);
+    uint64_t mix_done = SDL_GetPerformanceCounter();
+
+    ctx->stats.frames += frames;
+    ctx->stats.music_ticks += music_done - start;
+    ctx->stats.mix_ticks += mix_done - music_done;
+    return frames;
+}
+
+bool offline_audio_backend_get_stats(offline_audio_stats *stats) {
+    if(active_ctx == NULL) {
+        return false;
+    }
+    *stats = active_ctx->stats;
+    return true;
+}
+
+double offline_audio_stats_us_per_block(const offline_audio_stats *stats, uint64_t ticks) {
+    double blocks = stats->frames * 100.0 / max2(stats->sample_rate, 1);
+    if(blocks <= 0.0) {
+        return 0.0;
+    }
+    return (double)ticks * 1000000.0 / (double)SDL_GetPerformanceFrequency() / blocks;
+}
+
+void offline_audio_backend_reset_stats(void) {
+    if(active_ctx != NULL) {
+        memset(&active_ctx->stats, 0, sizeof(offline_audio_stats));
+        active_ctx->stats.sample_rate = active_ctx->sample_rate;
+        active_ctx->stats.resampler = active_ctx->resampler;
+    }
+}
+
+static bool setup_backend_context(void *userdata, unsigned sample_rate, bool mono, int resampler, float music_volume,
+                                  float sound_volume) {
+    assert(userdata);
+    offline_audio_context *ctx = userdata;
+    ctx->sample_rate = sample_rate;
+    ctx->channels = mono ? 1 : 2;
+    ctx->resampler = resampler;
+    ctx->next_playback_id = 0;
+    memset(&ctx->music, 0, sizeof(music_source));
+    mixer_init(&ctx->mixer, ctx->sample_rate, ctx->channels);
+    set_backend_music_volume(ctx, music_volume);
+    set_backend_sound_volume(ctx, sound_volume);
+    active_ctx = ctx;
+    offline_audio_backend_reset_stats();
+    log_info("Offline audio initialized: %uHz, %u channels", ctx->sample_rate, ctx->channels);
+    return true;
+}
+
+static void close_backend_context(void *userdata) {
+    assert(userdata);
+    stop_music(userdata);
+    if(active_ctx == userdata) {
+        active_ctx = NULL;
+    }
+    log_info("Offline audio closed!");
+}
+
+void offline_audio_backend_set_callbacks(audio_backend *offline_backend) {
+    offline_backend->is_available = is_available;
+    offline_backend->get_description = get_description;
+    offline_backend->get_name = get_name;
+    offline_backend->get_sample_rates = get_sample_rates;
+    offline_backend->get_info = get_info;
+    offline_backend->create = create_backend;
+    offline_backend->destroy = destroy_backend;
+    offline_backend->set_music_volume = set_backend_music_volume;
+    offline_backend->set_sound_volume = set_backend_sound_volume;
+    offline_backend->setup_context = setup_backend_context;
+    offline_backend->close_context = close_backend_context;
+    offline_backend->play_music = play_music;
+    offline_backend->play_sound = play_sound;
+    offline_backend->stop_music = stop_music;
+    offline_backend->fade_out = fade_out;
+}
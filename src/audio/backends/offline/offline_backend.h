@@ -0,0 +1,51 @@
+#ifndef OFFLINE_BACKEND_H
+#define OFFLINE_BACKEND_H
+
+#include "audio/backends/audio_backend.h"
+
+#include <stdint.h>
+
+/**
+ * Audio backend without an audio device. Nothing is played on its own; instead the caller pulls mixed audio
+ * out with offline_audio_backend_render() at its own pace, e.g. once per game tick when exporting a REC.
+ * The output only depends on what the game played and when, so it can be used as reference audio.
+ */
+void offline_audio_backend_set_callbacks(audio_backend *offline_backend);
+
+/**
+ * Get the output format of the offline backend.
+ * @return false if the offline backend is not the active one.
+ */
+bool offline_audio_backend_get_format(unsigned *sample_rate, unsigned *channels);
+
+/**
+ * Mix the next frames of audio as interleaved signed 16-bit samples.
+ * @param dst Room for frames * channels samples
+ * @return Number of frames written; 0 if the offline backend is not the active one.
+ */
+unsigned offline_audio_backend_render(int16_t *dst, unsigned frames);
+
+/**
+ * Time spent in offline_audio_backend_render(), in performance counter ticks.
+ */
+typedef struct offline_audio_stats {
+    unsigned sample_rate;
+    unsigned resampler; // Music resampler in use while these were collected
+    uint64_t frames;
+    uint64_t music_ticks; // Music rendering, libxmp or opus
+    uint64_t mix_ticks;   // Sound effect mixing
+} offline_audio_stats;
+
+/**
+ * Get the render timings since the backend was set up, or since the last reset.
+ * @return false if the offline backend is not the active one.
+ */
+bool offline_audio_backend_get_stats(offline_audio_stats *stats);
+void offline_audio_backend_reset_stats(void);
+
+/**
+ * Convert ticks from the stats to microseconds per 10 ms of rendered audio.
+ */
+double offline_audio_stats_us_per_block(const offline_audio_stats *stats, uint64_t ticks);
+
+#endif // OFFLINE_BACKEND_H
@@ -4,6 +4,7 @@
 #include "audio/sources/music_source.h"
 #include "utils/allocator.h"
 #include "utils/c_array_util.h"
+#include "utils/hashmap.h"
 #include "utils/log.h"
 #include "utils/miscmath.h"
 
@@ -17,6 +18,9 @@ static_assert(SDL_MIXER_VERSION_ATLEAST(2, 0, 4), "SDL_mixer version should be 2
 
 #define CHANNEL_MAX 8
 
+// Converted samples are cached until this much memory is in use; after that, samples are converted on every play.
+#define SAMPLE_CACHE_MAX_BYTES (32 * 1024 * 1024)
+
 static const audio_sample_rate supported_sample_rates[] = {
     {11025, 0, "11025Hz"},
     {22050, 0, "22050Hz"},
@@ -25,6 +29,19 @@ static const audio_sample_rate supported_sample_rates[] = {
 };
 static const int supported_sample_rate_count = N_ELEMENTS(supported_sample_rates);
 
+typedef struct sample_cache_key {
+    int id;
+    int pitch;
+    int sample_rate;
+    int channels;
+    Uint16 format;
+} sample_cache_key;
+
+typedef struct cached_sample {
+    Uint8 *buf;
+    Uint32 len;
+} cached_sample;
+
 typedef struct sdl_audio_context {
     int sample_rate;
     Uint16 format;
@@ -33,6 +50,10 @@ typedef struct sdl_audio_context {
     float volume;
     music_source music;
     Mix_Chunk channel_chunks[CHANNEL_MAX];
+    hashmap sample_cache; // sample_cache_key -> cached_sample
+    size_t cache_bytes;
+    unsigned cache_hits;
+    unsigned cache_misses;
 } sdl_audio_context;
 
 static bool is_available(void) {
@@ -93,8 +114,16 @@ static inline void free_chunk(sdl_audio_context *ctx, int i) {
     }
 }
 
-static bool audio_get_chunk(sdl_audio_context *ctx, Mix_Chunk *chunk, const char *src_buf, size_t src_len, int src_freq,
-                            float volume, int pitch) {
+static void free_cached_sample(void *value) {
+    cached_sample *sample = value;
+    SDL_free(sample->buf);
+}
+
+/**
+ * Convert an unsigned 8-bit mono sample to the device format. The result is allocated with SDL_malloc.
+ */
+static bool convert_sample(const sdl_audio_context *ctx, const char *src_buf, size_t src_len, int src_freq, int pitch,
+                           Uint8 **dst, Uint32 *dst_len) {
     Uint8 *dst_buf;
     SDL_AudioCVT cvt;
 
@@ -120,10 +149,8 @@ static bool audio_get_chunk(sdl_audio_context *ctx, Mix_Chunk *chunk, const char
         goto exit_1;
     }
 
-    chunk->volume = volume * MIX_MAX_VOLUME;
-    chunk->abuf = dst_buf;
-    chunk->alen = cvt.len_cvt;
-    chunk->allocated = 1;
+    *dst = dst_buf;
+    *dst_len = cvt.len_cvt;
     return true;
 
 exit_1:
@@ -132,6 +159,75 @@ exit_0:
     return false;
 }
 
+/**
+ * Find the converted sample for a sound, converting and caching it if this is the first time it is played with the
+ * current pitch. Returns NULL if the sample could not be converted, or the cache is already full.
+ */
+static const cached_sample *get_cached_sample(sdl_audio_context *ctx, int id, const char *src_buf, size_t src_len,
+                                              int src_freq, int pitch) {
+    sample_cache_key key;
+    memset(&key, 0, sizeof(key));
+    key.id = id;
+    key.pitch = pitch;
+    key.sample_rate = ctx->sample_rate;
+    key.channels = ctx->channels;
+    key.format = ctx->format;
+
+    void *value;
+    if(hashmap_get(&ctx->sample_cache, &key, sizeof(key), &value, NULL) == 0) {
+        ctx->cache_hits++;
+        return value;
+    }
+    ctx->cache_misses++;
+    if(ctx->cache_bytes >= SAMPLE_CACHE_MAX_BYTES) {
+        return NULL;
+    }
+
+    cached_sample sample;
+    if(!convert_sample(ctx, src_buf, src_len, src_freq, pitch, &sample.buf, &sample.len)) {
+        return NULL;
+    }
+    // The conversion buffer is sized for the worst case; give back whatever was not used.
+    Uint8 *shrunk = SDL_realloc(sample.buf, max2(sample.len, 1));
+    if(shrunk != NULL) {
+        sample.buf = shrunk;
+    }
+    ctx->cache_bytes += sample.len;
+    return hashmap_put(&ctx->sample_cache, &key, sizeof(key), &sample, sizeof(sample));
+}
+
+/**
+ * Point the channel chunk at a cached sample, or convert a private copy for the channel if there is no cached one.
+ * Playback starts offset bytes into the 8-bit source buffer.
+ */
+static bool load_chunk(sdl_audio_context *ctx, Mix_Chunk *chunk, int id, const char *src_buf, size_t src_len,
+                       size_t offset, int src_freq, int pitch) {
+    const cached_sample *sample = NULL;
+    if(id >= 0) {
+        sample = get_cached_sample(ctx, id, src_buf, src_len, src_freq, pitch);
+    }
+    if(sample != NULL) {
+        // Skip the same fraction of the converted sample, rounded to whole output frames.
+        Uint32 frame_size = ctx->channels * (SDL_AUDIO_BITSIZE(ctx->format) / 8);
+        Uint32 frames = sample->len / frame_size;
+        Uint32 skip = (Uint64)offset * frames / src_len * frame_size;
+        chunk->abuf = sample->buf + skip;
+        chunk->alen = sample->len - skip;
+        chunk->allocated = 0;
+        return true;
+    }
+    if(!convert_sample(ctx, src_buf + offset, src_len - offset, src_freq, pitch, &chunk->abuf, &chunk->alen)) {
+        return false;
+    }
+    chunk->allocated = 1;
+    return true;
+}
+
+static void cache_sound(void *userdata, int id, const char *src_buf, size_t src_len, int src_freq, int pitch) {
+    assert(userdata);
+    get_cached_sample(userdata, id, src_buf, src_len, src_freq, pitch);
+}
+
 static void set_backend_sound_volume(void *userdata, float volume) {
     assert(userdata);
     volume = clampf(volume, VOLUME_MIN, VOLUME_MAX);
@@ -156,8 +252,8 @@ static void get_info(void *userdata, unsigned *sample_rate, unsigned *channels,
         *resampler = ctx->resampler;
 }
 
-static int play_sound(void *userdata, const char *src_buf, size_t src_len, int src_freq, float volume, float panning,
-                      int pitch, int fade) {
+static int play_sound(void *userdata, int id, const char *src_buf, size_t src_len, size_t offset, int src_freq,
+                      float volume, float panning, int pitch, int fade) {
     assert(userdata);
     sdl_audio_context *ctx = userdata;
 
@@ -173,10 +269,11 @@ static int play_sound(void *userdata, const char *src_buf, size_t src_len, int s
         return -1;
     }
     free_chunk(ctx, channel); // Make sure old chunk is deallocated, if one exists.
-    if(!audio_get_chunk(ctx, &ctx->channel_chunks[channel], src_buf, src_len, src_freq, volume, pitch)) {
+    if(!load_chunk(ctx, &ctx->channel_chunks[channel], id, src_buf, src_len, offset, src_freq, pitch)) {
         log_error("Unable to play sound: Failed to load chunk");
         return -1;
     }
+    ctx->channel_chunks[channel].volume = volume * MIX_MAX_VOLUME;
     Mix_SetPanning(channel, clamp(pan_left * 255, 0, 255), clamp(pan_right * 255, 0, 255));
     if(Mix_FadeInChannelTimed(channel, &ctx->channel_chunks[channel], 0, fade, -1) == -1) {
         log_error("Unable to play sound: %s", Mix_GetError());
@@ -240,6 +337,7 @@ static bool setup_backend_context(void *userdata, unsigned sample_rate, bool mon
 
     // Make sure we have the correct amount of channels.
     Mix_AllocateChannels(CHANNEL_MAX);
+    hashmap_create_cb(&ctx->sample_cache, free_cached_sample);
 
     // Initialize playback parameters.
     set_backend_sound_volume(ctx, sound_volume);
@@ -272,6 +370,9 @@ static void close_backend_context(void *userdata) {
     for(int i = 0; i < CHANNEL_MAX; i++) {
         free_chunk(ctx, i);
     }
+    log_debug("Sample cache: %u samples, %zu bytes, %u hits, %u misses", hashmap_size(&ctx->sample_cache),
+              ctx->cache_bytes, ctx->cache_hits, ctx->cache_misses);
+    hashmap_free(&ctx->sample_cache);
     Mix_Quit();
     SDL_QuitSubSystem(SDL_INIT_AUDIO);
 }
@@ -290,6 +391,7 @@ void sdl_audio_backend_set_callbacks(audio_backend *sdl_backend) {
     sdl_backend->close_context = close_backend_context;
     sdl_backend->play_music = play_music;
     sdl_backend->play_sound = play_sound;
+    sdl_backend->cache_sound = cache_sound;
     sdl_backend->stop_music = stop_music;
     sdl_backend->fade_out = fade_out;
 }
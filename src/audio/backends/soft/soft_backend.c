@@ -0,0 +1,313 @@
+#include "audio/backends/soft/soft_backend.h"
+#include "audio/backends/audio_backend.h"
+#include "audio/mixer.h"
+#include "audio/sources/music_source.h"
+#include "utils/allocator.h"
+#include "utils/c_array_util.h"
+#include "utils/log.h"
+#include "utils/miscmath.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include <SDL.h>
+
+#define DEVICE_SAMPLES 1024
+#define COMMAND_RING_SIZE 256 // Must be a power of two
+#define COMMAND_INDEX_MASK (COMMAND_RING_SIZE * 2 - 1)
+
+static const audio_sample_rate supported_sample_rates[] = {
+    {11025, 0, "11025Hz"},
+    {22050, 0, "22050Hz"},
+    {44100, 0, "44100Hz"},
+    {48000, 1, "48000Hz"},
+};
+static const int supported_sample_rate_count = N_ELEMENTS(supported_sample_rates);
+
+typedef enum command_type
+{
+    COMMAND_PLAY,
+    COMMAND_FADE_OUT,
+    COMMAND_SOUND_VOLUME,
+    COMMAND_MUSIC_VOLUME,
+} command_type;
+
+typedef struct soft_command {
+    command_type type;
+    int playback_id;
+    const char *buf;
+    size_t len;
+    int freq;
+    float volume;
+    float panning;
+    int pitch;
+    int ms; // Fade in time for COMMAND_PLAY, fade out time for COMMAND_FADE_OUT
+} soft_command;
+
+/**
+ * Single producer, single consumer ring: the game thread writes commands and the audio callback runs them.
+ * Indexes run over twice the ring size, so that a full ring can be told apart from an empty one.
+ */
+typedef struct command_ring {
+    soft_command commands[COMMAND_RING_SIZE];
+    SDL_atomic_t head; // Next command to run; only written by the audio callback
+    SDL_atomic_t tail; // Next free slot; only written by the game thread
+} command_ring;
+
+typedef struct soft_audio_context {
+    SDL_AudioDeviceID device;
+    unsigned sample_rate;
+    unsigned channels;
+    int resampler;
+    float music_volume;
+    int next_playback_id;
+    command_ring commands;
+    // Owned by the audio callback while the device is running. The music source may only be swapped while
+    // holding the device lock.
+    music_source music;
+    mixer mixer;
+} soft_audio_context;
+
+// fade_out does not get a context, so keep track of the one that is set up.
+static soft_audio_context *active_ctx = NULL;
+
+static bool is_available(void) {
+    return true; // This is always available if compiled in.
+}
+
+static const char *get_description(void) {
+    return "Audio output using SDL, with a software mixer";
+}
+
+static const char *get_name(void) {
+    return "Software";
+}
+
+static unsigned int get_sample_rates(const audio_sample_rate **sample_rates) {
+    *sample_rates = supported_sample_rates;
+    return supported_sample_rate_count;
+}
+
+static void create_backend(audio_backend *player) {
+    player->ctx = omf_calloc(1, sizeof(soft_audio_context));
+}
+
+static void destroy_backend(audio_backend *player) {
+    omf_free(player->ctx);
+}
+
+static bool push_command(soft_audio_context *ctx, const soft_command *cmd) {
+    command_ring *ring = &ctx->commands;
+    int tail = SDL_AtomicGet(&ring->tail);
+    int head = SDL_AtomicGet(&ring->head);
+    if(((tail - head) & COMMAND_INDEX_MASK) == COMMAND_RING_SIZE) {
+        log_warn("Audio command queue is full, dropping command");
+        return false;
+    }
+    ring->commands[tail & (COMMAND_RING_SIZE - 1)] = *cmd;
+    // The atomic set is a full barrier, so the command is in place before the audio callback can see it.
+    SDL_AtomicSet(&ring->tail, (tail + 1) & COMMAND_INDEX_MASK);
+    return true;
+}
+
+static void run_commands(soft_audio_context *ctx) {
+    command_ring *ring = &ctx->commands;
+    int head = SDL_AtomicGet(&ring->head);
+    int tail = SDL_AtomicGet(&ring->tail);
+    while(head != tail) {
+        const soft_command *cmd = &ring->commands[head & (COMMAND_RING_SIZE - 1)];
+        switch(cmd->type) {
+            case COMMAND_PLAY:
+                // The game has no notion of sound priority; louder sounds are the ones that get kept.
+                mixer_play(&ctx->mixer, cmd->playback_id, cmd->buf, cmd->len, cmd->freq, cmd->volume, cmd->panning,
+                           cmd->pitch, cmd->ms, cmd->volume);
+                break;
+            case COMMAND_FADE_OUT:
+                mixer_fade_out(&ctx->mixer, cmd->playback_id, cmd->ms);
+                break;
+            case COMMAND_SOUND_VOLUME:
+                mixer_set_volume(&ctx->mixer, cmd->volume);
+                break;
+            case COMMAND_MUSIC_VOLUME:
+                music_source_set_volume(&ctx->music, cmd->volume);
+                break;
+        }
+        head = (head + 1) & COMMAND_INDEX_MASK;
+    }
+    SDL_AtomicSet(&ring->head, head);
+}
+
+static void audio_callback(void *userdata, Uint8 *stream, int len) {
+    soft_audio_context *ctx = userdata;
+    run_commands(ctx);
+    SDL_memset(stream, 0, len);
+    music_source_render(&ctx->music, (char *)stream, len);
+    mixer_render(&ctx->mixer, (int16_t *)stream, len / (ctx->channels * sizeof(int16_t)));
+}
+
+static void set_backend_sound_volume(void *userdata, float volume) {
+    assert(userdata);
+    soft_command cmd = {.type = COMMAND_SOUND_VOLUME, .volume = clampf(volume, VOLUME_MIN, VOLUME_MAX)};
+    push_command(userdata, &cmd);
+}
+
+static void set_backend_music_volume(void *userdata, float volume) {
+    assert(userdata);
+    soft_audio_context *ctx = userdata;
+    ctx->music_volume = clampf(volume, VOLUME_MIN, VOLUME_MAX);
+    soft_command cmd = {.type = COMMAND_MUSIC_VOLUME, .volume = ctx->music_volume};
+    push_command(ctx, &cmd);
+}
+
+static void get_info(void *userdata, unsigned *sample_rate, unsigned *channels, unsigned *resampler) {
+    assert(userdata);
+    soft_audio_context *ctx = userdata;
+    if(sample_rate != NULL)
+        *sample_rate = ctx->sample_rate;
+    if(channels != NULL)
+        *channels = ctx->channels;
+    if(resampler != NULL)
+        *resampler = ctx->resampler;
+}
+
+static int play_sound(void *userdata, int id, const char *src_buf, size_t src_len, size_t offset, int src_freq,
+                      float volume, float panning, int pitch, int fade) {
+    assert(userdata);
+    soft_audio_context *ctx = userdata;
+
+    // Playback ids are handed out here, so that they can be returned before the audio callback sees the sound.
+    int playback_id = ctx->next_playback_id;
+    ctx->next_playback_id = (ctx->next_playback_id + 1) & 0x7FFFFFFF;
+
+    // The sample data is not copied; sounds from the sounds loader stay put until audio is closed.
+    soft_command cmd = {
+        .type = COMMAND_PLAY,
+        .playback_id = playback_id,
+        .buf = src_buf + offset,
+        .len = src_len - offset,
+        .freq = src_freq,
+        .volume = volume,
+        .panning = panning,
+        .pitch = pitch,
+        .ms = fade,
+    };
+    if(!push_command(ctx, &cmd)) {
+        return -1;
+    }
+    return playback_id;
+}
+
+static void fade_out(int playback_id, int ms) {
+    if(active_ctx != NULL) {
+        soft_command cmd = {.type = COMMAND_FADE_OUT, .playback_id = playback_id, .ms = ms};
+        push_command(active_ctx, &cmd);
+    }
+}
+
+/**
+ * Swap the playing music source. This takes the device lock, but only happens when the music changes.
+ */
+static void swap_music(soft_audio_context *ctx, const music_source *src) {
+    music_source old;
+    SDL_LockAudioDevice(ctx->device);
+    memcpy(&old, &ctx->music, sizeof(music_source));
+    if(src != NULL) {
+        memcpy(&ctx->music, src, sizeof(music_source));
+    } else {
+        memset(&ctx->music, 0, sizeof(music_source));
+    }
+    SDL_UnlockAudioDevice(ctx->device);
+    music_source_close(&old);
+}
+
+static void stop_music(void *userdata) {
+    assert(userdata);
+    swap_music(userdata, NULL);
+}
+
+static void play_music(void *userdata, const music_source *src) {
+    assert(userdata);
+    soft_audio_context *ctx = userdata;
+    music_source music;
+    memcpy(&music, src, sizeof(music_source));
+    music_source_set_volume(&music, ctx->music_volume);
+    swap_music(ctx, &music);
+}
+
+static bool setup_backend_context(void *userdata, unsigned sample_rate, bool mono, int resampler, float music_volume,
+                                  float sound_volume) {
+    assert(userdata);
+    soft_audio_context *ctx = userdata;
+    memset(ctx, 0, sizeof(soft_audio_context));
+
+    if(SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
+        log_error("Unable to initialize audio subsystem: %s", SDL_GetError());
+        goto error_0;
+    }
+
+    // No format changes are allowed, so SDL converts for us if the device wants something else.
+    SDL_AudioSpec want, have;
+    memset(&want, 0, sizeof(want));
+    want.freq = sample_rate;
+    want.format = AUDIO_S16SYS;
+    want.channels = mono ? 1 : 2;
+    want.samples = DEVICE_SAMPLES;
+    want.callback = audio_callback;
+    want.userdata = ctx;
+    if((ctx->device = SDL_OpenAudioDevice(NULL, 0, &want, &have, 0)) == 0) {
+        log_error("Unable to open audio device: %s", SDL_GetError());
+        goto error_1;
+    }
+
+    // The device starts paused, so the callback state can be set up directly.
+    ctx->sample_rate = have.freq;
+    ctx->channels = have.channels;
+    ctx->resampler = resampler;
+    ctx->music_volume = clampf(music_volume, VOLUME_MIN, VOLUME_MAX);
+    mixer_init(&ctx->mixer, ctx->sample_rate, ctx->channels);
+    mixer_set_volume(&ctx->mixer, sound_volume);
+    active_ctx = ctx;
+
+    log_info("Opened audio device:");
+    log_info(" * Sample rate: %uHz", ctx->sample_rate);
+    log_info(" * Channels: %u", ctx->channels);
+    log_info(" * Voices: %d", MIXER_VOICES);
+    SDL_PauseAudioDevice(ctx->device, 0);
+    return true;
+
+error_1:
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+error_0:
+    return false;
+}
+
+static void close_backend_context(void *userdata) {
+    assert(userdata);
+    soft_audio_context *ctx = userdata;
+    log_debug("closing audio");
+    SDL_CloseAudioDevice(ctx->device);
+    music_source_close(&ctx->music);
+    log_debug("Mixer voices stolen: %u, sounds dropped: %u", ctx->mixer.stolen, ctx->mixer.dropped);
+    if(active_ctx == ctx) {
+        active_ctx = NULL;
+    }
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+}
+
+void soft_audio_backend_set_callbacks(audio_backend *soft_backend) {
+    soft_backend->is_available = is_available;
+    soft_backend->get_description = get_description;
+    soft_backend->get_name = get_name;
+    soft_backend->get_sample_rates = get_sample_rates;
+    soft_backend->get_info = get_info;
+    soft_backend->create = create_backend;
+    soft_backend->destroy = destroy_backend;
+    soft_backend->set_music_volume = set_backend_music_volume;
+    soft_backend->set_sound_volume = set_backend_sound_volume;
+    soft_backend->setup_context = setup_backend_context;
+    soft_backend->close_context = close_backend_context;
+    soft_backend->play_music = play_music;
+    soft_backend->play_sound = play_sound;
+    soft_backend->stop_music = stop_music;
+    soft_backend->fade_out = fade_out;
+}
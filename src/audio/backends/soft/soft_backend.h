@@ -0,0 +1,12 @@
+#ifndef SOFT_BACKEND_H
+#define SOFT_BACKEND_H
+
+#include "audio/backends/audio_backend.h"
+
+/**
+ * Audio output through a plain SDL audio device, with sound effects mixed by the built-in software mixer
+ * in the audio callback.
+ */
+void soft_audio_backend_set_callbacks(audio_backend *soft_backend);
+
+#endif // SOFT_BACKEND_H
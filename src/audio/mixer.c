@@ -0,0 +1,263 @@
+#include "audio/mixer.h"
+#include "audio/audio.h"
+#include "audio/backends/audio_backend.h"
+#include "utils/miscmath.h"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#define MIX_BLOCK 256
+
+void mixer_init(mixer *m, unsigned sample_rate, unsigned channels) {
+    memset(m, 0, sizeof(mixer));
+    m->sample_rate = sample_rate;
+    m->channels = channels;
+    m->volume = VOLUME_DEFAULT;
+}
+
+void mixer_set_volume(mixer *m, float volume) {
+    m->volume = clampf(volume, VOLUME_MIN, VOLUME_MAX);
+}
+
+static float ms_to_fade_step(const mixer *m, int ms) {
+    int frames = ms * (int)m->sample_rate / 1000;
+    return 1.0f / max2(frames, 1);
+}
+
+/**
+ * How much a voice would be missed if it was cut off now. Voices that are fading in count at their full level.
+ */
+static float voice_audibility(const mixer_voice *voice) {
+    return voice->priority * (voice->fade_step < 0.0f ? voice->fade : 1.0f);
+}
+
+static uint32_t voice_remaining(const mixer_voice *voice) {
+    return voice->len - (uint32_t)(voice->pos >> 32);
+}
+
+/**
+ * Check if voice a should be stolen before voice b: the least audible one goes first, then one that is already
+ * fading out, then the one closest to its end.
+ */
+static bool steal_first(const mixer_voice *a, const mixer_voice *b) {
+    float audibility_a = voice_audibility(a);
+    float audibility_b = voice_audibility(b);
+    if(audibility_a != audibility_b) {
+        return audibility_a < audibility_b;
+    }
+    bool fading_a = a->fade_step < 0.0f;
+    bool fading_b = b->fade_step < 0.0f;
+    if(fading_a != fading_b) {
+        return fading_a;
+    }
+    return voice_remaining(a) < voice_remaining(b);
+}
+
+static mixer_voice *find_voice(mixer *m, float priority) {
+    mixer_voice *best = NULL;
+    for(int i = 0; i < MIXER_VOICES; i++) {
+        mixer_voice *voice = &m->voices[i];
+        if(!voice->active) {
+            return voice;
+        }
+        if(best == NULL || steal_first(voice, best)) {
+            best = voice;
+        }
+    }
+    if(voice_audibility(best) > priority) {
+        m->dropped++;
+        return NULL;
+    }
+    m->stolen++;
+    return best;
+}
+
+bool mixer_play(mixer *m, int playback_id, const char *buf, size_t len, int freq, float volume, float panning,
+                int pitch, int fade, float priority) {
+    if(len == 0) {
+        return false;
+    }
+    mixer_voice *voice = find_voice(m, priority);
+    if(voice == NULL) {
+        return false;
+    }
+
+    volume = clampf(volume, VOLUME_MIN, VOLUME_MAX);
+    panning = clampf(panning, PANNING_MIN, PANNING_MAX);
+    memset(voice, 0, sizeof(mixer_voice));
+    voice->buf = (const unsigned char *)buf;
+    voice->len = len;
+    voice->step = ((uint64_t)pitched_samplerate(freq, pitch) << 32) / m->sample_rate;
+    voice->gain_left = volume * ((panning > 0) ? 1.0f - panning : 1.0f);
+    voice->gain_right = volume * ((panning < 0) ? 1.0f + panning : 1.0f);
+    if(fade > 0) {
+        voice->fade = 0.0f;
+        voice->fade_step = ms_to_fade_step(m, fade);
+    } else {
+        voice->fade = 1.0f;
+    }
+    voice->priority = priority;
+    voice->playback_id = playback_id;
+    voice->active = true;
+    return true;
+}
+
+void mixer_fade_out(mixer *m, int playback_id, int ms) {
+    for(int i = 0; i < MIXER_VOICES; i++) {
+        mixer_voice *voice = &m->voices[i];
+        if(voice->active && voice->playback_id == playback_id) {
+            voice->fade_step = -voice->fade * ms_to_fade_step(m, ms);
+            return;
+        }
+    }
+}
+
+void mixer_stop_all(mixer *m) {
+    for(int i = 0; i < MIXER_VOICES; i++) {
+        m->voices[i].active = false;
+    }
+}
+
+/**
+ * Resample up to frames of a voice into dst as floats in -1.0f ... 1.0f, interpolating linearly between source
+ * samples. The stepping through the source is a gather, so this part stays scalar.
+ * @return Number of frames written; less than asked if the sample ended.
+ */
+static unsigned fetch_voice(mixer_voice *voice, float *dst, unsigned frames) {
+    unsigned i = 0;
+    for(; i < frames; i++) {
+        uint32_t index = voice->pos >> 32;
+        if(index >= voice->len) {
+            break;
+        }
+        float frac = (uint32_t)voice->pos * (1.0f / 4294967296.0f);
+        float s0 = voice->buf[index] - 128;
+        float s1 = (index + 1 < voice->len) ? voice->buf[index + 1] - 128 : s0;
+        dst[i] = (s0 + (s1 - s0) * frac) * (1.0f / 128.0f);
+        voice->pos += voice->step;
+    }
+    return i;
+}
+
+/**
+ * acc += src * gain, with the gain ramping by fade_step per frame and clamped to 0.0f ... 1.0f.
+ * For stereo output, the left and right gains are applied to interleaved pairs.
+ */
+static void mix_mono(float *acc, const float *src, unsigned n, unsigned channels, float gain_left, float gain_right,
+                     float fade, float fade_step) {
+    unsigned i = 0;
+#if defined(__SSE2__)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 gl = _mm_set1_ps(gain_left);
+    const __m128 gr = _mm_set1_ps(gain_right);
+    const __m128 step4 = _mm_set1_ps(fade_step * 4);
+    __m128 f = _mm_add_ps(_mm_set1_ps(fade), _mm_mul_ps(_mm_set_ps(3, 2, 1, 0), _mm_set1_ps(fade_step)));
+    for(; i + 4 <= n; i += 4) {
+        __m128 s = _mm_mul_ps(_mm_loadu_ps(src + i), _mm_min_ps(_mm_max_ps(f, zero), one));
+        if(channels == 2) {
+            __m128 l = _mm_mul_ps(s, gl);
+            __m128 r = _mm_mul_ps(s, gr);
+            float *out = acc + i * 2;
+            _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_unpacklo_ps(l, r)));
+            _mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_unpackhi_ps(l, r)));
+        } else {
+            _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(s, gl)));
+        }
+        f = _mm_add_ps(f, step4);
+    }
+#elif defined(__ARM_NEON)
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t step4 = vdupq_n_f32(fade_step * 4);
+    const float ramp[4] = {0, 1, 2, 3};
+    float32x4_t f = vmlaq_n_f32(vdupq_n_f32(fade), vld1q_f32(ramp), fade_step);
+    for(; i + 4 <= n; i += 4) {
+        float32x4_t s = vmulq_f32(vld1q_f32(src + i), vminq_f32(vmaxq_f32(f, zero), one));
+        if(channels == 2) {
+            float32x4x2_t lr = vzipq_f32(vmulq_n_f32(s, gain_left), vmulq_n_f32(s, gain_right));
+            float *out = acc + i * 2;
+            vst1q_f32(out, vaddq_f32(vld1q_f32(out), lr.val[0]));
+            vst1q_f32(out + 4, vaddq_f32(vld1q_f32(out + 4), lr.val[1]));
+        } else {
+            vst1q_f32(acc + i, vmlaq_n_f32(vld1q_f32(acc + i), s, gain_left));
+        }
+        f = vaddq_f32(f, step4);
+    }
+#endif
+    for(; i < n; i++) {
+        float s = src[i] * clampf(fade + fade_step * i, 0.0f, 1.0f);
+        if(channels == 2) {
+            acc[i * 2 + 0] += s * gain_left;
+            acc[i * 2 + 1] += s * gain_right;
+        } else {
+            acc[i] += s * gain_left;
+        }
+    }
+}
+
+/**
+ * dst += acc scaled to 16 bits, saturating. The scaled value is truncated and saturated to 16 bits before the
+ * add, in the same way by every code path, so the output does not depend on the instruction set or on where
+ * a sample falls in the buffer.
+ */
+static void store_s16(int16_t *dst, const float *acc, unsigned n) {
+    unsigned i = 0;
+#if defined(__SSE2__)
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    for(; i + 8 <= n; i += 8) {
+        __m128i lo = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(acc + i), scale));
+        __m128i hi = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(acc + i + 4), scale));
+        __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_adds_epi16(d, _mm_packs_epi32(lo, hi)));
+    }
+#elif defined(__ARM_NEON)
+    for(; i + 8 <= n; i += 8) {
+        int32x4_t lo = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(acc + i), 32767.0f));
+        int32x4_t hi = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(acc + i + 4), 32767.0f));
+        int16x8_t s = vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi));
+        vst1q_s16(dst + i, vqaddq_s16(vld1q_s16(dst + i), s));
+    }
+#endif
+    for(; i < n; i++) {
+        int v = (int)clampf(acc[i] * 32767.0f, -32768.0f, 32767.0f);
+        dst[i] = clamp(dst[i] + v, -32768, 32767);
+    }
+}
+
+void mixer_render(mixer *m, int16_t *dst, unsigned frames) {
+    float acc[MIX_BLOCK * 2];
+    float src[MIX_BLOCK];
+    for(unsigned done = 0; done < frames;) {
+        unsigned block = umin2(frames - done, MIX_BLOCK);
+        bool silent = true;
+        memset(acc, 0, block * m->channels * sizeof(float));
+        for(int i = 0; i < MIXER_VOICES; i++) {
+            mixer_voice *voice = &m->voices[i];
+            if(!voice->active) {
+                continue;
+            }
+            unsigned n = fetch_voice(voice, src, block);
+            mix_mono(acc, src, n, m->channels, voice->gain_left * m->volume, voice->gain_right * m->volume,
+                     voice->fade, voice->fade_step);
+            silent = false;
+
+            voice->fade = clampf(voice->fade + voice->fade_step * n, 0.0f, 1.0f);
+            if(voice->fade_step > 0.0f && voice->fade >= 1.0f) {
+                voice->fade_step = 0.0f;
+            }
+            if(n < block || (voice->fade_step < 0.0f && voice->fade <= 0.0f)) {
+                voice->active = false;
+            }
+        }
+        if(!silent) {
+            store_s16(dst + done * m->channels, acc, block * m->channels);
+        }
+        done += block;
+    }
+}
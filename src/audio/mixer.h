@@ -0,0 +1,71 @@
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MIXER_VOICES 32
+
+/**
+ * Software mixer for the game's sound effects: unsigned 8-bit mono samples, resampled to the output rate with
+ * pitch, panning and linear fades. The mixer does no locking of its own; all calls for one mixer must come
+ * from the same thread, or be otherwise serialized by the owner.
+ */
+typedef struct mixer_voice {
+    const unsigned char *buf; // Referenced, not copied; must outlive the voice
+    uint32_t len;
+    uint64_t pos;  // 32.32 fixed point position in buf
+    uint64_t step; // 32.32 fixed point source samples per output frame
+    float gain_left;
+    float gain_right;
+    float fade;      // Current fade level, 0.0f ... 1.0f
+    float fade_step; // Fade level change per output frame
+    float priority;
+    int playback_id;
+    bool active;
+} mixer_voice;
+
+typedef struct mixer {
+    unsigned sample_rate;
+    unsigned channels;
+    float volume;
+    mixer_voice voices[MIXER_VOICES];
+    unsigned stolen;  // Voices cut short to make room for a new sound
+    unsigned dropped; // Sounds that did not get a voice at all
+} mixer;
+
+void mixer_init(mixer *m, unsigned sample_rate, unsigned channels);
+void mixer_set_volume(mixer *m, float volume);
+
+/**
+ * Start a sound. If all voices are busy, the least audible voice is stolen, unless the new sound has a
+ * lower priority than all of the playing ones.
+ *
+ * @param playback_id Caller chosen handle for mixer_fade_out
+ * @param buf Unsigned 8-bit mono sample data
+ * @param freq Sample rate of the data, before pitch
+ * @param priority Higher priority sounds are kept over lower priority ones when the voices run out
+ * @param fade How many milliseconds to fade in the playback over
+ * @return false if the sound was dropped.
+ */
+bool mixer_play(mixer *m, int playback_id, const char *buf, size_t len, int freq, float volume, float panning,
+                int pitch, int fade, float priority);
+
+/**
+ * Fade a playing sound to silence and stop it. Unknown or finished handles are ignored.
+ */
+void mixer_fade_out(mixer *m, int playback_id, int ms);
+
+/**
+ * Stop all playing sounds.
+ */
+void mixer_stop_all(mixer *m);
+
+/**
+ * Mix the active voices on top of interleaved signed 16-bit samples in dst, saturating on overflow.
+ * Clear dst first to get the sound effects alone.
+ */
+void mixer_render(mixer *m, int16_t *dst, unsigned frames);
+
+#endif // MIXER_H
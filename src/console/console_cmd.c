@@ -1,6 +1,7 @@
 #include "audio/audio.h"
 #include "console/console.h"
 #include "console/console_type.h"
+#include "controller/net_controller.h"
 #include "formats/error.h"
 #include "formats/rec_assertion.h"
 #include "game/scenes/arena.h"
@@ -456,6 +457,34 @@ int console_cmd_assert(game_state *gs, int argc, char **argv) {
     }
 }
 
+int console_cmd_netstats(game_state *gs, int argc, char **argv) {
+    if(argc == 1) {
+        net_stats_set_overlay(!net_stats_overlay_enabled());
+        console_output_addline(net_stats_overlay_enabled() ? "Netplay stats overlay ON" : "Netplay stats overlay OFF");
+        return 0;
+    }
+    if(argc == 2 && strcmp(argv[1], "show") == 0) {
+        for(int i = 0; i < game_state_num_players(gs); i++) {
+            controller *ctrl = game_player_get_ctrl(game_state_get_player(gs, i));
+            if(ctrl == NULL || ctrl->type != CTRL_TYPE_NETWORK) {
+                continue;
+            }
+            char buf[512];
+            net_stats_format(net_controller_get_stats(ctrl), SDL_GetTicks64(), buf, sizeof(buf));
+            char *line = strtok(buf, "\n");
+            while(line != NULL) {
+                console_output_addline(line);
+                line = strtok(NULL, "\n");
+            }
+            return 0;
+        }
+        console_output_addline("Not in a network game");
+        return 1;
+    }
+    console_output_addline("Usage: netstats [show]");
+    return 1;
+}
+
 void console_init_cmd(void) {
     // Add console commands
     console_add_cmd("h", &console_cmd_history, "show command history");
@@ -479,4 +508,6 @@ void console_init_cmd(void) {
     console_add_cmd("rank", &console_cmd_rank, "Set tournament mode rank");
     console_add_cmd("assert", &console_cmd_assert, "Insert an assertion into the current REC file");
     console_add_cmd("score", &console_cmd_score, "Set current score");
+    console_add_cmd("netstats", &console_cmd_netstats,
+                    "Toggle the netplay stats overlay. usage: netstats, or netstats show to print them");
 }
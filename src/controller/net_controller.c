@@ -11,10 +11,37 @@
 #include "game/utils/serial.h"
 #include "game/utils/settings.h"
 #include "utils/allocator.h"
-#include "utils/list.h"
 #include "utils/log.h"
 #include "utils/miscmath.h"
 
+#define MAX_EVENTS_PER_TICK 11
+#define TRANSCRIPT_INITIAL_SIZE 256
+
+typedef struct {
+    uint32_t tick;
+    uint8_t events[2][MAX_EVENTS_PER_TICK];
+} tick_events;
+
+// the inputs of both players, stored at tick modulo the size.
+// A slot only holds events if its tick is the one asked for and within [first, end).
+typedef struct {
+    tick_events *ticks;
+    uint32_t size;
+    // the oldest tick kept, everything before has been agreed on and replayed
+    uint32_t first;
+    // one past the newest tick with events
+    uint32_t end;
+} transcript;
+
+// a replayed tick, kept so a later rollback can start from it
+typedef struct {
+    snapshot snap;
+    // the arena hash after the inputs of the tick were applied
+    uint32_t hash;
+} rollback_frame;
+
+#define NO_ROLLBACK_TICK UINT32_MAX
+
 typedef struct {
     ENetHost *host;
     ENetPeer *peer;
@@ -44,7 +71,7 @@ typedef struct {
     uint32_t last_tick;
     // the last tick we've sent to the peer
     uint32_t last_sent_tick;
-    list transcript;
+    transcript transcript;
     // the last tick we've received from the peer
     uint32_t last_received_tick;
     // the tick of the last event the peer has ACKed
@@ -67,17 +94,20 @@ typedef struct {
     // the last action the peer took
     uint8_t last_peer_action;
     SDL_RWops *trace_file;
-    game_state *gs_bak;
+    // the game state at the last tick both sides agreed on
+    snapshot saved;
+    // recently replayed ticks, indexed by int_tick modulo the window
+    rollback_frame rollback[NET_ROLLBACK_WINDOW];
+    // the earliest tick whose inputs changed since the last replay
+    uint32_t rollback_tick;
+    // the sounds that were playing before a rollback
+    vector rollback_sounds;
+    net_stats stats;
+    // matches played on this connection, numbers the stats dumps
+    int match;
     int winner;
 } wtf;
 
-#define MAX_EVENTS_PER_TICK 11
-
-typedef struct {
-    uint32_t tick;
-    uint8_t events[2][MAX_EVENTS_PER_TICK];
-} tick_events;
-
 // simple standard deviation calculation
 float stddev(float average, int data[], int n) {
     float variance = 0.0f;
@@ -97,6 +127,10 @@ int avg_rtt(wtf *data) {
     if(data->rttfilled) {
         n = 100;
     }
+    if(n == 0) {
+        // No samples yet
+        return 0;
+    }
     for(int i = 0; i < n; i++) {
         sum += data->rttbuf[i];
     }
@@ -116,21 +150,87 @@ int avg_rtt(wtf *data) {
     return truncf(average);
 }
 
-// insert an event into the event trace
-void insert_event(wtf *data, uint32_t tick, uint16_t action, int id) {
+static void transcript_mark_empty(tick_events *ticks, uint32_t size) {
+    for(uint32_t i = 0; i < size; i++) {
+        ticks[i].tick = UINT32_MAX;
+    }
+}
 
-    iterator it;
-    list *transcript = &data->transcript;
-    list_iter_begin(transcript, &it);
-    tick_events *ev = NULL;
-    tick_events *nev = NULL;
-    tick_events event;
-    event.tick = tick;
-    memset(event.events[id], 0, MAX_EVENTS_PER_TICK);
-    memset(event.events[abs(id - 1)], 0, MAX_EVENTS_PER_TICK);
-    event.events[id][0] = action;
-    int i = 0;
+static void transcript_create(transcript *t) {
+    t->size = TRANSCRIPT_INITIAL_SIZE;
+    t->ticks = omf_calloc(t->size, sizeof(tick_events));
+    transcript_mark_empty(t->ticks, t->size);
+    t->first = 0;
+    t->end = 0;
+}
+
+static void transcript_free(transcript *t) {
+    omf_free(t->ticks);
+    t->size = 0;
+}
+
+static void transcript_clear(transcript *t) {
+    transcript_mark_empty(t->ticks, t->size);
+    t->first = 0;
+    t->end = 0;
+}
+
+// the events at a tick, or NULL if there are none
+static tick_events *transcript_get(transcript *t, uint32_t tick) {
+    if(tick < t->first || tick >= t->end) {
+        return NULL;
+    }
+    tick_events *ev = &t->ticks[tick % t->size];
+    return ev->tick == tick ? ev : NULL;
+}
+
+// the events at a tick, adding an empty entry if there are none yet. NULL if the tick was already dropped.
+static tick_events *transcript_add(transcript *t, uint32_t tick) {
+    if(tick < t->first) {
+        return NULL;
+    }
+    if(tick - t->first >= t->size) {
+        // too far ahead to fit, move the kept ticks over to a bigger buffer
+        uint32_t size = t->size;
+        while(tick - t->first >= size) {
+            size *= 2;
+        }
+        tick_events *ticks = omf_calloc(size, sizeof(tick_events));
+        transcript_mark_empty(ticks, size);
+        for(uint32_t i = t->first; i < t->end; i++) {
+            tick_events *ev = transcript_get(t, i);
+            if(ev) {
+                ticks[i % size] = *ev;
+            }
+        }
+        omf_free(t->ticks);
+        t->ticks = ticks;
+        t->size = size;
+    }
+
+    tick_events *ev = &t->ticks[tick % t->size];
+    if(ev->tick != tick || tick >= t->end) {
+        memset(ev, 0, sizeof(tick_events));
+        ev->tick = tick;
+    }
+    if(tick >= t->end) {
+        t->end = tick + 1;
+    }
+    return ev;
+}
+
+// drop the ticks up to and including the given one
+static void transcript_trim(transcript *t, uint32_t tick) {
+    if(tick >= t->first) {
+        t->first = tick + 1;
+    }
+    if(t->end < t->first) {
+        t->end = t->first;
+    }
+}
 
+// insert an event into the event trace
+void insert_event(wtf *data, uint32_t tick, uint16_t action, int id) {
     if(data->id == id && data->last_action == action) {
         // dedup inputs
         return;
@@ -146,33 +246,23 @@ void insert_event(wtf *data, uint32_t tick, uint16_t action, int id) {
         data->last_peer_input_tick = tick;
     }
 
-    foreach(it, ev) {
-        if(i == 0 && ev->tick > tick) {
-            list_prepend(transcript, &event, sizeof(tick_events));
-            goto done;
-        } else if(ev->tick == tick) {
-            for(int j = 0; j < MAX_EVENTS_PER_TICK; j++) {
-                if(ev->events[id][j] == 0) {
-                    if(j > 0 && ev->events[id][j - 1] == action) {
-                        // dedup
-                        return;
-                    }
-                    ev->events[id][j] = action;
-                    break;
-                }
+    tick_events *ev = transcript_add(&data->transcript, tick);
+    if(ev == NULL) {
+        // too old to matter, this tick has already been agreed on
+        return;
+    }
+    for(int j = 0; j < MAX_EVENTS_PER_TICK; j++) {
+        if(ev->events[id][j] == 0) {
+            if(j > 0 && ev->events[id][j - 1] == action) {
+                // dedup
+                return;
             }
-            goto done;
+            ev->events[id][j] = action;
+            break;
         }
-        nev = iter_peek(&it);
-        if(ev->tick < tick && nev && nev->tick > tick) {
-            list_iter_append(&it, &event, sizeof(tick_events));
-            goto done;
-        }
-        i++;
     }
-    // either the list is empty, or this tick is later than anything else
-    list_append(transcript, &event, sizeof(tick_events));
-done:
+
+    data->rollback_tick = umin2(data->rollback_tick, tick);
     if(id == data->id) {
         data->last_action = action;
     }
@@ -180,12 +270,11 @@ done:
 
 // check if we have any events to send
 bool has_event(wtf *data, int delay) {
-
-    iterator it;
-    list_iter_begin(&data->transcript, &it);
-    tick_events *ev = NULL;
-    foreach(it, ev) {
-        if(ev->tick < data->last_tick + delay && ev->tick > data->last_sent_tick && ev->events[data->id][0]) {
+    transcript *t = &data->transcript;
+    uint32_t end = umin2(t->end, data->last_tick + delay);
+    for(uint32_t tick = umax2(t->first, data->last_sent_tick + 1); tick < end; tick++) {
+        tick_events *ev = transcript_get(t, tick);
+        if(ev && ev->events[data->id][0]) {
             return true;
         }
     }
@@ -243,12 +332,12 @@ void event_names(char *buf, uint8_t *actions) {
     *buf++ = '\0';
 }
 
-void print_transcript(list *transcript) {
-    iterator it;
-    list_iter_begin(transcript, &it);
-    tick_events *ev = NULL;
-    foreach(it, ev) {
-        log_debug("tick %d has events %d -- %d", ev->tick, ev->events[0], ev->events[1]);
+void print_transcript(transcript *t) {
+    for(uint32_t tick = t->first; tick < t->end; tick++) {
+        tick_events *ev = transcript_get(t, tick);
+        if(ev) {
+            log_debug("tick %d has events %d -- %d", ev->tick, ev->events[0], ev->events[1]);
+        }
     }
 }
 
@@ -258,10 +347,7 @@ void send_events(wtf *data, int delay) {
     ENetPacket *packet;
     ENetPeer *peer = data->peer;
     ENetHost *host = data->host;
-    list *transcript = &data->transcript;
-    iterator it;
-    list_iter_begin(transcript, &it);
-    tick_events *ev = NULL;
+    transcript *t = &data->transcript;
     serial_create(&ser);
     // ACTION header
     serial_write_int8(&ser, EVENT_TYPE_ACTION);
@@ -271,14 +357,15 @@ void send_events(wtf *data, int delay) {
     // our tick
     serial_write_uint32(&ser, data->last_tick - data->local_proposal - 1);
     // the tick of our shared saved state
-    serial_write_uint32(&ser, data->gs_bak->int_tick - data->local_proposal);
+    serial_write_uint32(&ser, data->saved.int_tick - data->local_proposal);
     serial_write_int8(&ser, data->frame_advantage);
 
     int last_sent_tick = 0;
 
-    foreach(it, ev) {
-        if(ev->events[data->id][0] != 0 && ev->tick > data->last_acked_tick &&
-           ev->tick < data->last_tick - data->local_proposal + delay) {
+    uint32_t end = umin2(t->end, data->last_tick - data->local_proposal + delay);
+    for(uint32_t tick = umax2(t->first, data->last_acked_tick + 1); tick < end; tick++) {
+        tick_events *ev = transcript_get(t, tick);
+        if(ev && ev->events[data->id][0] != 0) {
             // each tick is written as the 32 bit tick value and a 0 terminated list of u8 actions on that tick
             serial_write_uint32(&ser, ev->tick);
             int i = 0;
@@ -304,12 +391,11 @@ void send_events(wtf *data, int delay) {
     enet_host_flush(host);
 }
 
-void send_game_information(wtf *data) {
+void send_game_information(wtf *data, game_state *gs) {
     serial ser;
     ENetPacket *packet;
     ENetPeer *peer = data->peer;
     ENetHost *host = data->host;
-    game_state *gs = data->gs_bak;
     game_player *player = game_state_get_player(gs, data->id);
 
     serial_create(&ser);
@@ -340,54 +426,210 @@ void send_game_information(wtf *data) {
     enet_host_flush(host);
 }
 
+// write an agreed on tick of events to the REC
+static void record_events(wtf *data, game_state *gs, tick_events *ev) {
+    sd_rec_move move;
+    data->last_traced_tick = ev->tick;
+
+    for(int j = 0; j < 2; j++) {
+        memset(&move, 0, sizeof(move));
+        move.tick = ev->tick;
+        move.lookup_id = 2;
+        move.player_id = j;
+        move.action = 0;
+
+        int k = 0;
+        while(ev->events[j][k] && k < MAX_EVENTS_PER_TICK) {
+            if(ev->events[j][k] & ACT_PUNCH) {
+                move.action |= SD_ACT_PUNCH;
+            }
+
+            if(ev->events[j][k] & ACT_KICK) {
+                move.action |= SD_ACT_KICK;
+            }
+
+            if(ev->events[j][k] & ACT_UP) {
+                move.action |= SD_ACT_UP;
+            }
+
+            if(ev->events[j][k] & ACT_DOWN) {
+                move.action |= SD_ACT_DOWN;
+            }
+
+            if(ev->events[j][k] & ACT_LEFT) {
+                move.action |= SD_ACT_LEFT;
+            }
+
+            if(ev->events[j][k] & ACT_RIGHT) {
+                move.action |= SD_ACT_RIGHT;
+            }
+
+            if(ev->events[j][k] == ACT_NONE) {
+                move.action = SD_ACT_NONE;
+            }
+
+            sd_rec_insert_action(gs->rec, gs->rec->move_count, &move);
+            k++;
+        }
+    }
+}
+
+static rollback_frame *get_rollback_frame(wtf *data, uint32_t int_tick) {
+    rollback_frame *frame = &data->rollback[int_tick % NET_ROLLBACK_WINDOW];
+    if(frame->snap.valid && frame->snap.int_tick == int_tick) {
+        return frame;
+    }
+    return NULL;
+}
+
+static void clear_rollback_frames(wtf *data) {
+    for(int i = 0; i < NET_ROLLBACK_WINDOW; i++) {
+        snapshot_clear(&data->rollback[i].snap);
+    }
+    data->rollback_tick = NO_ROLLBACK_TICK;
+}
+
+// find the newest replayed tick that no late input has changed since
+static rollback_frame *find_rollback_frame(wtf *data, uint32_t current_tick) {
+    if(data->trace_file) {
+        // the trace wants a state dump of every agreed tick, so always replay from the agreed state
+        return NULL;
+    }
+
+    uint32_t newest = current_tick - 1;
+    if(data->rollback_tick != NO_ROLLBACK_TICK) {
+        if(data->rollback_tick + data->local_proposal <= data->saved.int_tick) {
+            return NULL;
+        }
+        newest = umin2(newest, data->rollback_tick + data->local_proposal - 1);
+    }
+
+    rollback_frame *frame = NULL;
+    for(uint32_t t = newest; t > data->saved.int_tick && newest - t < NET_ROLLBACK_WINDOW; t--) {
+        if((frame = get_rollback_frame(data, t)) != NULL) {
+            break;
+        }
+    }
+    if(frame == NULL) {
+        return NULL;
+    }
+
+    // the agreed ticks we would skip over still have to be hash checked
+    uint32_t last = umin2(frame->snap.int_tick - 1 - data->local_proposal, data->last_acked_tick);
+    if(last > data->last_hash_tick) {
+        if(last - data->last_hash_tick > NET_ROLLBACK_WINDOW) {
+            return NULL;
+        }
+        for(uint32_t t = data->last_hash_tick + 1; t <= last; t++) {
+            if(get_rollback_frame(data, t + data->local_proposal) == NULL) {
+                return NULL;
+            }
+        }
+    }
+    return frame;
+}
+
+// do the bookkeeping for the agreed ticks before the frame a replay starts from
+static int skip_agreed_ticks(wtf *data, game_state *gs, rollback_frame *from) {
+    uint32_t from_tick = from->snap.int_tick - data->local_proposal;
+    uint32_t confirm_frame = data->last_acked_tick;
+
+    transcript *t = &data->transcript;
+    uint32_t end = umin2(t->end, umin2(from_tick, confirm_frame) + 1);
+    for(uint32_t tick = umax2(t->first, data->last_traced_tick + 1); tick < end; tick++) {
+        tick_events *ev = transcript_get(t, tick);
+        if(ev && (ev->events[0][0] || ev->events[1][0])) {
+            record_events(data, gs, ev);
+        }
+    }
+
+    uint32_t last = umin2(from_tick - 1, confirm_frame);
+    for(uint32_t t = data->last_hash_tick + 1; t <= last; t++) {
+        rollback_frame *frame = get_rollback_frame(data, t + data->local_proposal);
+        if(t == data->peer_last_hash_tick) {
+            net_stats_add_hash_check(&data->stats, SDL_GetTicks64(), t);
+        }
+        if(t == data->peer_last_hash_tick && data->peer_last_hash != frame->hash) {
+            log_debug("arena hash mismatch at %d (%d) -- got %" PRIu32 " expected %" PRIu32 "!", t,
+                      data->peer_last_hash_tick, data->peer_last_hash, frame->hash);
+            data->last_hash_tick = t;
+            data->last_hash = frame->hash;
+            send_events(data, NET_INPUT_DELAY);
+            return 1;
+        }
+        data->last_hash_tick = t;
+        data->last_hash = frame->hash;
+
+        if(t == confirm_frame && frame->snap.int_tick > data->saved.int_tick) {
+            log_debug("keeping replayed game state at last agreed on tick %d with hash %" PRIu32, t, frame->hash);
+            // the frame becomes the agreed state, and its slot gets the old one to reuse the buffers
+            snapshot tmp = data->saved;
+            data->saved = frame->snap;
+            frame->snap = tmp;
+            snapshot_clear(&frame->snap);
+        }
+    }
+    return 0;
+}
+
 // replay the game state, using the input logs from both sides
 int rewind_and_replay(wtf *data, controller *ctrl) {
     // first, find the last frame we have input from the other side
     // this will be our next checkpoint (as no events can come in before
-    iterator it;
-    game_state *gs_current = ctrl->gs;
-    list *transcript = &data->transcript;
-    list_iter_begin(transcript, &it);
+    game_state *gs = ctrl->gs;
     tick_events *ev = NULL;
-    game_state *gs = data->gs_bak;
-    game_state *gs_new = NULL;
+    bool saved = false;
     char buf[512];
 
-    game_state *gs_old = omf_calloc(1, sizeof(game_state));
-    game_state_clone(gs, gs_old);
-
-    log_debug("current game ticks is %" PRIu32 ", stored game ticks are %" PRIu32 ", last tick is %" PRIu32,
-              gs_current->int_tick - data->local_proposal, gs->int_tick - data->local_proposal,
-              data->last_tick - data->local_proposal);
+    uint32_t current_tick = gs->int_tick;
+    uint32_t confirm_frame = data->last_acked_tick;
 
-    // fix the game state pointers in the controllers
-    for(int i = 0; i < game_state_num_players(gs); i++) {
-        game_player *gp = game_state_get_player(gs, i);
-        controller *c = game_player_get_ctrl(gp);
-        if(c) {
-            c->gs = gs;
+    // start from the newest replayed tick the late inputs did not change, if we still have it,
+    // otherwise from the last tick we agreed on
+    snapshot *from = &data->saved;
+    rollback_frame *frame = find_rollback_frame(data, current_tick);
+    if(frame) {
+        if(skip_agreed_ticks(data, gs, frame)) {
+            data->rollback_tick = NO_ROLLBACK_TICK;
+            return 1;
         }
+        from = &frame->snap;
     }
+    uint32_t saved_tick = data->saved.int_tick;
 
-    uint64_t replay_start = SDL_GetTicks64();
-    int tick_count = 0;
+    log_debug("current game ticks is %" PRIu32 ", stored game ticks are %" PRIu32 ", replaying from %" PRIu32
+              ", last tick is %" PRIu32,
+              current_tick - data->local_proposal, saved_tick - data->local_proposal,
+              from->int_tick - data->local_proposal, data->last_tick - data->local_proposal);
 
-    uint32_t arena_hash;
+    data->rollback_tick = NO_ROLLBACK_TICK;
 
-    uint32_t confirm_frame = data->last_acked_tick;
+    // rewind the game state in place
+    game_state_copy_sounds(gs, &data->rollback_sounds);
+    if(game_state_restore(gs, from)) {
+        log_error("unable to restore the game state at tick %" PRIu32, from->int_tick - data->local_proposal);
+        return 1;
+    }
+    // replayed ticks must not start sounds or poll the network
+    gs->clone = true;
 
-    ev = iter_next(&it);
+    uint64_t replay_start = SDL_GetPerformanceCounter();
+    int tick_count = 0;
+
+    uint32_t arena_hash;
 
     uint32_t start_tick = gs->int_tick - data->local_proposal;
 
-    while(ev && ev->tick <= start_tick) {
-        // tick too old to matter
-        list_delete(transcript, &it);
-        ev = iter_next(&it);
-    }
+    // ticks up to the agreed state are too old to matter
+    transcript_trim(&data->transcript, saved_tick - data->local_proposal);
 
-    while(gs->int_tick < gs_current->int_tick) {
-        if(ev && ev->tick == gs->int_tick - data->local_proposal) {
+    while(gs->int_tick < current_tick) {
+        // the events at the start tick are already part of the state we start from
+        ev = NULL;
+        if(gs->int_tick - data->local_proposal > start_tick) {
+            ev = transcript_get(&data->transcript, gs->int_tick - data->local_proposal);
+        }
+        if(ev) {
             // feed in the inputs
             for(int j = 0; j < 2; j++) {
                 int player_id = j;
@@ -405,50 +647,7 @@ int rewind_and_replay(wtf *data, controller *ctrl) {
             if((ev->events[0][0] || ev->events[1][0]) && ev->tick <= confirm_frame &&
                ev->tick > data->last_traced_tick) {
                 // this event has been agreed on by both sides
-                sd_rec_move move;
-                data->last_traced_tick = ev->tick;
-
-                for(int j = 0; j < 2; j++) {
-                    memset(&move, 0, sizeof(move));
-                    move.tick = ev->tick;
-                    move.lookup_id = 2;
-                    move.player_id = j;
-                    move.action = 0;
-
-                    int k = 0;
-                    while(ev->events[j][k] && k < MAX_EVENTS_PER_TICK) {
-                        if(ev->events[j][k] & ACT_PUNCH) {
-                            move.action |= SD_ACT_PUNCH;
-                        }
-
-                        if(ev->events[j][k] & ACT_KICK) {
-                            move.action |= SD_ACT_KICK;
-                        }
-
-                        if(ev->events[j][k] & ACT_UP) {
-                            move.action |= SD_ACT_UP;
-                        }
-
-                        if(ev->events[j][k] & ACT_DOWN) {
-                            move.action |= SD_ACT_DOWN;
-                        }
-
-                        if(ev->events[j][k] & ACT_LEFT) {
-                            move.action |= SD_ACT_LEFT;
-                        }
-
-                        if(ev->events[j][k] & ACT_RIGHT) {
-                            move.action |= SD_ACT_RIGHT;
-                        }
-
-                        if(ev->events[j][k] == ACT_NONE) {
-                            move.action = SD_ACT_NONE;
-                        }
-
-                        sd_rec_insert_action(gs->rec, gs->rec->move_count, &move);
-                        k++;
-                    }
-                }
+                record_events(data, gs, ev);
 
                 if(data->trace_file) {
                     char buf0[12];
@@ -465,7 +664,6 @@ int rewind_and_replay(wtf *data, controller *ctrl) {
                     SDL_RWwrite(data->trace_file, buf, strlen(buf), 1);
                 }
             }
-            ev = iter_next(&it);
         } else {
             // only do this if we're not on the first tick of the replay
             if(gs->int_tick - data->local_proposal > start_tick) {
@@ -496,16 +694,26 @@ int rewind_and_replay(wtf *data, controller *ctrl) {
 
         // The next tick is past when we have agreement, so we need to save the last known good game state
         // for future replays
-        if(gs_new == NULL && gs->int_tick - data->local_proposal == confirm_frame && gs->int_tick > gs_old->int_tick) {
+        if(!saved && gs->int_tick - data->local_proposal == confirm_frame && gs->int_tick > saved_tick) {
             log_debug("saving game state at last agreed on tick %d with hash %" PRIu32,
                       gs->int_tick - data->local_proposal, arena_state_hash(gs));
             // save off the game state at the point we last agreed
             // on the state of the game
-            gs_new = omf_calloc(1, sizeof(game_state));
-            game_state_clone(gs, gs_new);
-            data->gs_bak = gs_new;
-            game_state_clone_free(gs_old);
-            omf_free(gs_old);
+            game_state_snapshot(gs, &data->saved);
+            saved = true;
+        }
+
+        // keep the last ticks of the replay around, a later rollback can start from them
+        if(current_tick - gs->int_tick <= NET_ROLLBACK_WINDOW &&
+           &data->rollback[gs->int_tick % NET_ROLLBACK_WINDOW] != frame) {
+            rollback_frame *kept = &data->rollback[gs->int_tick % NET_ROLLBACK_WINDOW];
+            game_state_snapshot(gs, &kept->snap);
+            kept->hash = arena_hash;
+        }
+
+        if(data->peer_last_hash_tick && gs->int_tick - data->local_proposal == data->peer_last_hash_tick &&
+           gs->int_tick - data->local_proposal <= confirm_frame) {
+            net_stats_add_hash_check(&data->stats, SDL_GetTicks64(), data->peer_last_hash_tick);
         }
 
         if(data->peer_last_hash_tick && gs->int_tick - data->local_proposal == data->peer_last_hash_tick &&
@@ -540,14 +748,9 @@ int rewind_and_replay(wtf *data, controller *ctrl) {
             data->last_hash = arena_hash;
             send_events(data, NET_INPUT_DELAY);
 
-            // reset the controller game states
-            for(int i = 0; i < game_state_num_players(gs); i++) {
-                game_player *gp = game_state_get_player(gs, i);
-                controller *c = game_player_get_ctrl(gp);
-                if(c) {
-                    c->gs = gs_current;
-                }
-            }
+            // the match is over, leave the game state where the hashes diverged
+            gs->clone = false;
+            game_state_merge_rolled_back_sounds(gs, &data->rollback_sounds);
             return 1;
         } else if(gs->int_tick - data->local_proposal == data->peer_last_hash_tick) {
             log_debug("arena hashes agree!");
@@ -563,26 +766,18 @@ int rewind_and_replay(wtf *data, controller *ctrl) {
         tick_count++;
     }
 
-    uint64_t replay_end = SDL_GetTicks64();
+    uint64_t replay_end = SDL_GetPerformanceCounter();
+    uint32_t replay_usec = (replay_end - replay_start) * 1000000 / SDL_GetPerformanceFrequency();
+    net_stats_add_replay(&data->stats, SDL_GetTicks64(), tick_count, replay_usec);
 
-    if(gs_new == NULL) {
-        // we weren't able to make a new state backup, so restore the old one
-        data->gs_bak = gs_old;
-    }
+    // if no newer tick was agreed on, the old snapshot is kept for the next replay
+    gs->clone = false;
+    game_state_merge_rolled_back_sounds(gs, &data->rollback_sounds);
 
     log_debug("advanced game state to %" PRIu32 ", expected %" PRIu32, gs->int_tick - data->local_proposal,
               data->last_tick - data->local_proposal);
 
-    log_debug("replayed %d ticks in %d milliseconds", tick_count, replay_end - replay_start);
-
-    // replace the game state with the replayed one
-    gs->new_state = NULL;
-    if(gs_current->new_state) {
-        game_state_clone_free(gs_current->new_state);
-        omf_free(gs_current->new_state);
-    }
-    gs_current->new_state = gs;
-    data->gs_bak->new_state = NULL;
+    log_debug("replayed %d ticks in %.3f milliseconds", tick_count, replay_usec / 1000.0f);
 
     return 0;
 }
@@ -623,6 +818,11 @@ int net_controller_tick_offset(controller *ctrl) {
     return data->tick_offset / 2;
 }
 
+const net_stats *net_controller_get_stats(controller *ctrl) {
+    wtf *data = ctrl->data;
+    return &data->stats;
+}
+
 void net_controller_free(controller *ctrl) {
     wtf *data = ctrl->data;
 
@@ -632,10 +832,12 @@ void net_controller_free(controller *ctrl) {
 
         SDL_RWwrite(data->trace_file, buf, sz, 1);
 
-        iterator it;
-        list_iter_begin(&data->transcript, &it);
-        tick_events *ev = NULL;
-        foreach(it, ev) {
+        transcript *t = &data->transcript;
+        for(uint32_t tick = t->first; tick < t->end; tick++) {
+            tick_events *ev = transcript_get(t, tick);
+            if(ev == NULL) {
+                continue;
+            }
             log_debug("tick %" PRIu32 " has events %d -- %d", ev->tick, ev->events[0], ev->events[1]);
             char buf0[12];
             char buf1[12];
@@ -679,11 +881,13 @@ done:
         enet_host_destroy(data->host);
         data->host = NULL;
     }
-    list_free(&data->transcript);
-    if(data->gs_bak) {
-        game_state_clone_free(data->gs_bak);
-        omf_free(data->gs_bak);
+    transcript_free(&data->transcript);
+    snapshot_free(&data->saved);
+    net_stats_free(&data->stats);
+    for(int i = 0; i < NET_ROLLBACK_WINDOW; i++) {
+        snapshot_free(&data->rollback[i].snap);
     }
+    vector_free(&data->rollback_sounds);
     if(ctrl->data) {
         omf_free(ctrl->data);
     }
@@ -697,7 +901,7 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
     serial ser;
     uint32_t ticks = ctrl->gs->int_tick;
 
-    if(data->gs_bak && has_event(data, NET_INPUT_DELAY) && ticks > data->last_tick) {
+    if(data->saved.valid && has_event(data, NET_INPUT_DELAY) && ticks > data->last_tick) {
         data->last_tick = ticks;
         send_events(data, NET_INPUT_DELAY);
     }
@@ -722,21 +926,27 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
         data->confirmed = false;
     }
 
-    if(data->gs_bak == NULL && data->disconnected == 0 && scene_is_arena(game_state_get_scene(ctrl->gs)) &&
+    if(!data->saved.valid && data->disconnected == 0 && scene_is_arena(game_state_get_scene(ctrl->gs)) &&
        game_state_find_object(ctrl->gs, game_player_get_har_obj_id(game_state_get_player(ctrl->gs, 1)))) {
         arena_reset(ctrl->gs->sc);
-        data->gs_bak = omf_calloc(1, sizeof(game_state));
-        game_state_clone(ctrl->gs, data->gs_bak);
-        send_game_information(data);
-        log_debug("cloned game state at arena tick %d hash %" PRIu32, data->gs_bak->int_tick - data->local_proposal,
-                  arena_state_hash(data->gs_bak));
+        game_state_snapshot(ctrl->gs, &data->saved);
+        send_game_information(data, ctrl->gs);
+        log_debug("saved game state at arena tick %d hash %" PRIu32, data->saved.int_tick - data->local_proposal,
+                  arena_state_hash(ctrl->gs));
         data->local_proposal = ticks; // reset the tick offset to the start of the match
-        data->last_hash_tick = data->gs_bak->int_tick - data->local_proposal;
-        data->last_hash = arena_state_hash(data->gs_bak);
-    } else if(data->gs_bak != NULL && !scene_is_arena(game_state_get_scene(ctrl->gs))) {
-        // changed scene and no longer need a game state backup, release it
-        game_state_clone_free(data->gs_bak);
-        omf_free(data->gs_bak);
+        data->last_hash_tick = data->saved.int_tick - data->local_proposal;
+        data->last_hash = arena_state_hash(ctrl->gs);
+        net_stats_reset(&data->stats);
+        char *stats_file = settings_get()->net.net_stats_file;
+        if(stats_file && stats_file[0] != '\0') {
+            data->match++;
+            net_stats_open_csv(&data->stats, stats_file, data->match);
+        }
+    } else if(data->saved.valid && !scene_is_arena(game_state_get_scene(ctrl->gs))) {
+        // changed scene and no longer need a game state backup, drop it
+        snapshot_clear(&data->saved);
+        clear_rollback_frames(data);
+        net_stats_close_csv(&data->stats);
         data->last_action = ACT_NONE;
         data->synchronized = false;
         data->local_proposal = 0;
@@ -744,7 +954,6 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
         data->confirmed = false;
         data->last_tick = 0;
         data->last_sent_tick = 0;
-        data->gs_bak = NULL;
         data->last_received_tick = 0;
         data->last_acked_tick = 0;
         data->last_har_state = -1;
@@ -754,8 +963,7 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
         data->last_hash = 0;
         data->last_hash_tick = 0;
 
-        list_free(&data->transcript);
-        list_create(&data->transcript);
+        transcript_clear(&data->transcript);
     }
 
     bool has_received = false;
@@ -776,17 +984,15 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
 
                         data->frame_advantage = (ticks - data->local_proposal) - (peerticks + (avg_rtt(data) / 2));
 
-                        if(data->gs_bak && data->synchronized && data->frame_advantage > peer_frame_advantage + 1) {
+                        // the delay is engine pacing, so it is not rolled back with the rest of the game state
+                        if(data->saved.valid && data->synchronized &&
+                           data->frame_advantage > peer_frame_advantage + 1) {
                             log_debug("local ticks %d  remote ticks %d (rtt %d) frame advantage %d > %d",
                                       ticks - data->local_proposal, peerticks, (avg_rtt(data) / 2),
                                       data->frame_advantage, peer_frame_advantage);
                             ctrl->gs->delay = (data->frame_advantage - peer_frame_advantage) * 2;
-                            data->gs_bak->delay = (data->frame_advantage - peer_frame_advantage) * 2;
                         } else {
                             ctrl->gs->delay = 0;
-                            if(data->gs_bak) {
-                                data->gs_bak->delay = 0;
-                            }
                         }
 
                         for(size_t i = ser.rpos; i < event.packet->dataLength;) {
@@ -799,7 +1005,7 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
                                 action = serial_read_int8(&ser);
                                 k++;
 
-                                if(data->synchronized && data->gs_bak) {
+                                if(data->synchronized && data->saved.valid) {
                                     if(remote_tick > data->last_received_tick) {
                                         has_received = true;
                                         if(action) {
@@ -816,7 +1022,7 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
                             } while(action);
                             i += 4 + k;
                         }
-                        if(data->synchronized && data->gs_bak) {
+                        if(data->synchronized && data->saved.valid) {
                             // the 20 is here to avoid doing blank replays too often
                             if(last_acked > data->last_acked_tick + 20) {
                                 // the remote state has updated, so we may be able to advance our local state more
@@ -831,9 +1037,8 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
                                 data->peer_last_hash_tick = peer_last_hash_tick;
                                 data->peer_last_hash = peer_last_hash;
                                 log_debug("peer last hash is %" PRIu32 " %d, local is %d %" PRIu32,
-                                          data->peer_last_hash_tick, data->peer_last_hash,
-                                          data->gs_bak->int_tick - data->local_proposal,
-                                          arena_state_hash(data->gs_bak));
+                                          data->peer_last_hash_tick, data->peer_last_hash, data->last_hash_tick,
+                                          data->last_hash);
                             }
                         }
                     } break;
@@ -973,7 +1178,7 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
                         // cross-check the config with the peer
                         uint8_t val = serial_read_int8(&ser);
                         game_player *player = game_state_get_player(ctrl->gs, abs(data->id - 1));
-                        if(data->gs_bak && ctrl->gs->this_id - SCENE_ARENA0 != val) {
+                        if(data->saved.valid && ctrl->gs->this_id - SCENE_ARENA0 != val) {
                             log_error("Arena ID mismatch, we had %d they had %d", ctrl->gs->this_id - SCENE_ARENA0,
                                       val);
                             enet_peer_disconnect_later(data->peer, 0);
@@ -1054,16 +1259,15 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
                 event.peer->data = NULL;
                 data->synchronized = false;
                 data->winner = arena_is_over(ctrl->gs->sc);
-                if(data->winner == -1 && data->gs_bak) {
+                if(data->winner == -1 && data->saved.valid) {
                     // match did not end cleanly
                     // so force the game to playback ALL events to try to update the trace/rec files
                     data->last_received_tick = ctrl->gs->int_tick - data->local_proposal;
                     rewind_and_replay(data, ctrl);
                 }
-                if(data->gs_bak) {
-                    game_state_clone_free(data->gs_bak);
-                    omf_free(data->gs_bak);
-                }
+                snapshot_clear(&data->saved);
+                clear_rollback_frames(data);
+                net_stats_close_csv(&data->stats);
                 if(ctrl->gs->rec) {
                     sd_rec_finish(ctrl->gs->rec, ticks - data->local_proposal);
                 }
@@ -1101,6 +1305,12 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
         data->last_rewind_tick = ticks;
     }
 
+    if(data->saved.valid) {
+        uint64_t now = SDL_GetTicks64();
+        net_stats_set_connection(&data->stats, avg_rtt(data), data->frame_advantage, data->tick_offset);
+        net_stats_write_csv(&data->stats, now, ticks - data->local_proposal);
+    }
+
     unsigned tick_interval = 5;
     // sample slower once we've filled the buffer and the ping seems stable
     if(data->rttfilled && !rapid_rtt_change) {
@@ -1146,7 +1356,7 @@ void controller_hook(controller *ctrl, int action) {
 
     if(peer) {
         // log_debug("Local event %d at %d", action, data->last_tick - data->local_proposal);
-        if(data->synchronized && data->gs_bak) {
+        if(data->synchronized && data->saved.valid) {
             insert_event(data, ctrl->gs->int_tick - data->local_proposal + NET_INPUT_DELAY /*+ (ctrl->rtt / 2)*/,
                          action, data->id);
         } else {
@@ -1222,30 +1432,33 @@ int net_controller_poll(controller *ctrl, ctrl_event **ev) {
     if(ctrl->gs->clone) {
         return 0;
     }
-    iterator it;
-    list *transcript = &data->transcript;
-    list_iter_begin(transcript, &it);
-    tick_events *e = NULL;
+    transcript *t = &data->transcript;
     int id = abs(data->id - 1);
     uint32_t current_tick = ctrl->gs->int_tick - data->local_proposal;
+
+    tick_events *e = transcript_get(t, current_tick);
+    if(e && e->events[id][0] != 0) {
+        // events for the current tick, send em all
+        int i = 0;
+        while(e->events[id][i] && i < MAX_EVENTS_PER_TICK) {
+            controller_cmd(ctrl, e->events[id][i], ev);
+            i++;
+        }
+        return 0;
+    }
+
     // last peer input may be from before, so start with that
     uint8_t last = data->last_peer_action;
-
-    foreach(it, e) {
-        if(e->events[id][0] != 0 && e->tick == current_tick) {
-            // events for the current tick, send em all
-            int i = 0;
-            while(e->events[id][i]) {
-                controller_cmd(ctrl, e->events[id][i], ev);
-                i++;
-            }
-            return 0;
-        } else if(e->events[id][0] != 0 && e->tick < current_tick) {
+    // otherwise repeat the newest input before this tick
+    for(uint32_t tick = umin2(current_tick, t->end); tick > t->first; tick--) {
+        e = transcript_get(t, tick - 1);
+        if(e && e->events[id][0] != 0) {
             int i = 0;
             while(e->events[id][i] && i < MAX_EVENTS_PER_TICK) {
                 last = e->events[id][i];
                 i++;
             }
+            break;
         }
     }
     // return the last input we've gotten from the peer
@@ -1271,7 +1484,14 @@ void net_controller_create(controller *ctrl, ENetHost *host, ENetPeer *peer, ENe
     data->confirmed = false;
     data->last_tick = 0;
     data->last_sent_tick = 0;
-    data->gs_bak = NULL;
+    snapshot_create(&data->saved);
+    for(int i = 0; i < NET_ROLLBACK_WINDOW; i++) {
+        snapshot_create(&data->rollback[i].snap);
+    }
+    data->rollback_tick = NO_ROLLBACK_TICK;
+    vector_create(&data->rollback_sounds, sizeof(playing_sound));
+    net_stats_create(&data->stats);
+    data->match = 0;
     data->last_received_tick = 0;
     data->last_acked_tick = 0;
     data->last_har_state = -1;
@@ -1288,7 +1508,7 @@ void net_controller_create(controller *ctrl, ENetHost *host, ENetPeer *peer, ENe
             log_debug("failed to open trace file");
         }
     }
-    list_create(&data->transcript);
+    transcript_create(&data->transcript);
     ctrl->data = data;
     ctrl->type = CTRL_TYPE_NETWORK;
     ctrl->tick_fun = &net_controller_tick;
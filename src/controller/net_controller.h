@@ -2,8 +2,11 @@
 #define NET_CONTROLLER_H
 
 #define NET_INPUT_DELAY 2
+// how many of the most recently replayed ticks are kept as rollback points
+#define NET_ROLLBACK_WINDOW 16
 
 #include "controller/controller.h"
+#include "controller/net_stats.h"
 #include <SDL.h>
 #include <enet/enet.h>
 
@@ -14,6 +17,7 @@ void net_controller_har_hook(int action, void *cb_data);
 
 bool net_controller_ready(controller *ctrl);
 int net_controller_tick_offset(controller *ctrl);
+const net_stats *net_controller_get_stats(controller *ctrl);
 
 ENetPeer *net_controller_get_lobby_connection(controller *ctrl);
 
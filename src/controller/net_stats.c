@@ -0,0 +1,197 @@
+#include "controller/net_stats.h"
+#include "utils/log.h"
+#include <stdio.h>
+#include <string.h>
+
+static bool overlay_enabled = false;
+
+void net_stats_create(net_stats *stats) {
+    memset(stats, 0, sizeof(net_stats));
+}
+
+void net_stats_free(net_stats *stats) {
+    net_stats_close_csv(stats);
+}
+
+void net_stats_reset(net_stats *stats) {
+    SDL_RWops *csv = stats->csv;
+    memset(stats, 0, sizeof(net_stats));
+    stats->csv = csv;
+}
+
+void net_stats_add_replay(net_stats *stats, uint64_t now, uint32_t ticks, uint32_t usec) {
+    net_stats_replay *replay = &stats->replays[stats->replay_pos];
+    replay->time = now;
+    replay->ticks = ticks;
+    replay->usec = usec;
+    stats->replay_pos = (stats->replay_pos + 1) % NET_STATS_SAMPLES;
+    if(stats->replay_count < NET_STATS_SAMPLES) {
+        stats->replay_count++;
+    }
+}
+
+void net_stats_add_hash_check(net_stats *stats, uint64_t now, uint32_t tick) {
+    if(tick == stats->last_hash_tick) {
+        return;
+    }
+    stats->last_hash_tick = tick;
+    stats->hash_checks[stats->hash_pos] = now;
+    stats->hash_pos = (stats->hash_pos + 1) % NET_STATS_SAMPLES;
+    if(stats->hash_count < NET_STATS_SAMPLES) {
+        stats->hash_count++;
+    }
+}
+
+void net_stats_set_connection(net_stats *stats, int avg_rtt, int frame_advantage, int tick_offset) {
+    stats->avg_rtt = avg_rtt;
+    stats->frame_advantage = frame_advantage;
+    stats->tick_offset = tick_offset;
+}
+
+int net_stats_rollbacks_per_sec(const net_stats *stats, uint64_t now) {
+    int count = 0;
+    for(unsigned i = 0; i < stats->replay_count; i++) {
+        if(now - stats->replays[i].time < 1000) {
+            count++;
+        }
+    }
+    return count;
+}
+
+int net_stats_hash_checks_per_sec(const net_stats *stats, uint64_t now) {
+    int count = 0;
+    for(unsigned i = 0; i < stats->hash_count; i++) {
+        if(now - stats->hash_checks[i] < 1000) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static int bucket(uint32_t value, uint32_t first) {
+    int i = 0;
+    while(i < NET_STATS_BUCKETS - 1 && value > first) {
+        first *= 2;
+        i++;
+    }
+    return i;
+}
+
+void net_stats_histogram(const net_stats *stats, unsigned ticks[NET_STATS_BUCKETS], unsigned ms[NET_STATS_BUCKETS]) {
+    memset(ticks, 0, sizeof(unsigned) * NET_STATS_BUCKETS);
+    memset(ms, 0, sizeof(unsigned) * NET_STATS_BUCKETS);
+    for(unsigned i = 0; i < stats->replay_count; i++) {
+        ticks[bucket(stats->replays[i].ticks, 1)]++;
+        ms[bucket(stats->replays[i].usec, 250)]++;
+    }
+}
+
+// averages and maximums over the recorded replays that finished at or after the given time
+static void replay_summary(const net_stats *stats, uint64_t since, float *avg_ticks, uint32_t *max_ticks,
+                           float *avg_ms, float *max_ms) {
+    uint64_t sum_ticks = 0;
+    uint64_t sum_usec = 0;
+    uint32_t max_usec = 0;
+    unsigned n = 0;
+    *max_ticks = 0;
+    for(unsigned i = 0; i < stats->replay_count; i++) {
+        if(stats->replays[i].time < since) {
+            continue;
+        }
+        n++;
+        sum_ticks += stats->replays[i].ticks;
+        sum_usec += stats->replays[i].usec;
+        if(stats->replays[i].ticks > *max_ticks) {
+            *max_ticks = stats->replays[i].ticks;
+        }
+        if(stats->replays[i].usec > max_usec) {
+            max_usec = stats->replays[i].usec;
+        }
+    }
+    if(n == 0) {
+        n = 1;
+    }
+    *avg_ticks = (float)sum_ticks / n;
+    *avg_ms = (float)sum_usec / n / 1000.0f;
+    *max_ms = max_usec / 1000.0f;
+}
+
+void net_stats_format(const net_stats *stats, uint64_t now, char *buf, size_t len) {
+    unsigned ticks[NET_STATS_BUCKETS];
+    unsigned ms[NET_STATS_BUCKETS];
+    float avg_ticks, avg_ms, max_ms;
+    uint32_t max_ticks;
+    net_stats_histogram(stats, ticks, ms);
+    replay_summary(stats, 0, &avg_ticks, &max_ticks, &avg_ms, &max_ms);
+
+    snprintf(buf, len,
+             "rollbacks/s %d hash checks/s %d\n"
+             "rtt %d advantage %d offset %d\n"
+             "replay ticks avg %.1f max %u\n"
+             "replay ms avg %.2f max %.2f\n"
+             "ticks <=1:%u 2:%u 4:%u 8:%u 16:%u 32:%u 64:%u >:%u\n"
+             "ms <.25:%u .5:%u 1:%u 2:%u 4:%u 8:%u 16:%u >:%u",
+             net_stats_rollbacks_per_sec(stats, now), net_stats_hash_checks_per_sec(stats, now), stats->avg_rtt,
+             stats->frame_advantage, stats->tick_offset, avg_ticks, max_ticks, avg_ms, max_ms, ticks[0], ticks[1],
+             ticks[2], ticks[3], ticks[4], ticks[5], ticks[6], ticks[7], ms[0], ms[1], ms[2], ms[3], ms[4], ms[5],
+             ms[6], ms[7]);
+}
+
+bool net_stats_open_csv(net_stats *stats, const char *path, int match) {
+    net_stats_close_csv(stats);
+
+    // put the match number in front of the extension, if there is one
+    char filename[1024];
+    const char *slash = strrchr(path, '/');
+    const char *dot = strrchr(path, '.');
+    if(dot == NULL || (slash != NULL && dot < slash)) {
+        snprintf(filename, sizeof(filename), "%s-%d", path, match);
+    } else {
+        snprintf(filename, sizeof(filename), "%.*s-%d%s", (int)(dot - path), path, match, dot);
+    }
+
+    stats->csv = SDL_RWFromFile(filename, "w");
+    if(stats->csv == NULL) {
+        log_error("failed to open netplay stats file %s", filename);
+        return false;
+    }
+    const char *header = "tick,rollbacks_per_sec,replay_ticks_avg,replay_ticks_max,replay_ms_avg,replay_ms_max,"
+                         "avg_rtt,frame_advantage,tick_offset,hash_checks_per_sec\n";
+    SDL_RWwrite(stats->csv, header, strlen(header), 1);
+    stats->last_row = 0;
+    return true;
+}
+
+void net_stats_close_csv(net_stats *stats) {
+    if(stats->csv) {
+        SDL_RWclose(stats->csv);
+        stats->csv = NULL;
+    }
+}
+
+void net_stats_write_csv(net_stats *stats, uint64_t now, uint32_t tick) {
+    if(stats->csv == NULL || now - stats->last_row < 1000) {
+        return;
+    }
+    // each row covers the replays since the previous one
+    uint64_t since = stats->last_row;
+    stats->last_row = now;
+
+    float avg_ticks, avg_ms, max_ms;
+    uint32_t max_ticks;
+    replay_summary(stats, since, &avg_ticks, &max_ticks, &avg_ms, &max_ms);
+
+    char buf[256];
+    int sz = snprintf(buf, sizeof(buf), "%u,%d,%.2f,%u,%.3f,%.3f,%d,%d,%d,%d\n", tick,
+                      net_stats_rollbacks_per_sec(stats, now), avg_ticks, max_ticks, avg_ms, max_ms, stats->avg_rtt,
+                      stats->frame_advantage, stats->tick_offset, net_stats_hash_checks_per_sec(stats, now));
+    SDL_RWwrite(stats->csv, buf, sz, 1);
+}
+
+bool net_stats_overlay_enabled(void) {
+    return overlay_enabled;
+}
+
+void net_stats_set_overlay(bool enabled) {
+    overlay_enabled = enabled;
+}
@@ -0,0 +1,88 @@
+#ifndef NET_STATS_H
+#define NET_STATS_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// how many of the latest replays and hash checks the rolling statistics are made of
+#define NET_STATS_SAMPLES 256
+// histogram buckets, each twice as wide as the previous one
+#define NET_STATS_BUCKETS 8
+
+typedef struct net_stats_replay_t {
+    uint64_t time; // SDL_GetTicks64 when the replay finished
+    uint32_t ticks;
+    uint32_t usec;
+} net_stats_replay;
+
+typedef struct net_stats_t {
+    net_stats_replay replays[NET_STATS_SAMPLES];
+    unsigned replay_pos;
+    unsigned replay_count;
+    uint64_t hash_checks[NET_STATS_SAMPLES];
+    unsigned hash_pos;
+    unsigned hash_count;
+    uint32_t last_hash_tick;
+
+    int avg_rtt;
+    int frame_advantage;
+    int tick_offset;
+
+    // optional per match CSV dump, one row per second
+    SDL_RWops *csv;
+    uint64_t last_row;
+} net_stats;
+
+void net_stats_create(net_stats *stats);
+void net_stats_free(net_stats *stats);
+
+/**
+ * Forget everything recorded so far. Called when a new match starts.
+ */
+void net_stats_reset(net_stats *stats);
+
+void net_stats_add_replay(net_stats *stats, uint64_t now, uint32_t ticks, uint32_t usec);
+
+/**
+ * Record a comparison of our arena hash against the peer's. Repeated checks of the same tick count once.
+ */
+void net_stats_add_hash_check(net_stats *stats, uint64_t now, uint32_t tick);
+
+void net_stats_set_connection(net_stats *stats, int avg_rtt, int frame_advantage, int tick_offset);
+
+int net_stats_rollbacks_per_sec(const net_stats *stats, uint64_t now);
+int net_stats_hash_checks_per_sec(const net_stats *stats, uint64_t now);
+
+/**
+ * Build histograms of the recorded replays. Bucket 0 counts replays of one tick and below 0.25 ms,
+ * every following bucket covers twice the range of the previous one, and the last one everything above.
+ */
+void net_stats_histogram(const net_stats *stats, unsigned ticks[NET_STATS_BUCKETS], unsigned ms[NET_STATS_BUCKETS]);
+
+/**
+ * Format the statistics as a few lines of text, for the overlay and the console.
+ */
+void net_stats_format(const net_stats *stats, uint64_t now, char *buf, size_t len);
+
+/**
+ * Start dumping the statistics to a CSV file. The match number is added to the file name,
+ * so "netstats.csv" becomes "netstats-1.csv" for the first match.
+ * @return true on success
+ */
+bool net_stats_open_csv(net_stats *stats, const char *path, int match);
+void net_stats_close_csv(net_stats *stats);
+
+/**
+ * Write a CSV row, if a file is open and a second has passed since the last one.
+ */
+void net_stats_write_csv(net_stats *stats, uint64_t now, uint32_t tick);
+
+/**
+ * Whether the netplay statistics overlay is shown in the arena.
+ */
+bool net_stats_overlay_enabled(void);
+void net_stats_set_overlay(bool enabled);
+
+#endif // NET_STATS_H
@@ -14,6 +14,8 @@ typedef struct {
     uint32_t max_tick;
     hashmap tick_lookup;
     vector game_states;
+    int assertions_passed;
+    int assertions_failed;
 } rec_controller_data;
 
 void rec_controller_free(controller *ctrl) {
@@ -86,8 +88,13 @@ int rec_controller_poll(controller *ctrl, ctrl_event **ev) {
                 rec_assertion ass;
                 if(parse_assertion(buf, &ass)) {
                     log_assertion(&ass);
-                    if(!game_state_check_assertion_is_met(&ass, ctrl->gs)) {
-                        abort();
+                    if(game_state_check_assertion_is_met(&ass, ctrl->gs)) {
+                        data->assertions_passed++;
+                    } else {
+                        data->assertions_failed++;
+                        if(!ctrl->gs->init_flags->nonfatal_assertions) {
+                            abort();
+                        }
                     }
                 }
             } else if(move->lookup_id == 2) {
@@ -180,6 +187,14 @@ void rec_controller_step_back(controller *ctrl) {
     rec_controller_find_old_last_action(ctrl);
 }
 
+void rec_controller_get_assertion_counts(controller *ctrl, int *passed, int *failed) {
+    rec_controller_data *data = ctrl->data;
+    if(passed != NULL)
+        *passed = data->assertions_passed;
+    if(failed != NULL)
+        *failed = data->assertions_failed;
+}
+
 void rec_controller_create(controller *ctrl, int player, sd_rec_file *rec) {
     rec_controller_data *data = omf_calloc(1, sizeof(rec_controller_data));
     data->last_tick = 0;
@@ -8,4 +8,7 @@
 void rec_controller_create(controller *ctrl, int player, sd_rec_file *rec);
 void rec_controller_free(controller *ctrl);
 
+// Number of REC assertions that held and failed so far for this player
+void rec_controller_get_assertion_counts(controller *ctrl, int *passed, int *failed);
+
 #endif // REC_CONTROLLER_H
@@ -7,12 +7,15 @@
 #include "game/game_player.h"
 #include "game/game_state.h"
 #include "game/utils/settings.h"
+#include "resources/asset_cache.h"
+#include "resources/asset_pack.h"
 #include "resources/languages.h"
 #include "resources/sounds_loader.h"
 #include "utils/allocator.h"
 #include "utils/log.h"
 #include "utils/miscmath.h"
 #include "utils/png_writer.h"
+#include "utils/scandir.h"
 #include "utils/time_fmt.h"
 #include "video/vga_state.h"
 #include "video/video.h"
@@ -21,11 +24,14 @@
 
 #define MAX_TICKS_PER_FRAME 10
 #define TICK_EXPIRY_MS 100
+#define CAPTURE_INTERVAL 6
 
 static int run = 0;
 static int start_timeout = 30;
 static int enable_screen_updates = 1;
 static int debug_palette_number = 0;
+static int capture_frame_number = 0;
+static bool capturing_frames = false;
 
 int engine_init(engine_init_flags *init_flags) {
     settings *setting = settings_get();
@@ -48,7 +54,8 @@ int engine_init(engine_init_flags *init_flags) {
     if(strlen(init_flags->force_renderer) > 0)
         renderer = init_flags->force_renderer;
 
-    // Initialize everything.
+    // Initialize everything. The resource pack goes first, since everything after it may load files.
+    asset_pack_init();
     video_scan_renderers();
     audio_scan_backends();
     if(!video_init(renderer, w, h, fs, vsync, aspect, framerate_limit))
@@ -57,6 +64,7 @@ int engine_init(engine_init_flags *init_flags) {
         goto exit_1;
     if(!sounds_loader_init())
         goto exit_2;
+    audio_cache_sounds();
     if(!lang_init())
         goto exit_3;
     if(!fonts_init())
@@ -86,6 +94,7 @@ exit_2:
 exit_1:
     video_close();
 exit_0:
+    asset_pack_close();
     return 1;
 }
 
@@ -102,6 +111,18 @@ void save_screenshot(const SDL_Rect *r, unsigned char *data, bool flip) {
     omf_free(time);
 }
 
+// Called from the capture thread, one frame at a time.
+void save_capture_frame(const SDL_Rect *r, unsigned char *data, bool flip) {
+    char *time = format_time();
+    char *filename = omf_malloc(256);
+    snprintf(filename, 256, "capture_%s_%05d.png", time, capture_frame_number++);
+    if(!write_rgb_png(filename, r->w, r->h, data, false, flip)) {
+        log_error("Frame capture write operation failed (%s)", filename);
+    }
+    omf_free(filename);
+    omf_free(time);
+}
+
 void save_palette_shot(void) {
     char *time = format_time();
     char *filename = omf_malloc(256);
@@ -181,6 +202,14 @@ void engine_run(engine_init_flags *init_flags) {
                     if(e.key.keysym.sym == SDLK_F1) {
                         video_schedule_screenshot(save_screenshot);
                     }
+                    if(e.key.keysym.sym == SDLK_F4) {
+                        capturing_frames = !capturing_frames;
+                        if(video_schedule_capture(capturing_frames ? save_capture_frame : NULL, CAPTURE_INTERVAL)) {
+                            log_info("Frame capture %s", capturing_frames ? "started" : "stopped");
+                        } else {
+                            capturing_frames = false;
+                        }
+                    }
                     if(e.key.keysym.sym == SDLK_F2) {
                         save_palette_shot();
                     }
@@ -390,8 +419,12 @@ void engine_close(void) {
     altpals_close();
     fonts_close();
     lang_close();
-    sounds_loader_close();
+    // Audio backends may still be playing straight out of the sounds loader's buffers.
     audio_close();
+    sounds_loader_close();
+    asset_cache_close();
+    asset_pack_close();
+    scan_directory_index_free();
     video_close();
     vga_state_close();
     log_info("Engine deinit successful.");
@@ -13,6 +13,7 @@ typedef struct engine_init_flags_t {
     char rec_file[255];
     int warpspeed;
     int speed;
+    int nonfatal_assertions; // REC assertion failures are counted instead of aborting
 } engine_init_flags;
 
 int engine_init(engine_init_flags *init_flags); // Init window, audiodevice, etc.
@@ -20,6 +20,13 @@ memreader *memreader_open_from_reader(sd_reader *reader, int len) {
         return memreader_open(NULL, 0);
     }
 
+    // Point straight into the reader's buffer when the whole block is there. The slice is only valid while the
+    // reader is open, which is how these are used anyway.
+    char *slice = sd_read_slice(reader, len);
+    if(slice != NULL) {
+        return memreader_open(slice, len);
+    }
+
     char *buf = omf_calloc(1, len);
     sd_read_buf(reader, buf, len);
     memreader *mreader = memreader_open(buf, len);
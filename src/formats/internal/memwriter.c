@@ -85,3 +85,13 @@ void memwrite_fill(memwriter *writer, char content, int len) {
     memset(writer->buf + writer->data_len, content, len);
     writer->data_len += len;
 }
+
+void memwrite_variable_str(memwriter *writer, const char *str) {
+    if(str == NULL) {
+        memwrite_uword(writer, 0);
+        return;
+    }
+    uint16_t len = strlen(str) + 1;
+    memwrite_uword(writer, len);
+    memwrite_buf(writer, str, len);
+}
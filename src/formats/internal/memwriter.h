@@ -25,5 +25,6 @@ void memwrite_word(memwriter *writer, int16_t value);
 void memwrite_dword(memwriter *writer, int32_t value);
 void memwrite_float(memwriter *writer, float value);
 void memwrite_fill(memwriter *writer, char content, int len);
+void memwrite_variable_str(memwriter *writer, const char *str);
 
 #endif // MEMWRITER_H
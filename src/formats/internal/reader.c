@@ -10,13 +10,43 @@
 #include "utils/c_string_util.h"
 #include "utils/scandir.h"
 
+/**
+ * The whole file is read to memory when it is opened, and the read functions decode straight from the buffer.
+ * Reading past the end behaves like stdio: whatever is left is copied, and the reader is flagged as not ok until
+ * the position is set again.
+ */
 struct sd_reader {
-    FILE *handle;
+    char *data; // filesize bytes, followed by a terminating zero for the text functions
     long filesize;
+    long pos;
+    bool eof;
     int sd_errno;
 };
 
+static sd_reader_source reader_source = NULL;
+
+void sd_reader_set_source(sd_reader_source source) {
+    reader_source = source;
+}
+
+sd_reader *sd_reader_open_from_buf(const char *buf, long len) {
+    sd_reader *reader = omf_calloc(1, sizeof(sd_reader));
+    reader->data = omf_malloc(len + 1);
+    memcpy(reader->data, buf, len);
+    reader->data[len] = 0;
+    reader->filesize = len;
+    return reader;
+}
+
 sd_reader *sd_reader_open(const char *file) {
+    if(reader_source != NULL) {
+        long len;
+        const char *data = reader_source(file, &len);
+        if(data != NULL) {
+            return sd_reader_open_from_buf(data, len);
+        }
+    }
+
 #if !defined(_WIN32) && !defined(WIN32)
     char path_buf[256];
     strncpy_or_abort(path_buf, file, sizeof(path_buf));
@@ -25,33 +55,41 @@ sd_reader *sd_reader_open(const char *file) {
     }
     file = path_buf;
 #endif
-    sd_reader *reader = omf_calloc(1, sizeof(sd_reader));
-    reader->sd_errno = 0;
     // Attempt to open file (note: Binary mode!)
-    reader->handle = fopen(file, "rb");
-    if(!reader->handle) {
-        omf_free(reader);
+    FILE *handle = fopen(file, "rb");
+    if(!handle) {
         return NULL;
     }
 
     // Find file size
-    if(fseek(reader->handle, 0, SEEK_END) == -1) {
-        goto error;
+    if(fseek(handle, 0, SEEK_END) == -1) {
+        goto error_0;
     }
-    reader->filesize = ftell(reader->handle);
-    if(reader->filesize == -1) {
-        goto error;
+    long filesize = ftell(handle);
+    if(filesize == -1) {
+        goto error_0;
     }
-    if(fseek(reader->handle, 0, SEEK_SET) == -1) {
-        goto error;
+    if(fseek(handle, 0, SEEK_SET) == -1) {
+        goto error_0;
     }
 
+    sd_reader *reader = omf_calloc(1, sizeof(sd_reader));
+    reader->data = omf_malloc(filesize + 1);
+    if(fread(reader->data, 1, filesize, handle) != (size_t)filesize) {
+        goto error_1;
+    }
+    reader->data[filesize] = 0;
+    reader->filesize = filesize;
+    fclose(handle);
+
     // All done.
     return reader;
 
-error:
-    fclose(reader->handle);
+error_1:
+    omf_free(reader->data);
     omf_free(reader);
+error_0:
+    fclose(handle);
     return NULL;
 }
 
@@ -64,90 +102,143 @@ int sd_reader_errno(const sd_reader *reader) {
 }
 
 void sd_reader_close(sd_reader *reader) {
-    fclose(reader->handle);
+    omf_free(reader->data);
     omf_free(reader);
 }
 
 int sd_reader_set(sd_reader *reader, long offset) {
-    if(fseek(reader->handle, offset, SEEK_SET) != 0) {
-        reader->sd_errno = errno;
+    if(offset < 0) {
+        reader->sd_errno = EINVAL;
         return 0;
     }
+    reader->pos = offset;
+    reader->eof = false;
     return 1;
 }
 
 int sd_reader_ok(const sd_reader *reader) {
-    if(feof(reader->handle)) {
+    if(reader->eof) {
         return 0;
     }
     return 1;
 }
 
 long sd_reader_pos(sd_reader *reader) {
-    long res = ftell(reader->handle);
-    if(res == -1) {
-        reader->sd_errno = errno;
-    }
-    return res;
+    return reader->pos;
+}
+
+static inline size_t remaining(const sd_reader *reader) {
+    return reader->pos < reader->filesize ? (size_t)(reader->filesize - reader->pos) : 0;
 }
 
 int sd_read_buf(sd_reader *reader, char *buf, size_t len) {
-    if(fread(buf, 1, len, reader->handle) != len) {
-        reader->sd_errno = ferror(reader->handle);
+    size_t left = remaining(reader);
+    if(len > left) {
+        memcpy(buf, reader->data + reader->pos, left);
+        reader->pos += left;
+        reader->eof = true;
         return 0;
     }
+    memcpy(buf, reader->data + reader->pos, len);
+    reader->pos += len;
     return 1;
 }
 
+char *sd_read_slice(sd_reader *reader, size_t len) {
+    if(len > remaining(reader)) {
+        return NULL;
+    }
+    char *slice = reader->data + reader->pos;
+    reader->pos += len;
+    return slice;
+}
+
 int sd_peek_buf(sd_reader *reader, char *buf, int len) {
     if(sd_read_buf(reader, buf, len)) {
         return 0;
     }
-    if(fseek(reader->handle, ftell(reader->handle) - len, SEEK_SET) == -1) {
-        reader->sd_errno = errno;
+    if(reader->pos < len) {
+        reader->sd_errno = EINVAL;
+    } else {
+        sd_reader_set(reader, reader->pos - len);
     }
     return 1;
 }
 
+/**
+ * Get a pointer to the next n bytes and step over them, or NULL if the file ends before that. The fixed size
+ * reads below decode from the pointer, and only fall back to sd_read_buf for the short read at the end.
+ */
+static inline const uint8_t *take(sd_reader *reader, size_t n) {
+    if(n > remaining(reader)) {
+        return NULL;
+    }
+    const uint8_t *p = (const uint8_t *)reader->data + reader->pos;
+    reader->pos += n;
+    return p;
+}
+
+static inline uint16_t decode_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t decode_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t read_u16(sd_reader *reader) {
+    const uint8_t *p = take(reader, 2);
+    if(p == NULL) {
+        uint8_t tail[2] = {0};
+        sd_read_buf(reader, (char *)tail, 2);
+        return decode_u16(tail);
+    }
+    return decode_u16(p);
+}
+
+static uint32_t read_u32(sd_reader *reader) {
+    const uint8_t *p = take(reader, 4);
+    if(p == NULL) {
+        uint8_t tail[4] = {0};
+        sd_read_buf(reader, (char *)tail, 4);
+        return decode_u32(tail);
+    }
+    return decode_u32(p);
+}
+
 uint8_t sd_read_ubyte(sd_reader *reader) {
-    uint8_t d = 0;
-    sd_read_buf(reader, (char *)&d, 1);
-    return d;
+    const uint8_t *p = take(reader, 1);
+    if(p == NULL) {
+        reader->eof = true;
+        return 0;
+    }
+    return *p;
 }
 
 uint16_t sd_read_uword(sd_reader *reader) {
-    uint16_t d = 0;
-    sd_read_buf(reader, (char *)&d, 2);
-    return d;
+    return read_u16(reader);
 }
 
 uint32_t sd_read_udword(sd_reader *reader) {
-    uint32_t d = 0;
-    sd_read_buf(reader, (char *)&d, 4);
-    return d;
+    return read_u32(reader);
 }
 
 int8_t sd_read_byte(sd_reader *reader) {
-    int8_t d = 0;
-    sd_read_buf(reader, (char *)&d, 1);
-    return d;
+    return (int8_t)sd_read_ubyte(reader);
 }
 
 int16_t sd_read_word(sd_reader *reader) {
-    int16_t d = 0;
-    sd_read_buf(reader, (char *)&d, 2);
-    return d;
+    return (int16_t)read_u16(reader);
 }
 
 int32_t sd_read_dword(sd_reader *reader) {
-    int32_t d = 0;
-    sd_read_buf(reader, (char *)&d, 4);
-    return d;
+    return (int32_t)read_u32(reader);
 }
 
 float sd_read_float(sd_reader *reader) {
-    float f = 0;
-    sd_read_buf(reader, (char *)&f, 4);
+    uint32_t d = read_u32(reader);
+    float f;
+    memcpy(&f, &d, sizeof(f));
     return f;
 }
 
@@ -204,23 +295,41 @@ int sd_match(sd_reader *reader, const char *buf, unsigned int nbytes) {
 }
 
 void sd_skip(sd_reader *reader, unsigned int nbytes) {
-    if(fseek(reader->handle, nbytes, SEEK_CUR) == -1) {
-        reader->sd_errno = errno;
-    }
+    reader->pos += nbytes;
 }
 
 int sd_read_scan(const sd_reader *reader, const char *format, ...) {
+    if(reader->pos >= reader->filesize) {
+        return EOF;
+    }
     va_list argp;
     va_start(argp, format);
-    int ret = fscanf(reader->handle, format, argp);
+    int ret = vsscanf(reader->data + reader->pos, format, argp);
     va_end(argp);
     return ret;
 }
 
-int sd_read_line(const sd_reader *reader, char *buffer, int maxlen) {
-    if(fgets(buffer, maxlen, reader->handle) == NULL) {
+int sd_read_line(sd_reader *reader, char *buffer, int maxlen) {
+    size_t left = remaining(reader);
+    if(left == 0) {
+        reader->eof = true;
         return 1;
     }
+    if(maxlen < 1) {
+        return 1;
+    }
+    const char *start = reader->data + reader->pos;
+    size_t len = (size_t)maxlen - 1 < left ? (size_t)maxlen - 1 : left;
+    const char *newline = memchr(start, '\n', len);
+    if(newline != NULL) {
+        len = newline - start + 1;
+    } else if(len == left) {
+        // Ran into the end of the file while looking for the line end
+        reader->eof = true;
+    }
+    memcpy(buffer, start, len);
+    buffer[len] = 0;
+    reader->pos += len;
     return 0;
 }
 
@@ -8,8 +8,26 @@
 
 typedef struct sd_reader sd_reader;
 
+/**
+ * Source for file contents that sd_reader_open checks before the file system. Gets the path given to
+ * sd_reader_open, and returns the contents of the file and its length, or NULL if it does not have the file.
+ * The returned data is copied, so it is never changed by the reader.
+ */
+typedef const char *(*sd_reader_source)(const char *file, long *len);
+
+/**
+ * Set the source for file contents, or NULL to only use the file system. The source may be called from any
+ * thread that opens readers, so it should only be set while no files are being loaded.
+ */
+void sd_reader_set_source(sd_reader_source source);
+
 sd_reader *sd_reader_open(const char *file);
 
+/**
+ * Open a reader over len bytes of data in memory. The data is copied.
+ */
+sd_reader *sd_reader_open_from_buf(const char *buf, long len);
+
 /**
  * Check for errors
  */
@@ -25,6 +43,13 @@ int sd_reader_set(sd_reader *reader, long pos);
 int sd_read_buf(sd_reader *reader, char *buf, size_t len);
 int sd_peek_buf(sd_reader *reader, char *buf, int len);
 
+/**
+ * Get a pointer to the next len bytes of the file and step over them, without copying. The memory stays valid
+ * until the reader is closed, and may be changed in place by the caller.
+ * @return Pointer to the data, or NULL if there are less than len bytes left. Nothing is read in that case.
+ */
+char *sd_read_slice(sd_reader *reader, size_t len);
+
 uint8_t sd_read_ubyte(sd_reader *reader);
 uint16_t sd_read_uword(sd_reader *reader);
 uint32_t sd_read_udword(sd_reader *reader);
@@ -41,8 +66,16 @@ int16_t sd_peek_word(sd_reader *reader);
 int32_t sd_peek_dword(sd_reader *reader);
 float sd_peek_float(sd_reader *reader);
 
+/**
+ * sscanf from the current position. Does not advance the read position.
+ */
 int sd_read_scan(const sd_reader *reader, const char *format, ...);
-int sd_read_line(const sd_reader *reader, char *buffer, int maxlen);
+
+/**
+ * Read up to and including the next newline, like fgets.
+ * @return 0 if something was read, 1 if not.
+ */
+int sd_read_line(sd_reader *reader, char *buffer, int maxlen);
 
 /**
  * Compare following nbytes amount of data and given buffer. Does not advance file pointer.
@@ -0,0 +1,196 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "formats/error.h"
+#include "formats/internal/reader.h"
+#include "formats/internal/writer.h"
+#include "formats/pack.h"
+#include "utils/allocator.h"
+#include "utils/c_string_util.h"
+
+static const char pack_magic[8] = "OMFPACK";
+
+// Name, offset, length, source size and source modification time
+#define PACK_ENTRY_SIZE (SD_PACK_NAME_LENGTH + 20)
+
+static int64_t read_time(sd_reader *r) {
+    uint32_t lo = sd_read_udword(r);
+    uint32_t hi = sd_read_udword(r);
+    return (int64_t)(((uint64_t)hi << 32) | lo);
+}
+
+static void write_time(sd_writer *w, int64_t t) {
+    sd_write_udword(w, (uint32_t)((uint64_t)t & 0xFFFFFFFF));
+    sd_write_udword(w, (uint32_t)((uint64_t)t >> 32));
+}
+
+static int compare_entries(const void *a, const void *b) {
+    const sd_pack_entry *ea = a;
+    const sd_pack_entry *eb = b;
+    return omf_strncasecmp(ea->name, eb->name, SD_PACK_NAME_LENGTH);
+}
+
+/**
+ * Find the index of the first entry that does not sort before the given name.
+ */
+static unsigned int lower_bound(const sd_pack_file *pack, const char *name) {
+    unsigned int lo = 0;
+    unsigned int hi = pack->count;
+    while(lo < hi) {
+        unsigned int mid = lo + (hi - lo) / 2;
+        if(omf_strncasecmp(pack->entries[mid].name, name, SD_PACK_NAME_LENGTH) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+int sd_pack_create(sd_pack_file *pack) {
+    if(pack == NULL) {
+        return SD_INVALID_INPUT;
+    }
+    memset(pack, 0, sizeof(sd_pack_file));
+    return SD_SUCCESS;
+}
+
+int sd_pack_load(sd_pack_file *pack, const char *filename) {
+    int ret = SD_FILE_PARSE_ERROR;
+    if(pack == NULL || filename == NULL) {
+        return SD_INVALID_INPUT;
+    }
+
+    sd_reader *r = sd_reader_open(filename);
+    if(!r) {
+        return SD_FILE_OPEN_ERROR;
+    }
+
+    // Header
+    char magic[sizeof(pack_magic)];
+    if(!sd_read_buf(r, magic, sizeof(magic)) || memcmp(magic, pack_magic, sizeof(magic)) != 0) {
+        ret = SD_FILE_INVALID_TYPE;
+        goto error_0;
+    }
+    if(sd_read_udword(r) != SD_PACK_VERSION) {
+        ret = SD_FORMAT_NOT_SUPPORTED;
+        goto error_0;
+    }
+    uint32_t count = sd_read_udword(r);
+    uint32_t data_len = sd_read_udword(r);
+    long index_len = (long)count * PACK_ENTRY_SIZE;
+    if(!sd_reader_ok(r) || sd_reader_pos(r) + index_len + (long)data_len != sd_reader_filesize(r)) {
+        goto error_0;
+    }
+
+    // Entry index
+    pack->entries = omf_calloc(count, sizeof(sd_pack_entry));
+    pack->count = count;
+    for(uint32_t i = 0; i < count; i++) {
+        sd_pack_entry *entry = &pack->entries[i];
+        sd_read_buf(r, entry->name, SD_PACK_NAME_LENGTH);
+        entry->name[SD_PACK_NAME_LENGTH - 1] = 0;
+        entry->offset = sd_read_udword(r);
+        entry->len = sd_read_udword(r);
+        entry->source_size = sd_read_udword(r);
+        entry->source_mtime = read_time(r);
+        if(entry->offset > data_len || entry->len > data_len - entry->offset) {
+            goto error_1;
+        }
+    }
+
+    // Data for all entries, in one block. One extra byte so that an empty pack gets a buffer too.
+    pack->data = omf_malloc(data_len + 1);
+    pack->data_len = data_len;
+    if(!sd_read_buf(r, pack->data, data_len)) {
+        goto error_1;
+    }
+
+    // Lookups use a binary search
+    if(count > 0) {
+        qsort(pack->entries, count, sizeof(sd_pack_entry), compare_entries);
+    }
+
+    sd_reader_close(r);
+    return SD_SUCCESS;
+
+error_1:
+    sd_pack_free(pack);
+error_0:
+    sd_reader_close(r);
+    return ret;
+}
+
+int sd_pack_save(const sd_pack_file *pack, const char *filename) {
+    if(pack == NULL || filename == NULL) {
+        return SD_INVALID_INPUT;
+    }
+
+    sd_writer *w = sd_writer_open(filename);
+    if(!w) {
+        return SD_FILE_OPEN_ERROR;
+    }
+
+    sd_write_buf(w, pack_magic, sizeof(pack_magic));
+    sd_write_udword(w, SD_PACK_VERSION);
+    sd_write_udword(w, pack->count);
+    sd_write_udword(w, pack->data_len);
+    for(unsigned int i = 0; i < pack->count; i++) {
+        const sd_pack_entry *entry = &pack->entries[i];
+        sd_write_buf(w, entry->name, SD_PACK_NAME_LENGTH);
+        sd_write_udword(w, entry->offset);
+        sd_write_udword(w, entry->len);
+        sd_write_udword(w, entry->source_size);
+        write_time(w, entry->source_mtime);
+    }
+    sd_write_buf(w, pack->data, pack->data_len);
+
+    sd_writer_close(w);
+    return SD_SUCCESS;
+}
+
+int sd_pack_add(sd_pack_file *pack, const char *name, const char *buf, uint32_t len, uint32_t source_size,
+                int64_t source_mtime) {
+    if(pack == NULL || name == NULL || strlen(name) >= SD_PACK_NAME_LENGTH) {
+        return SD_INVALID_INPUT;
+    }
+    if(sd_pack_find(pack, name) != NULL) {
+        return SD_INVALID_INPUT;
+    }
+
+    // Insert the entry where it keeps the index sorted
+    unsigned int pos = lower_bound(pack, name);
+    pack->entries = omf_realloc(pack->entries, (pack->count + 1) * sizeof(sd_pack_entry));
+    memmove(&pack->entries[pos + 1], &pack->entries[pos], (pack->count - pos) * sizeof(sd_pack_entry));
+    pack->count++;
+    sd_pack_entry *entry = &pack->entries[pos];
+    memset(entry, 0, sizeof(sd_pack_entry));
+    strncpy_or_truncate(entry->name, name, sizeof(entry->name));
+    entry->offset = pack->data_len;
+    entry->len = len;
+    entry->source_size = source_size;
+    entry->source_mtime = source_mtime;
+
+    pack->data = omf_realloc(pack->data, pack->data_len + len + 1);
+    memcpy(pack->data + pack->data_len, buf, len);
+    pack->data_len += len;
+    return SD_SUCCESS;
+}
+
+const sd_pack_entry *sd_pack_find(const sd_pack_file *pack, const char *name) {
+    unsigned int pos = lower_bound(pack, name);
+    if(pos < pack->count && omf_strncasecmp(pack->entries[pos].name, name, SD_PACK_NAME_LENGTH) == 0) {
+        return &pack->entries[pos];
+    }
+    return NULL;
+}
+
+void sd_pack_free(sd_pack_file *pack) {
+    if(pack == NULL) {
+        return;
+    }
+    omf_free(pack->entries);
+    omf_free(pack->data);
+    pack->count = 0;
+    pack->data_len = 0;
+}
@@ -0,0 +1,125 @@
+/*! \file
+ * \brief Resource pack handling.
+ * \details Functions and structs for reading, writing and modifying OpenOMF resource packs. A pack bundles the
+ *          game data files into one file, along with data that has been decoded ahead of time.
+ * \copyright MIT license.
+ */
+
+#ifndef SD_PACK_H
+#define SD_PACK_H
+
+#include <stdint.h>
+
+#define SD_PACK_VERSION 2            ///< Current pack file version. Packs with any other version are not loaded.
+#define SD_PACK_NAME_LENGTH 32       ///< Maximum length of an entry name, including the terminating zero.
+#define SD_PACK_PIXELS_SUFFIX ".PIX" ///< Suffix for entries that hold decoded sprite pixels of a BK or AF file.
+
+/*
+ * Entries named after a BK or AF file with SD_PACK_PIXELS_SUFFIX added hold the sprites of that file, decoded.
+ * There is one record for every sprite that has data of its own and a non-zero size, in the order the sprites
+ * appear in the file: sprite width, sprite height, decoded width and decoded height as little endian 16 bit
+ * values, followed by the decoded pixels.
+ */
+
+/*! \brief Pack entry
+ *
+ * Index entry for one block of data in the pack.
+ */
+typedef struct {
+    char name[SD_PACK_NAME_LENGTH]; ///< Entry name, usually the name of the file it was made from
+    uint32_t offset;                ///< Offset of the data from the start of the data block
+    uint32_t len;                   ///< Byte length of the data
+    uint32_t source_size;           ///< Byte length of the file the entry was made from, when it was packed
+    int64_t source_mtime;           ///< Modification time of the file the entry was made from, when it was packed
+} sd_pack_entry;
+
+/*! \brief Resource pack
+ *
+ * Entry index, followed by a single data block that holds the data of all entries.
+ */
+typedef struct {
+    unsigned int count;     ///< Number of entries
+    sd_pack_entry *entries; ///< Entry index, sorted by name without regard to case
+    char *data;             ///< Data of all entries
+    uint32_t data_len;      ///< Byte length of data
+} sd_pack_file;
+
+/*! \brief Initialize pack structure
+ *
+ * Initializes the pack structure with empty values.
+ *
+ * \retval SD_INVALID_INPUT Pack struct pointer was NULL
+ * \retval SD_SUCCESS Success.
+ *
+ * \param pack Allocated pack struct pointer.
+ */
+int sd_pack_create(sd_pack_file *pack);
+
+/*! \brief Load pack file
+ *
+ * Loads the given pack file to memory. The structure must be initialized with sd_pack_create()
+ * before using this function.
+ *
+ * \retval SD_FILE_OPEN_ERROR File could not be opened for reading.
+ * \retval SD_FILE_INVALID_TYPE File is not a pack.
+ * \retval SD_FORMAT_NOT_SUPPORTED Pack was made for another version.
+ * \retval SD_FILE_PARSE_ERROR Entry index does not match the data.
+ * \retval SD_SUCCESS Success.
+ *
+ * \param pack Pack struct pointer.
+ * \param filename Name of the pack file to load from.
+ */
+int sd_pack_load(sd_pack_file *pack, const char *filename);
+
+/*! \brief Save pack file
+ *
+ * Saves the given pack to a file on disk.
+ *
+ * \retval SD_FILE_OPEN_ERROR File could not be opened for writing.
+ * \retval SD_SUCCESS Success.
+ *
+ * \param pack Pack struct pointer.
+ * \param filename Name of the pack file to save into.
+ */
+int sd_pack_save(const sd_pack_file *pack, const char *filename);
+
+/*! \brief Add an entry
+ *
+ * Copies len bytes from buf to the end of the pack, under the given name. The size and modification time of
+ * the file the data was made from are stored with the entry, so that the entry can be ignored once the file
+ * has changed.
+ *
+ * \retval SD_INVALID_INPUT Name is too long, or an entry with the same name exists.
+ * \retval SD_SUCCESS Success.
+ *
+ * \param pack Pack struct pointer.
+ * \param name Entry name.
+ * \param buf Data to add.
+ * \param len Byte length of data.
+ * \param source_size Byte length of the file the data was made from.
+ * \param source_mtime Modification time of the file the data was made from.
+ */
+int sd_pack_add(sd_pack_file *pack, const char *name, const char *buf, uint32_t len, uint32_t source_size,
+                int64_t source_mtime);
+
+/*! \brief Find an entry
+ *
+ * Looks up the entry with the given name. Names are compared without regard to case.
+ *
+ * \return Pointer to the entry, or NULL if there is no such entry. The entry data starts at pack->data plus the
+ *         entry offset. Both are valid until the pack is changed or freed.
+ *
+ * \param pack Pack struct pointer.
+ * \param name Entry name.
+ */
+const sd_pack_entry *sd_pack_find(const sd_pack_file *pack, const char *name);
+
+/*! \brief Free pack structure
+ *
+ * Frees up all memory reserved by the pack structure.
+ *
+ * \param pack Pack struct to free.
+ */
+void sd_pack_free(sd_pack_file *pack);
+
+#endif // SD_PACK_H
@@ -4,6 +4,7 @@
 #include "utils/allocator.h"
 #include "utils/miscmath.h"
 #include "video/vga_state.h"
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -44,6 +45,124 @@ unsigned char palette_resolve_color(uint8_t r, uint8_t g, uint8_t b, const vga_p
     return 0;
 }
 
+static uint32_t lookup_pack(uint8_t r, uint8_t g, uint8_t b) {
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+static unsigned int lookup_slot(uint32_t rgb) {
+    // Fibonacci hashing; the upper bits of the product are well spread even for similar colors.
+    return ((rgb * 2654435761u) >> 16) & (PALETTE_LOOKUP_HASH_SIZE - 1);
+}
+
+static int lookup_component(const vga_color *c, int axis) {
+    switch(axis) {
+        case 0:
+            return c->r;
+        case 1:
+            return c->g;
+        default:
+            return c->b;
+    }
+}
+
+// Arranges tree[lo ... hi - 1] so that the median on the current axis sits in the middle, with the smaller
+// colors before it and the larger ones after it. Then does the same for both halves on the next axis.
+static void lookup_build_tree(palette_lookup *lookup, int lo, int hi, int axis) {
+    if(hi - lo <= 1) {
+        return;
+    }
+    // Insertion sort is plenty for at most 256 entries, and keeps equal colors in index order.
+    for(int i = lo + 1; i < hi; i++) {
+        vga_index idx = lookup->tree[i];
+        int key = lookup_component(&lookup->colors[idx], axis);
+        int j = i - 1;
+        while(j >= lo && lookup_component(&lookup->colors[lookup->tree[j]], axis) > key) {
+            lookup->tree[j + 1] = lookup->tree[j];
+            j--;
+        }
+        lookup->tree[j + 1] = idx;
+    }
+    int mid = lo + (hi - lo) / 2;
+    lookup_build_tree(lookup, lo, mid, (axis + 1) % 3);
+    lookup_build_tree(lookup, mid + 1, hi, (axis + 1) % 3);
+}
+
+static void lookup_search_tree(const palette_lookup *lookup, const vga_color *c, int lo, int hi, int axis,
+                               int *best_dist, vga_index *best) {
+    if(lo >= hi) {
+        return;
+    }
+    int mid = lo + (hi - lo) / 2;
+    vga_index idx = lookup->tree[mid];
+    const vga_color *node = &lookup->colors[idx];
+    int dr = node->r - c->r;
+    int dg = node->g - c->g;
+    int db = node->b - c->b;
+    int dist = dr * dr + dg * dg + db * db;
+    if(dist < *best_dist || (dist == *best_dist && idx < *best)) {
+        *best_dist = dist;
+        *best = idx;
+    }
+
+    // Search the side the color is on first; the other side only if it can hold something as close.
+    int diff = lookup_component(c, axis) - lookup_component(node, axis);
+    int next = (axis + 1) % 3;
+    if(diff < 0) {
+        lookup_search_tree(lookup, c, lo, mid, next, best_dist, best);
+        if(diff * diff <= *best_dist) {
+            lookup_search_tree(lookup, c, mid + 1, hi, next, best_dist, best);
+        }
+    } else {
+        lookup_search_tree(lookup, c, mid + 1, hi, next, best_dist, best);
+        if(diff * diff <= *best_dist) {
+            lookup_search_tree(lookup, c, lo, mid, next, best_dist, best);
+        }
+    }
+}
+
+void palette_lookup_create(palette_lookup *lookup, const vga_palette *pal, int index_start, int index_count) {
+    assert(index_start >= 0 && index_count >= 0 && index_start + index_count <= 256);
+    memset(lookup->exact_keys, 0, sizeof(lookup->exact_keys));
+    memcpy(lookup->colors, pal->colors, sizeof(lookup->colors));
+    lookup->tree_size = 0;
+
+    for(int i = index_start; i < index_start + index_count; i++) {
+        const vga_color *c = &pal->colors[i];
+        uint32_t key = lookup_pack(c->r, c->g, c->b) + 1;
+        unsigned int slot = lookup_slot(key - 1);
+        while(lookup->exact_keys[slot] != 0 && lookup->exact_keys[slot] != key) {
+            slot = (slot + 1) & (PALETTE_LOOKUP_HASH_SIZE - 1);
+        }
+        // Keep the first index with this color
+        if(lookup->exact_keys[slot] == 0) {
+            lookup->exact_keys[slot] = key;
+            lookup->exact_values[slot] = i;
+        }
+        lookup->tree[lookup->tree_size++] = i;
+    }
+    lookup_build_tree(lookup, 0, lookup->tree_size, 0);
+}
+
+int palette_lookup_exact(const palette_lookup *lookup, uint8_t r, uint8_t g, uint8_t b) {
+    uint32_t key = lookup_pack(r, g, b) + 1;
+    unsigned int slot = lookup_slot(key - 1);
+    while(lookup->exact_keys[slot] != 0) {
+        if(lookup->exact_keys[slot] == key) {
+            return lookup->exact_values[slot];
+        }
+        slot = (slot + 1) & (PALETTE_LOOKUP_HASH_SIZE - 1);
+    }
+    return -1;
+}
+
+vga_index palette_lookup_nearest(const palette_lookup *lookup, uint8_t r, uint8_t g, uint8_t b) {
+    vga_color c = {r, g, b};
+    int best_dist = INT_MAX;
+    vga_index best = 0;
+    lookup_search_tree(lookup, &c, 0, lookup->tree_size, 0, &best_dist, &best);
+    return best;
+}
+
 int palette_to_gimp_palette(const vga_palette *pal, const char *filename) {
     sd_writer *w;
     unsigned char r, g, b;
@@ -32,6 +32,60 @@
  */
 unsigned char palette_resolve_color(uint8_t r, uint8_t g, uint8_t b, const vga_palette *pal);
 
+#define PALETTE_LOOKUP_HASH_SIZE 512 ///< Slots in the exact match table. Must be a power of two, over 256.
+
+/*! \brief Reverse palette lookup
+ *
+ * Maps RGB colors back to indexes of a palette, for converting a lot of pixels at once. Exact matches
+ * are found from a hash table, and nearest matches from a k-d tree of the palette colors. Only the
+ * indexes in the range given to palette_lookup_create() are considered.
+ */
+typedef struct {
+    uint32_t exact_keys[PALETTE_LOOKUP_HASH_SIZE]; ///< Packed RGB color + 1 for each used slot, 0 if free
+    vga_index exact_values[PALETTE_LOOKUP_HASH_SIZE]; ///< Palette index for each used slot
+    vga_color colors[256];                            ///< Copy of the palette colors
+    vga_index tree[256];                              ///< Palette indexes, laid out as an implicit k-d tree
+    int tree_size;                                    ///< Number of indexes in the tree
+} palette_lookup;
+
+/*! \brief Build a reverse palette lookup
+ *
+ * Builds the lookup structures for palette indexes index_start ... index_start + index_count - 1.
+ * The palette is copied, so later changes to it are not seen by the lookup.
+ *
+ * \param lookup Lookup struct to fill.
+ * \param pal Palette to map colors to.
+ * \param index_start First palette index to consider.
+ * \param index_count Number of palette indexes to consider.
+ */
+void palette_lookup_create(palette_lookup *lookup, const vga_palette *pal, int index_start, int index_count);
+
+/*! \brief Find an exact palette match
+ *
+ * Finds the palette index with exactly the given color. If several indexes have the color, the lowest
+ * one is returned, like palette_resolve_color() does.
+ *
+ * \param lookup Lookup struct built with palette_lookup_create().
+ * \param r Red color index (0 - 0xFF)
+ * \param g Green color index (0 - 0xFF)
+ * \param b Blue color index (0 - 0xFF)
+ * \return Palette index, or -1 if no index has the color.
+ */
+int palette_lookup_exact(const palette_lookup *lookup, uint8_t r, uint8_t g, uint8_t b);
+
+/*! \brief Find the nearest palette match
+ *
+ * Finds the palette index whose color is closest to the given color, measured as euclidean distance in
+ * RGB space. Ties go to the lowest index. An empty lookup always returns index 0.
+ *
+ * \param lookup Lookup struct built with palette_lookup_create().
+ * \param r Red color index (0 - 0xFF)
+ * \param g Green color index (0 - 0xFF)
+ * \param b Blue color index (0 - 0xFF)
+ * \return Palette index
+ */
+vga_index palette_lookup_nearest(const palette_lookup *lookup, uint8_t r, uint8_t g, uint8_t b);
+
 /*! \brief Exports palette to GIMP palette file.
  *
  * Exports a palette to GIMP palette format (GPL).
@@ -9,8 +9,6 @@
 #include "utils/c_string_util.h"
 #include "utils/log.h"
 
-#define PILOT_BLOCK_LENGTH 428
-
 int sd_pilot_create(sd_pilot *pilot) {
     if(pilot == NULL) {
         return SD_INVALID_INPUT;
@@ -18,6 +18,8 @@
 #include "formats/sprite.h"
 #include <stdint.h>
 
+#define PILOT_BLOCK_LENGTH 428 ///< Byte length of a pilot block, as read by sd_pilot_load_from_mem()
+
 /*! \brief PIC pilot information
  *
  * Contains a pilot information. Current upgrades, powers, tournament, etc.
@@ -19,6 +19,24 @@ void sd_script_frame_create(sd_script_frame *frame, int tick_len, int sprite) {
     vector_create(&frame->tags, sizeof(sd_script_tag));
     frame->tick_len = tick_len;
     frame->sprite = sprite;
+    sd_script_frame_compile(frame);
+}
+
+void sd_script_frame_compile(sd_script_frame *frame) {
+    memset(frame->tag_bits, 0, sizeof(frame->tag_bits));
+    memset(frame->tag_values, 0, sizeof(frame->tag_values));
+
+    // If a tag is in the list more than once, the last one counts.
+    iterator it;
+    sd_script_tag *tag;
+    vector_iter_begin(&frame->tags, &it);
+    foreach(it, tag) {
+        if(tag->id < 0) {
+            continue;
+        }
+        frame->tag_bits[tag->id / 32] |= 1u << (tag->id % 32);
+        frame->tag_values[tag->id] = tag->value;
+    }
 }
 
 int sd_script_frame_clone(sd_script_frame *src, sd_script_frame *dst) {
@@ -28,6 +46,8 @@ int sd_script_frame_clone(sd_script_frame *src, sd_script_frame *dst) {
     foreach(it, tag) {
         vector_append(&dst->tags, tag);
     }
+    memcpy(dst->tag_bits, src->tag_bits, sizeof(dst->tag_bits));
+    memcpy(dst->tag_values, src->tag_values, sizeof(dst->tag_values));
     return SD_SUCCESS;
 }
 
@@ -53,18 +73,33 @@ void sd_script_frame_free(sd_script_frame *frame) {
 
 static void sd_script_tag_create(sd_script_tag *tag) {
     memset(tag, 0, sizeof(sd_script_tag));
+    tag->id = -1;
+}
+
+// Fills in the tag information from the tag list. Returns false if the tag does not exist.
+static bool sd_script_tag_lookup(sd_script_tag *tag, const char *key) {
+    int id = sd_tag_find_id(key);
+    if(id < 0) {
+        return false;
+    }
+    tag->id = id;
+    tag->key = sd_taglist[id].tag;
+    tag->desc = sd_taglist[id].description;
+    tag->has_param = sd_taglist[id].has_param;
+    return true;
 }
 
 bool sd_script_frame_add_tag(sd_script_frame *frame, const char *key, int value) {
     sd_script_tag tag;
     sd_script_tag_create(&tag);
-    if(sd_tag_info(key, &tag.has_param, &tag.key, &tag.desc) != 0) {
+    if(!sd_script_tag_lookup(&tag, key)) {
         return false;
     }
     if(tag.has_param) {
         tag.value = value;
     }
     vector_append(&frame->tags, &tag);
+    sd_script_frame_compile(frame);
     return true;
 }
 
@@ -102,6 +137,7 @@ int sd_script_clear_tags(sd_script *script, int frame_id) {
     }
 
     vector_clear(&frame->tags);
+    sd_script_frame_compile(frame);
     return SD_SUCCESS;
 }
 
@@ -222,9 +258,10 @@ static int read_int(const str *src, int *original) {
 static bool test_tag_slice(const str *test, sd_script_tag *new, str *src, int *now) {
     const int len = str_size(test);
     const int jmp = *now + len;
-    if(sd_tag_info(str_c(test), &new->has_param, &new->key, &new->desc) == 0) {
+    if(sd_script_tag_lookup(new, str_c(test))) {
         // Ensure that tag has no value, if value is not desired.
         if(!new->has_param && find_numeric_span(src, jmp) > jmp) {
+            new->id = -1;
             return false;
         }
 
@@ -300,6 +337,7 @@ static bool decode_next_frame(sd_script_frame *frame, str *src, int *now) {
     sd_script_tag_create(&tag);
     while(*now < (int)str_size(src)) {
         if(parse_frame(frame, src, now)) {
+            sd_script_frame_compile(frame);
             return true;
         }
         if(parse_tag(&tag, src, now)) {
@@ -531,6 +569,25 @@ int sd_script_next_frame_with_sprite(const sd_script *script, int sprite_id, uns
     return -1;
 }
 
+int sd_script_next_frame_with_tag_id(const sd_script *script, sd_tag_id tag, uint32_t current_tick) {
+    if(script == NULL)
+        return -1;
+    if(current_tick > sd_script_get_total_ticks(script))
+        return -1;
+
+    unsigned pos = 0;
+    sd_script_frame *frame;
+    for(unsigned i = 0; i < vector_size(&script->frames); i++) {
+        frame = vector_get(&script->frames, i);
+        if(current_tick < pos && sd_script_isset_id(frame, tag)) {
+            return (int)i;
+        }
+        pos += frame->tick_len;
+    }
+
+    return -1;
+}
+
 int sd_script_next_frame_with_tag(const sd_script *script, const char *tag, uint32_t current_tick) {
     if(script == NULL || tag == NULL)
         return -1;
@@ -566,6 +623,7 @@ int sd_script_delete_tag(sd_script *script, int frame_id, const char *tag) {
     foreach(it, now) {
         if(strcmp(now->key, tag) == 0) {
             vector_delete(&frame->tags, &it);
+            sd_script_frame_compile(frame);
             return SD_SUCCESS;
         }
     }
@@ -584,7 +642,8 @@ int sd_script_set_tag(sd_script *script, int frame_id, const char *tag, int valu
 
     // Get tag information
     sd_script_tag new;
-    if(sd_tag_info(tag, &new.has_param, &new.key, &new.desc) != SD_SUCCESS) {
+    sd_script_tag_create(&new);
+    if(!sd_script_tag_lookup(&new, tag)) {
         return SD_INVALID_INPUT;
     }
     if(new.has_param) {
@@ -594,6 +653,7 @@ int sd_script_set_tag(sd_script *script, int frame_id, const char *tag, int valu
     // Delete old tag (if exists), then add new.
     sd_script_delete_tag(script, frame_id, tag);
     vector_append(&frame->tags, &new);
+    sd_script_frame_compile(frame);
     return SD_SUCCESS;
 }
 
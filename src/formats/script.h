@@ -25,16 +25,22 @@ typedef struct sd_script_tag {
     const char *desc; ///< Tag description
     int has_param;    ///< Tells if the tag has a parameter
     int value;        ///< Tag parameter value. Only valid if has_param = 1.
+    int id;           ///< Tag identifier (sd_tag_id), or -1 for tags that are not in the tag list.
 } sd_script_tag;
 
+#define SD_TAG_BITS_SIZE ((SD_TAG_COUNT + 31) / 32)
+
 /*! \brief Animation frame
  *
- * Describes a single frame in animation string.
+ * Describes a single frame in animation string. The tag list is also compiled into a bitset
+ * and a value table indexed by tag identifier, so that the tags can be checked without a search.
  */
 typedef struct sd_script_frame {
-    int sprite;   ///< Sprite ID that the frame relates to
-    int tick_len; ///< Length of the frame in ticks
-    vector tags;  ///< A list of tags in this frame
+    int sprite;                          ///< Sprite ID that the frame relates to
+    int tick_len;                        ///< Length of the frame in ticks
+    vector tags;                         ///< A list of tags in this frame
+    uint32_t tag_bits[SD_TAG_BITS_SIZE]; ///< Set tags, one bit per sd_tag_id
+    int tag_values[SD_TAG_COUNT];        ///< Tag parameter values by sd_tag_id. 0 if the tag is not set.
 } sd_script_frame;
 
 /*! \brief Animation script
@@ -305,6 +311,36 @@ int sd_script_isset(const sd_script_frame *frame, const char *tag);
  */
 int sd_script_get(const sd_script_frame *frame, const char *tag);
 
+/*! \brief Tells if the tag is set in frame
+ *
+ * Same as sd_script_isset(), but looks up the tag by its identifier.
+ *
+ * \param frame The frame structure to inspect. May be NULL.
+ * \param tag Tag identifier
+ * \return 1 or 0
+ */
+static inline int sd_script_isset_id(const sd_script_frame *frame, sd_tag_id tag) {
+    if(frame == NULL) {
+        return 0;
+    }
+    return (frame->tag_bits[tag / 32] >> (tag % 32)) & 1;
+}
+
+/*! \brief Returns the tag value in frame
+ *
+ * Same as sd_script_get(), but looks up the tag by its identifier.
+ *
+ * \param frame The frame structure to inspect. May be NULL.
+ * \param tag Tag identifier
+ * \return Tag parameter value or 0.
+ */
+static inline int sd_script_get_id(const sd_script_frame *frame, sd_tag_id tag) {
+    if(frame == NULL) {
+        return 0;
+    }
+    return frame->tag_values[tag];
+}
+
 /*! \brief Returns the next frame number with a given sprite ID
  *
  * Returns the next frame number with the given sprite number. Sprite numbers start from 0 and go to
@@ -341,6 +377,17 @@ int sd_script_next_frame_with_sprite(const sd_script *script, int sprite_id, uns
  */
 int sd_script_next_frame_with_tag(const sd_script *script, const char *tag, uint32_t current_tick);
 
+/*! \brief Returns the next frame number with a given tag
+ *
+ * Same as sd_script_next_frame_with_tag(), but looks up the tag by its identifier.
+ *
+ * \param script Script structure to search through
+ * \param tag Tag identifier to search for
+ * \param current_tick Current tick time
+ * \return Frame ID or -1 on error
+ */
+int sd_script_next_frame_with_tag_id(const sd_script *script, sd_tag_id tag, uint32_t current_tick);
+
 /*! \brief Sets a tag for the given frame
  *
  * Sets the tag for the given frame. If the tag has not been set previously, a new tag
@@ -459,4 +506,12 @@ void sd_script_frame_free(sd_script_frame *frame);
  */
 bool sd_script_frame_add_tag(sd_script_frame *frame, const char *key, int value);
 
+/** Rebuild the tag bitset and value table of a frame from its tag list.
+ *
+ * This is done by all the functions here that change tags. Call it after changing the tag list by hand.
+ *
+ * @param frame Frame to update
+ */
+void sd_script_frame_compile(sd_script_frame *frame);
+
 #endif // SD_SCRIPT_H
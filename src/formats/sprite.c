@@ -90,6 +90,19 @@ int sd_sprite_save(sd_writer *w, const sd_sprite *sprite) {
     return SD_SUCCESS;
 }
 
+void sd_sprite_msave(memwriter *w, const sd_sprite *sprite) {
+    memwrite_uword(w, sprite->len);
+    memwrite_word(w, sprite->pos_x);
+    memwrite_word(w, sprite->pos_y);
+    memwrite_uword(w, sprite->width);
+    memwrite_uword(w, sprite->height);
+    memwrite_ubyte(w, sprite->index);
+    memwrite_ubyte(w, sprite->missing);
+    if(!sprite->missing) {
+        memwrite_buf(w, sprite->data, sprite->len);
+    }
+}
+
 int sd_sprite_rgba_encode(sd_sprite *dst, const sd_rgba_image *src, const vga_palette *pal) {
     int lastx = -1;
     int lasty = 0;
@@ -110,13 +123,17 @@ int sd_sprite_rgba_encode(sd_sprite *dst, const sd_rgba_image *src, const vga_pa
     rgb_size = src->w * src->h * 4;
     buf = omf_calloc(rgb_size, 1);
 
+    // Colors are matched exactly; anything not on the palette becomes index 0.
+    palette_lookup lookup;
+    palette_lookup_create(&lookup, pal, 0, 256);
+
     // always initialize Y to 0
     buf[i++] = 2;
     buf[i++] = 0;
     rowstart = i;
 
     // Walk through the RGBA data
-    for(size_t pos = 0; pos <= rgb_size; pos += 4) {
+    for(size_t pos = 0; pos < rgb_size; pos += 4) {
         uint8_t r = src->data[pos];
         uint8_t g = src->data[pos + 1];
         uint8_t b = src->data[pos + 2];
@@ -169,7 +186,8 @@ int sd_sprite_rgba_encode(sd_sprite *dst, const sd_rgba_image *src, const vga_pa
             lastx = x;
             lasty = y;
             // write byte
-            buf[i++] = palette_resolve_color(r, g, b, pal);
+            int idx = palette_lookup_exact(&lookup, r, g, b);
+            buf[i++] = idx < 0 ? 0 : idx;
             rowlen++;
         }
     }
@@ -265,79 +283,120 @@ int sd_sprite_rgba_decode(sd_rgba_image *dst, const sd_sprite *src, const vga_pa
     return SD_SUCCESS;
 }
 
-int sd_sprite_vga_decode(sd_vga_image *dst, const sd_sprite *src) {
-    uint16_t x = 0;
-    uint16_t y = 0;
-    int i = 0;
-    uint16_t c = 0;
-    uint16_t data = 0;
-    char op = 0;
+/**
+ * Decode the pixels of a sprite into dst, which holds dst_size bytes and has been cleared. Each run of pixels is
+ * copied in one go. Runs that go past the end of dst are cut short, like the game does.
+ */
+static int vga_decode_pixels(char *dst, unsigned int dst_size, const sd_sprite *src) {
+    const uint8_t *data = (const uint8_t *)src->data;
+    unsigned int len = src->len;
+    unsigned int i = 0;
+    unsigned int x = 0;
+    unsigned int y = 0;
+
+    // Walk through raw sprite data, one word at a time
+    while(i + 2 <= len) {
+        uint16_t c = data[i] | (data[i + 1] << 8);
+        unsigned int arg = c >> 2;
+        i += 2;
+
+        switch(c & 3) {
+            case 0:
+                x = arg;
+                break;
+            case 2:
+                y = arg;
+                break;
+            case 1: {
+                // Run of arg pixels, starting from (x, y). Never read past the sprite data.
+                unsigned int n = arg < len - i ? arg : len - i;
+                unsigned int pos = y * src->width + x;
+                if(n > 0 && (pos >= dst_size || n > dst_size - pos)) {
+                    if(pos < dst_size) {
+                        memcpy(dst + pos, data + i, dst_size - pos);
+                    }
+                    log_warn("Truncating sd_sprite vga data");
+                    // This code path is taken when loading tournament REC files (incl. ones from DOS)
+                    // TODO: Figure out what's going on with sprite width/height, and
+                    // clean up (centralize?) those width/height++/-- adjustments.
+                    return SD_SUCCESS;
+                }
+                memcpy(dst + pos, data + i, n);
+                i += n;
+                x = 0;
+                break;
+            }
+            case 3:
+                if(i != len) {
+                    return SD_INVALID_INPUT;
+                }
+                break;
+        }
+    }
+    return SD_SUCCESS;
+}
 
+/**
+ * Size of the VGA image a sprite decodes to. If image data length is 0, then size should be 1x1.
+ */
+static void vga_decode_size(const sd_sprite *src, unsigned int *w, unsigned int *h) {
+    *w = src->len > 0 ? src->width : 1;
+    *h = src->len > 0 ? src->height : 1;
+}
+
+int sd_sprite_vga_decode(sd_vga_image *dst, const sd_sprite *src) {
     // Make sure we aren't being fed BS
     if(dst == NULL || src == NULL) {
         return SD_INVALID_INPUT;
     }
 
-    // If image data length is 0, then size should be 1x1
-    if(src->len > 0) {
-        sd_vga_image_create(dst, src->width, src->height);
-    } else {
-        sd_vga_image_create(dst, 1, 1);
-    }
+    unsigned int w, h;
+    vga_decode_size(src, &w, &h);
+    sd_vga_image_create(dst, w, h);
 
     // XXX CREDITS.BK has a bunch of 0 width sprites, for some unknown reason
     if(src->width == 0 || src->height == 0 || src->len == 0) {
         return SD_SUCCESS;
     }
 
-    // the number of bytes that can be written to `dst`.
-    unsigned int dst_size = dst->w * dst->h;
+    // All done. dst should now contain a valid vga image.
+    return vga_decode_pixels(dst->data, dst->w * dst->h, src);
+}
 
-    // Walk through raw sprite data
-    while(i < src->len) {
-        // read a word
-        c = (uint8_t)src->data[i] + ((uint8_t)src->data[i + 1] << 8);
-        op = c % 4;
-        data = c / 4;
-        i += 2; // we read 2 bytes
+int sd_sprite_vga_decode_batch(sd_vga_image *dst, sd_sprite *const *src, int count, char **arena) {
+    if(dst == NULL || src == NULL || arena == NULL) {
+        return SD_INVALID_INPUT;
+    }
 
-        // Handle operation
-        switch(op) {
-            case 0:
-                x = data;
-                break;
-            case 2:
-                y = data;
-                break;
-            case 1:
-                while(data > 0) {
-                    uint8_t b = src->data[i];
-                    unsigned int pos = ((y * src->width) + x);
-                    // if we're about to overflow the `dst` buffer, don't.
-                    if(pos >= dst_size) {
-                        log_warn("Truncating sd_sprite vga data");
-                        // This code path is taken when loading tournament REC files (incl. ones from DOS)
-                        // TODO: Figure out what's going on with sprite width/height, and
-                        // clean up (centralize?) those width/height++/-- adjustments.
-                        return SD_SUCCESS;
-                    }
-                    dst->data[pos] = b;
-                    i++; // we read 1 byte
-                    x++;
-                    data--;
-                }
-                x = 0;
-                break;
-            case 3:
-                if(i != src->len) {
-                    return SD_INVALID_INPUT;
-                }
-                break;
+    // Find out the size of every image first, so that they can all go in one allocation.
+    size_t total = 0;
+    for(int i = 0; i < count; i++) {
+        memset(&dst[i], 0, sizeof(sd_vga_image));
+        if(src[i] == NULL || src[i]->missing) {
+            continue;
         }
+        vga_decode_size(src[i], &dst[i].w, &dst[i].h);
+        dst[i].len = dst[i].w * dst[i].h;
+        total += dst[i].len;
     }
 
-    // All done. dst should now contain a valid vga image.
-    return SD_SUCCESS;
+    int ret = SD_SUCCESS;
+    char *next = *arena = omf_calloc(1, total + 1);
+    for(int i = 0; i < count; i++) {
+        if(src[i] == NULL || src[i]->missing) {
+            continue;
+        }
+        dst[i].data = next;
+        next += dst[i].len;
+        if(src[i]->width == 0 || src[i]->height == 0 || src[i]->len == 0) {
+            continue;
+        }
+        int decoded = vga_decode_pixels(dst[i].data, dst[i].len, src[i]);
+        if(decoded != SD_SUCCESS) {
+            ret = decoded;
+        }
+    }
+    return ret;
 }
 
 int sd_sprite_vga_encode(sd_sprite *dst, const sd_vga_image *src) {
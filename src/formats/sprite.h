@@ -11,6 +11,7 @@
 #ifndef SD_SPRITE_H
 #define SD_SPRITE_H
 
+#include "formats/internal/memwriter.h"
 #include "formats/internal/reader.h"
 #include "formats/internal/writer.h"
 #include "formats/rgba_image.h"
@@ -118,6 +119,22 @@ int sd_sprite_rgba_decode(sd_rgba_image *dst, const sd_sprite *src, const vga_pa
  */
 int sd_sprite_vga_decode(sd_vga_image *dst, const sd_sprite *src);
 
+/*! \brief Decode several sprites to VGA image format.
+ *
+ * Decodes count sprites like sd_sprite_vga_decode(), but places the pixels of all images in a single
+ * allocation. Missing sprites and NULL entries share the data of another sprite, so they are left empty
+ * (all zeroes). The images must not be freed with sd_vga_image_free(); free the arena with omf_free() instead.
+ *
+ * \retval SD_INVALID_INPUT Dst, src or arena was NULL, or a sprite had invalid data.
+ * \retval SD_SUCCESS Success.
+ *
+ * \param dst Array of count VGA image structs to decode into.
+ * \param src Array of count sprite pointers.
+ * \param count Number of sprites.
+ * \param arena Pointer to the allocation holding all the pixels is written here.
+ */
+int sd_sprite_vga_decode_batch(sd_vga_image *dst, sd_sprite *const *src, int count, char **arena);
+
 /*! \brief Encode sprite from VGA image format.
  *
  * Encodes a VGA image to sprite format
@@ -132,5 +149,6 @@ int sd_sprite_vga_encode(sd_sprite *dst, const sd_vga_image *src);
 
 int sd_sprite_load(sd_reader *reader, sd_sprite *sprite);
 int sd_sprite_save(sd_writer *writer, const sd_sprite *sprite);
+void sd_sprite_msave(memwriter *writer, const sd_sprite *sprite);
 
 #endif // SD_SPRITE_H
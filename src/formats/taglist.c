@@ -158,4 +158,6 @@ const sd_tag sd_taglist[] = {
     {"zz",  0, "Invulnerable to any attacks"                                                                          },
 };
 
-const int sd_taglist_size = 153;
+_Static_assert(sizeof(sd_taglist) / sizeof(sd_taglist[0]) == SD_TAG_COUNT, "sd_tag_id must match sd_taglist");
+
+const int sd_taglist_size = SD_TAG_COUNT;
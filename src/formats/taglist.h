@@ -10,6 +10,169 @@
 #ifndef SD_TAGLIST_H
 #define SD_TAGLIST_H
 
+/*! \brief Tag identifiers
+ *
+ * One identifier per entry in sd_taglist, in the same order. Used for fast tag lookups in
+ * decoded animation frames, see sd_script_isset_id() and sd_script_get_id().
+ */
+typedef enum
+{
+    SD_TAG_AA,
+    SD_TAG_AB,
+    SD_TAG_AC,
+    SD_TAG_AD,
+    SD_TAG_AE,
+    SD_TAG_AF,
+    SD_TAG_AG,
+    SD_TAG_AI,
+    SD_TAG_AM,
+    SD_TAG_AO,
+    SD_TAG_AS,
+    SD_TAG_AT,
+    SD_TAG_AW,
+    SD_TAG_AX,
+    SD_TAG_AR,
+    SD_TAG_AL,
+    SD_TAG_B,
+    SD_TAG_B1,
+    SD_TAG_B2,
+    SD_TAG_BB,
+    SD_TAG_BE,
+    SD_TAG_BF,
+    SD_TAG_BH,
+    SD_TAG_BL,
+    SD_TAG_BM,
+    SD_TAG_BJ,
+    SD_TAG_BS,
+    SD_TAG_BU,
+    SD_TAG_BW,
+    SD_TAG_BX,
+    SD_TAG_BPD,
+    SD_TAG_BPS,
+    SD_TAG_BPN,
+    SD_TAG_BPF,
+    SD_TAG_BPP,
+    SD_TAG_BPB,
+    SD_TAG_BPO,
+    SD_TAG_BZ,
+    SD_TAG_BA,
+    SD_TAG_BC,
+    SD_TAG_BD,
+    SD_TAG_BG,
+    SD_TAG_BI,
+    SD_TAG_BK,
+    SD_TAG_BN,
+    SD_TAG_BO,
+    SD_TAG_BR,
+    SD_TAG_BT,
+    SD_TAG_BY,
+    SD_TAG_CF,
+    SD_TAG_CG,
+    SD_TAG_CL,
+    SD_TAG_CP,
+    SD_TAG_CW,
+    SD_TAG_CX,
+    SD_TAG_CY,
+    SD_TAG_D,
+    SD_TAG_E,
+    SD_TAG_F,
+    SD_TAG_G,
+    SD_TAG_H,
+    SD_TAG_I,
+    SD_TAG_JF2,
+    SD_TAG_JF,
+    SD_TAG_JG,
+    SD_TAG_JH,
+    SD_TAG_JJ,
+    SD_TAG_JL,
+    SD_TAG_JM,
+    SD_TAG_JP,
+    SD_TAG_JZ,
+    SD_TAG_JN,
+    SD_TAG_K,
+    SD_TAG_L,
+    SD_TAG_MA,
+    SD_TAG_MC,
+    SD_TAG_MD,
+    SD_TAG_MG,
+    SD_TAG_MI,
+    SD_TAG_MM,
+    SD_TAG_MN,
+    SD_TAG_MO,
+    SD_TAG_MP,
+    SD_TAG_MRX,
+    SD_TAG_MRY,
+    SD_TAG_MS,
+    SD_TAG_MU,
+    SD_TAG_MX,
+    SD_TAG_MY,
+    SD_TAG_M,
+    SD_TAG_N,
+    SD_TAG_OX,
+    SD_TAG_OY,
+    SD_TAG_PA,
+    SD_TAG_PB,
+    SD_TAG_PC,
+    SD_TAG_PD,
+    SD_TAG_PE,
+    SD_TAG_PH,
+    SD_TAG_PP,
+    SD_TAG_PS,
+    SD_TAG_PTD,
+    SD_TAG_PTP,
+    SD_TAG_PTR,
+    SD_TAG_Q,
+    SD_TAG_R,
+    SD_TAG_S,
+    SD_TAG_SA,
+    SD_TAG_SB,
+    SD_TAG_SC,
+    SD_TAG_SD,
+    SD_TAG_SE,
+    SD_TAG_SF,
+    SD_TAG_SL,
+    SD_TAG_SMF,
+    SD_TAG_SMO,
+    SD_TAG_SP,
+    SD_TAG_SW,
+    SD_TAG_T,
+    SD_TAG_U,
+    SD_TAG_UA,
+    SD_TAG_UB,
+    SD_TAG_UC,
+    SD_TAG_UD,
+    SD_TAG_UE,
+    SD_TAG_UF,
+    SD_TAG_UG,
+    SD_TAG_UH,
+    SD_TAG_UJ,
+    SD_TAG_UL,
+    SD_TAG_UN,
+    SD_TAG_UR,
+    SD_TAG_US,
+    SD_TAG_UZ,
+    SD_TAG_V,
+    SD_TAG_VSX,
+    SD_TAG_VSY,
+    SD_TAG_W,
+    SD_TAG_X_MINUS,
+    SD_TAG_X_PLUS,
+    SD_TAG_X_EQ,
+    SD_TAG_X,
+    SD_TAG_Y_MINUS,
+    SD_TAG_Y_PLUS,
+    SD_TAG_Y_EQ,
+    SD_TAG_Y,
+    SD_TAG_ZG,
+    SD_TAG_ZH,
+    SD_TAG_ZJ,
+    SD_TAG_ZL,
+    SD_TAG_ZM,
+    SD_TAG_ZP,
+    SD_TAG_ZZ,
+    SD_TAG_COUNT
+} sd_tag_id;
+
 /*! \brief Tag information entry
  *
  * Contains information about a single animation tag.
@@ -39,4 +202,11 @@ extern const int sd_taglist_size; ///< Taglist size
  */
 int sd_tag_info(const char *search_tag, int *req_param, const char **tag, const char **desc);
 
+/*! \brief Find the identifier of a tag
+ *
+ * \param search_tag A Tag to look for
+ * \return Tag identifier, or -1 if the tag does not exist.
+ */
+int sd_tag_find_id(const char *search_tag);
+
 #endif // SD_TAGLIST_H
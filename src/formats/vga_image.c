@@ -62,6 +62,25 @@ int sd_vga_image_decode(sd_rgba_image *dst, const sd_vga_image *src, const vga_p
     return SD_SUCCESS;
 }
 
+int sd_vga_image_encode(sd_vga_image *dst, const sd_rgba_image *src, const palette_lookup *lookup) {
+    int ret;
+    if(dst == NULL || src == NULL || lookup == NULL) {
+        return SD_INVALID_INPUT;
+    }
+    if((ret = sd_vga_image_create(dst, src->w, src->h)) != SD_SUCCESS) {
+        return ret;
+    }
+    for(unsigned int i = 0; i < dst->len; i++) {
+        const uint8_t *px = (const uint8_t *)&src->data[i * 4];
+        if(px[3] != 255) {
+            continue;
+        }
+        int idx = palette_lookup_exact(lookup, px[0], px[1], px[2]);
+        dst->data[i] = idx >= 0 ? idx : palette_lookup_nearest(lookup, px[0], px[1], px[2]);
+    }
+    return SD_SUCCESS;
+}
+
 int sd_vga_image_from_png(sd_vga_image *img, const char *filename) {
     if(sd_vga_image_create(img, 320, 200) != SD_SUCCESS) {
         return SD_FAILURE;
@@ -85,6 +85,25 @@ void sd_vga_image_free(sd_vga_image *img);
  */
 int sd_vga_image_decode(sd_rgba_image *dst, const sd_vga_image *src, const vga_palette *pal);
 
+/*! \brief Encode RGBA data to VGA format
+ *
+ * Converts the RGBA image to a VGA image, mapping each pixel to the palette index with the
+ * same color, or the nearest one if the palette has no exact match. Pixels that are not fully
+ * opaque become index 0. Only the palette indexes given to the lookup are used.
+ *
+ * Note! The output VGA image will be created here. If the image had been
+ * already created by using sd_vga_image_create() previously, there may
+ * potentially be a memory leak, since the old image internals will not be freed.
+ *
+ * \retval SD_INVALID_INPUT Dst, src or lookup was NULL.
+ * \retval SD_SUCCESS Success.
+ *
+ * \param dst Destination VGA image struct pointer.
+ * \param src Source RGBA image pointer
+ * \param lookup Reverse palette lookup, built with palette_lookup_create()
+ */
+int sd_vga_image_encode(sd_vga_image *dst, const sd_rgba_image *src, const palette_lookup *lookup);
+
 /*! \brief Load an indexed image from a PNG file.
  *
  * Loads an indexed (paletted) image from a PNG file. Maximum allowed image
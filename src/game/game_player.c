@@ -1,6 +1,9 @@
 #include "game/game_player.h"
+#include "game/utils/snapshot.h"
 #include "utils/allocator.h"
+#include "utils/c_array_util.h"
 #include <stdlib.h>
+#include <string.h>
 
 void game_player_create(game_player *gp) {
     gp->har_obj_id = 0;
@@ -90,6 +93,25 @@ void game_player_clone(game_player *src, game_player *dst) {
     har_screencaps_clone(&src->screencaps, &dst->screencaps);
 }
 
+// Controllers, pilots and pictures are not changed by the fight, and screencaps are pictures for the newsroom
+static const snapshot_field game_player_fields[] = {
+    SNAPSHOT_FIELD(game_player, har_obj_id),
+    SNAPSHOT_FIELD(game_player, selectable),
+    SNAPSHOT_FIELD(game_player, god),
+    SNAPSHOT_FIELD(game_player, ez_destruct),
+    SNAPSHOT_FIELD(game_player, sp_wins),
+};
+
+void game_player_snapshot(const game_player *gp, serial *ser) {
+    snapshot_write_fields(ser, gp, game_player_fields, N_ELEMENTS(game_player_fields));
+    chr_score_snapshot(&gp->score, ser);
+}
+
+void game_player_restore(game_player *gp, serial *ser) {
+    snapshot_read_fields(ser, gp, game_player_fields, N_ELEMENTS(game_player_fields));
+    chr_score_restore(&gp->score, ser);
+}
+
 int game_player_clone_free(game_player *gp) {
     chr_score_free(&gp->score);
     har_screencaps_free(&gp->screencaps);
@@ -44,5 +44,7 @@ void game_player_set_pilot(game_player *gp, sd_pilot *new_pilot);
 chr_score *game_player_get_score(game_player *gp);
 void game_player_clone(game_player *src, game_player *dst);
 int game_player_clone_free(game_player *gp);
+void game_player_snapshot(const game_player *gp, serial *ser);
+void game_player_restore(game_player *gp, serial *ser);
 
 #endif // GAME_PLAYER_H
@@ -35,6 +35,7 @@
 #include "video/vga_state.h"
 #include "video/video.h"
 #include <SDL.h>
+#include <inttypes.h>
 #include <math.h>
 #include <stdlib.h>
 #include <time.h>
@@ -54,25 +55,6 @@ static void _setup_rec_controller(game_state *gs, int player_id, sd_rec_file *re
 // Used for crossfades
 #define FRAME_WAIT_TICKS 30
 
-typedef struct {
-    int layer;      ///< Object rendering layer
-    int persistent; ///< 1 if the object should keep alive across scene boundaries
-    int singleton;  ///< 1 if object should be the only representative of its animation ID
-    object *obj;
-} render_obj;
-
-typedef struct {
-    int tick;
-    int id;
-    int length;
-    int duration;
-    int freq;
-    float volume;
-    float panning;
-    int pitch;
-    int playback_id;
-} playing_sound;
-
 int game_state_get_assertion_operand(rec_assertion_operand *op, game_state *gs) {
     if(op->is_literal) {
         return op->value.literal;
@@ -226,6 +208,7 @@ int game_state_create(game_state *gs, engine_init_flags *init_flags) {
     gs->hit_pause = 0;
     game_state_match_settings_reset(gs);
     vector_create(&gs->objects, sizeof(render_obj));
+    idmap_create(&gs->object_index);
     vector_create(&gs->sounds, sizeof(playing_sound));
 
     // For screen shake
@@ -347,7 +330,9 @@ error_1:
     scene_free(gs->sc);
 error_0:
     omf_free(gs->sc);
+    gs->sc = NULL;
     vector_free(&gs->objects);
+    idmap_free(&gs->object_index);
     vector_free(&gs->sounds);
     return 1;
 }
@@ -378,6 +363,7 @@ int game_state_add_object(game_state *gs, object *obj, int layer, int singleton,
         }
     }
     vector_append(&gs->objects, &o);
+    idmap_put(&gs->object_index, obj->id, obj);
 
 #ifdef DEBUGMODE_STFU
     animation *ani = object_get_animation(obj);
@@ -417,6 +403,7 @@ void game_state_del_animation(game_state *gs, int anim_id) {
     foreach(it, robj) {
         animation *ani = object_get_animation(robj->obj);
         if(ani != NULL && ani->id == anim_id) {
+            idmap_del(&gs->object_index, robj->obj->id);
             object_free(robj->obj);
             omf_free(robj->obj);
             vector_delete(&gs->objects, &it);
@@ -433,6 +420,7 @@ void game_state_del_object(game_state *gs, object *target) {
     vector_iter_begin(&gs->objects, &it);
     foreach(it, robj) {
         if(target == robj->obj) {
+            idmap_del(&gs->object_index, robj->obj->id);
             object_free(robj->obj);
             omf_free(robj->obj);
             vector_delete(&gs->objects, &it);
@@ -447,6 +435,7 @@ void game_state_del_object_by_id(game_state *gs, uint32_t target) {
     vector_iter_begin(&gs->objects, &it);
     foreach(it, robj) {
         if(target == robj->obj->id) {
+            idmap_del(&gs->object_index, robj->obj->id);
             object_free(robj->obj);
             omf_free(robj->obj);
             vector_delete(&gs->objects, &it);
@@ -472,6 +461,7 @@ void game_state_clear_objects(game_state *gs, int mask) {
     vector_iter_begin(&gs->objects, &it);
     foreach(it, robj) {
         if(object_get_group(robj->obj) & mask) {
+            idmap_del(&gs->object_index, robj->obj->id);
             object_free(robj->obj);
             omf_free(robj->obj);
             vector_delete(&gs->objects, &it);
@@ -665,6 +655,7 @@ int game_load_new(game_state *gs, int scene_id) {
     vector_iter_begin(&gs->objects, &it);
     foreach(it, robj) {
         if(!robj->persistent) {
+            idmap_del(&gs->object_index, robj->obj->id);
             object_free(robj->obj);
             omf_free(robj->obj);
             vector_delete(&gs->objects, &it);
@@ -783,6 +774,11 @@ void game_state_call_collide(game_state *gs) {
     unsigned int size = vector_size(&gs->objects);
     for(unsigned i = 0; i < size; i++) {
         a = ((render_obj *)vector_get(&gs->objects, i))->obj;
+        // object_collide only calls the callback of the first object of the pair, so pairs
+        // led by an object without one (scrap, sparks, announcements, ...) can be skipped entirely.
+        if(a->collide == NULL) {
+            continue;
+        }
         for(unsigned k = i + 1; k < size; k++) {
             b = ((render_obj *)vector_get(&gs->objects, k))->obj;
             if(a->group != b->group || a->group == GROUP_UNKNOWN || b->group == GROUP_UNKNOWN ||
@@ -802,6 +798,7 @@ void game_state_cleanup(game_state *gs) {
     foreach(it, robj) {
         if(object_finished(robj->obj)) {
             /*log_debug("Animation object %d is finished, removing.", robj->obj->cur_animation->id);*/
+            idmap_del(&gs->object_index, robj->obj->id);
             object_free(robj->obj);
             omf_free(robj->obj);
             vector_delete(&gs->objects, &it);
@@ -877,7 +874,7 @@ void game_state_call_tick(game_state *gs, int mode) {
     }
 }
 
-void game_state_merge_sounds(game_state *old, game_state *new) {
+static void merge_sounds(vector *old_sounds, vector *new_sounds) {
     // We need to do several things here:
     // * Leave any sounds that are playing in both states alone
     // * Fade out any sounds only playing in the old state
@@ -885,10 +882,10 @@ void game_state_merge_sounds(game_state *old, game_state *new) {
 
     playing_sound *s, *s2;
     iterator it, it2;
-    vector_iter_begin(&old->sounds, &it);
+    vector_iter_begin(old_sounds, &it);
     while((s = iter_next(&it)) != NULL) {
         bool found = false;
-        vector_iter_begin(&new->sounds, &it2);
+        vector_iter_begin(new_sounds, &it2);
         while((s2 = iter_next(&it2)) != NULL) {
             if(s->id == s2->id && s->tick == s2->tick) {
                 // same sound, same frame
@@ -904,10 +901,10 @@ void game_state_merge_sounds(game_state *old, game_state *new) {
         }
     }
 
-    vector_iter_begin(&new->sounds, &it);
+    vector_iter_begin(new_sounds, &it);
     while((s = iter_next(&it)) != NULL) {
         bool found = false;
-        vector_iter_begin(&old->sounds, &it2);
+        vector_iter_begin(old_sounds, &it2);
         while((s2 = iter_next(&it2)) != NULL) {
             if(s->id == s2->id && s->tick == s2->tick) {
                 // same sound, same frame
@@ -950,13 +947,31 @@ void game_state_merge_sounds(game_state *old, game_state *new) {
             // guard against playing beyond the end of the buffer
             if(offset < src_len) {
                 // TODO decide on a fade in time
-                s->playback_id = audio_play_sound_buf(src_buf + offset, src_len - offset, s->freq, s->volume,
-                                                      s->panning, s->pitch, 500);
+                s->playback_id = audio_play_sound_offset(s->id, offset, s->volume, s->panning, s->pitch, 500);
             }
         }
     }
 }
 
+void game_state_merge_sounds(game_state *old, game_state *new) {
+    merge_sounds(&old->sounds, &new->sounds);
+}
+
+void game_state_copy_sounds(game_state *gs, vector *dst) {
+    vector_clear(dst);
+    iterator it;
+    playing_sound *s;
+    vector_iter_begin(&gs->sounds, &it);
+    while((s = iter_next(&it)) != NULL) {
+        vector_append(dst, s);
+    }
+}
+
+// After a rollback the game state was replayed in place. previous holds the sounds from before that.
+void game_state_merge_rolled_back_sounds(game_state *gs, vector *previous) {
+    merge_sounds(previous, &gs->sounds);
+}
+
 // This function is always called with the same interval, and game speed does not affect it
 void game_state_static_tick(game_state *gs, bool replay) {
     // Set scene crossfade values
@@ -1257,6 +1272,7 @@ void game_state_clone_free(game_state *gs) {
         vector_delete(&gs->objects, &it);
     }
     vector_free(&gs->objects);
+    idmap_free(&gs->object_index);
     vector_free(&gs->sounds);
 
     // Free scene
@@ -1286,6 +1302,7 @@ void game_state_free(game_state **_gs) {
         vector_delete(&gs->objects, &it);
     }
     vector_free(&gs->objects);
+    idmap_free(&gs->object_index);
     vector_free(&gs->sounds);
 
     // Free scene
@@ -1340,15 +1357,7 @@ int render_obj_clone(render_obj *src, render_obj *dst, game_state *gs) {
 }
 
 object *game_state_find_object(game_state *gs, uint32_t object_id) {
-    iterator it;
-    vector_iter_begin(&gs->objects, &it);
-    render_obj *robj;
-    foreach(it, robj) {
-        if(robj->obj->id == object_id) {
-            return robj->obj;
-        }
-    }
-    return NULL;
+    return idmap_get(&gs->object_index, object_id);
 }
 
 int game_state_find_objects(game_state *gs, vector *out, bool (*predicate)(const object *obj, void *user_data),
@@ -1398,7 +1407,7 @@ void game_state_play_sound(game_state *gs, int id, float volume, float panning,
         // do not actually begin playback if this is a cloned game state
         // cloned game states that are promoted to the active game state
         // will have this flag removed
-        s.playback_id = audio_play_sound_buf(src_buf, src_len, src_freq, volume, panning, pitch, 0);
+        s.playback_id = audio_play_sound(id, volume, panning, pitch);
         if(s.playback_id == -1) {
             // don't track sounds that failed to play
             return;
@@ -1413,6 +1422,7 @@ int game_state_clone(game_state *src, game_state *dst) {
     memcpy(dst, src, sizeof(game_state));
     // fix any pointers to volatile data
     vector_create(&dst->objects, sizeof(render_obj));
+    idmap_create(&dst->object_index);
     vector_create(&dst->sounds, sizeof(playing_sound));
 
     dst->next_wait_ticks = 0;
@@ -1425,6 +1435,7 @@ int game_state_clone(game_state *src, game_state *dst) {
         render_obj d;
         render_obj_clone(robj, &d, dst);
         vector_append(&dst->objects, &d);
+        idmap_put(&dst->object_index, d.obj->id, d.obj);
     }
 
     vector_iter_begin(&src->sounds, &it);
@@ -1450,6 +1461,228 @@ int game_state_clone(game_state *src, game_state *dst) {
     return 0;
 }
 
+// Resources, engine pacing and crossfades belong to the running game state and are not rolled back
+static const snapshot_field game_state_fields[] = {
+    SNAPSHOT_FIELD(game_state, paused),
+    SNAPSHOT_FIELD(game_state, this_id),
+    SNAPSHOT_FIELD(game_state, next_id),
+    SNAPSHOT_FIELD(game_state, next_next_id),
+    SNAPSHOT_FIELD(game_state, tick),
+    SNAPSHOT_FIELD(game_state, int_tick),
+    SNAPSHOT_FIELD(game_state, role),
+    SNAPSHOT_FIELD(game_state, speed),
+    SNAPSHOT_FIELD(game_state, match_settings.throw_range),
+    SNAPSHOT_FIELD(game_state, match_settings.hit_pause),
+    SNAPSHOT_FIELD(game_state, match_settings.block_damage),
+    SNAPSHOT_FIELD(game_state, match_settings.vitality),
+    SNAPSHOT_FIELD(game_state, match_settings.jump_height),
+    SNAPSHOT_FIELD(game_state, match_settings.knock_down),
+    SNAPSHOT_FIELD(game_state, match_settings.rehit),
+    SNAPSHOT_FIELD(game_state, match_settings.defensive_throws),
+    SNAPSHOT_FIELD(game_state, match_settings.power1),
+    SNAPSHOT_FIELD(game_state, match_settings.power2),
+    SNAPSHOT_FIELD(game_state, match_settings.hazards),
+    SNAPSHOT_FIELD(game_state, match_settings.rounds),
+    SNAPSHOT_FIELD(game_state, match_settings.fight_mode),
+    SNAPSHOT_FIELD(game_state, match_settings.sim),
+    SNAPSHOT_FIELD(game_state, screen_shake_horizontal),
+    SNAPSHOT_FIELD(game_state, screen_shake_vertical),
+    SNAPSHOT_FIELD(game_state, arena),
+    SNAPSHOT_FIELD(game_state, speed_slowdown_previous),
+    SNAPSHOT_FIELD(game_state, speed_slowdown_time),
+    SNAPSHOT_FIELD(game_state, hit_pause),
+    SNAPSHOT_FIELD(game_state, hide_ui),
+    SNAPSHOT_FIELD(game_state, warp_speed),
+    SNAPSHOT_FIELD(game_state, net_mode),
+    SNAPSHOT_FIELD(game_state, fight_stats.winner),
+    SNAPSHOT_FIELD(game_state, fight_stats.plug_text),
+    SNAPSHOT_FIELD(game_state, fight_stats.sold),
+    SNAPSHOT_FIELD(game_state, fight_stats.winnings),
+    SNAPSHOT_FIELD(game_state, fight_stats.bonuses),
+    SNAPSHOT_FIELD(game_state, fight_stats.repair_cost),
+    SNAPSHOT_FIELD(game_state, fight_stats.profit),
+    SNAPSHOT_FIELD(game_state, fight_stats.hp),
+    SNAPSHOT_FIELD(game_state, fight_stats.max_hp),
+    SNAPSHOT_FIELD(game_state, fight_stats.finish),
+    SNAPSHOT_FIELD(game_state, fight_stats.challenger),
+    SNAPSHOT_FIELD(game_state, fight_stats.hits_landed),
+    SNAPSHOT_FIELD(game_state, fight_stats.average_damage),
+    SNAPSHOT_FIELD(game_state, fight_stats.total_attacks),
+    SNAPSHOT_FIELD(game_state, fight_stats.hit_miss_ratio),
+    SNAPSHOT_FIELD(game_state, rand.seed),
+};
+
+static const snapshot_field render_obj_fields[] = {
+    SNAPSHOT_FIELD(render_obj, layer),
+    SNAPSHOT_FIELD(render_obj, persistent),
+    SNAPSHOT_FIELD(render_obj, singleton),
+};
+
+void game_state_snapshot(game_state *gs, snapshot *snap) {
+    serial *ser = &snap->data;
+    snapshot_clear(snap);
+
+    snapshot_begin_section(snap, SNAPSHOT_SECTION_STATE, 0);
+    snapshot_write_fields(ser, gs, game_state_fields, N_ELEMENTS(game_state_fields));
+    snapshot_end_section(snap);
+
+    snapshot_begin_section(snap, SNAPSHOT_SECTION_SOUNDS, 0);
+    uint32_t count = vector_size(&gs->sounds);
+    serial_write(ser, (const char *)&count, sizeof(count));
+    serial_write(ser, gs->sounds.data, count * sizeof(playing_sound));
+    snapshot_end_section(snap);
+
+    for(int i = 0; i < 2; i++) {
+        snapshot_begin_section(snap, SNAPSHOT_SECTION_PLAYER, i);
+        game_player_snapshot(gs->players[i], ser);
+        snapshot_end_section(snap);
+    }
+
+    snapshot_begin_section(snap, SNAPSHOT_SECTION_SCENE, gs->sc->id);
+    scene_snapshot(gs->sc, ser);
+    snapshot_end_section(snap);
+
+    iterator it;
+    render_obj *robj;
+    vector_iter_begin(&gs->objects, &it);
+    foreach(it, robj) {
+        snapshot_begin_section(snap, SNAPSHOT_SECTION_OBJECT, robj->obj->id);
+        snapshot_write_fields(ser, robj, render_obj_fields, N_ELEMENTS(render_obj_fields));
+        object_snapshot(robj->obj, ser);
+        snapshot_end_section(snap);
+    }
+
+    snap->tick = gs->tick;
+    snap->int_tick = gs->int_tick;
+    snap->valid = true;
+}
+
+// Check that everything in the snapshot can be put back, before anything is touched. These are the same cases
+// that object_restore() and har_restore() refuse, so the restore below does not fail halfway.
+static bool game_state_can_restore(game_state *gs, snapshot *snap) {
+    if(!snap->valid || gs->sc == NULL || snapshot_find_section(snap, SNAPSHOT_SECTION_SCENE, gs->sc->id) == NULL) {
+        return false;
+    }
+
+    iterator it;
+    snapshot_section *section;
+    vector_iter_begin(&snap->sections, &it);
+    foreach(it, section) {
+        if(section->kind != SNAPSHOT_SECTION_OBJECT) {
+            continue;
+        }
+        // Read through a copy of the snapshot buffer, so that the read position of the snapshot is left alone
+        serial view = snap->data;
+        render_obj o;
+        object saved;
+        memset(&saved, 0, sizeof(object));
+        view.rpos = section->offset;
+        snapshot_read_fields(&view, &o, render_obj_fields, N_ELEMENTS(render_obj_fields));
+        object_snapshot_read(&saved, &view);
+        object *current = game_state_find_object(gs, section->id);
+        if(current == NULL && (saved.group == GROUP_HAR || saved.cur_animation_own == OWNER_OBJECT)) {
+            // these cannot be built back up from the snapshot alone
+            return false;
+        }
+        if(current != NULL && saved.cur_animation_own == OWNER_OBJECT && saved.cur_animation != current->cur_animation) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Rewinds gs in place to the point where the snapshot was taken. Objects that still exist are written over,
+ * objects destroyed since are recreated and objects created since are freed. Object ids are kept, so anything
+ * that refers to objects by id stays valid. Returns 1 without changing anything if the snapshot cannot be
+ * restored, or if an object failed to restore; in that case the object is dropped and the state is not usable.
+ */
+int game_state_restore(game_state *gs, snapshot *snap) {
+    if(!game_state_can_restore(gs, snap)) {
+        return 1;
+    }
+
+    serial *ser = &snap->data;
+    serial_read_reset(ser);
+
+    snapshot_read_fields(ser, gs, game_state_fields, N_ELEMENTS(game_state_fields));
+
+    uint32_t count;
+    serial_read(ser, (char *)&count, sizeof(count));
+    vector_clear(&gs->sounds);
+    for(uint32_t i = 0; i < count; i++) {
+        serial_read(ser, vector_append_ptr(&gs->sounds), sizeof(playing_sound));
+    }
+
+    for(int i = 0; i < 2; i++) {
+        game_player_restore(gs->players[i], ser);
+    }
+
+    scene_restore(gs->sc, ser);
+
+    // Move the current objects aside, and then rebuild the object list in the order of the snapshot
+    iterator it;
+    render_obj *robj;
+    vector_clear(&snap->scratch);
+    vector_iter_begin(&gs->objects, &it);
+    foreach(it, robj) {
+        vector_append(&snap->scratch, &robj->obj);
+    }
+    vector_clear(&gs->objects);
+
+    snapshot_section *section;
+    bool failed = false;
+    vector_iter_begin(&snap->sections, &it);
+    foreach(it, section) {
+        if(section->kind != SNAPSHOT_SECTION_OBJECT) {
+            continue;
+        }
+        render_obj o;
+        ser->rpos = section->offset;
+        snapshot_read_fields(ser, &o, render_obj_fields, N_ELEMENTS(render_obj_fields));
+        // Objects picked up from the index are dropped from it, so only the leftovers remain there
+        o.obj = idmap_get(&gs->object_index, section->id);
+        if(o.obj != NULL) {
+            idmap_del(&gs->object_index, section->id);
+        }
+        bool fresh = o.obj == NULL;
+        if(fresh) {
+            o.obj = omf_calloc(1, sizeof(object));
+        }
+        if(object_restore(o.obj, ser, gs, fresh)) {
+            // The object is only partly restored, so it cannot be kept. A fresh one has no callbacks yet.
+            log_error("Unable to restore object %" PRIu32 " from snapshot", section->id);
+            if(fresh) {
+                player_free(o.obj);
+            } else {
+                object_free(o.obj);
+            }
+            omf_free(o.obj);
+            failed = true;
+            continue;
+        }
+        vector_append(&gs->objects, &o);
+    }
+
+    // Anything left over was created after the snapshot
+    object **current;
+    vector_iter_begin(&snap->scratch, &it);
+    foreach(it, current) {
+        if(idmap_get(&gs->object_index, (*current)->id) == *current) {
+            object_free(*current);
+            omf_free(*current);
+        }
+    }
+    vector_clear(&snap->scratch);
+
+    idmap_clear(&gs->object_index);
+    vector_iter_begin(&gs->objects, &it);
+    foreach(it, robj) {
+        idmap_put(&gs->object_index, robj->obj->id, robj->obj);
+    }
+    return failed ? 1 : 0;
+}
+
 bool game_state_hars_are_alive(game_state *gs) {
     har *h1 = object_get_userdata(game_state_find_object(gs, game_state_get_player(gs, 0)->har_obj_id));
     har *h2 = object_get_userdata(game_state_find_object(gs, game_state_get_player(gs, 1)->har_obj_id));
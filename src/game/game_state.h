@@ -4,6 +4,7 @@
 #include "formats/rec_assertion.h"
 #include "game/game_state_type.h"
 #include "game/utils/serial.h"
+#include "game/utils/snapshot.h"
 #include "utils/random.h"
 #include "utils/vector.h"
 #include <SDL.h>
@@ -51,6 +52,11 @@ void game_state_play_sound(game_state *gs, int id, float volume, float panning,
 int game_state_clone(game_state *src, game_state *dst);
 void game_state_clone_free(game_state *gs);
 
+void game_state_snapshot(game_state *gs, snapshot *snap);
+int game_state_restore(game_state *gs, snapshot *snap);
+void game_state_copy_sounds(game_state *gs, vector *dst);
+void game_state_merge_rolled_back_sounds(game_state *gs, vector *previous);
+
 void _setup_keyboard(game_state *gs, int player_id, int control_id);
 void _setup_ai(game_state *gs, int player_id);
 int _setup_joystick(game_state *gs, int player_id, const char *joyname, int offset);
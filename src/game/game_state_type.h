@@ -7,6 +7,7 @@
 #include "formats/rec.h"
 #include "game/protos/fight_stats.h"
 #include "game/utils/settings.h"
+#include "utils/idmap.h"
 #include "utils/random.h"
 #include "utils/vector.h"
 
@@ -35,6 +36,28 @@ typedef struct scene_t scene;
 typedef struct game_player_t game_player;
 typedef struct ticktimer_t ticktimer;
 typedef struct controller_t controller;
+typedef struct object_t object;
+
+// an object in the game state object list
+typedef struct {
+    int layer;      ///< Object rendering layer
+    int persistent; ///< 1 if the object should keep alive across scene boundaries
+    int singleton;  ///< 1 if object should be the only representative of its animation ID
+    object *obj;
+} render_obj;
+
+// a sound started by the game, tracked so that it can be reconciled after a rollback
+typedef struct {
+    int tick;
+    int id;
+    int length;
+    int duration;
+    int freq;
+    float volume;
+    float panning;
+    int pitch;
+    int playback_id;
+} playing_sound;
 
 // roughly modeled after the configuration in REC files
 typedef struct {
@@ -93,6 +116,7 @@ typedef struct game_state_t {
     int net_mode; // NET_MODE_NONE, NET_MODE_CLIENT, NET_MODE_SERVER
     scene *sc;
     vector objects;
+    idmap object_index; // object id -> object, for the objects in the list above
     vector sounds;
     game_player *players[2];
 
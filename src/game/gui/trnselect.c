@@ -16,9 +16,10 @@
 // Local small gauge type
 typedef struct trnselect {
     sprite *img;
-    vector tournaments;
+    vector tournaments; // Tournament headers, see trnlist_init
     component *label;
     int selected;
+    sd_tournament_file *loaded; // Fully loaded selected tournament, or NULL if not loaded yet
 } trnselect;
 
 static void trnselect_render(component *c) {
@@ -55,6 +56,17 @@ static void load_description(component **c, const gui_theme *theme, const sd_tou
     component_layout(*c, x, locale->desc_vmove, locale->desc_width, 130 - locale->desc_vmove);
 }
 
+static sd_tournament_file *selected_header(trnselect *local) {
+    return vector_get(&local->tournaments, local->selected);
+}
+
+static void free_loaded(trnselect *local) {
+    if(local->loaded != NULL) {
+        sd_tournament_free(local->loaded);
+        omf_free(local->loaded);
+    }
+}
+
 static void trnselect_free(component *c) {
     trnselect *g = widget_get_obj(c);
     vga_state_pop_palette(); // Recover previous palette
@@ -62,6 +74,7 @@ static void trnselect_free(component *c) {
         sprite_free(g->img);
         omf_free(g->img);
     }
+    free_loaded(g);
     trnlist_free(&g->tournaments);
     if(g->label) {
         component_free(g->label);
@@ -75,7 +88,8 @@ void trnselect_next(component *c) {
     if(local->selected >= (int)vector_size(&local->tournaments)) {
         local->selected = 0;
     }
-    sd_tournament_file *trn = trnselect_selected(c);
+    free_loaded(local);
+    sd_tournament_file *trn = selected_header(local);
     sd_sprite *logo = trn->locales[0]->logo;
     vga_state_set_base_palette_from_range(&trn->pal, 128, 128, 40);
     load_description(&local->label, component_get_theme(c), trn->locales[0]);
@@ -89,7 +103,8 @@ void trnselect_prev(component *c) {
     if(local->selected < 0) {
         local->selected = vector_size(&local->tournaments) - 1;
     }
-    sd_tournament_file *trn = trnselect_selected(c);
+    free_loaded(local);
+    sd_tournament_file *trn = selected_header(local);
     sd_sprite *logo = trn->locales[0]->logo;
     vga_state_set_base_palette_from_range(&trn->pal, 128, 128, 40);
     load_description(&local->label, component_get_theme(c), trn->locales[0]);
@@ -99,7 +114,14 @@ void trnselect_prev(component *c) {
 
 sd_tournament_file *trnselect_selected(component *c) {
     trnselect *local = widget_get_obj(c);
-    return vector_get(&local->tournaments, local->selected);
+    if(local->loaded == NULL) {
+        // The list only has the headers, so load the whole tournament once it is picked.
+        local->loaded = omf_calloc(1, sizeof(sd_tournament_file));
+        if(trn_load(local->loaded, selected_header(local)->filename) != 0) {
+            free_loaded(local);
+        }
+    }
+    return local->loaded;
 }
 
 static void trnselect_init(component *c, const gui_theme *theme) {
@@ -110,7 +132,7 @@ static void trnselect_init(component *c, const gui_theme *theme) {
 
     vga_state_push_palette(); // Backup the current palette
 
-    sd_tournament_file *trn = trnselect_selected(c);
+    sd_tournament_file *trn = selected_header(local);
     sd_sprite *logo = trn->locales[0]->logo;
     vga_state_set_base_palette_from_range(&trn->pal, 128, 128, 40);
     load_description(&local->label, theme, trn->locales[0]);
@@ -127,6 +149,7 @@ component *trnselect_create(void) {
     local->selected = 0;
     local->img = NULL;
     local->label = NULL;
+    local->loaded = NULL;
     widget_set_obj(c, local);
 
     // Set callbacks
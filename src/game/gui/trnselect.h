@@ -8,6 +8,10 @@ component *trnselect_create(void);
 int trnselect_get_pilot_count(component *c, int pic_id);
 void trnselect_next(component *c);
 void trnselect_prev(component *c);
+/**
+ * Get the selected tournament. The menu only holds tournament headers, so this loads the whole tournament file.
+ * @return Selected tournament, owned by the widget and valid until the selection changes, or NULL on load failure.
+ */
 sd_tournament_file *trnselect_selected(component *c);
 
 #endif // TRNSELECT_H
@@ -19,6 +19,7 @@
 #include "resources/animation.h"
 #include "resources/pilots.h"
 #include "utils/allocator.h"
+#include "utils/c_array_util.h"
 #include "utils/log.h"
 #include "utils/miscmath.h"
 #include "utils/random.h"
@@ -430,41 +431,41 @@ bool is_in_range(object *obj, af_move *move) {
 }
 
 int har_is_invincible(object *obj, af_move *move) {
-    if(player_frame_isset(obj, "zz")) {
+    if(player_frame_isset(obj, SD_TAG_ZZ)) {
         // blocks everything
         return 1;
     }
 
     switch(move->category) {
         case CAT_CLOSE:
-            if(player_frame_isset(obj, "zg") || obj->cur_animation->id == ANIM_DAMAGE ||
+            if(player_frame_isset(obj, SD_TAG_ZG) || obj->cur_animation->id == ANIM_DAMAGE ||
                obj->cur_animation->id == ANIM_STANDING_BLOCK || obj->cur_animation->id == ANIM_CROUCHING_BLOCK ||
                obj->cur_animation->id == ANIM_STANDUP) {
                 return 1;
             }
             break;
         case CAT_LOW:
-            if(player_frame_isset(obj, "zl")) {
+            if(player_frame_isset(obj, SD_TAG_ZL)) {
                 return 1;
             }
             break;
         case CAT_MEDIUM:
-            if(player_frame_isset(obj, "zm")) {
+            if(player_frame_isset(obj, SD_TAG_ZM)) {
                 return 1;
             }
             break;
         case CAT_HIGH:
-            if(player_frame_isset(obj, "zh")) {
+            if(player_frame_isset(obj, SD_TAG_ZH)) {
                 return 1;
             }
             break;
         case CAT_JUMPING:
-            if(player_frame_isset(obj, "zj")) {
+            if(player_frame_isset(obj, SD_TAG_ZJ)) {
                 return 1;
             }
             break;
         case CAT_PROJECTILE:
-            if(player_frame_isset(obj, "zp")) {
+            if(player_frame_isset(obj, SD_TAG_ZP)) {
                 return 1;
             }
             break;
@@ -633,7 +634,7 @@ void har_move(object *obj) {
     // Check for wall hits
     if(obj->pos.x <= ARENA_LEFT_WALL || obj->pos.x >= ARENA_RIGHT_WALL) {
         h->is_wallhugging = 1;
-        if(player_frame_isset(obj, "cw") && player_frame_isset(obj, "d")) {
+        if(player_frame_isset(obj, SD_TAG_CW) && player_frame_isset(obj, SD_TAG_D)) {
             log_debug("disabling d tag on animation because of wall hit");
             obj->animation_state.disable_d = 1;
         }
@@ -649,7 +650,7 @@ void har_move(object *obj) {
         obj->pos.y = ARENA_FLOOR;
         clear_rehits(h);
 
-        if(player_frame_isset(obj, "cl")) {
+        if(player_frame_isset(obj, SD_TAG_CL)) {
             af_move *move = af_get_move(h->af_data, obj->cur_animation->id);
             object_set_vel(obj, vec2f_create(0, 0));
             har_set_ani(obj, move->next_move, 0);
@@ -666,7 +667,7 @@ void har_move(object *obj) {
             object_set_stride(obj, h->stride);
             har_event_land(h, ctrl);
             har_floor_landing_effects(obj, true);
-        } else if(h->state == STATE_JUMPING && enemy_har->is_grabbed == 0 && !player_frame_isset(obj, "cg")) {
+        } else if(h->state == STATE_JUMPING && enemy_har->is_grabbed == 0 && !player_frame_isset(obj, SD_TAG_CG)) {
             // Change animation from jump to walk or idle,
             // depending on held inputs
             if(last_input == '6') {
@@ -985,8 +986,8 @@ void har_take_damage(object *obj, const str *string, float damage, float stun) {
         // XXX hack - if the first frame has the 'k' tag, treat it as some vertical knockback
         // we can't do this in player.c because it breaks the jaguar leap, which also uses the 'k' tag.
         // Insanius 3/17/2025 - This is actually mostly correct, the OG checks if the string starts with the 'k' char
-        const sd_script_frame *frame = sd_script_get_frame(&obj->animation_state.parser, 0);
-        if(frame != NULL && sd_script_isset(frame, "k")) {
+        const sd_script_frame *frame = sd_script_get_frame(player_get_script(obj), 0);
+        if(frame != NULL && sd_script_isset_id(frame, SD_TAG_K)) {
             obj->vel.x = -5 * object_get_direction(obj);
             obj->vel.y = -8;
         }
@@ -1204,8 +1205,8 @@ void calc_damage_and_stun(object *obj, af_move *move, int *damage, int *stun) {
     sd_pilot *pilot = gp->pilot;
 
     int multiplier = 100;
-    if(player_frame_isset(obj, "k")) {
-        multiplier = player_frame_get(obj, "k") + 10;
+    if(player_frame_isset(obj, SD_TAG_K)) {
+        multiplier = player_frame_get(obj, SD_TAG_K) + 10;
         // log_debug("Set multiplier %d", multiplier);
     }
 
@@ -1279,7 +1280,7 @@ int har_collide_with_har(object *obj_a, object *obj_b, int loop) {
 
     // if UH is set, bypass many of the collision bypass checks
     // TODO check these are the right ones
-    if(!player_frame_isset(obj_b, "uh")) {
+    if(!player_frame_isset(obj_b, SD_TAG_UH)) {
         if(b->state == STATE_WALLDAMAGE || b->state >= STATE_VICTORY || b->state == STATE_STANDING_UP) {
             // can't hit em while they're down
             return 0;
@@ -1315,17 +1316,17 @@ int har_collide_with_har(object *obj_a, object *obj_b, int loop) {
     }
     if(a->damage_done == 0 &&
        (intersect_har_sprite_hitpoint(obj_a, obj_b, level, &hit_coord) || move->category == CAT_CLOSE ||
-        (player_frame_isset(obj_a, "ue") && !object_is_airborne(obj_b)))) {
+        (player_frame_isset(obj_a, SD_TAG_UE) && !object_is_airborne(obj_b)))) {
 
         obj_a->q_counter = obj_a->q_val;
         obj_a->should_hitpause = true;
 
-        if(har_is_blocking(obj_b, move) && !player_frame_isset(obj_a, "bn")) {
+        if(har_is_blocking(obj_b, move) && !player_frame_isset(obj_a, SD_TAG_BN)) {
             a->damage_done = 1;
             har_event_enemy_block(a, move, false, ctrl_a);
             har_event_block(b, move, false, ctrl_b);
             har_block(obj_b, hit_coord, move->block_stun);
-            if(player_frame_isset(obj_a, "i") && move->next_move) {
+            if(player_frame_isset(obj_a, SD_TAG_I) && move->next_move) {
                 har_set_ani(obj_a, move->next_move, 0);
             }
             if(b->is_wallhugging) {
@@ -1418,7 +1419,7 @@ int har_collide_with_har(object *obj_a, object *obj_b, int loop) {
         // face B to the direction they're being attacked from
         object_set_direction(obj_b, -object_get_direction(obj_a));
 
-        if(player_frame_isset(obj_a, "ai")) {
+        if(player_frame_isset(obj_a, SD_TAG_AI)) {
             str str;
             str_from_c(&str, "A1-s01l50B2-C2-L5-M400");
             har_take_damage(obj_b, &str, damage, stun);
@@ -1524,7 +1525,7 @@ void har_collide_with_projectile(object *o_har, object *o_pjt) {
 
         controller *ctrl = game_player_get_ctrl(game_state_get_player(o_har->gs, h->player_id));
         controller *ctrl_other = game_player_get_ctrl(game_state_get_player(o_pjt->gs, other->player_id));
-        if(har_is_blocking(o_har, move) && !player_frame_isset(o_pjt, "bn")) {
+        if(har_is_blocking(o_har, move) && !player_frame_isset(o_pjt, SD_TAG_BN)) {
             projectile_mark_hit(o_pjt); // prevent this projectile from hitting again
             o_pjt->animation_state.finished = 1;
             if(move->successor_id && move->category != CAT_CLOSE) {
@@ -1560,7 +1561,7 @@ void har_collide_with_projectile(object *o_har, object *o_pjt) {
 
         // check the animation is still going
         // for some reason this has been observed to happen sometimes, an example is frame 18 of chronos' stasis
-        if(!sd_script_get_frame_at(&o_pjt->animation_state.parser, o_pjt->animation_state.current_tick)) {
+        if(!sd_script_get_frame_at(player_get_script(o_pjt), o_pjt->animation_state.current_tick)) {
             log_debug("no such frame at tick %d", o_pjt->animation_state.current_tick);
             return;
         }
@@ -1576,7 +1577,7 @@ void har_collide_with_projectile(object *o_har, object *o_pjt) {
         }
 
         // Exception case for chronos' time freeze
-        if(player_frame_isset(o_pjt, "af")) {
+        if(player_frame_isset(o_pjt, SD_TAG_AF)) {
             // statis ticks is the raw damage from the move
             h->in_stasis_ticks = move->raw_damage;
         } else if(move->damage > 0) {
@@ -1594,7 +1595,7 @@ void har_collide_with_projectile(object *o_har, object *o_pjt) {
             int stun = 0;
             calc_damage_and_stun(o_pjt, move, &damage, &stun);
             damage = air_hit ? damage * 0.6 : damage;
-            if(player_frame_isset(o_pjt, "ai")) {
+            if(player_frame_isset(o_pjt, SD_TAG_AI)) {
                 str str;
                 str_from_c(&str, "A1-s01l50B2-C2-L5-M400");
                 har_take_damage(o_har, &str, damage, stun);
@@ -1873,7 +1874,7 @@ void har_tick(object *obj) {
 
     // See if we are being grabbed. We detect this by checking the
     // "e" tag -- force to enemy position.
-    // player_frame_isset(obj, "e");
+    // player_frame_isset(obj, SD_TAG_E);
     h->is_grabbed = h->throw_duration > 0;
 
     if(h->throw_duration > 0) {
@@ -1902,7 +1903,7 @@ void har_tick(object *obj) {
         }
     }
 
-    if(player_frame_isset(obj, "aa")) {
+    if(player_frame_isset(obj, SD_TAG_AA)) {
         h->air_attacked = 0; // This tag allows you to attack again
     }
 
@@ -1912,9 +1913,9 @@ void har_tick(object *obj) {
     // Make sure HAR doesn't walk through walls
     // TODO: Roof!
     vec2i pos = object_get_pos(obj);
-    int ab_flag = player_frame_isset(obj, "ab");
-    if((h->state != STATE_DEFEAT && !ab_flag) || player_frame_isset(enemy_obj, "cw")) {
-        int wall_flag = player_frame_isset(obj, "aw");
+    int ab_flag = player_frame_isset(obj, SD_TAG_AB);
+    if((h->state != STATE_DEFEAT && !ab_flag) || player_frame_isset(enemy_obj, SD_TAG_CW)) {
+        int wall_flag = player_frame_isset(obj, SD_TAG_AW);
         int wall = 0;
         if(pos.x < ARENA_LEFT_WALL) {
             pos.x = ARENA_LEFT_WALL;
@@ -1940,15 +1941,16 @@ void har_tick(object *obj) {
     }
 
     // Check for HAR specific palette tricks
-    if(player_frame_isset(obj, "ptr") || player_frame_isset(obj, "ptd") || player_frame_isset(obj, "ptp")) {
-        h->p_pal_ref = player_frame_get(obj, "pd");
-        h->p_har_switch = player_frame_isset(obj, "pe");
-        h->p_fade_out_ticks = h->p_fade_out_ticks_left = player_frame_get(obj, "ptr");
-        h->p_fade_in_ticks = h->p_fade_in_ticks_left = player_frame_get(obj, "ptd");
-        h->p_sustain_ticks_left = player_frame_get(obj, "ptp");
-        // h->p_max_intensity = player_frame_get(obj, "pp");
-        // h->p_base_intensity = player_frame_get(obj, "pb");
-        h->p_color_fn = player_frame_isset(obj, "pa");
+    if(player_frame_isset(obj, SD_TAG_PTR) || player_frame_isset(obj, SD_TAG_PTD) ||
+       player_frame_isset(obj, SD_TAG_PTP)) {
+        h->p_pal_ref = player_frame_get(obj, SD_TAG_PD);
+        h->p_har_switch = player_frame_isset(obj, SD_TAG_PE);
+        h->p_fade_out_ticks = h->p_fade_out_ticks_left = player_frame_get(obj, SD_TAG_PTR);
+        h->p_fade_in_ticks = h->p_fade_in_ticks_left = player_frame_get(obj, SD_TAG_PTD);
+        h->p_sustain_ticks_left = player_frame_get(obj, SD_TAG_PTP);
+        // h->p_max_intensity = player_frame_get(obj, SD_TAG_PP);
+        // h->p_base_intensity = player_frame_get(obj, SD_TAG_PB);
+        h->p_color_fn = player_frame_isset(obj, SD_TAG_PA);
     }
 
     // Object took walldamage, but has now landed
@@ -2088,19 +2090,19 @@ bool is_move_chain_allowed(object *obj, af_move *move) {
 
     // check if the current frame allows chaining
     bool allowed = false;
-    if(player_frame_isset(obj, "jn") && move->id == player_frame_get(obj, "jn")) {
+    if(player_frame_isset(obj, SD_TAG_JN) && move->id == player_frame_get(obj, SD_TAG_JN)) {
         allowed = true;
     } else {
         switch(move->category) {
             case CAT_JUMPING:
                 // JZ should be checked in a bunch of other places but since it's only used for one move we'll cheat.
-                if(player_frame_isset(obj, "jz") || player_frame_isset(obj, "jj") ||
+                if(player_frame_isset(obj, SD_TAG_JZ) || player_frame_isset(obj, SD_TAG_JJ) ||
                    (is_har_idle_air(obj) && allowed_in_idle && !h->air_attacked)) {
                     allowed = true;
                 }
                 break;
             case CAT_CLOSE:
-                if(player_frame_isset(obj, "jg") || (is_har_idle_grounded(obj) && allowed_in_idle)) {
+                if(player_frame_isset(obj, SD_TAG_JG) || (is_har_idle_grounded(obj) && allowed_in_idle)) {
                     object *enemy_obj = game_state_find_object(
                         obj->gs, game_player_get_har_obj_id(game_state_get_player(obj->gs, !h->player_id)));
                     if(enemy_obj->pos.y == ARENA_FLOOR && !har_is_invincible(enemy_obj, move) &&
@@ -2110,27 +2112,27 @@ bool is_move_chain_allowed(object *obj, af_move *move) {
                 }
                 break;
             case CAT_LOW:
-                if(player_frame_isset(obj, "jl") || (is_har_idle_grounded(obj) && allowed_in_idle)) {
+                if(player_frame_isset(obj, SD_TAG_JL) || (is_har_idle_grounded(obj) && allowed_in_idle)) {
                     allowed = true;
                 }
                 break;
             case CAT_MEDIUM:
-                if(player_frame_isset(obj, "jm") || (is_har_idle_grounded(obj) && allowed_in_idle)) {
+                if(player_frame_isset(obj, SD_TAG_JM) || (is_har_idle_grounded(obj) && allowed_in_idle)) {
                     allowed = true;
                 }
                 break;
             case CAT_HIGH:
-                if(player_frame_isset(obj, "jh") || (is_har_idle_grounded(obj) && allowed_in_idle)) {
+                if(player_frame_isset(obj, SD_TAG_JH) || (is_har_idle_grounded(obj) && allowed_in_idle)) {
                     allowed = true;
                 }
                 break;
             case CAT_SCRAP:
-                if(player_frame_isset(obj, "jf") && h->state != STATE_DONE && allowed_in_idle) {
+                if(player_frame_isset(obj, SD_TAG_JF) && h->state != STATE_DONE && allowed_in_idle) {
                     allowed = true;
                 }
                 break;
             case CAT_DESTRUCTION:
-                if(player_frame_isset(obj, "jf2") && allowed_in_idle) {
+                if(player_frame_isset(obj, SD_TAG_JF2) && allowed_in_idle) {
                     allowed = true;
                 }
                 break;
@@ -2177,13 +2179,14 @@ af_move *scrap_destruction_cheat(object *obj, char input) {
         af_move *move;
         if((move = af_get_move(h->af_data, i))) {
             if(move->category == CAT_SCRAP && h->state == STATE_VICTORY && input == 'K' &&
-               (player_frame_isset(obj, "jf") || (player_frame_isset(obj, "jn") && i == player_frame_get(obj, "jn")))) {
+               (player_frame_isset(obj, SD_TAG_JF) ||
+                (player_frame_isset(obj, SD_TAG_JN) && i == player_frame_get(obj, SD_TAG_JN)))) {
                 return move;
             }
 
             if(move->category == CAT_DESTRUCTION && h->state == STATE_SCRAP && input == 'P' &&
-               (player_frame_isset(obj, "jf2") ||
-                (player_frame_isset(obj, "jn") && i == player_frame_get(obj, "jn")))) {
+               (player_frame_isset(obj, SD_TAG_JF2) ||
+                (player_frame_isset(obj, SD_TAG_JN) && i == player_frame_get(obj, SD_TAG_JN)))) {
                 return move;
             }
         }
@@ -2293,8 +2296,9 @@ int har_act(object *obj, int act_type) {
     }
     af_move *move = match_move(obj, prefix, truncated_inputs);
 
-    if(player_frame_isset(obj, "jn") && player_frame_isset(obj, "cw") && (enemy_har->state == STATE_WALLDAMAGE)) {
-        move = af_get_move(h->af_data, player_frame_get(obj, "jn"));
+    if(player_frame_isset(obj, SD_TAG_JN) && player_frame_isset(obj, SD_TAG_CW) &&
+       (enemy_har->state == STATE_WALLDAMAGE)) {
+        move = af_get_move(h->af_data, player_frame_get(obj, SD_TAG_JN));
     }
 
     if(game_state_get_player(obj->gs, h->player_id)->ez_destruct && move == NULL &&
@@ -2503,7 +2507,7 @@ void har_finished(object *obj) {
         object_dynamic_tick(obj);
         h->block_duration--;
         // If UR is set, force other HAR to stay in blockstun if they're in it
-        if(player_frame_isset(enemy_obj, "ur")) {
+        if(player_frame_isset(enemy_obj, SD_TAG_UR)) {
             h->block_duration = 1;
         }
     } else if(h->state == STATE_SCRAP || h->state == STATE_DESTRUCTION) {
@@ -2630,9 +2634,121 @@ int har_clone_free(object *obj) {
     return 0;
 }
 
+// Hooks and caches belong to the scene, and frame stretching is never rolled back
+static const snapshot_field har_fields[] = {
+    SNAPSHOT_FIELD(har, id),
+    SNAPSHOT_FIELD(har, player_id),
+    SNAPSHOT_FIELD(har, pilot_id),
+    SNAPSHOT_FIELD(har, state),
+    SNAPSHOT_FIELD(har, executing_move),
+    SNAPSHOT_FIELD(har, close),
+    SNAPSHOT_FIELD(har, af_data),
+    SNAPSHOT_FIELD(har, damage_done),
+    SNAPSHOT_FIELD(har, damage_received),
+    SNAPSHOT_FIELD(har, air_attacked),
+    SNAPSHOT_FIELD(har, is_wallhugging),
+    SNAPSHOT_FIELD(har, is_grabbed),
+    SNAPSHOT_FIELD(har, last_damage_value),
+    SNAPSHOT_FIELD(har, last_stun_value),
+    SNAPSHOT_FIELD(har, jump_speed),
+    SNAPSHOT_FIELD(har, superjump_speed),
+    SNAPSHOT_FIELD(har, fall_speed),
+    SNAPSHOT_FIELD(har, fwd_speed),
+    SNAPSHOT_FIELD(har, back_speed),
+    SNAPSHOT_FIELD(har, in_stasis_ticks),
+    SNAPSHOT_FIELD(har, throw_duration),
+    SNAPSHOT_FIELD(har, block_duration),
+    SNAPSHOT_FIELD(har, height),
+    SNAPSHOT_FIELD(har, stride),
+    SNAPSHOT_FIELD(har, stun_factor),
+    SNAPSHOT_FIELD(har, health_max),
+    SNAPSHOT_FIELD(har, health),
+    SNAPSHOT_FIELD(har, endurance_max),
+    SNAPSHOT_FIELD(har, endurance),
+    SNAPSHOT_FIELD(har, inputs),
+    SNAPSHOT_FIELD(har, input_change_tick),
+    SNAPSHOT_FIELD(har, stun_timer),
+    SNAPSHOT_FIELD(har, p_pal_ref),
+    SNAPSHOT_FIELD(har, p_har_switch),
+    SNAPSHOT_FIELD(har, p_fade_out_ticks),
+    SNAPSHOT_FIELD(har, p_fade_out_ticks_left),
+    SNAPSHOT_FIELD(har, p_fade_in_ticks),
+    SNAPSHOT_FIELD(har, p_fade_in_ticks_left),
+    SNAPSHOT_FIELD(har, p_sustain_ticks_left),
+    SNAPSHOT_FIELD(har, p_color_fn),
+    SNAPSHOT_FIELD(har, walk_destination),
+    SNAPSHOT_FIELD(har, walk_done_anim),
+    SNAPSHOT_FIELD(har, walk_done_tick),
+    SNAPSHOT_FIELD(har, custom_defeat_animation),
+    SNAPSHOT_FIELD(har, rehits),
+    SNAPSHOT_FIELD(har, rehit_combo),
+};
+
+void har_snapshot(const object *obj, serial *ser) {
+    const har *local = object_get_userdata(obj);
+    snapshot_write_fields(ser, local, har_fields, N_ELEMENTS(har_fields));
+
+    uint32_t count = hashmap_reserved(&local->disabled_animations);
+    serial_write(ser, (const char *)&count, sizeof(count));
+    iterator it;
+    hashmap_pair *pair = NULL;
+    hashmap_iter_begin(&local->disabled_animations, &it);
+    foreach(it, pair) {
+        serial_write(ser, pair->key, sizeof(unsigned int));
+        serial_write(ser, pair->value, sizeof(uint16_t));
+    }
+}
+
+static bool har_disabled_animations_match(har *local, serial *ser, uint32_t count) {
+    if(count != hashmap_reserved(&local->disabled_animations)) {
+        return false;
+    }
+    for(uint32_t i = 0; i < count; i++) {
+        unsigned int key;
+        uint16_t ticks;
+        uint16_t *current;
+        unsigned int len;
+        serial_read(ser, (char *)&key, sizeof(key));
+        serial_read(ser, (char *)&ticks, sizeof(ticks));
+        if(hashmap_get_int(&local->disabled_animations, key, (void **)&current, &len) != 0 || *current != ticks) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int har_restore(object *obj, serial *ser, bool fresh) {
+    if(fresh) {
+        // HARs live for the whole fight, and their hooks belong to the scene
+        return 1;
+    }
+    har *local = object_get_userdata(obj);
+    snapshot_read_fields(ser, local, har_fields, N_ELEMENTS(har_fields));
+    // same as har_clone(), replays always start without frame stretching
+    local->delay = 0;
+
+    uint32_t count;
+    serial_read(ser, (char *)&count, sizeof(count));
+    size_t start = ser->rpos;
+    if(!har_disabled_animations_match(local, ser, count)) {
+        ser->rpos = start;
+        hashmap_clear(&local->disabled_animations);
+        for(uint32_t i = 0; i < count; i++) {
+            unsigned int key;
+            uint16_t ticks;
+            serial_read(ser, (char *)&key, sizeof(key));
+            serial_read(ser, (char *)&ticks, sizeof(ticks));
+            hashmap_put_int(&local->disabled_animations, key, &ticks, sizeof(ticks));
+        }
+    }
+    return 0;
+}
+
 void har_bootstrap(object *obj) {
     obj->clone = har_clone;
     obj->clone_free = har_clone_free;
+    obj->snapshot = har_snapshot;
+    obj->restore = har_restore;
 }
 
 int har_create(object *obj, af *af_data, int dir, int har_id, int pilot_id, int player_id) {
@@ -2831,7 +2947,7 @@ int har_create(object *obj, af *af_data, int dir, int har_id, int pilot_id, int
                 if(str && str_size(str) != 0 && !str_equal_c(str, "!")) {
                     // its not the empty string and its not the string '!'
                     // so we should use it
-                    str_set(&move->ani.animation_string, str);
+                    animation_set_string(&move->ani, str_c(str));
                     if(pilot->enhancements[har_id] > 0) {
                         log_debug("using enhancement %d string '%s' for animation %d on har %d",
                                   pilot->enhancements[har_id], str_c(str), i, har_id);
@@ -2850,18 +2966,18 @@ int har_create(object *obj, af *af_data, int dir, int har_id, int pilot_id, int
                         // arm speed
                         if(move->ani.extra_string_count > 0) {
                             // sometimes there's not enough extra strings, so take the last available
-                            str_set(&move->ani.animation_string,
-                                    vector_get(&move->ani.extra_strings,
-                                               min2(pilot->arm_speed, move->ani.extra_string_count - 1)));
+                            str *speed_str = vector_get(&move->ani.extra_strings,
+                                                        min2(pilot->arm_speed, move->ani.extra_string_count - 1));
+                            animation_set_string(&move->ani, str_c(speed_str));
                         }
                         break;
                     case 2:
                         // leg speed
                         if(move->ani.extra_string_count > 0) {
                             // sometimes there's not enough extra strings, so take the last available
-                            str_set(&move->ani.animation_string,
-                                    vector_get(&move->ani.extra_strings,
-                                               min2(pilot->leg_speed, move->ani.extra_string_count - 1)));
+                            str *speed_str = vector_get(&move->ani.extra_strings,
+                                                        min2(pilot->leg_speed, move->ani.extra_string_count - 1));
+                            animation_set_string(&move->ani, str_c(speed_str));
                         }
                         break;
                     case 3:
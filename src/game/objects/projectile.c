@@ -3,6 +3,7 @@
 #include "game/game_state.h"
 #include "game/objects/arena_constraints.h"
 #include "utils/allocator.h"
+#include "utils/c_array_util.h"
 #include "utils/log.h"
 #include "video/video.h"
 #include <stdlib.h>
@@ -83,7 +84,7 @@ void projectile_move(object *obj) {
         }
         // if not invincible, not ignoring bounds checking and actually has an X velocity (the latter two help with
         // shadow grab)
-    } else if(!local->invincible && !player_frame_isset(obj, "bh") && !IS_ZERO(obj->vel.x)) {
+    } else if(!local->invincible && !player_frame_isset(obj, SD_TAG_BH) && !IS_ZERO(obj->vel.x)) {
         if(obj->pos.x < ARENA_LEFT_WALL) {
             obj->pos.x = ARENA_LEFT_WALL;
             obj->animation_state.finished = 1;
@@ -142,6 +143,31 @@ int projectile_clone_free(object *obj) {
     return 0;
 }
 
+static const snapshot_field projectile_fields[] = {
+    SNAPSHOT_FIELD(projectile_local, player_id),
+    SNAPSHOT_FIELD(projectile_local, af_data),
+    SNAPSHOT_FIELD(projectile_local, wall_bounce),
+    SNAPSHOT_FIELD(projectile_local, ground_freeze),
+    SNAPSHOT_FIELD(projectile_local, invincible),
+    SNAPSHOT_FIELD(projectile_local, has_hit),
+    SNAPSHOT_FIELD(projectile_local, parent_id),
+};
+
+void projectile_snapshot(const object *obj, serial *ser) {
+    snapshot_write_fields(ser, object_get_userdata(obj), projectile_fields, N_ELEMENTS(projectile_fields));
+}
+
+int projectile_restore(object *obj, serial *ser, bool fresh) {
+    if(fresh) {
+        object_set_userdata(obj, omf_calloc(1, sizeof(projectile_local)));
+#ifdef DEBUGMODE
+        debug_surfaces_create(obj);
+#endif
+    }
+    snapshot_read_fields(ser, object_get_userdata(obj), projectile_fields, N_ELEMENTS(projectile_fields));
+    return 0;
+}
+
 #ifdef DEBUGMODE
 void projectile_debug(object *obj) {
     projectile_local *h = object_get_userdata(obj);
@@ -233,6 +259,8 @@ int projectile_create(object *obj, object *parent) {
 
     obj->clone = projectile_clone;
     obj->clone_free = projectile_clone_free;
+    obj->snapshot = projectile_snapshot;
+    obj->restore = projectile_restore;
     return 0;
 }
 
@@ -4,6 +4,7 @@
 #include "game/objects/arena_constraints.h"
 #include "resources/af_move.h"
 #include "utils/allocator.h"
+#include "utils/c_array_util.h"
 #include "utils/c_string_util.h"
 #include "utils/log.h"
 #include "utils/miscmath.h"
@@ -84,6 +85,8 @@ void object_create(object *obj, game_state *gs, vec2i pos, vec2f vel) {
     obj->debug = NULL;
     obj->clone = NULL;
     obj->clone_free = NULL;
+    obj->snapshot = NULL;
+    obj->restore = NULL;
 }
 
 int object_clone(object *src, object *dst, game_state *gs) {
@@ -103,6 +106,136 @@ int object_clone(object *src, object *dst, game_state *gs) {
     return 0;
 }
 
+// The custom animation script and the userdata are owned by the object, they are saved separately
+static const snapshot_field object_fields[] = {
+    SNAPSHOT_FIELD(object, id),
+    SNAPSHOT_FIELD(object, start),
+    SNAPSHOT_FIELD(object, pos),
+    SNAPSHOT_FIELD(object, vel),
+    SNAPSHOT_FIELD(object, cvel),
+    SNAPSHOT_FIELD(object, vertical_velocity_modifier),
+    SNAPSHOT_FIELD(object, horizontal_velocity_modifier),
+    SNAPSHOT_FIELD(object, direction),
+    SNAPSHOT_FIELD(object, group),
+    SNAPSHOT_FIELD(object, wall_collision),
+    SNAPSHOT_FIELD(object, hit_pixels_disabled),
+    SNAPSHOT_FIELD(object, crossup_protection),
+    SNAPSHOT_FIELD(object, should_hitpause),
+    SNAPSHOT_FIELD(object, q_counter),
+    SNAPSHOT_FIELD(object, q_val),
+    SNAPSHOT_FIELD(object, can_hit),
+    SNAPSHOT_FIELD(object, orb_val),
+    SNAPSHOT_FIELD(object, x_percent),
+    SNAPSHOT_FIELD(object, y_percent),
+    SNAPSHOT_FIELD(object, gravity),
+    SNAPSHOT_FIELD(object, frame_video_effects),
+    SNAPSHOT_FIELD(object, animation_video_effects),
+    SNAPSHOT_FIELD(object, object_flags),
+    SNAPSHOT_FIELD(object, layers),
+    SNAPSHOT_FIELD(object, cur_animation_own),
+    SNAPSHOT_FIELD(object, cur_animation),
+    SNAPSHOT_FIELD(object, cur_sprite_id),
+    SNAPSHOT_FIELD(object, sound_translation_table),
+    SNAPSHOT_FIELD(object, sprite_override),
+    SNAPSHOT_FIELD(object, attached_to_id),
+    SNAPSHOT_FIELD(object, pal_offset),
+    SNAPSHOT_FIELD(object, pal_limit),
+    SNAPSHOT_FIELD(object, halt),
+    SNAPSHOT_FIELD(object, halt_ticks),
+    SNAPSHOT_FIELD(object, stride),
+    SNAPSHOT_FIELD(object, cast_shadow),
+    SNAPSHOT_FIELD(object, o_shadow_correction),
+    SNAPSHOT_FIELD(object, cur_surface),
+    SNAPSHOT_FIELD(object, sprite_state.flipmode),
+    SNAPSHOT_FIELD(object, sprite_state.timer),
+    SNAPSHOT_FIELD(object, sprite_state.duration),
+    SNAPSHOT_FIELD(object, sprite_state.screen_shake_horizontal),
+    SNAPSHOT_FIELD(object, sprite_state.screen_shake_vertical),
+    SNAPSHOT_FIELD(object, sprite_state.o_correction),
+    SNAPSHOT_FIELD(object, sprite_state.disable_gravity),
+    SNAPSHOT_FIELD(object, sprite_state.blend_start),
+    SNAPSHOT_FIELD(object, sprite_state.blend_finish),
+    SNAPSHOT_FIELD(object, sprite_state.pal_ref_index),
+    SNAPSHOT_FIELD(object, sprite_state.pal_entry_count),
+    SNAPSHOT_FIELD(object, sprite_state.pal_start_index),
+    SNAPSHOT_FIELD(object, sprite_state.pal_begin),
+    SNAPSHOT_FIELD(object, sprite_state.pal_end),
+    SNAPSHOT_FIELD(object, sprite_state.pal_tint),
+    SNAPSHOT_FIELD(object, sprite_state.pal_tricks_off),
+    SNAPSHOT_FIELD(object, sprite_state.bd_flag),
+    SNAPSHOT_FIELD(object, animation_state.previous_tick),
+    SNAPSHOT_FIELD(object, animation_state.current_tick),
+    SNAPSHOT_FIELD(object, animation_state.previous),
+    SNAPSHOT_FIELD(object, animation_state.entered_frame),
+    SNAPSHOT_FIELD(object, animation_state.repeat),
+    SNAPSHOT_FIELD(object, animation_state.reverse),
+    SNAPSHOT_FIELD(object, animation_state.finished),
+    SNAPSHOT_FIELD(object, animation_state.disable_d),
+    SNAPSHOT_FIELD(object, animation_state.shadow_corner_hack),
+    SNAPSHOT_FIELD(object, animation_state.looping),
+    SNAPSHOT_FIELD(object, animation_state.pal_copy_entries),
+    SNAPSHOT_FIELD(object, animation_state.pal_copy_start),
+    SNAPSHOT_FIELD(object, animation_state.pal_copy_count),
+    SNAPSHOT_FIELD(object, animation_state.spawn_userdata),
+    SNAPSHOT_FIELD(object, animation_state.destroy_userdata),
+    SNAPSHOT_FIELD(object, animation_state.disable_userdata),
+    SNAPSHOT_FIELD(object, animation_state.enemy_obj_id),
+    SNAPSHOT_FIELD(object, animation_state.spawn),
+    SNAPSHOT_FIELD(object, animation_state.destroy),
+    SNAPSHOT_FIELD(object, animation_state.disable),
+    SNAPSHOT_FIELD(object, slide_state.vel),
+    SNAPSHOT_FIELD(object, slide_state.timer),
+    SNAPSHOT_FIELD(object, age),
+    SNAPSHOT_FIELD(object, free),
+    SNAPSHOT_FIELD(object, act),
+    SNAPSHOT_FIELD(object, static_tick),
+    SNAPSHOT_FIELD(object, dynamic_tick),
+    SNAPSHOT_FIELD(object, collide),
+    SNAPSHOT_FIELD(object, finish),
+    SNAPSHOT_FIELD(object, move),
+    SNAPSHOT_FIELD(object, palette_transform),
+    SNAPSHOT_FIELD(object, debug),
+    SNAPSHOT_FIELD(object, clone),
+    SNAPSHOT_FIELD(object, clone_free),
+    SNAPSHOT_FIELD(object, snapshot),
+    SNAPSHOT_FIELD(object, restore),
+};
+
+void object_snapshot(const object *obj, serial *ser) {
+    snapshot_write_fields(ser, obj, object_fields, N_ELEMENTS(object_fields));
+    player_snapshot(obj, ser);
+    if(obj->snapshot != NULL) {
+        obj->snapshot(obj, ser);
+    }
+}
+
+void object_snapshot_read(object *obj, serial *ser) {
+    snapshot_read_fields(ser, obj, object_fields, N_ELEMENTS(object_fields));
+}
+
+/** Restores an object from a snapshot written by object_snapshot().
+ * \param obj Object to restore. If fresh is set, this is a zeroed object that will be built from the snapshot.
+ * \param fresh Whether the object was destroyed after the snapshot was taken and needs to be recreated.
+ * \return 0 on success, 1 if the object cannot be restored in this way.
+ */
+int object_restore(object *obj, serial *ser, game_state *gs, bool fresh) {
+    // The resources this object owns are not in the snapshot, so they are kept as they are
+    object saved;
+    memcpy(&saved, obj, sizeof(object));
+    object_snapshot_read(&saved, ser);
+    if(saved.cur_animation_own == OWNER_OBJECT && (fresh || saved.cur_animation != obj->cur_animation)) {
+        // Object owned animations are never swapped during a fight, so there is nothing to restore them from.
+        return 1;
+    }
+    memcpy(obj, &saved, sizeof(object));
+    obj->gs = gs;
+    player_restore(obj, ser, fresh);
+    if(obj->restore != NULL) {
+        return obj->restore(obj, ser, fresh);
+    }
+    return 0;
+}
+
 // FIXME: This was removed in HEAD, not sure why or what is the replacement
 // TODO: GET RID
 void object_create_static(object *obj, game_state *gs) {
@@ -296,8 +429,8 @@ void object_del_frame_effects(object *obj, uint32_t effects) {
 }
 
 void object_apply_controllable_velocity(object *obj, bool is_projectile, char input) {
-    if(player_frame_isset(obj, "cx")) {
-        float cx = player_frame_get(obj, "cx") / 10.0;
+    if(player_frame_isset(obj, SD_TAG_CX)) {
+        float cx = player_frame_get(obj, SD_TAG_CX) / 10.0;
         if(!is_projectile) {
             cx *= obj->horizontal_velocity_modifier;
         }
@@ -311,8 +444,8 @@ void object_apply_controllable_velocity(object *obj, bool is_projectile, char in
             obj->cvel.x -= cx * 0.7 * object_get_direction(obj);
         }
         // CY needs CX to be set, and only works for projectiles
-        if(player_frame_isset(obj, "cy") && is_projectile) {
-            float cy = player_frame_get(obj, "cy") / 10.0;
+        if(player_frame_isset(obj, SD_TAG_CY) && is_projectile) {
+            float cy = player_frame_get(obj, SD_TAG_CY) / 10.0;
             if(input == '8') {
                 obj->cvel.y -= cy;
             } else if(input == '2') {
@@ -808,7 +941,7 @@ void object_set_disable_cb(object *obj, object_state_disable_cb cbf, void *userd
 }
 
 int object_is_airborne(const object *obj) {
-    return obj->pos.y < ARENA_FLOOR || obj->vel.y < 0 || player_frame_isset(obj, "ug");
+    return obj->pos.y < ARENA_FLOOR || obj->vel.y < 0 || player_frame_isset(obj, SD_TAG_UG);
 }
 
 /* Attaches one object to another. Positions are synced to this from the attached. */
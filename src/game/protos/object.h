@@ -79,6 +79,8 @@ typedef void (*object_finish_cb)(object *obj);
 typedef void (*object_debug_cb)(object *obj);
 typedef int (*object_clone_cb)(object *src, object *dst);
 typedef int (*object_clone_free_cb)(object *obj);
+typedef void (*object_snapshot_cb)(const object *obj, serial *ser);
+typedef int (*object_restore_cb)(object *obj, serial *ser, bool fresh);
 
 struct object_t {
     uint32_t id;
@@ -156,6 +158,8 @@ struct object_t {
     object_debug_cb debug;
     object_clone_cb clone;
     object_clone_free_cb clone_free;
+    object_snapshot_cb snapshot;
+    object_restore_cb restore;
 };
 
 void object_create(object *obj, game_state *gs, vec2i pos, vec2f vel);
@@ -176,6 +180,9 @@ void object_free(object *obj);
 
 int object_clone(object *src, object *dst, game_state *gs);
 int object_clone_free(object *obj);
+void object_snapshot(const object *obj, serial *ser);
+void object_snapshot_read(object *obj, serial *ser);
+int object_restore(object *obj, serial *ser, game_state *gs, bool fresh);
 
 void object_attach_to(object *obj, const object *attach_to);
 
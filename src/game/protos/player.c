@@ -11,6 +11,7 @@
 #include "game/protos/player.h"
 #include "game/utils/settings.h"
 #include "resources/ids.h"
+#include "utils/c_array_util.h"
 #include "utils/log.h"
 #include "utils/miscmath.h"
 #include "utils/random.h"
@@ -28,33 +29,169 @@ static void player_clear_frame(object *obj) {
     s->blend_finish = 0xFF;
 }
 
+// Played when the object has no animation yet
+static const sd_script empty_script = {
+    .frames = {.block_size = sizeof(sd_script_frame)},
+};
+
 void player_create(object *obj) {
     memset(&obj->animation_state, 0, sizeof(player_animation_state));
     obj->animation_state.previous_tick = ~0u;
-    sd_script_create(&obj->animation_state.parser);
     player_clear_frame(obj);
 }
 
 void player_clone(object *src, object *dst) {
-    sd_script_clone(&src->animation_state.parser, &dst->animation_state.parser);
+    if(src->animation_state.has_custom) {
+        sd_script_clone(&src->animation_state.custom, &dst->animation_state.custom);
+    }
 }
 
-void player_free(object *obj) {
-    sd_script_free(&obj->animation_state.parser);
+const sd_script *player_get_script(const object *obj) {
+    if(obj->animation_state.has_custom) {
+        return &obj->animation_state.custom;
+    }
+    if(obj->cur_animation != NULL) {
+        return &obj->cur_animation->script;
+    }
+    return &empty_script;
 }
 
-void player_reload_with_str(object *obj, const char *custom_str) {
-    // Free and reload parser
-    sd_script_free(&obj->animation_state.parser);
-    sd_script_create(&obj->animation_state.parser);
-    int ret;
-    int err_pos;
-    ret = sd_script_decode(&obj->animation_state.parser, custom_str, &err_pos);
-    if(ret != SD_SUCCESS) {
-        log_error("Decoder error %s at position %d in string \"%s\"", sd_get_error(ret), err_pos, custom_str);
+static void player_free_custom(object *obj) {
+    if(obj->animation_state.has_custom) {
+        sd_script_free(&obj->animation_state.custom);
+        obj->animation_state.has_custom = false;
+    }
+}
+
+static const snapshot_field tag_fields[] = {
+    SNAPSHOT_FIELD(sd_script_tag, key),
+    SNAPSHOT_FIELD(sd_script_tag, desc),
+    SNAPSHOT_FIELD(sd_script_tag, has_param),
+    SNAPSHOT_FIELD(sd_script_tag, value),
+    SNAPSHOT_FIELD(sd_script_tag, id),
+};
+
+void player_snapshot(const object *obj, serial *ser) {
+    // The shared animation scripts never change, so only a custom script needs to be saved
+    uint8_t has_custom = obj->animation_state.has_custom;
+    serial_write(ser, (const char *)&has_custom, sizeof(has_custom));
+    if(!has_custom) {
+        return;
     }
 
-    // Set player state
+    const sd_script *parser = &obj->animation_state.custom;
+    uint32_t frame_count = vector_size(&parser->frames);
+    serial_write(ser, (const char *)&frame_count, sizeof(frame_count));
+
+    iterator it;
+    sd_script_frame *frame;
+    vector_iter_begin(&parser->frames, &it);
+    foreach(it, frame) {
+        uint32_t tag_count = vector_size(&frame->tags);
+        serial_write(ser, (const char *)&frame->sprite, sizeof(frame->sprite));
+        serial_write(ser, (const char *)&frame->tick_len, sizeof(frame->tick_len));
+        serial_write(ser, (const char *)&tag_count, sizeof(tag_count));
+        for(uint32_t i = 0; i < tag_count; i++) {
+            snapshot_write_fields(ser, vector_get(&frame->tags, i), tag_fields, N_ELEMENTS(tag_fields));
+        }
+    }
+}
+
+// Checks if the parser in the snapshot has the same frames and tags as the current one. Frame lengths and
+// sprites may differ, those get written over in place.
+static bool player_parser_matches(const sd_script *parser, serial *ser) {
+    uint32_t frame_count;
+    serial_read(ser, (char *)&frame_count, sizeof(frame_count));
+    if(frame_count != vector_size(&parser->frames)) {
+        return false;
+    }
+    for(uint32_t i = 0; i < frame_count; i++) {
+        const sd_script_frame *frame = vector_get(&parser->frames, i);
+        int sprite, tick_len;
+        uint32_t tag_count;
+        serial_read(ser, (char *)&sprite, sizeof(sprite));
+        serial_read(ser, (char *)&tick_len, sizeof(tick_len));
+        serial_read(ser, (char *)&tag_count, sizeof(tag_count));
+        if(tag_count != vector_size(&frame->tags)) {
+            return false;
+        }
+        for(uint32_t j = 0; j < tag_count; j++) {
+            const sd_script_tag *current = vector_get(&frame->tags, j);
+            sd_script_tag tag;
+            snapshot_read_fields(ser, &tag, tag_fields, N_ELEMENTS(tag_fields));
+            if(tag.key != current->key || tag.has_param != current->has_param || tag.value != current->value ||
+               tag.id != current->id) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void player_restore(object *obj, serial *ser, bool fresh) {
+    player_animation_state *state = &obj->animation_state;
+    // A fresh object only has the custom script fields of the snapshot, there is nothing to free
+    if(fresh) {
+        state->has_custom = false;
+    }
+
+    uint8_t has_custom;
+    serial_read(ser, (char *)&has_custom, sizeof(has_custom));
+    if(!has_custom) {
+        player_free_custom(obj);
+        return;
+    }
+
+    sd_script *parser = &state->custom;
+    size_t start = ser->rpos;
+    uint32_t frame_count;
+
+    if(state->has_custom && player_parser_matches(parser, ser)) {
+        // Same animation string as before, so only the frame lengths can have changed
+        ser->rpos = start;
+        serial_read(ser, (char *)&frame_count, sizeof(frame_count));
+        for(uint32_t i = 0; i < frame_count; i++) {
+            sd_script_frame *frame = vector_get(&parser->frames, i);
+            uint32_t tag_count;
+            serial_read(ser, (char *)&frame->sprite, sizeof(frame->sprite));
+            serial_read(ser, (char *)&frame->tick_len, sizeof(frame->tick_len));
+            serial_read(ser, (char *)&tag_count, sizeof(tag_count));
+            for(uint32_t j = 0; j < tag_count; j++) {
+                sd_script_tag tag;
+                snapshot_read_fields(ser, &tag, tag_fields, N_ELEMENTS(tag_fields));
+            }
+        }
+        return;
+    }
+
+    // The custom script has changed since the snapshot was taken, rebuild it
+    ser->rpos = start;
+    player_free_custom(obj);
+    sd_script_create(parser);
+    state->has_custom = true;
+    serial_read(ser, (char *)&frame_count, sizeof(frame_count));
+    for(uint32_t i = 0; i < frame_count; i++) {
+        int sprite, tick_len;
+        uint32_t tag_count;
+        serial_read(ser, (char *)&sprite, sizeof(sprite));
+        serial_read(ser, (char *)&tick_len, sizeof(tick_len));
+        serial_read(ser, (char *)&tag_count, sizeof(tag_count));
+        sd_script_frame frame;
+        sd_script_frame_create(&frame, tick_len, sprite);
+        for(uint32_t j = 0; j < tag_count; j++) {
+            snapshot_read_fields(ser, vector_append_ptr(&frame.tags), tag_fields, N_ELEMENTS(tag_fields));
+        }
+        sd_script_frame_compile(&frame);
+        vector_append(&parser->frames, &frame);
+    }
+}
+
+void player_free(object *obj) {
+    player_free_custom(obj);
+}
+
+// Sets the player state for a new animation or animation string
+static void player_start(object *obj) {
     player_reset(obj);
     obj->animation_state.reverse = 0;
     obj->slide_state.timer = 0;
@@ -64,8 +201,24 @@ void player_reload_with_str(object *obj, const char *custom_str) {
     obj->can_hit = 0;
 }
 
+void player_reload_with_str(object *obj, const char *custom_str) {
+    // Free and reload parser
+    player_free_custom(obj);
+    sd_script_create(&obj->animation_state.custom);
+    obj->animation_state.has_custom = true;
+    int ret;
+    int err_pos;
+    ret = sd_script_decode(&obj->animation_state.custom, custom_str, &err_pos);
+    if(ret != SD_SUCCESS) {
+        log_error("Decoder error %s at position %d in string \"%s\"", sd_get_error(ret), err_pos, custom_str);
+    }
+    player_start(obj);
+}
+
 void player_reload(object *obj) {
-    player_reload_with_str(obj, str_c(&obj->cur_animation->animation_string));
+    // Play the script of the animation itself
+    player_free_custom(obj);
+    player_start(obj);
 }
 
 void player_reset(object *obj) {
@@ -76,16 +229,14 @@ void player_reset(object *obj) {
     obj->animation_state.disable_d = 0;
 }
 
-int player_frame_isset(const object *obj, const char *tag) {
-    const sd_script_frame *frame =
-        sd_script_get_frame_at(&obj->animation_state.parser, obj->animation_state.current_tick);
-    return sd_script_isset(frame, tag);
+int player_frame_isset(const object *obj, sd_tag_id tag) {
+    const sd_script_frame *frame = sd_script_get_frame_at(player_get_script(obj), obj->animation_state.current_tick);
+    return sd_script_isset_id(frame, tag);
 }
 
-int player_frame_get(const object *obj, const char *tag) {
-    const sd_script_frame *frame =
-        sd_script_get_frame_at(&obj->animation_state.parser, obj->animation_state.current_tick);
-    return sd_script_get(frame, tag);
+int player_frame_get(const object *obj, sd_tag_id tag) {
+    const sd_script_frame *frame = sd_script_get_frame_at(player_get_script(obj), obj->animation_state.current_tick);
+    return sd_script_get_id(frame, tag);
 }
 
 /*
@@ -93,7 +244,7 @@ int player_frame_get(const object *obj, const char *tag) {
  */
 void player_set_delay(object *obj, int delay) {
     // find the first frame that spawns a projectile, if any
-    int r = sd_script_next_frame_with_tag(&obj->animation_state.parser, "m", 0);
+    int r = sd_script_next_frame_with_tag_id(player_get_script(obj), SD_TAG_M, 0);
     int frames = (r >= 0) ? r : 99;
 
     // find the first frame with hit coordinates
@@ -101,7 +252,7 @@ void player_set_delay(object *obj, int delay) {
     collision_coord *cc;
     vector_iter_begin(&obj->cur_animation->collision_coords, &it);
     foreach(it, cc) {
-        r = sd_script_next_frame_with_sprite(&obj->animation_state.parser, cc->frame_index, 0);
+        r = sd_script_next_frame_with_sprite(player_get_script(obj), cc->frame_index, 0);
         frames = (r >= 0 && r < frames) ? r : frames;
     }
 
@@ -112,10 +263,16 @@ void player_set_delay(object *obj, int delay) {
 
     log_debug("Animation has %d initializer frames", frames);
 
+    // The animation script is shared, so make a copy of it to change
+    if(!obj->animation_state.has_custom) {
+        sd_script_clone(&obj->cur_animation->script, &obj->animation_state.custom);
+        obj->animation_state.has_custom = true;
+    }
+
     int delay_per_frame = delay / frames;
     int rem = delay % frames;
     for(int i = 0; i < frames; i++) {
-        int duration = sd_script_get_tick_len_at_frame(&obj->animation_state.parser, i);
+        int duration = sd_script_get_tick_len_at_frame(&obj->animation_state.custom, i);
         int old_dur = duration;
         int new_duration = duration + delay_per_frame;
         if(rem) {
@@ -123,8 +280,8 @@ void player_set_delay(object *obj, int delay) {
             rem--;
         }
 
-        sd_script_set_tick_len_at_frame(&obj->animation_state.parser, i, new_duration);
-        duration = sd_script_get_tick_len_at_frame(&obj->animation_state.parser, i);
+        sd_script_set_tick_len_at_frame(&obj->animation_state.custom, i, new_duration);
+        duration = sd_script_get_tick_len_at_frame(&obj->animation_state.custom, i);
         log_debug("changed duration of frame %d from %d to %d", i, old_dur, duration);
     }
 }
@@ -159,7 +316,7 @@ void player_describe_object(object *obj) {
 
 void player_describe_mp_flags(const sd_script_frame *frame, int mp) {
     if(mp != 0) {
-        log_debug("mp flags set for new animation %d:", sd_script_get(frame, "m"));
+        log_debug("mp flags set for new animation %d:", sd_script_get_id(frame, SD_TAG_M));
         if(mp & 0x1)
             log_debug(" * 0x01: NON-HAR Sprite");
         if(mp & 0x2)
@@ -189,13 +346,13 @@ void player_run(object *obj) {
     if(state->finished)
         return;
 
-    const sd_script_frame *frame = sd_script_get_frame_at(&state->parser, state->current_tick);
+    const sd_script_frame *frame = sd_script_get_frame_at(player_get_script(obj), state->current_tick);
 
     // Animation has ended ?
     if(frame == NULL) {
         if(state->repeat) {
             player_reset(obj);
-            frame = sd_script_get_frame_at(&state->parser, state->current_tick);
+            frame = sd_script_get_frame_at(player_get_script(obj), state->current_tick);
         } else {
             state->finished = 1;
             if(obj->finish != NULL) {
@@ -214,9 +371,9 @@ void player_run(object *obj) {
     assert(frame != NULL);
 
     // Get MP flag content, set to 0 if not set.
-    uint8_t mp = sd_script_isset(frame, "mp") ? sd_script_get(frame, "mp") & 0xFF : 0;
+    uint8_t mp = sd_script_isset_id(frame, SD_TAG_MP) ? sd_script_get_id(frame, SD_TAG_MP) & 0xFF : 0;
 
-    if(sd_script_isset(frame, "e") && enemy && !sd_script_isset(frame, "am")) {
+    if(sd_script_isset_id(frame, SD_TAG_E) && enemy && !sd_script_isset_id(frame, SD_TAG_AM)) {
 
         // Set speed to 0, since we're being controlled by animation tag system
         obj->vel.x = 0;
@@ -230,10 +387,10 @@ void player_run(object *obj) {
     }
 
     if(enemy) {
-        enemy->crossup_protection = sd_script_isset(frame, "ag");
+        enemy->crossup_protection = sd_script_isset_id(frame, SD_TAG_AG);
     }
 
-    if(sd_script_isset(frame, "ar")) {
+    if(sd_script_isset_id(frame, SD_TAG_AR)) {
         object_set_direction(obj, object_get_direction(obj) * -1);
     }
 
@@ -241,19 +398,19 @@ void player_run(object *obj) {
     obj->wall_collision = false;
     // See if x+/- or y+/- are set and save values
     int trans_x = 0, trans_y = 0;
-    if(sd_script_isset(frame, "y-")) {
-        trans_y = sd_script_get(frame, "y-") * -1;
-    } else if(sd_script_isset(frame, "y+")) {
-        trans_y = sd_script_get(frame, "y+");
+    if(sd_script_isset_id(frame, SD_TAG_Y_MINUS)) {
+        trans_y = sd_script_get_id(frame, SD_TAG_Y_MINUS) * -1;
+    } else if(sd_script_isset_id(frame, SD_TAG_Y_PLUS)) {
+        trans_y = sd_script_get_id(frame, SD_TAG_Y_PLUS);
     }
-    if(sd_script_isset(frame, "x-")) {
-        trans_x = sd_script_get(frame, "x-") * -1 * object_get_direction(obj);
-    } else if(sd_script_isset(frame, "x+")) {
-        trans_x = sd_script_get(frame, "x+") * object_get_direction(obj);
+    if(sd_script_isset_id(frame, SD_TAG_X_MINUS)) {
+        trans_x = sd_script_get_id(frame, SD_TAG_X_MINUS) * -1 * object_get_direction(obj);
+    } else if(sd_script_isset_id(frame, SD_TAG_X_PLUS)) {
+        trans_x = sd_script_get_id(frame, SD_TAG_X_PLUS) * object_get_direction(obj);
     }
 
     // Check if frame changed from the previous tick
-    state->entered_frame = sd_script_frame_changed(&state->parser, state->previous_tick, state->current_tick);
+    state->entered_frame = sd_script_frame_changed(player_get_script(obj), state->previous_tick, state->current_tick);
     if(state->entered_frame) {
 #ifdef DEBUGMODE
         // player_describe_frame(frame);
@@ -262,7 +419,7 @@ void player_run(object *obj) {
 #endif
         player_clear_frame(obj);
 
-        if(sd_script_isset(frame, "ac")) {
+        if(sd_script_isset_id(frame, SD_TAG_AC)) {
             // force the har to face the center of the arena
             if(obj->pos.x > 160) {
                 object_set_direction(obj, OBJECT_FACE_LEFT);
@@ -272,7 +429,7 @@ void player_run(object *obj) {
         }
 
         // TODO this needs to somehow be delayed for 1 tick
-        if(sd_script_isset(frame, "n")) {
+        if(sd_script_isset_id(frame, SD_TAG_N)) {
             obj->hit_pixels_disabled = true;
         } else {
             obj->hit_pixels_disabled = false;
@@ -281,8 +438,8 @@ void player_run(object *obj) {
         // BJ sets new animation for our HAR
         // TODO this is still wrong somehow, there's some kind of conditional
         // but it fixes gargoyle's scrap looping and some other stuff
-        if(sd_script_isset(frame, "bj")) {
-            int new_ani = sd_script_get(frame, "bj");
+        if(sd_script_isset_id(frame, SD_TAG_BJ)) {
+            int new_ani = sd_script_get_id(frame, SD_TAG_BJ);
             har_set_ani(obj, new_ani, 0);
             if(new_ani == ANIM_STANDUP) {
                 har_face_enemy(obj, enemy);
@@ -291,27 +448,27 @@ void player_run(object *obj) {
             return;
         }
 
-        if(sd_script_isset(frame, "mc")) {
+        if(sd_script_isset_id(frame, SD_TAG_MC)) {
             // if UC is also set, when UC proceeds to the next animation, set the object gravity to the HAR's gravity
             obj->object_flags |= OBJECT_FLAGS_MC;
         }
 
-        if(sd_script_isset(frame, "ud")) {
+        if(sd_script_isset_id(frame, SD_TAG_UD)) {
             // object moves to next animation when owning HAR is hit
             obj->object_flags |= OBJECT_FLAGS_NEXT_ANIM_ON_OWNER_HIT;
         }
 
-        if(sd_script_isset(frame, "uz")) {
+        if(sd_script_isset_id(frame, SD_TAG_UZ)) {
             // object moves to next animation when enemy HAR is hit
             obj->object_flags |= OBJECT_FLAGS_NEXT_ANIM_ON_ENEMY_HIT;
         }
 
-        if(sd_script_isset(frame, "cp") && obj->should_hitpause) {
+        if(sd_script_isset_id(frame, SD_TAG_CP) && obj->should_hitpause) {
             obj->should_hitpause = false;
             game_state_hit_pause(obj->gs);
         }
 
-        if(sd_script_isset(frame, "mu")) {
+        if(sd_script_isset_id(frame, SD_TAG_MU)) {
             // mu tags depend on a previous mm tag, so we need to iterate all of then tags, keeping track of the last mm
             // value we spawn
             iterator it;
@@ -319,9 +476,9 @@ void player_run(object *obj) {
             vector_iter_begin(&frame->tags, &it);
             int mm = 0;
             foreach(it, tag) {
-                if(strcmp(tag->key, "mm") == 0) {
+                if(tag->id == SD_TAG_MM) {
                     mm = tag->value;
-                } else if(strcmp(tag->key, "mu") == 0 && mm) {
+                } else if(tag->id == SD_TAG_MU && mm) {
                     if(obj->cur_animation->id == 9) {
                         // I know this might be hard to believe, but the mu tag applies to the ENEMY if you're in
                         // animation 9. This is so the shadow grab lockout lives as long as the grabbed har is
@@ -334,9 +491,9 @@ void player_run(object *obj) {
             }
         }
 
-        if(sd_script_isset(frame, "bm") && enemy) {
+        if(sd_script_isset_id(frame, SD_TAG_BM) && enemy) {
             int destination = 160;
-            if(sd_script_isset(frame, "am") && sd_script_isset(frame, "e")) {
+            if(sd_script_isset_id(frame, SD_TAG_AM) && sd_script_isset_id(frame, SD_TAG_E)) {
                 // destination is the enemy's position
                 destination = enemy->pos.x - trans_x;
                 if(obj->pos.x > enemy->pos.x) {
@@ -345,7 +502,7 @@ void player_run(object *obj) {
                     object_set_direction(obj, OBJECT_FACE_RIGHT);
                 }
                 destination = max2(ARENA_LEFT_WALL, min2(ARENA_RIGHT_WALL, destination));
-            } else if(sd_script_isset(frame, "cf")) {
+            } else if(sd_script_isset_id(frame, SD_TAG_CF)) {
                 // shadow's scrap, position is in the corner behind shadow
                 if(object_get_direction(enemy) == OBJECT_FACE_RIGHT) {
                     destination = ARENA_RIGHT_WALL;
@@ -361,7 +518,7 @@ void player_run(object *obj) {
             }
             // clear this
             trans_x = 0;
-            if(sd_script_get(frame, "bm") == 10 && destination > 0 && fabsf(obj->pos.x - destination) > 5.0) {
+            if(sd_script_get_id(frame, SD_TAG_BM) == 10 && destination > 0 && fabsf(obj->pos.x - destination) > 5.0) {
                 log_debug("HAR walk to %d from %d", destination, obj->pos.x);
                 har_walk_to(obj, destination);
                 return;
@@ -369,7 +526,7 @@ void player_run(object *obj) {
         }
     }
 
-    if(sd_script_isset(frame, "h")) {
+    if(sd_script_isset_id(frame, SD_TAG_H)) {
         // Hover, reset all velocities to 0 on every frame
         obj->vel.x = 0;
         obj->vel.y = 0;
@@ -377,15 +534,15 @@ void player_run(object *obj) {
         obj->cvel.y = 0;
     }
 
-    int ab_flag = sd_script_isset(frame, "ab"); // Pass through walls
+    int ab_flag = sd_script_isset_id(frame, SD_TAG_AB); // Pass through walls
 
     // Set to ground
-    if(sd_script_isset(frame, "g")) {
+    if(sd_script_isset_id(frame, SD_TAG_G)) {
         obj->vel.y = 0;
         obj->pos.y = ARENA_FLOOR;
     }
 
-    if(sd_script_isset(frame, "at") && enemy) {
+    if(sd_script_isset_id(frame, SD_TAG_AT) && enemy) {
         // TODO: Modify this with correct push behavior after the push PR is in
         // set the object's X position to be behind the opponent
 
@@ -398,7 +555,7 @@ void player_run(object *obj) {
 
     // Handle vx+/-, vy+/-, x+/-. y+/-
     if(trans_x || trans_y) {
-        if(sd_script_isset(frame, "v")) {
+        if(sd_script_isset_id(frame, SD_TAG_V)) {
             obj->vel.x = (trans_x * (mp & 0x20 ? -1 : 1)) * obj->horizontal_velocity_modifier;
             obj->vel.y = trans_y * obj->horizontal_velocity_modifier;
             // log_debug("vel x+%d, y+%d to x=%f, y=%f", trans_x * (mp & 0x20 ? -1 : 1), trans_y, obj->vel.x,
@@ -407,13 +564,13 @@ void player_run(object *obj) {
             obj->pos.x += trans_x * (mp & 0x20 ? -1 : 1);
             if(!ab_flag) {
                 if(obj->pos.x < ARENA_LEFT_WALL && obj->group == GROUP_HAR) {
-                    if(sd_script_isset(frame, "e") && enemy) {
+                    if(sd_script_isset_id(frame, SD_TAG_E) && enemy) {
                         enemy->pos.x += ARENA_LEFT_WALL - obj->pos.x;
                     }
                     obj->pos.x = ARENA_LEFT_WALL;
                     obj->wall_collision = true;
                 } else if(obj->pos.x > ARENA_RIGHT_WALL && obj->group == GROUP_HAR) {
-                    if(sd_script_isset(frame, "e") && enemy) {
+                    if(sd_script_isset_id(frame, SD_TAG_E) && enemy) {
                         enemy->pos.x -= obj->pos.x - ARENA_RIGHT_WALL;
                     }
                     obj->pos.x = ARENA_RIGHT_WALL;
@@ -440,7 +597,7 @@ void player_run(object *obj) {
     // If frame changed, do something
     if(state->entered_frame) {
         // Animation creation command
-        if(sd_script_isset(frame, "m") && state->spawn != NULL) {
+        if(sd_script_isset_id(frame, SD_TAG_M) && state->spawn != NULL) {
             int mx = 0;
             int my = 0;
             float vx = 0;
@@ -448,122 +605,122 @@ void player_run(object *obj) {
 
             // Instance count
             int instances = 1;
-            if(sd_script_isset(frame, "mi")) {
-                instances = sd_script_get(frame, "mi");
+            if(sd_script_isset_id(frame, SD_TAG_MI)) {
+                instances = sd_script_get_id(frame, SD_TAG_MI);
                 log_debug("spawning %d instances", instances);
             }
 
             // Staring X coordinate for new animation
-            if(sd_script_isset(frame, "mx")) {
-                mx = obj->start.x + (sd_script_get(frame, "mx") * object_get_direction(obj));
+            if(sd_script_isset_id(frame, SD_TAG_MX)) {
+                mx = obj->start.x + (sd_script_get_id(frame, SD_TAG_MX) * object_get_direction(obj));
             }
 
             // Staring Y coordinate for new animation
-            if(sd_script_isset(frame, "my")) {
-                my = obj->start.y + sd_script_get(frame, "my");
+            if(sd_script_isset_id(frame, SD_TAG_MY)) {
+                my = obj->start.y + sd_script_get_id(frame, SD_TAG_MY);
             }
 
             // Angle/speed for new animation
-            if(sd_script_isset(frame, "ma")) {
-                int ma = sd_script_get(frame, "ma");
+            if(sd_script_isset_id(frame, SD_TAG_MA)) {
+                int ma = sd_script_get_id(frame, SD_TAG_MA);
                 vx = cosf(ma);
                 vy = sinf(ma);
                 log_debug("MA is set! angle = %d, vx = %f, vy = %f", ma, vx, vy);
             }
 
             // Special positioning for certain desert arena sprites
-            int ms = sd_script_isset(frame, "ms");
+            int ms = sd_script_isset_id(frame, SD_TAG_MS);
 
             // Gravity for new object
-            int mg = sd_script_isset(frame, "mg") ? sd_script_get(frame, "mg") : 0;
+            int mg = sd_script_isset_id(frame, SD_TAG_MG) ? sd_script_get_id(frame, SD_TAG_MG) : 0;
 
             for(int i = 0; i < instances; i++) {
                 // random starting coordinates
-                if(sd_script_isset(frame, "mrx")) {
-                    int mrx = sd_script_get(frame, "mrx");
-                    int mm = sd_script_isset(frame, "mm") ? sd_script_get(frame, "mm") : mrx;
+                if(sd_script_isset_id(frame, SD_TAG_MRX)) {
+                    int mrx = sd_script_get_id(frame, SD_TAG_MRX);
+                    int mm = sd_script_isset_id(frame, SD_TAG_MM) ? sd_script_get_id(frame, SD_TAG_MM) : mrx;
                     mx = random_int(&obj->gs->rand, 320 - 2 * mm) + mrx;
                     log_debug("randomized mx as %d", mx);
                 }
-                if(sd_script_isset(frame, "mry")) {
-                    int mry = sd_script_get(frame, "mry");
-                    int mm = sd_script_isset(frame, "mm") ? sd_script_get(frame, "mm") : mry;
+                if(sd_script_isset_id(frame, SD_TAG_MRY)) {
+                    int mry = sd_script_get_id(frame, SD_TAG_MRY);
+                    int mm = sd_script_isset_id(frame, SD_TAG_MM) ? sd_script_get_id(frame, SD_TAG_MM) : mry;
                     my = random_int(&obj->gs->rand, 320 - 2 * mm) + mry;
                     log_debug("randomized my as %d", my);
                 }
 
-                state->spawn(obj, sd_script_get(frame, "m"), vec2i_create(mx, my), vec2f_create(vx, vy), mp, ms, mg,
-                             state->spawn_userdata);
+                state->spawn(obj, sd_script_get_id(frame, SD_TAG_M), vec2i_create(mx, my), vec2f_create(vx, vy), mp, ms,
+                             mg, state->spawn_userdata);
             }
         }
 
         // Animation deletion
-        if(sd_script_isset(frame, "md") && state->destroy != NULL) {
-            state->destroy(obj, sd_script_get(frame, "md"), state->destroy_userdata);
+        if(sd_script_isset_id(frame, SD_TAG_MD) && state->destroy != NULL) {
+            state->destroy(obj, sd_script_get_id(frame, SD_TAG_MD), state->destroy_userdata);
         }
 
         // Music playback
-        if(sd_script_isset(frame, "smo")) {
-            if(sd_script_get(frame, "smo") == 0) {
+        if(sd_script_isset_id(frame, SD_TAG_SMO)) {
+            if(sd_script_get_id(frame, SD_TAG_SMO) == 0) {
                 audio_stop_music();
                 return;
             }
-            audio_play_music(PSM_END + (sd_script_get(frame, "smo") - 1));
+            audio_play_music(PSM_END + (sd_script_get_id(frame, SD_TAG_SMO) - 1));
         }
-        if(sd_script_isset(frame, "smf")) {
+        if(sd_script_isset_id(frame, SD_TAG_SMF)) {
             audio_stop_music();
         }
 
         // Sound playback
-        if(sd_script_isset(frame, "s")) {
+        if(sd_script_isset_id(frame, SD_TAG_S)) {
             int pitch = 0;
             float volume = VOLUME_DEFAULT;
             float panning = PANNING_DEFAULT;
-            if(sd_script_isset(frame, "sf")) {
-                pitch = sd_script_get(frame, "sf");
+            if(sd_script_isset_id(frame, SD_TAG_SF)) {
+                pitch = sd_script_get_id(frame, SD_TAG_SF);
                 assert(pitch >= -128 && pitch <= 128);
                 log_debug("object in group %d sound freq adjustment is %d", obj->group, pitch);
             }
-            if(sd_script_isset(frame, "l")) {
-                int v = clamp(sd_script_get(frame, "l"), 0, 100);
+            if(sd_script_isset_id(frame, SD_TAG_L)) {
+                int v = clamp(sd_script_get_id(frame, SD_TAG_L), 0, 100);
                 volume = (v / 100.0f);
             }
-            if(sd_script_isset(frame, "sb")) {
-                panning = clamp(sd_script_get(frame, "sb"), -100, 100) / 100.0f;
+            if(sd_script_isset_id(frame, SD_TAG_SB)) {
+                panning = clamp(sd_script_get_id(frame, SD_TAG_SB), -100, 100) / 100.0f;
             } else {
                 panning = (obj->pos.x - 160) / 160.0f;
             }
             if(obj->sound_translation_table) {
-                int sound_id = obj->sound_translation_table[sd_script_get(frame, "s")] - 1;
+                int sound_id = obj->sound_translation_table[sd_script_get_id(frame, SD_TAG_S)] - 1;
                 game_state_play_sound(obj->gs, sound_id, volume, panning, pitch);
             }
         }
 
         // Blend mode stuff
-        if(sd_script_isset(frame, "bb")) {
-            rstate->screen_shake_vertical = sd_script_get(frame, "bb");
+        if(sd_script_isset_id(frame, SD_TAG_BB)) {
+            rstate->screen_shake_vertical = sd_script_get_id(frame, SD_TAG_BB);
         }
-        if(sd_script_isset(frame, "bf")) {
-            rstate->blend_finish = sd_script_get(frame, "bf");
+        if(sd_script_isset_id(frame, SD_TAG_BF)) {
+            rstate->blend_finish = sd_script_get_id(frame, SD_TAG_BF);
         }
-        if(sd_script_isset(frame, "bl")) {
-            rstate->screen_shake_horizontal = sd_script_get(frame, "bl");
+        if(sd_script_isset_id(frame, SD_TAG_BL)) {
+            rstate->screen_shake_horizontal = sd_script_get_id(frame, SD_TAG_BL);
         }
-        if(sd_script_isset(frame, "bs")) {
-            rstate->blend_start = sd_script_get(frame, "bs");
+        if(sd_script_isset_id(frame, SD_TAG_BS)) {
+            rstate->blend_start = sd_script_get_id(frame, SD_TAG_BS);
         }
 
         // Palette tricks
-        if(sd_script_isset(frame, "bpd")) {
-            rstate->pal_ref_index = sd_script_get(frame, "bpd");
+        if(sd_script_isset_id(frame, SD_TAG_BPD)) {
+            rstate->pal_ref_index = sd_script_get_id(frame, SD_TAG_BPD);
         }
-        if(sd_script_isset(frame, "bpn")) {
-            rstate->pal_entry_count = sd_script_get(frame, "bpn");
+        if(sd_script_isset_id(frame, SD_TAG_BPN)) {
+            rstate->pal_entry_count = sd_script_get_id(frame, SD_TAG_BPN);
         }
-        if(sd_script_isset(frame, "bps")) {
-            rstate->pal_start_index = sd_script_get(frame, "bps");
+        if(sd_script_isset_id(frame, SD_TAG_BPS)) {
+            rstate->pal_start_index = sd_script_get_id(frame, SD_TAG_BPS);
         }
-        if(sd_script_isset(frame, "bpf")) {
+        if(sd_script_isset_id(frame, SD_TAG_BPF)) {
             // Exact values come from master.dat
             if(game_state_get_player(obj->gs, 0)->har_obj_id == obj->id) {
                 rstate->pal_start_index = 1;
@@ -573,57 +730,57 @@ void player_run(object *obj) {
                 rstate->pal_entry_count = 48;
             }
         }
-        if(sd_script_isset(frame, "bpp")) {
-            rstate->pal_end = COLOR_6TO8(sd_script_get(frame, "bpp"));
-            rstate->pal_begin = COLOR_6TO8(sd_script_get(frame, "bpp"));
+        if(sd_script_isset_id(frame, SD_TAG_BPP)) {
+            rstate->pal_end = COLOR_6TO8(sd_script_get_id(frame, SD_TAG_BPP));
+            rstate->pal_begin = COLOR_6TO8(sd_script_get_id(frame, SD_TAG_BPP));
         }
-        if(sd_script_isset(frame, "bpb")) {
-            rstate->pal_begin = COLOR_6TO8(sd_script_get(frame, "bpb"));
+        if(sd_script_isset_id(frame, SD_TAG_BPB)) {
+            rstate->pal_begin = COLOR_6TO8(sd_script_get_id(frame, SD_TAG_BPB));
         }
-        if(sd_script_isset(frame, "bz")) {
+        if(sd_script_isset_id(frame, SD_TAG_BZ)) {
             rstate->pal_tint = 1;
         }
 
         // CREDITS palette copy tricks
-        rstate->pal_tricks_off = sd_script_isset(frame, "bpo") ? 1 : 0; // Disable the standard palette tricks
-        rstate->bd_flag =
-            sd_script_isset(frame, "bd"); // Read palette from the last frame of animation (we emulate this internally)
+        rstate->pal_tricks_off = sd_script_isset_id(frame, SD_TAG_BPO) ? 1 : 0; // Disable the standard palette tricks
+        rstate->bd_flag = sd_script_isset_id(
+            frame, SD_TAG_BD); // Read palette from the last frame of animation (we emulate this internally)
 
         // These are animation-global instead of per-frame.
-        if(sd_script_isset(frame, "ba")) {
-            state->pal_copy_count = sd_script_get(frame, "ba");   // Number of copies to make after bi + bc
-            state->pal_copy_start = sd_script_get(frame, "bi");   // Start offset for copying
-            state->pal_copy_entries = sd_script_get(frame, "bc"); // Number of indexes to copy
+        if(sd_script_isset_id(frame, SD_TAG_BA)) {
+            state->pal_copy_count = sd_script_get_id(frame, SD_TAG_BA);   // Number of copies to make after bi + bc
+            state->pal_copy_start = sd_script_get_id(frame, SD_TAG_BI);   // Start offset for copying
+            state->pal_copy_entries = sd_script_get_id(frame, SD_TAG_BC); // Number of indexes to copy
         }
 
-        if(sd_script_isset(frame, "by")) {
+        if(sd_script_isset_id(frame, SD_TAG_BY)) {
             object_set_shadow(obj, 0);
         }
 
-        if(sd_script_isset(frame, "bw")) {
+        if(sd_script_isset_id(frame, SD_TAG_BW)) {
             object_set_shadow(obj, 1);
         }
 
         // Handle position correction
-        if(sd_script_isset(frame, "ox")) {
-            log_debug("O_CORRECTION: X = %d", sd_script_get(frame, "ox"));
-            rstate->o_correction.x = sd_script_get(frame, "ox");
+        if(sd_script_isset_id(frame, SD_TAG_OX)) {
+            log_debug("O_CORRECTION: X = %d", sd_script_get_id(frame, SD_TAG_OX));
+            rstate->o_correction.x = sd_script_get_id(frame, SD_TAG_OX);
         } else {
             rstate->o_correction.x = 0;
         }
-        if(sd_script_isset(frame, "oy")) {
-            log_debug("O_CORRECTION: Y = %d", sd_script_get(frame, "oy"));
-            rstate->o_correction.y = sd_script_get(frame, "oy");
+        if(sd_script_isset_id(frame, SD_TAG_OY)) {
+            log_debug("O_CORRECTION: Y = %d", sd_script_get_id(frame, SD_TAG_OY));
+            rstate->o_correction.y = sd_script_get_id(frame, SD_TAG_OY);
         } else {
             rstate->o_correction.y = 0;
         }
 
-        if(sd_script_isset(frame, "bo")) {
-            player_set_shadow_correction_y(obj, sd_script_get(frame, "bo"));
+        if(sd_script_isset_id(frame, SD_TAG_BO)) {
+            player_set_shadow_correction_y(obj, sd_script_get_id(frame, SD_TAG_BO));
         }
 
         // If UA is set, force other HAR to damage animation
-        if(sd_script_isset(frame, "ua") && enemy) {
+        if(sd_script_isset_id(frame, SD_TAG_UA) && enemy) {
             har *h = object_get_userdata(obj);
             if(enemy->cur_animation->id != ANIM_DAMAGE) {
                 har *eh = object_get_userdata(enemy);
@@ -638,25 +795,25 @@ void player_run(object *obj) {
         }
 
         // handle scaling on the Y axis
-        if(sd_script_isset(frame, "y")) {
-            obj->y_percent = sd_script_get(frame, "y") / 100.0f;
+        if(sd_script_isset_id(frame, SD_TAG_Y)) {
+            obj->y_percent = sd_script_get_id(frame, SD_TAG_Y) / 100.0f;
         }
 
         // Handle slides
-        if(sd_script_isset(frame, "x=") || sd_script_isset(frame, "y=")) {
+        if(sd_script_isset_id(frame, SD_TAG_X_EQ) || sd_script_isset_id(frame, SD_TAG_Y_EQ)) {
             obj->vel = vec2f_create(0, 0);
         }
-        if(sd_script_isset(frame, "x=")) {
-            obj->pos.x = obj->start.x + (sd_script_get(frame, "x=") * object_get_direction(obj));
+        if(sd_script_isset_id(frame, SD_TAG_X_EQ)) {
+            obj->pos.x = obj->start.x + (sd_script_get_id(frame, SD_TAG_X_EQ) * object_get_direction(obj));
 
             // Find frame ID by tick
-            int frame_id = sd_script_next_frame_with_tag(&state->parser, "x=", state->current_tick);
+            int frame_id = sd_script_next_frame_with_tag_id(player_get_script(obj), SD_TAG_X_EQ, state->current_tick);
 
             // Handle it!
             if(frame_id >= 0) {
-                int mr = sd_script_get_tick_pos_at_frame(&state->parser, frame_id);
+                int mr = sd_script_get_tick_pos_at_frame(player_get_script(obj), frame_id);
                 int r = mr - state->current_tick - frame->tick_len;
-                int next_x = sd_script_get(sd_script_get_frame(&state->parser, frame_id), "x=");
+                int next_x = sd_script_get_id(sd_script_get_frame(player_get_script(obj), frame_id), SD_TAG_X_EQ);
                 int slide = obj->start.x + (next_x * object_get_direction(obj));
                 if(slide != obj->pos.x) {
                     obj->slide_state.vel.x = dist(obj->pos.x, slide) / (float)(frame->tick_len + r);
@@ -670,17 +827,17 @@ void player_run(object *obj) {
                 }
             }
         }
-        if(sd_script_isset(frame, "y=")) {
-            obj->pos.y = obj->start.y + sd_script_get(frame, "y=");
+        if(sd_script_isset_id(frame, SD_TAG_Y_EQ)) {
+            obj->pos.y = obj->start.y + sd_script_get_id(frame, SD_TAG_Y_EQ);
 
             // Find frame ID by tick
-            int frame_id = sd_script_next_frame_with_tag(&state->parser, "y=", state->current_tick);
+            int frame_id = sd_script_next_frame_with_tag_id(player_get_script(obj), SD_TAG_Y_EQ, state->current_tick);
 
             // handle it!
             if(frame_id >= 0) {
-                int mr = sd_script_get_tick_pos_at_frame(&state->parser, frame_id);
+                int mr = sd_script_get_tick_pos_at_frame(player_get_script(obj), frame_id);
                 int r = mr - state->current_tick - frame->tick_len;
-                int next_y = sd_script_get(sd_script_get_frame(&state->parser, frame_id), "y=");
+                int next_y = sd_script_get_id(sd_script_get_frame(player_get_script(obj), frame_id), SD_TAG_Y_EQ);
                 int slide = next_y + obj->start.y;
                 if(slide != obj->pos.y) {
                     obj->slide_state.vel.y = dist(obj->pos.y, slide) / (float)(frame->tick_len + r);
@@ -695,8 +852,8 @@ void player_run(object *obj) {
             }
         }
 
-        if(sd_script_isset(frame, "q")) {
-            obj->q_val = sd_script_get(frame, "q");
+        if(sd_script_isset_id(frame, SD_TAG_Q)) {
+            obj->q_val = sd_script_get_id(frame, SD_TAG_Q);
             // Enable hit if the q value is higher than the hit count for this animation
             if(obj->q_val > obj->q_counter) {
                 obj->can_hit = 1;
@@ -705,13 +862,13 @@ void player_run(object *obj) {
 
         // Set video effects now.
         int effects = EFFECT_NONE;
-        if(player_frame_isset(obj, "bt"))
+        if(player_frame_isset(obj, SD_TAG_BT))
             effects |= EFFECT_DARK_TINT;
-        if(player_frame_isset(obj, "br"))
+        if(player_frame_isset(obj, SD_TAG_BR))
             effects |= EFFECT_GLOW;
-        if(player_frame_isset(obj, "ub"))
+        if(player_frame_isset(obj, SD_TAG_UB))
             effects |= EFFECT_TRAIL;
-        if(player_frame_isset(obj, "bg"))
+        if(player_frame_isset(obj, SD_TAG_BG))
             effects |= EFFECT_ADD;
         object_set_frame_effects(obj, effects);
 
@@ -719,17 +876,17 @@ void player_run(object *obj) {
         object_select_sprite(obj, frame->sprite);
         if(obj->cur_sprite_id >= 0) {
             rstate->duration = frame->tick_len;
-            if(sd_script_isset(frame, "r")) { // || obj->animation_state.shadow_corner_hack) {
+            if(sd_script_isset_id(frame, SD_TAG_R)) { // || obj->animation_state.shadow_corner_hack) {
                 rstate->flipmode ^= FLIP_HORIZONTAL;
             }
-            if(sd_script_isset(frame, "f")) {
+            if(sd_script_isset_id(frame, SD_TAG_F)) {
                 rstate->flipmode ^= FLIP_VERTICAL;
             }
         }
     }
 
     // Orb meandering.  Only the fire pit orb should have this tag set.
-    if(sd_script_isset(frame, "as")) {
+    if(sd_script_isset_id(frame, SD_TAG_AS)) {
         double base_val = (obj->orb_val & 7) + 8.f;
         double delta_1 = abs(obj->orb_val * 4) + obj->gs->tick;
         double delta_2 = abs(obj->orb_val * 2) + obj->gs->tick;
@@ -743,7 +900,7 @@ void player_run(object *obj) {
         obj->vel.y = 0;
     }
 
-    if(sd_script_isset(frame, "bu")) {
+    if(sd_script_isset_id(frame, SD_TAG_BU)) {
         if(obj->vel.y < 0.0f) {
             float x_dist = dist(obj->pos.x, 160);
             // assume that bu is used in conjunction with 'vy-X' and that we want to land in the center of the arena
@@ -754,7 +911,7 @@ void player_run(object *obj) {
         }
     }
 
-    if(sd_script_isset(frame, "cg")) {
+    if(sd_script_isset_id(frame, SD_TAG_CG)) {
         obj->animation_state.disable_d = obj->pos.y < ARENA_FLOOR ? 1 : 0;
 
         if(obj->pos.y >= ARENA_FLOOR) {
@@ -766,14 +923,14 @@ void player_run(object *obj) {
     }
 
     // Tick management
-    if(sd_script_isset(frame, "d") && !obj->animation_state.disable_d) {
+    if(sd_script_isset_id(frame, SD_TAG_D) && !obj->animation_state.disable_d) {
         state->previous_tick = state->current_tick;
-        int tick_value = sd_script_get(frame, "d");
+        int tick_value = sd_script_get_id(frame, SD_TAG_D);
         if(tick_value >= 0) {
             state->current_tick = tick_value + 1;
             state->looping = true;
         } else {
-            tick_value = sd_script_get_total_ticks(&state->parser) + tick_value;
+            tick_value = sd_script_get_total_ticks(player_get_script(obj)) + tick_value;
             state->current_tick = tick_value;
         }
         return;
@@ -801,8 +958,7 @@ void player_jump_to_tick(object *obj, int tick) {
 }
 
 unsigned int player_get_len_ticks(const object *obj) {
-    const player_animation_state *state = &obj->animation_state;
-    return sd_script_get_total_ticks(&state->parser);
+    return sd_script_get_total_ticks(player_get_script(obj));
 }
 
 void player_set_repeat(object *obj, int repeat) {
@@ -815,14 +971,15 @@ int player_get_repeat(const object *obj) {
 
 void player_next_frame(object *obj) {
     player_animation_state *state = &obj->animation_state;
-    int current_index = sd_script_get_frame_index_at(&state->parser, state->current_tick);
-    state->current_tick = sd_script_get_tick_pos_at_frame(&state->parser, current_index + 1);
+    const sd_script *script = player_get_script(obj);
+    int current_index = sd_script_get_frame_index_at(script, state->current_tick);
+    state->current_tick = sd_script_get_tick_pos_at_frame(script, current_index + 1);
     state->previous_tick = state->current_tick - 1;
 }
 
 void player_goto_frame(object *obj, int frame_id) {
     player_animation_state *state = &obj->animation_state;
-    state->current_tick = sd_script_get_tick_pos_at_frame(&state->parser, frame_id);
+    state->current_tick = sd_script_get_tick_pos_at_frame(player_get_script(obj), frame_id);
     state->previous_tick = state->current_tick - 1;
 }
 
@@ -831,8 +988,8 @@ uint32_t player_get_current_tick(const object *obj) {
 }
 
 int player_get_last_frame(const object *obj) {
-    const player_animation_state *state = &obj->animation_state;
-    return sd_script_get_frame_at(&state->parser, sd_script_get_total_ticks(&state->parser) - 1)->sprite;
+    const sd_script *script = player_get_script(obj);
+    return sd_script_get_frame_at(script, sd_script_get_total_ticks(script) - 1)->sprite;
 }
 
 char player_get_last_frame_letter(const object *obj) {
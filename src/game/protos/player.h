@@ -3,6 +3,7 @@
 
 #include "formats/script.h"
 #include "game/game_state.h"
+#include "game/utils/serial.h"
 #include "utils/vec.h"
 #include <stdint.h>
 
@@ -47,7 +48,10 @@ typedef struct player_animation_state_t {
     uint32_t current_tick;
     int previous;
     int entered_frame;
-    sd_script parser;
+    // Animations are played from the script decoded when the animation was loaded. Custom strings, and
+    // animations that had their timing changed, get a script of their own.
+    sd_script custom;
+    bool has_custom;
     uint8_t repeat;
     uint8_t reverse;
     uint8_t finished;
@@ -70,12 +74,15 @@ typedef struct player_animation_state_t {
 
 void player_create(object *obj);
 void player_clone(object *src, object *dst);
+void player_snapshot(const object *obj, serial *ser);
+void player_restore(object *obj, serial *ser, bool fresh);
 void player_free(object *obj);
 void player_reload(object *obj);
 void player_reload_with_str(object *obj, const char *str);
 void player_reset(object *obj);
-int player_frame_isset(const object *obj, const char *tag);
-int player_frame_get(const object *obj, const char *tag);
+const sd_script *player_get_script(const object *obj);
+int player_frame_isset(const object *obj, sd_tag_id tag);
+int player_frame_get(const object *obj, sd_tag_id tag);
 void player_run(object *obj);
 void player_set_repeat(object *obj, int repeat);
 int player_get_repeat(const object *obj);
@@ -1,7 +1,7 @@
 #include "game/protos/scene.h"
 #include "game/game_player.h"
 #include "game/game_state_type.h"
-#include "resources/af_loader.h"
+#include "resources/asset_cache.h"
 #include "resources/bk_loader.h"
 #include "resources/ids.h"
 #include "resources/pathmanager.h"
@@ -17,6 +17,21 @@ void cb_scene_spawn_object(object *parent, int id, vec2i pos, vec2f vel, uint8_t
                            void *userdata);
 void cb_scene_destroy_object(object *parent, int id, void *userdata);
 
+// Resource id of the BK file for a scene, or -1 if the scene does not use one of the game's own BK files.
+static int scene_bk_resource(int scene_id) {
+    switch(scene_id) {
+        case SCENE_NONE:
+        case SCENE_TRN_CUTSCENE:
+            return -1;
+        case SCENE_SCOREBOARD:
+            return BK_MENU;
+        case SCENE_LOBBY:
+            return PCX_NETARENA;
+        default:
+            return BK_INTRO + (scene_id - 1);
+    }
+}
+
 // Loads BK file etc.
 int scene_create(scene *scene, game_state *gs, int scene_id) {
     if(scene_id == SCENE_NONE) {
@@ -25,38 +40,36 @@ int scene_create(scene *scene, game_state *gs, int scene_id) {
 
     char path_buf[256];
     char const *bkfilename;
-    switch(scene_id) {
-        case SCENE_TRN_CUTSCENE: {
-            game_player *player = game_state_get_player(gs, 0);
-            if(player && player->chr && player->chr->bk_name[0] != '\0') {
-                snprintf(path_buf, sizeof(path_buf), "%s/%s", pm_get_local_path(RESOURCE_PATH), player->chr->bk_name);
-                bkfilename = path_buf;
-                break;
-            }
+    int resource_id = scene_bk_resource(scene_id);
+    if(scene_id == SCENE_TRN_CUTSCENE) {
+        game_player *player = game_state_get_player(gs, 0);
+        if(!player || !player->chr || player->chr->bk_name[0] == '\0') {
             log_error("Not a valid time to be going to SCENE_TRN_CUTSCENE");
             return 1;
         }
-        default:
-            bkfilename = pm_get_resource_path(BK_INTRO + (scene_id - 1));
-            break;
-        case SCENE_SCOREBOARD:
-            bkfilename = pm_get_resource_path(BK_MENU);
-            break;
-        case SCENE_LOBBY:
-            bkfilename = pm_get_resource_path(PCX_NETARENA);
-            break;
+        snprintf(path_buf, sizeof(path_buf), "%s/%s", pm_get_local_path(RESOURCE_PATH), player->chr->bk_name);
+        bkfilename = path_buf;
     }
 
-    // Load BK
+    // Load BK. The game's own BK files go through the asset cache; tournament cutscenes are one-off files.
     scene->bk_data = omf_calloc(1, sizeof(bk));
-    if(load_bk_file(scene->bk_data, bkfilename)) {
+    if(resource_id >= 0) {
+        bkfilename = pm_get_resource_path(resource_id);
+        if(asset_cache_load_bk(scene->bk_data, resource_id)) {
+            log_error("Unable to load scene %s (%s)!", scene_get_name(scene_id), bkfilename);
+            return 1;
+        }
+    } else if(load_bk_file(scene->bk_data, bkfilename)) {
         log_error("Unable to load scene %s (%s)!", scene_get_name(scene_id), bkfilename);
         return 1;
     }
+    scene->bk_resource_id = resource_id;
     scene->id = scene_id;
     scene->gs = gs;
     scene->af_data[0] = NULL;
     scene->af_data[1] = NULL;
+    scene->af_resource_id[0] = -1;
+    scene->af_resource_id[1] = -1;
     scene->static_ticks_since_start = 0;
 
     // Init functions
@@ -88,19 +101,39 @@ int scene_create(scene *scene, game_state *gs, int scene_id) {
     return 0;
 }
 
-int scene_load_har(scene *scene, int player_id) {
-    game_player *player = game_state_get_player(scene->gs, player_id);
+void scene_prefetch(int scene_id) {
+    int resource_id = scene_bk_resource(scene_id);
+    if(resource_id >= 0) {
+        asset_cache_prefetch_bk(resource_id);
+    }
+}
+
+void scene_prefetch_har(int har_id) {
+    asset_cache_prefetch_af(har_to_resource(har_id));
+}
+
+static void scene_free_har(scene *scene, int player_id) {
     if(scene->af_data[player_id]) {
         af_free(scene->af_data[player_id]);
         omf_free(scene->af_data[player_id]);
     }
+    if(scene->af_resource_id[player_id] >= 0) {
+        asset_cache_release(scene->af_resource_id[player_id]);
+        scene->af_resource_id[player_id] = -1;
+    }
+}
+
+int scene_load_har(scene *scene, int player_id) {
+    game_player *player = game_state_get_player(scene->gs, player_id);
+    scene_free_har(scene, player_id);
     scene->af_data[player_id] = omf_calloc(1, sizeof(af));
 
     int resource_id = har_to_resource(player->pilot->har_id);
-    if(load_af_file(scene->af_data[player_id], resource_id)) {
+    if(asset_cache_load_af(scene->af_data[player_id], resource_id)) {
         log_error("Unable to load HAR %s (%s)!", har_get_name(player->pilot->har_id), get_resource_name(resource_id));
         return 1;
     }
+    scene->af_resource_id[player_id] = resource_id;
 
     log_debug("Loaded HAR %s (%s).", har_get_name(player->pilot->har_id), get_resource_name(resource_id));
     return 0;
@@ -150,6 +183,29 @@ int scene_clone(scene *src, scene *dst, game_state *gs) {
     return 0;
 }
 
+void scene_snapshot(const scene *sc, serial *ser) {
+    serial_write(ser, (const char *)&sc->id, sizeof(sc->id));
+    serial_write(ser, (const char *)&sc->static_ticks_since_start, sizeof(sc->static_ticks_since_start));
+    ticktimer_snapshot(&sc->tick_timer, ser);
+    if(sc->snapshot) {
+        sc->snapshot(sc, ser);
+    }
+}
+
+int scene_restore(scene *sc, serial *ser) {
+    int id;
+    serial_read(ser, (char *)&id, sizeof(id));
+    if(id != sc->id) {
+        return 1;
+    }
+    serial_read(ser, (char *)&sc->static_ticks_since_start, sizeof(sc->static_ticks_since_start));
+    ticktimer_restore(&sc->tick_timer, ser);
+    if(sc->restore) {
+        sc->restore(sc, ser);
+    }
+    return 0;
+}
+
 int scene_clone_free(scene *sc) {
     if(sc->clone_free) {
         sc->clone_free(sc);
@@ -249,14 +305,11 @@ void scene_free(scene *scene) {
     }
     bk_free(scene->bk_data);
     omf_free(scene->bk_data);
-    if(scene->af_data[0]) {
-        af_free(scene->af_data[0]);
-        omf_free(scene->af_data[0]);
-    }
-    if(scene->af_data[1]) {
-        af_free(scene->af_data[1]);
-        omf_free(scene->af_data[1]);
+    if(scene->bk_resource_id >= 0) {
+        asset_cache_release(scene->bk_resource_id);
     }
+    scene_free_har(scene, 0);
+    scene_free_har(scene, 1);
     ticktimer_close(&scene->tick_timer);
 }
 
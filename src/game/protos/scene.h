@@ -27,12 +27,16 @@ typedef void (*scene_startup_cb)(scene *scene, int anim_id, int *m_load, int *m_
 typedef int (*scene_anim_prio_override_cb)(scene *scene, int anim_id);
 typedef void (*scene_clone_cb)(scene *src, scene *dst);
 typedef void (*scene_clone_free_cb)(scene *scene);
+typedef void (*scene_snapshot_cb)(const scene *scene, serial *ser);
+typedef void (*scene_restore_cb)(scene *scene, serial *ser);
 
 struct scene_t {
     game_state *gs;
     int id;
     bk *bk_data;
     af *af_data[2];
+    int bk_resource_id;    // Asset cache reference for bk_data, or -1 if it was loaded outside the cache
+    int af_resource_id[2]; // Asset cache references for af_data, or -1 if there is none
     void *userdata;
     int static_ticks_since_start;
 
@@ -48,11 +52,23 @@ struct scene_t {
     scene_anim_prio_override_cb prio_override;
     scene_clone_cb clone;
     scene_clone_free_cb clone_free;
+    scene_snapshot_cb snapshot;
+    scene_restore_cb restore;
     ticktimer tick_timer;
 };
 
 int scene_create(scene *scene, game_state *gs, int scene_id);
 int scene_load_har(scene *scene, int player_id);
+
+/**
+ * Start loading the BK file of a scene in the background, ahead of switching to it.
+ */
+void scene_prefetch(int scene_id);
+
+/**
+ * Start loading the AF file of a HAR in the background, ahead of a scene_load_har for it.
+ */
+void scene_prefetch_har(int har_id);
 void scene_init(scene *scene);
 void scene_free(scene *scene);
 int scene_event(scene *scene, SDL_Event *event);
@@ -68,6 +84,8 @@ bool scene_is_arena(scene *scene);
 
 int scene_clone(scene *src, scene *dst, game_state *gs);
 int scene_clone_free(scene *sc);
+void scene_snapshot(const scene *sc, serial *ser);
+int scene_restore(scene *sc, serial *ser);
 
 void scene_set_userdata(scene *scene, void *userdata);
 void *scene_get_userdata(const scene *scene);
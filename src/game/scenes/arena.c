@@ -32,6 +32,7 @@
 #include "resources/languages.h"
 #include "resources/sgmanager.h"
 #include "utils/allocator.h"
+#include "utils/c_array_util.h"
 #include "utils/log.h"
 #include "utils/miscmath.h"
 #include "utils/random.h"
@@ -90,6 +91,7 @@ typedef struct arena_local {
     text *player_name[2];
     text *player_har[2];
     text *player_ping[2];
+    text *net_stats;
 
     int round;
     int rounds;
@@ -573,7 +575,7 @@ bool can_wallslam(int player_id, scene *scene) {
     object *o_har2 =
         game_state_find_object(scene->gs, game_player_get_har_obj_id(game_state_get_player(scene->gs, !player_id)));
 
-    if(player_frame_isset(o_har2, "cw")) {
+    if(player_frame_isset(o_har2, SD_TAG_CW)) {
         return true;
     }
 
@@ -604,7 +606,7 @@ void arena_har_hit_wall_hook(int player_id, int wall, scene *scene) {
     }
 
     float abs_velocity_h = fabsf(o_har->vel.x) / o_har->horizontal_velocity_modifier;
-    if(player_frame_isset(o_har2, "cw")) {
+    if(player_frame_isset(o_har2, SD_TAG_CW)) {
         abs_velocity_h = 7;
     }
 
@@ -1268,7 +1270,7 @@ void arena_dynamic_tick(scene *scene, int paused) {
             } else if(local->win_state == DONE) {
                 local->ending_ticks++;
                 // you win/lose animation is done
-                if(player_frame_isset(obj_har[0], "be") || player_frame_isset(obj_har[1], "be") ||
+                if(player_frame_isset(obj_har[0], SD_TAG_BE) || player_frame_isset(obj_har[1], SD_TAG_BE) ||
                    chr_score_onscreen(s1) || chr_score_onscreen(s2) || har_is_scrap_walking(obj_har[0]) ||
                    har_is_scrap_walking(obj_har[1])) {
                     local->ending_ticks = 50;
@@ -1331,9 +1333,9 @@ void arena_dynamic_tick(scene *scene, int paused) {
         }
 
         // check some invariants
-        assert(player_frame_isset(obj_har[0], "ab") ||
+        assert(player_frame_isset(obj_har[0], SD_TAG_AB) ||
                (obj_har[0]->pos.x >= ARENA_LEFT_WALL && obj_har[0]->pos.x <= ARENA_RIGHT_WALL));
-        assert(player_frame_isset(obj_har[1], "ab") ||
+        assert(player_frame_isset(obj_har[1], SD_TAG_AB) ||
                (obj_har[1]->pos.x >= ARENA_LEFT_WALL && obj_har[1]->pos.x <= ARENA_RIGHT_WALL));
         if(hars[0]->health == 0) {
             assert(hars[0]->state == STATE_DEFEAT || hars[0]->state == STATE_RECOIL || hars[0]->state == STATE_NONE ||
@@ -1445,6 +1447,20 @@ void arena_render_overlay(scene *scene) {
             text_set_from_c(local->player_ping[1], buf);
             text_draw(local->player_ping[1], 160, 40);
         }
+
+        // render netplay stats, if enabled from the console
+        if(net_stats_overlay_enabled()) {
+            for(int i = 0; i < 2; i++) {
+                if(player[i]->ctrl->type == CTRL_TYPE_NETWORK) {
+                    char stats[512];
+                    net_stats_format(net_controller_get_stats(player[i]->ctrl), SDL_GetTicks64(), stats,
+                                     sizeof(stats));
+                    text_set_from_c(local->net_stats, stats);
+                    text_draw(local->net_stats, 5, 48);
+                    break;
+                }
+            }
+        }
     }
 
     // Render menu (if visible)
@@ -1561,6 +1577,30 @@ void arena_clone(scene *src, scene *dst) {
     button_set_userdata(c, dst);
 }
 
+// GUI components are not in the snapshot, they follow the game state on their own
+static const snapshot_field arena_fields[] = {
+    SNAPSHOT_FIELD(arena_local, menu_visible),
+    SNAPSHOT_FIELD(arena_local, state),
+    SNAPSHOT_FIELD(arena_local, ending_ticks),
+    SNAPSHOT_FIELD(arena_local, round),
+    SNAPSHOT_FIELD(arena_local, rounds),
+    SNAPSHOT_FIELD(arena_local, over),
+    SNAPSHOT_FIELD(arena_local, winner),
+    SNAPSHOT_FIELD(arena_local, tournament),
+    SNAPSHOT_FIELD(arena_local, win_state),
+    SNAPSHOT_FIELD(arena_local, player_rounds),
+    SNAPSHOT_FIELD(arena_local, rein_enabled),
+    SNAPSHOT_FIELD(arena_local, rec_last),
+};
+
+static void arena_snapshot(const scene *scene, serial *ser) {
+    snapshot_write_fields(ser, scene_get_userdata(scene), arena_fields, N_ELEMENTS(arena_fields));
+}
+
+static void arena_restore(scene *scene, serial *ser) {
+    snapshot_read_fields(ser, scene_get_userdata(scene), arena_fields, N_ELEMENTS(arena_fields));
+}
+
 int arena_get_wall_slam_tolerance(game_state *gs) {
     if(gs->match_settings.hazards) {
         int arena_id = gs->this_id - SCENE_ARENA0;
@@ -1629,6 +1669,7 @@ static void arena_free(scene *scene) {
         text_free(&local->player_har[i]);
         text_free(&local->player_ping[i]);
     }
+    text_free(&local->net_stats);
 
     settings_save();
 
@@ -1844,6 +1885,10 @@ int arena_create(scene *scene) {
     text_set_horizontal_align(local->player_har[1], TEXT_ALIGN_RIGHT);
     text_set_horizontal_align(local->player_ping[1], TEXT_ALIGN_RIGHT);
 
+    // Netplay stats overlay, several lines across the screen
+    local->net_stats = create_text_object("");
+    text_set_bounding_box(local->net_stats, 310, 60);
+
     // Arena menu theme
     gui_theme theme;
     gui_theme_defaults(&theme);
@@ -1988,6 +2033,8 @@ int arena_create(scene *scene) {
     scene_set_render_overlay_cb(scene, arena_render_overlay);
     scene_set_debug_cb(scene, arena_debug);
     scene->clone = arena_clone;
+    scene->snapshot = arena_snapshot;
+    scene->restore = arena_restore;
 
     // initialize recording, if we're not doing playback
     if(scene->gs->init_flags->playback == 0) {
@@ -333,6 +333,9 @@ void mechlab_tick(scene *scene, int paused) {
             mechlab_theme(&theme);
             local->frame = gui_frame_create(&theme, 0, 0, 320, 200);
             mechlab_enter_trnselect_menu(scene);
+        } else if(local->dashtype == DASHBOARD_SELECT_TOURNAMENT && lab_dash_trnselect_selected(&local->tw) == NULL) {
+            // Tournament file went missing or broke after the list was made; the error is already logged.
+            game_state_set_next(scene->gs, SCENE_MENU);
         } else if(local->dashtype == DASHBOARD_SELECT_TOURNAMENT) {
             sd_tournament_file *trn = lab_dash_trnselect_selected(&local->tw);
             if(player1->pilot->money < trn->registration_fee) {
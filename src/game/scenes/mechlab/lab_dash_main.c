@@ -47,13 +47,19 @@ bool lab_dash_main_chr_load(component *c, void *userdata) {
     dashboard_widgets *dw = userdata;
     game_player *p1 = game_state_get_player(dw->scene->gs, 0);
 
+    // The list only has the saved characters without their enemies, so load the picked one fully.
+    sg_entry *entry = list_get(dw->savegames, dw->index);
+    sd_chr_file *chr = omf_calloc(1, sizeof(sd_chr_file));
+    if(sg_load(chr, entry->filename) != SD_SUCCESS) {
+        sd_chr_free(chr);
+        omf_free(chr);
+        return false;
+    }
+
     sd_chr_file *oldchr = p1->chr;
-    sd_chr_file *chr = ((sd_chr_file *)list_get(dw->savegames, dw->index));
-    p1->chr = omf_calloc(1, sizeof(sd_chr_file));
-    memcpy(p1->chr, chr, sizeof(sd_chr_file));
+    p1->chr = chr;
 
     assert(oldchr != NULL);
-    assert(oldchr != chr);
     log_debug("Freeing previous CHR %s", oldchr->pilot.name);
     sd_chr_free(oldchr);
     omf_free(oldchr);
@@ -63,15 +69,9 @@ bool lab_dash_main_chr_load(component *c, void *userdata) {
     if(dw->savegames) {
         iterator it;
         list_iter_begin(dw->savegames, &it);
-        sd_chr_file *chr = NULL;
-
-        int16_t i = 0;
-        foreach(it, chr) {
-            if(i != dw->index) {
-                log_debug("Freeing CHR %s", chr->pilot.name);
-                sd_chr_free(chr);
-            }
-            ++i;
+        foreach(it, entry) {
+            log_debug("Freeing CHR %s", entry->chr.pilot.name);
+            sg_entry_free(entry);
         }
 
         list_free(dw->savegames);
@@ -99,7 +99,7 @@ bool lab_dash_main_chr_left(component *c, void *userdata) {
         dw->index = list_size(dw->savegames) - 1;
     }
     game_player *p1 = game_state_get_player(dw->scene->gs, 0);
-    p1->pilot = &((sd_chr_file *)list_get(dw->savegames, dw->index))->pilot;
+    p1->pilot = &((sg_entry *)list_get(dw->savegames, dw->index))->chr.pilot;
     mechlab_update(dw->scene);
     return true;
 }
@@ -112,7 +112,7 @@ bool lab_dash_main_chr_right(component *c, void *userdata) {
         dw->index = 0;
     }
     game_player *p1 = game_state_get_player(dw->scene->gs, 0);
-    p1->pilot = &((sd_chr_file *)list_get(dw->savegames, dw->index))->pilot;
+    p1->pilot = &((sg_entry *)list_get(dw->savegames, dw->index))->chr.pilot;
     mechlab_update(dw->scene);
     return true;
 }
@@ -129,16 +129,16 @@ void lab_dash_main_chr_init(component *menu, component *submenu) {
     iterator it;
     list_iter_begin(dw->savegames, &it);
 
-    sd_chr_file *chr = NULL;
-    foreach(it, chr) {
-        if(p1->chr && strcmp(p1->chr->pilot.name, chr->pilot.name) == 0) {
-            sd_chr_free(chr);
+    sg_entry *entry = NULL;
+    foreach(it, entry) {
+        if(p1->chr && strcmp(p1->chr->pilot.name, entry->chr.pilot.name) == 0) {
+            sg_entry_free(entry);
             list_delete(dw->savegames, &it);
         }
     }
     dw->index = 0;
-    chr = list_get(dw->savegames, 0);
-    p1->pilot = &chr->pilot;
+    entry = list_get(dw->savegames, 0);
+    p1->pilot = &entry->chr.pilot;
     if(!p1->chr) {
         mechlab_load_har(dw->scene, p1->pilot);
     }
@@ -319,7 +319,7 @@ void lab_dash_main_chr_done(component *menu, component *submenu) {
     iterator it;
     game_player *p1 = game_state_get_player(dw->scene->gs, 0);
 
-    sd_chr_file *chr = NULL;
+    sg_entry *entry = NULL;
 
     if(p1->chr) {
         // character is loaded, revert the pilot to it
@@ -333,9 +333,9 @@ void lab_dash_main_chr_done(component *menu, component *submenu) {
 
     if(dw->savegames) {
         list_iter_begin(dw->savegames, &it);
-        foreach(it, chr) {
-            log_debug("freeing CHR %s", chr->pilot.name);
-            sd_chr_free(chr);
+        foreach(it, entry) {
+            log_debug("freeing CHR %s", entry->chr.pilot.name);
+            sg_entry_free(entry);
         }
         list_free(dw->savegames);
         omf_free(dw->savegames);
@@ -541,6 +541,8 @@ void handle_action(scene *scene, int player, int action) {
                     if(player2->pilot->name[strlen(player2->pilot->name) - 1] == '\n') {
                         player2->pilot->name[strlen(player2->pilot->name) - 1] = 0;
                     }
+                    scene_prefetch_har(player1->pilot->har_id);
+                    scene_prefetch_har(player2->pilot->har_id);
                     game_state_set_next(scene->gs, SCENE_VS);
                 }
             }
@@ -386,6 +386,9 @@ int newsroom_create(scene *scene) {
     game_player *p1 = game_state_get_player(scene->gs, 0);
     game_player *p2 = game_state_get_player(scene->gs, 1);
 
+    // The player keeps their HAR for the next fight; the opponent is only known when the news is over.
+    scene_prefetch_har(p1->pilot->har_id);
+
     if(p1->chr && p2->pilot && (p2->pilot->only_fight_once || (p2->pilot->secret && p2->sp_wins == 0))) {
         // We never want to see this pilot again this tournament.
         // TODO figure out how the original disables them from fighting again
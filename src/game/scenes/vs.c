@@ -207,6 +207,7 @@ void vs_handle_action(scene *scene, int action) {
 
                     text_set_from_c(local->arena_name, lang_get(56 + scene->gs->arena));
                     text_set_from_c(local->arena_desc, lang_get(66 + scene->gs->arena));
+                    scene_prefetch(SCENE_ARENA0 + scene->gs->arena);
                 }
                 break;
             case ACT_DOWN:
@@ -221,6 +222,7 @@ void vs_handle_action(scene *scene, int action) {
 
                     text_set_from_c(local->arena_name, lang_get(56 + scene->gs->arena));
                     text_set_from_c(local->arena_desc, lang_get(66 + scene->gs->arena));
+                    scene_prefetch(SCENE_ARENA0 + scene->gs->arena);
                 }
                 break;
         }
@@ -671,6 +673,13 @@ int vs_create(scene *scene) {
         // 1 player mode cycles through the arenas
     }
 
+    // Start loading the fight while the VS screen is up.
+    if(player2->pilot) {
+        scene_prefetch_har(player1->pilot->har_id);
+        scene_prefetch_har(player2->pilot->har_id);
+        scene_prefetch(SCENE_ARENA0 + scene->gs->arena);
+    }
+
     // Insults
     if(player2->pilot && player2->pilot->pilot_id == PILOT_KREISSACK && settings_get()->gameplay.difficulty < 2) {
         // kreissack, but not on Veteran or higher
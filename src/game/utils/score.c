@@ -1,6 +1,8 @@
 #include "game/utils/score.h"
 #include "game/utils/formatting.h"
+#include "game/utils/snapshot.h"
 #include "utils/allocator.h"
+#include "utils/c_array_util.h"
 #include "utils/c_string_util.h"
 #include "utils/log.h"
 #include "video/surface.h"
@@ -338,3 +340,110 @@ int chr_score_clone(chr_score *src, chr_score *dst) {
     }
     return 0;
 }
+
+// The texts themselves are saved separately
+static const snapshot_field score_fields[] = {
+    SNAPSHOT_FIELD(chr_score, score),
+    SNAPSHOT_FIELD(chr_score, rounds),
+    SNAPSHOT_FIELD(chr_score, wins),
+    SNAPSHOT_FIELD(chr_score, health),
+    SNAPSHOT_FIELD(chr_score, x),
+    SNAPSHOT_FIELD(chr_score, y),
+    SNAPSHOT_FIELD(chr_score, direction),
+    SNAPSHOT_FIELD(chr_score, difficulty),
+    SNAPSHOT_FIELD(chr_score, consecutive_hits),
+    SNAPSHOT_FIELD(chr_score, consecutive_hit_score),
+    SNAPSHOT_FIELD(chr_score, combo_hits),
+    SNAPSHOT_FIELD(chr_score, combo_hit_score),
+    SNAPSHOT_FIELD(chr_score, multipliers),
+    SNAPSHOT_FIELD(chr_score, done),
+    SNAPSHOT_FIELD(chr_score, scrap),
+    SNAPSHOT_FIELD(chr_score, destruction),
+};
+
+static const snapshot_field score_text_fields[] = {
+    SNAPSHOT_FIELD(score_text, position),
+    SNAPSHOT_FIELD(score_text, start),
+    SNAPSHOT_FIELD(score_text, points),
+    SNAPSHOT_FIELD(score_text, age),
+};
+
+// Texts are saved with their terminator, so that restoring can use them right from the snapshot
+static void write_text(serial *ser, const text *t) {
+    const char *str = text_c(t);
+    uint32_t len = strlen(str) + 1;
+    serial_write(ser, (const char *)&len, sizeof(len));
+    serial_write(ser, str, len);
+}
+
+static const char *read_text(serial *ser) {
+    uint32_t len;
+    serial_read(ser, (char *)&len, sizeof(len));
+    const char *str = ser->data + ser->rpos;
+    ser->rpos += len;
+    return str;
+}
+
+void chr_score_snapshot(const chr_score *score, serial *ser) {
+    snapshot_write_fields(ser, score, score_fields, N_ELEMENTS(score_fields));
+    write_text(ser, score->total);
+
+    iterator it;
+    score_text *t;
+    uint32_t count = list_size(&score->texts);
+    serial_write(ser, (const char *)&count, sizeof(count));
+    list_iter_begin(&score->texts, &it);
+    foreach(it, t) {
+        snapshot_write_fields(ser, t, score_text_fields, N_ELEMENTS(score_text_fields));
+        write_text(ser, t->text);
+    }
+}
+
+void chr_score_restore(chr_score *score, serial *ser) {
+    snapshot_read_fields(ser, score, score_fields, N_ELEMENTS(score_fields));
+
+    const char *str = read_text(ser);
+    if(strcmp(str, text_c(score->total)) != 0) {
+        text_set_from_c(score->total, str);
+    }
+
+    // Texts that are still sliding are usually the same ones as before, so keep them if possible
+    uint32_t count;
+    serial_read(ser, (char *)&count, sizeof(count));
+    size_t start = ser->rpos;
+    bool same = count == list_size(&score->texts);
+    iterator it;
+    score_text *t;
+    list_iter_begin(&score->texts, &it);
+    for(uint32_t i = 0; same && i < count; i++) {
+        score_text s;
+        t = iter_next(&it);
+        snapshot_read_fields(ser, &s, score_text_fields, N_ELEMENTS(score_text_fields));
+        str = read_text(ser);
+        if(s.points != t->points || strcmp(str, text_c(t->text)) != 0) {
+            same = false;
+        }
+    }
+
+    ser->rpos = start;
+    if(same) {
+        list_iter_begin(&score->texts, &it);
+        foreach(it, t) {
+            snapshot_read_fields(ser, t, score_text_fields, N_ELEMENTS(score_text_fields));
+            read_text(ser);
+        }
+        return;
+    }
+
+    list_iter_begin(&score->texts, &it);
+    foreach(it, t) {
+        text_free(&t->text);
+        list_delete(&score->texts, &it);
+    }
+    for(uint32_t i = 0; i < count; i++) {
+        score_text s;
+        snapshot_read_fields(ser, &s, score_text_fields, N_ELEMENTS(score_text_fields));
+        s.text = create_text_obj(read_text(ser));
+        list_append(&score->texts, &s, sizeof(score_text));
+    }
+}
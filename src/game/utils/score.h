@@ -3,6 +3,7 @@
 
 #include "game/gui/text/text.h"
 #include "game/protos/object.h"
+#include "game/utils/serial.h"
 #include "utils/list.h"
 #include "video/surface.h"
 #include <stdbool.h>
@@ -61,5 +62,7 @@ int chr_score_end_combo(chr_score *score, vec2i pos);
 int chr_score_interrupt(chr_score *score, vec2i pos);
 
 int chr_score_clone(chr_score *src, chr_score *dst);
+void chr_score_snapshot(const chr_score *score, serial *ser);
+void chr_score_restore(chr_score *score, serial *ser);
 
 #endif // SCORE_H
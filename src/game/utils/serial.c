@@ -98,6 +98,12 @@ void serial_free(serial *s) {
     s->wpos = 0;
 }
 
+// Drop the contents but keep the buffer, so that it can be refilled without reallocating
+void serial_reset(serial *s) {
+    s->rpos = 0;
+    s->wpos = 0;
+}
+
 size_t serial_len(serial *s) {
     return s->wpos;
 }
@@ -22,6 +22,7 @@ void serial_write_float(serial *s, float v);
 size_t serial_len(serial *s);
 void serial_read(serial *s, char *buf, size_t len);
 void serial_free(serial *s);
+void serial_reset(serial *s);
 void serial_read_reset(serial *s);
 int8_t serial_read_int8(serial *s);
 int16_t serial_read_int16(serial *s);
@@ -152,6 +152,7 @@ const field f_net[] = {
     F_STRING(settings_network, net_lobby_address, "lobby.openomf.org"),
     F_STRING(settings_network, net_username, ""),
     F_STRING(settings_network, trace_file, NULL),
+    F_STRING(settings_network, net_stats_file, NULL),
     F_INT(settings_network, net_connect_port, 2097),
     F_INT(settings_network, net_listen_port_start, 0),
     F_INT(settings_network, net_listen_port_end, 0),
@@ -115,6 +115,7 @@ typedef struct {
     char *net_connect_ip;
     char *net_lobby_address;
     char *trace_file;
+    char *net_stats_file;
     char *net_username;
     int net_connect_port;
     int net_listen_port_start;
@@ -0,0 +1,112 @@
+#include "game/utils/snapshot.h"
+#include "utils/iterator.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *section_names[] = {"game state", "sounds", "player", "scene", "object"};
+
+void snapshot_create(snapshot *snap) {
+    serial_create(&snap->data);
+    vector_create(&snap->sections, sizeof(snapshot_section));
+    vector_create(&snap->scratch, sizeof(void *));
+    snap->tick = 0;
+    snap->int_tick = 0;
+    snap->valid = false;
+}
+
+void snapshot_free(snapshot *snap) {
+    serial_free(&snap->data);
+    vector_free(&snap->sections);
+    vector_free(&snap->scratch);
+    snap->valid = false;
+}
+
+void snapshot_clear(snapshot *snap) {
+    serial_reset(&snap->data);
+    vector_clear(&snap->sections);
+    snap->valid = false;
+}
+
+void snapshot_begin_section(snapshot *snap, uint8_t kind, uint32_t id) {
+    snapshot_section *section = vector_append_ptr(&snap->sections);
+    section->kind = kind;
+    section->id = id;
+    section->offset = serial_len(&snap->data);
+    section->size = 0;
+}
+
+void snapshot_end_section(snapshot *snap) {
+    snapshot_section *section = vector_back(&snap->sections);
+    section->size = serial_len(&snap->data) - section->offset;
+}
+
+const snapshot_section *snapshot_find_section(const snapshot *snap, uint8_t kind, uint32_t id) {
+    iterator it;
+    snapshot_section *section;
+    vector_iter_begin(&snap->sections, &it);
+    foreach(it, section) {
+        if(section->kind == kind && section->id == id) {
+            return section;
+        }
+    }
+    return NULL;
+}
+
+const char *snapshot_section_data(const snapshot *snap, const snapshot_section *section) {
+    return snap->data.data + section->offset;
+}
+
+size_t snapshot_size(const snapshot *snap) {
+    return snap->data.wpos;
+}
+
+void snapshot_write_fields(serial *ser, const void *src, const snapshot_field *fields, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        serial_write(ser, (const char *)src + fields[i].offset, fields[i].size);
+    }
+}
+
+// Members that are not in the list are left as they are
+void snapshot_read_fields(serial *ser, void *dst, const snapshot_field *fields, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        serial_read(ser, (char *)dst + fields[i].offset, fields[i].size);
+    }
+}
+
+bool snapshot_diff(const snapshot *a, const snapshot *b, char *buf, size_t len) {
+    iterator it;
+    snapshot_section *section;
+
+    vector_iter_begin(&a->sections, &it);
+    foreach(it, section) {
+        const snapshot_section *other = snapshot_find_section(b, section->kind, section->id);
+        if(other == NULL) {
+            snprintf(buf, len, "%s %u only exists in the first snapshot", section_names[section->kind], section->id);
+            return true;
+        }
+        const char *data_a = snapshot_section_data(a, section);
+        const char *data_b = snapshot_section_data(b, other);
+        uint32_t size = section->size < other->size ? section->size : other->size;
+        for(uint32_t i = 0; i < size; i++) {
+            if(data_a[i] != data_b[i]) {
+                snprintf(buf, len, "%s %u differs at byte %u", section_names[section->kind], section->id, i);
+                return true;
+            }
+        }
+        if(section->size != other->size) {
+            snprintf(buf, len, "%s %u has size %u vs %u", section_names[section->kind], section->id, section->size,
+                     other->size);
+            return true;
+        }
+    }
+
+    vector_iter_begin(&b->sections, &it);
+    foreach(it, section) {
+        if(snapshot_find_section(a, section->kind, section->id) == NULL) {
+            snprintf(buf, len, "%s %u only exists in the second snapshot", section_names[section->kind],
+                     section->id);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,71 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "game/utils/serial.h"
+#include "utils/vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum
+{
+    SNAPSHOT_SECTION_STATE = 0,
+    SNAPSHOT_SECTION_SOUNDS,
+    SNAPSHOT_SECTION_PLAYER,
+    SNAPSHOT_SECTION_SCENE,
+    SNAPSHOT_SECTION_OBJECT,
+};
+
+/*
+ * A struct member that is saved in snapshots. Structs are saved member by member, so that padding and pointers
+ * to memory the struct owns never end up in a snapshot, and equal states give equal snapshots. Pointers are only
+ * saved when they refer to code or to loaded resources, which stay the same while the snapshots are in use.
+ */
+typedef struct snapshot_field_t {
+    uint32_t offset;
+    uint32_t size;
+} snapshot_field;
+
+#define SNAPSHOT_FIELD(type, member) {offsetof(type, member), sizeof(((type *)0)->member)}
+
+typedef struct snapshot_section_t {
+    uint8_t kind;
+    uint32_t id;
+    uint32_t offset;
+    uint32_t size;
+} snapshot_section;
+
+/*
+ * Simulation state serialized into one flat buffer. The buffers are kept between saves,
+ * so once they have grown to fit a fight, saving a snapshot does not allocate.
+ */
+typedef struct snapshot_t {
+    serial data;
+    vector sections; // snapshot_section, one per state, player, scene and object
+    vector scratch;  // void pointers, working space while restoring
+    uint32_t tick;
+    uint32_t int_tick;
+    bool valid;
+} snapshot;
+
+void snapshot_create(snapshot *snap);
+void snapshot_free(snapshot *snap);
+void snapshot_clear(snapshot *snap);
+
+void snapshot_begin_section(snapshot *snap, uint8_t kind, uint32_t id);
+void snapshot_end_section(snapshot *snap);
+const snapshot_section *snapshot_find_section(const snapshot *snap, uint8_t kind, uint32_t id);
+const char *snapshot_section_data(const snapshot *snap, const snapshot_section *section);
+
+size_t snapshot_size(const snapshot *snap);
+
+void snapshot_write_fields(serial *ser, const void *src, const snapshot_field *fields, size_t count);
+void snapshot_read_fields(serial *ser, void *dst, const snapshot_field *fields, size_t count);
+
+/**
+ * Compare two snapshots section by section.
+ * @return true if they differ. The first difference found is described in buf.
+ */
+bool snapshot_diff(const snapshot *a, const snapshot *b, char *buf, size_t len);
+
+#endif // SNAPSHOT_H
@@ -1,5 +1,9 @@
 #include "game/utils/ticktimer.h"
+#include "game/utils/snapshot.h"
+#include "utils/c_array_util.h"
+#include "utils/iterator.h"
 #include "utils/vector.h"
+#include <stdint.h>
 #include <stdlib.h>
 
 typedef struct {
@@ -47,3 +51,29 @@ void ticktimer_clone(ticktimer *src, ticktimer *dst) {
         vector_append(&dst->units, unit);
     }
 }
+
+static const snapshot_field unit_fields[] = {
+    SNAPSHOT_FIELD(ticktimer_unit, callback),
+    SNAPSHOT_FIELD(ticktimer_unit, ticks),
+    SNAPSHOT_FIELD(ticktimer_unit, userdata),
+};
+
+void ticktimer_snapshot(const ticktimer *tt, serial *ser) {
+    iterator it;
+    ticktimer_unit *unit;
+    uint32_t count = vector_size(&tt->units);
+    serial_write(ser, (const char *)&count, sizeof(count));
+    vector_iter_begin(&tt->units, &it);
+    foreach(it, unit) {
+        snapshot_write_fields(ser, unit, unit_fields, N_ELEMENTS(unit_fields));
+    }
+}
+
+void ticktimer_restore(ticktimer *tt, serial *ser) {
+    uint32_t count;
+    serial_read(ser, (char *)&count, sizeof(count));
+    vector_clear(&tt->units);
+    for(uint32_t i = 0; i < count; i++) {
+        snapshot_read_fields(ser, vector_append_ptr(&tt->units), unit_fields, N_ELEMENTS(unit_fields));
+    }
+}
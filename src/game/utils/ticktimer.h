@@ -1,6 +1,7 @@
 #ifndef TICKTIMER_H
 #define TICKTIMER_H
 
+#include "game/utils/serial.h"
 #include "utils/vector.h"
 
 typedef struct ticktimer_t {
@@ -15,5 +16,7 @@ void ticktimer_run(ticktimer *tt, void *scenedata);
 void ticktimer_close(ticktimer *tt);
 
 void ticktimer_clone(ticktimer *src, ticktimer *dst);
+void ticktimer_snapshot(const ticktimer *tt, serial *ser);
+void ticktimer_restore(ticktimer *tt, serial *ser);
 
 #endif // TICKTIMER_H
@@ -3,7 +3,7 @@
 #include "resources/sprite.h"
 #include <string.h>
 
-void af_create(af *a, void *src) {
+void af_create(af *a, void *src, sprite_pixels *pixels) {
     sd_af_file *sdaf = (sd_af_file *)src;
 
     // Trivial stuff
@@ -31,7 +31,7 @@ void af_create(af *a, void *src) {
     for(int i = 0; i < 70; i++) {
         if(sdaf->moves[i] != NULL) {
             af_move *move = omf_calloc(1, sizeof(af_move));
-            af_move_create(move, &a->sprites, (void *)sdaf->moves[i], i);
+            af_move_create(move, &a->sprites, (void *)sdaf->moves[i], i, pixels);
             array_set(&a->moves, i, move);
         }
     }
@@ -41,6 +41,34 @@ af_move *af_get_move(const af *a, int id) {
     return array_get(&a->moves, id);
 }
 
+int af_clone(af *src, af *dst) {
+    dst->id = src->id;
+    dst->endurance = src->endurance;
+    dst->health = src->health;
+    dst->forward_speed = src->forward_speed;
+    dst->reverse_speed = src->reverse_speed;
+    dst->jump_speed = src->jump_speed;
+    dst->fall_speed = src->fall_speed;
+    memcpy(dst->sound_translation_table, src->sound_translation_table, 30);
+
+    array_create(&dst->moves);
+    // The sprite table is only needed while creating the animations.
+    array_create(&dst->sprites);
+
+    hashmap surfaces;
+    hashmap_create(&surfaces);
+    iterator it;
+    af_move *move = NULL;
+    array_iter_begin(&src->moves, &it);
+    foreach(it, move) {
+        af_move *copy = omf_calloc(1, sizeof(af_move));
+        af_move_clone(move, copy, &surfaces);
+        array_set(&dst->moves, move->id, copy);
+    }
+    hashmap_free(&surfaces);
+    return 0;
+}
+
 void af_free(af *a) {
     iterator it;
     af_move *move = NULL;
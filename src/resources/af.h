@@ -18,8 +18,16 @@ typedef struct af_t {
     char sound_translation_table[30];
 } af;
 
-void af_create(af *a, void *src);
+/**
+ * Create an AF from an sd_af_file. pixels may hold the sprites decoded ahead of time, or be NULL.
+ */
+void af_create(af *a, void *src, sprite_pixels *pixels);
 af_move *af_get_move(const af *a, int id);
+
+/**
+ * Make a deep copy of an AF, for a HAR that is free to change it. Surfaces shared between sprites stay shared.
+ */
+int af_clone(af *src, af *dst);
 void af_free(af *a);
 
 #endif // AF_H
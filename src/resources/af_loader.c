@@ -1,6 +1,7 @@
 #include "resources/af_loader.h"
 #include "formats/af.h"
 #include "formats/error.h"
+#include "resources/asset_pack.h"
 #include "resources/pathmanager.h"
 
 int load_af_file(af *a, int id) {
@@ -17,8 +18,10 @@ int load_af_file(af *a, int id) {
         return 1;
     }
 
-    // Convert
-    af_create(a, &tmp);
+    // Convert, with the sprites from the resource pack if it has them
+    sprite_pixels pixels;
+    bool packed = asset_pack_get_pixels(filename, &pixels);
+    af_create(a, &tmp, packed ? &pixels : NULL);
     sd_af_free(&tmp);
     return 0;
 }
@@ -1,7 +1,8 @@
 #include "resources/af_move.h"
 #include "formats/move.h"
+#include <string.h>
 
-void af_move_create(af_move *move, array *sprites, void *src, int id) {
+void af_move_create(af_move *move, array *sprites, void *src, int id, sprite_pixels *pixels) {
     sd_move *sdmv = (sd_move *)src;
     str_from_c(&move->move_string, sdmv->move_string);
     str_from_c(&move->footer_string, sdmv->footer_string);
@@ -18,13 +19,20 @@ void af_move_create(af_move *move, array *sprites, void *src, int id) {
     move->pos_constraints = sdmv->pos_constraint;
     move->throw_duration = sdmv->throw_duration;
     move->extra_string_selector = sdmv->extra_string_selector;
-    animation_create(&move->ani, sprites, sdmv->animation, id);
+    animation_create(&move->ani, sprites, sdmv->animation, id, pixels);
     if(id == ANIM_JUMPING) {
         // fixup the jump coordinates
         animation_fixup_coordinates(&move->ani, 0, JUMP_COORD_ADJUSTMENT * -1);
     }
 }
 
+int af_move_clone(af_move *src, af_move *dst, hashmap *surfaces) {
+    memcpy(dst, src, sizeof(af_move));
+    str_from(&dst->move_string, &src->move_string);
+    str_from(&dst->footer_string, &src->footer_string);
+    return animation_clone_shared(&src->ani, &dst->ani, surfaces);
+}
+
 void af_move_free(af_move *move) {
     animation_free(&move->ani);
     str_free(&move->move_string);
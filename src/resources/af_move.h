@@ -29,7 +29,8 @@ typedef struct af_move_t {
 #endif
 } af_move;
 
-void af_move_create(af_move *move, array *sprites, void *src, int id);
+void af_move_create(af_move *move, array *sprites, void *src, int id, sprite_pixels *pixels);
+int af_move_clone(af_move *src, af_move *dst, hashmap *surfaces);
 void af_move_free(af_move *move);
 
 #endif // AF_MOVE_H
@@ -1,19 +1,34 @@
 #include "resources/animation.h"
 #include "formats/animation.h"
+#include "formats/error.h"
 #include "utils/allocator.h"
+#include "utils/log.h"
 #include <stdlib.h>
+#include <string.h>
 
 typedef struct sprite_reference_t {
     sprite *sprite;
 } sprite_reference;
 
-void animation_create(animation *ani, array *sprites, void *src, int id) {
+// Decodes the animation string once, so that objects switching to this animation don't need to.
+static void animation_decode_string(animation *ani) {
+    int err_pos;
+    sd_script_create(&ani->script);
+    int ret = sd_script_decode(&ani->script, str_c(&ani->animation_string), &err_pos);
+    if(ret != SD_SUCCESS) {
+        log_error("Decoder error %s at position %d in string \"%s\"", sd_get_error(ret), err_pos,
+                  str_c(&ani->animation_string));
+    }
+}
+
+void animation_create(animation *ani, array *sprites, void *src, int id, sprite_pixels *pixels) {
     sd_animation *sdani = (sd_animation *)src;
 
     // Copy simple stuff
     ani->id = id;
     ani->start_pos = vec2i_create(sdani->start_x, sdani->start_y);
     str_from_c(&ani->animation_string, sdani->anim_string);
+    animation_decode_string(ani);
 
     // Copy collision coordinates
     vector_create_with_size(&ani->collision_coords, sizeof(collision_coord), sdani->coord_count);
@@ -35,8 +50,14 @@ void animation_create(animation *ani, array *sprites, void *src, int id) {
         // inside it, which vector_append does not copy
     }
 
-    // Handle sprites
+    // Handle sprites. Unless they come decoded from the resource pack, decode them all in one go.
     vector_create_with_size(&ani->sprites, sizeof(sprite_reference), sdani->sprite_count);
+    sd_vga_image *decoded = NULL;
+    char *decoded_arena = NULL;
+    if(pixels == NULL && sdani->sprite_count > 0) {
+        decoded = omf_calloc(sdani->sprite_count, sizeof(sd_vga_image));
+        sd_sprite_vga_decode_batch(decoded, sdani->sprites, sdani->sprite_count, &decoded_arena);
+    }
     sprite *tmp_sprite;
     for(int i = 0; i < sdani->sprite_count; i++) {
         if(sdani->sprites[i]->missing) {
@@ -49,7 +70,11 @@ void animation_create(animation *ani, array *sprites, void *src, int id) {
             vector_append(&ani->sprites, &spr);
         } else {
             tmp_sprite = omf_calloc(1, sizeof(sprite));
-            sprite_create(tmp_sprite, (void *)sdani->sprites[i], i);
+            if(decoded != NULL) {
+                sprite_create_from_vga(tmp_sprite, (void *)sdani->sprites[i], i, &decoded[i]);
+            } else {
+                sprite_create_from_pixels(tmp_sprite, (void *)sdani->sprites[i], i, pixels);
+            }
             sprite_reference spr;
             spr.sprite = tmp_sprite;
             if(sdani->sprites[i]->index) {
@@ -59,6 +84,8 @@ void animation_create(animation *ani, array *sprites, void *src, int id) {
             vector_append(&ani->sprites, &spr);
         }
     }
+    omf_free(decoded);
+    omf_free(decoded_arena);
 }
 
 animation *create_animation_from_single(sprite *sp, vec2i pos) {
@@ -66,6 +93,7 @@ animation *create_animation_from_single(sprite *sp, vec2i pos) {
     a->start_pos = pos;
     a->id = -1;
     str_from_c(&a->animation_string, "A9999999999");
+    animation_decode_string(a);
     vector_create_with_size(&a->collision_coords, sizeof(collision_coord), 0);
     vector_create_with_size(&a->extra_strings, sizeof(str), 0);
     vector_create_with_size(&a->sprites, sizeof(sprite_reference), 1);
@@ -75,10 +103,32 @@ animation *create_animation_from_single(sprite *sp, vec2i pos) {
     return a;
 }
 
-int animation_clone(animation *src, animation *dst) {
+/**
+ * Copy a sprite so that sprites sharing a surface in the source also share the copy. The sprite that owns the
+ * surface in the source owns the copy, whichever of them gets here first.
+ */
+static sprite *sprite_clone_shared(const sprite *src, hashmap *surfaces) {
+    sprite *new = omf_calloc(1, sizeof(sprite));
+    memcpy(new, src, sizeof(sprite));
+    if(src->data == NULL) {
+        return new;
+    }
+    surface **copy;
+    if(hashmap_get(surfaces, &src->data, sizeof(surface *), (void **)&copy, NULL) == 0) {
+        new->data = *copy;
+        return new;
+    }
+    new->data = omf_calloc(1, sizeof(surface));
+    surface_create_from(new->data, src->data);
+    hashmap_put(surfaces, &src->data, sizeof(surface *), &new->data, sizeof(surface *));
+    return new;
+}
+
+static int animation_clone_with(animation *src, animation *dst, hashmap *surfaces) {
     iterator it;
     memcpy(dst, src, sizeof(animation));
     str_from(&dst->animation_string, &src->animation_string);
+    sd_script_clone(&src->script, &dst->script);
     vector_create_with_size(&dst->collision_coords, sizeof(collision_coord), vector_size(&src->collision_coords));
     vector_iter_begin(&src->collision_coords, &it);
     collision_coord *tmp_coord = NULL;
@@ -99,13 +149,21 @@ int animation_clone(animation *src, animation *dst) {
     sprite_reference *spr = NULL;
     foreach(it, spr) {
         sprite_reference spr_clone;
-        spr_clone.sprite = sprite_copy(spr->sprite);
+        spr_clone.sprite = surfaces ? sprite_clone_shared(spr->sprite, surfaces) : sprite_copy(spr->sprite);
         vector_append(&dst->sprites, &spr_clone);
     }
 
     return 0;
 }
 
+int animation_clone(animation *src, animation *dst) {
+    return animation_clone_with(src, dst, NULL);
+}
+
+int animation_clone_shared(animation *src, animation *dst, hashmap *surfaces) {
+    return animation_clone_with(src, dst, surfaces);
+}
+
 void animation_fixup_coordinates(animation *ani, int fix_x, int fix_y) {
     iterator it;
     sprite_reference *spr;
@@ -136,11 +194,18 @@ int animation_get_sprite_count(animation *ani) {
     return vector_size(&ani->sprites);
 }
 
+void animation_set_string(animation *ani, const char *str) {
+    str_set_c(&ani->animation_string, str);
+    sd_script_free(&ani->script);
+    animation_decode_string(ani);
+}
+
 void animation_free(animation *ani) {
     iterator it;
 
     // Free animation string
     str_free(&ani->animation_string);
+    sd_script_free(&ani->script);
 
     // Free collision coordinates
     vector_free(&ani->collision_coords);
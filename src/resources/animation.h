@@ -1,8 +1,10 @@
 #ifndef ANIMATION_H
 #define ANIMATION_H
 
+#include "formats/script.h"
 #include "resources/sprite.h"
 #include "utils/array.h"
+#include "utils/hashmap.h"
 #include "utils/str.h"
 #include "utils/vec.h"
 #include "utils/vector.h"
@@ -41,20 +43,37 @@ typedef struct animation_t {
     vec2i start_pos;
     vector collision_coords;
     str animation_string;
+    sd_script script; // animation_string decoded, shared by every object playing this animation
     uint8_t extra_string_count;
     vector extra_strings;
     vector sprites;
 } animation;
 
-void animation_create(animation *ani, array *sprites, void *src, int id);
+/**
+ * Create an animation from an sd_animation. Sprites are taken from pixels when it is not NULL; see
+ * sprite_create_from_pixels.
+ */
+void animation_create(animation *ani, array *sprites, void *src, int id, sprite_pixels *pixels);
 sprite *animation_get_sprite(animation *ani, int sprite_id);
 void animation_free(animation *ani);
 
 int animation_get_sprite_count(animation *ani);
 
+/**
+ * Replace the animation string, and decode it again.
+ */
+void animation_set_string(animation *ani, const char *str);
+
 animation *create_animation_from_single(sprite *sp, vec2i pos);
 void animation_fixup_coordinates(animation *ani, int fix_x, int fix_y);
 
 int animation_clone(animation *src, animation *dst);
 
+/**
+ * Clone an animation, keeping surfaces that are shared between sprites shared in the clone too. Surfaces that were
+ * already copied by an earlier call with the same map are reused, so the animations of one BK or AF file can be
+ * cloned one by one. The map is keyed by the source surface pointer and holds the copied surface pointer.
+ */
+int animation_clone_shared(animation *src, animation *dst, hashmap *surfaces);
+
 #endif // ANIMATION_H
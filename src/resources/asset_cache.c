@@ -0,0 +1,415 @@
+#include "resources/asset_cache.h"
+#include "resources/af_loader.h"
+#include "resources/bk_loader.h"
+#include "resources/ids.h"
+#include "resources/pathmanager.h"
+#include "utils/hashmap.h"
+#include "utils/log.h"
+
+#include <SDL_mutex.h>
+#include <SDL_thread.h>
+#include <assert.h>
+#include <string.h>
+
+#define ASSET_CACHE_MAX_BYTES (48 * 1024 * 1024)
+
+typedef enum asset_type
+{
+    ASSET_NONE = 0,
+    ASSET_BK,
+    ASSET_AF,
+} asset_type;
+
+typedef enum prefetch_state
+{
+    PREFETCH_NONE = 0,
+    PREFETCH_QUEUED,
+    PREFETCH_RUNNING,
+    PREFETCH_DONE,
+} prefetch_state;
+
+typedef union asset_data {
+    bk bk;
+    af af;
+} asset_data;
+
+typedef struct cached_asset {
+    asset_type type;
+    asset_data data;
+    size_t bytes;
+    unsigned refs;
+    unsigned last_use;
+
+    // Shared with the loader thread; only touched while holding loader.lock.
+    prefetch_state prefetch;
+    asset_type prefetch_type;
+    asset_data prefetched;
+} cached_asset;
+
+/**
+ * Background loader for asset_cache_prefetch_*. Finished files wait in their cache slot until the main thread
+ * picks them up, since the rest of the cache is only ever touched by the main thread.
+ */
+typedef struct asset_loader {
+    SDL_Thread *thread;
+    SDL_mutex *lock;
+    SDL_cond *work; // Signaled when a job is queued, or when closing
+    SDL_cond *done; // Signaled when a job is finished
+    int queue[NUMBER_OF_RESOURCES];
+    int head;
+    int count;
+    bool closing;
+    bool failed; // The thread could not be started; everything is loaded synchronously
+} asset_loader;
+
+// Resource ids are small and fixed, so a plain table does the job.
+static cached_asset assets[NUMBER_OF_RESOURCES];
+static asset_loader loader;
+static size_t cache_bytes = 0;
+static unsigned use_counter = 0;
+static unsigned hits = 0;
+static unsigned misses = 0;
+static unsigned drops = 0;
+static unsigned prefetched = 0;
+static unsigned waits = 0;
+
+/**
+ * Rough size of an animation in memory. Surfaces shared between sprites are only counted once.
+ */
+static size_t animation_bytes(animation *ani, hashmap *seen) {
+    size_t bytes = sizeof(animation);
+    void *found;
+    for(int i = 0; i < animation_get_sprite_count(ani); i++) {
+        sprite *sp = animation_get_sprite(ani, i);
+        bytes += sizeof(sprite);
+        if(sp->data != NULL && hashmap_get(seen, &sp->data, sizeof(surface *), &found, NULL) != 0) {
+            hashmap_put(seen, &sp->data, sizeof(surface *), &sp->data, sizeof(surface *));
+            bytes += sizeof(surface) + (size_t)sp->data->w * sp->data->h;
+        }
+    }
+    return bytes;
+}
+
+static size_t bk_bytes(bk *b) {
+    size_t bytes = sizeof(bk) + (size_t)b->background.w * b->background.h;
+    bytes += vector_size(&b->palettes) * (sizeof(vga_palette) + sizeof(vga_remap_tables));
+
+    hashmap seen;
+    hashmap_create(&seen);
+    iterator it;
+    hashmap_iter_begin(&b->infos, &it);
+    hashmap_pair *pair = NULL;
+    foreach(it, pair) {
+        bytes += sizeof(bk_info) + animation_bytes(&((bk_info *)pair->value)->ani, &seen);
+    }
+    hashmap_free(&seen);
+    return bytes;
+}
+
+static size_t af_bytes(af *a) {
+    size_t bytes = sizeof(af);
+
+    hashmap seen;
+    hashmap_create(&seen);
+    iterator it;
+    array_iter_begin(&a->moves, &it);
+    af_move *move = NULL;
+    foreach(it, move) {
+        bytes += sizeof(af_move) + animation_bytes(&move->ani, &seen);
+    }
+    hashmap_free(&seen);
+    return bytes;
+}
+
+static void free_asset_data(asset_data *data, asset_type type) {
+    switch(type) {
+        case ASSET_BK:
+            bk_free(&data->bk);
+            break;
+        case ASSET_AF:
+            af_free(&data->af);
+            break;
+        case ASSET_NONE:
+            break;
+    }
+}
+
+static void drop_asset(cached_asset *asset) {
+    if(asset->type == ASSET_NONE) {
+        return;
+    }
+    free_asset_data(&asset->data, asset->type);
+    cache_bytes -= asset->bytes;
+    // The prefetch fields belong to the loader, so leave them be.
+    asset->type = ASSET_NONE;
+    asset->bytes = 0;
+    asset->refs = 0;
+    asset->last_use = 0;
+}
+
+/**
+ * Drop the least recently used unreferenced files until the cache fits in its budget again, or until only files
+ * that are in use are left.
+ */
+static void trim_cache(void) {
+    while(cache_bytes > ASSET_CACHE_MAX_BYTES) {
+        cached_asset *oldest = NULL;
+        for(int i = 0; i < NUMBER_OF_RESOURCES; i++) {
+            cached_asset *asset = &assets[i];
+            if(asset->type != ASSET_NONE && asset->refs == 0 &&
+               (oldest == NULL || asset->last_use < oldest->last_use)) {
+                oldest = asset;
+            }
+        }
+        if(oldest == NULL) {
+            return;
+        }
+        log_debug("Dropping %s from the asset cache", get_resource_name(oldest - assets));
+        drop_asset(oldest);
+        drops++;
+    }
+}
+
+/**
+ * Load and decode a file. Safe to call from the loader thread.
+ * @return true if the file was loaded.
+ */
+static bool load_asset_data(asset_data *data, asset_type type, int resource_id) {
+    if(type == ASSET_BK) {
+        return load_bk_file(&data->bk, pm_get_resource_path(resource_id)) == 0;
+    }
+    return load_af_file(&data->af, resource_id) == 0;
+}
+
+static void add_asset(cached_asset *asset, asset_data *data, asset_type type) {
+    asset->type = type;
+    asset->data = *data;
+    asset->bytes = (type == ASSET_BK) ? bk_bytes(&asset->data.bk) : af_bytes(&asset->data.af);
+    asset->last_use = ++use_counter;
+    cache_bytes += asset->bytes;
+}
+
+static int loader_thread(void *userdata) {
+    SDL_LockMutex(loader.lock);
+    while(true) {
+        while(loader.count == 0 && !loader.closing) {
+            SDL_CondWait(loader.work, loader.lock);
+        }
+        if(loader.closing) {
+            break; // Whatever is still queued is dropped.
+        }
+        int resource_id = loader.queue[loader.head];
+        loader.head = (loader.head + 1) % NUMBER_OF_RESOURCES;
+        loader.count--;
+        cached_asset *asset = &assets[resource_id];
+        if(asset->prefetch != PREFETCH_QUEUED) {
+            continue; // Cancelled by the main thread.
+        }
+        asset->prefetch = PREFETCH_RUNNING;
+        asset_type type = asset->prefetch_type;
+
+        // Don't hold the lock while loading, so that the main thread can keep queueing.
+        SDL_UnlockMutex(loader.lock);
+        asset_data data;
+        bool loaded = load_asset_data(&data, type, resource_id);
+        SDL_LockMutex(loader.lock);
+
+        if(loaded) {
+            asset->prefetched = data;
+            asset->prefetch = PREFETCH_DONE;
+        } else {
+            asset->prefetch = PREFETCH_NONE;
+        }
+        SDL_CondBroadcast(loader.done);
+    }
+    SDL_UnlockMutex(loader.lock);
+    return 0;
+}
+
+static bool start_loader(void) {
+    if(loader.thread != NULL) {
+        return true;
+    }
+    if(loader.failed) {
+        return false;
+    }
+    loader.lock = SDL_CreateMutex();
+    loader.work = SDL_CreateCond();
+    loader.done = SDL_CreateCond();
+    if(loader.lock != NULL && loader.work != NULL && loader.done != NULL) {
+        loader.thread = SDL_CreateThread(loader_thread, "asset loader", NULL);
+    }
+    if(loader.thread == NULL) {
+        log_warn("Unable to start asset loader thread, assets are loaded when needed: %s", SDL_GetError());
+        loader.failed = true;
+        return false;
+    }
+    return true;
+}
+
+static void stop_loader(void) {
+    if(loader.thread != NULL) {
+        SDL_LockMutex(loader.lock);
+        loader.closing = true;
+        SDL_CondSignal(loader.work);
+        SDL_UnlockMutex(loader.lock);
+        SDL_WaitThread(loader.thread, NULL);
+    }
+    for(int i = 0; i < NUMBER_OF_RESOURCES; i++) {
+        cached_asset *asset = &assets[i];
+        if(asset->prefetch == PREFETCH_DONE) {
+            free_asset_data(&asset->prefetched, asset->prefetch_type);
+        }
+        asset->prefetch = PREFETCH_NONE;
+    }
+    if(loader.done != NULL) {
+        SDL_DestroyCond(loader.done);
+    }
+    if(loader.work != NULL) {
+        SDL_DestroyCond(loader.work);
+    }
+    if(loader.lock != NULL) {
+        SDL_DestroyMutex(loader.lock);
+    }
+    memset(&loader, 0, sizeof(asset_loader));
+}
+
+/**
+ * Move files that the loader thread has finished into the cache. Must hold loader.lock.
+ */
+static void adopt_prefetched(void) {
+    for(int i = 0; i < NUMBER_OF_RESOURCES; i++) {
+        cached_asset *asset = &assets[i];
+        if(asset->prefetch == PREFETCH_DONE) {
+            add_asset(asset, &asset->prefetched, asset->prefetch_type);
+            asset->prefetch = PREFETCH_NONE;
+            prefetched++;
+        }
+    }
+}
+
+/**
+ * Get a prefetched file into the cache, if there is one for this resource. A job that has not started yet is
+ * cancelled, since loading right here is no slower. A job that is running is waited for.
+ */
+static void finish_prefetch(int resource_id) {
+    if(loader.thread == NULL) {
+        return;
+    }
+    cached_asset *asset = &assets[resource_id];
+    SDL_LockMutex(loader.lock);
+    if(asset->prefetch == PREFETCH_QUEUED) {
+        asset->prefetch = PREFETCH_NONE;
+    }
+    if(asset->prefetch == PREFETCH_RUNNING) {
+        waits++;
+        while(asset->prefetch == PREFETCH_RUNNING) {
+            SDL_CondWait(loader.done, loader.lock);
+        }
+    }
+    adopt_prefetched();
+    SDL_UnlockMutex(loader.lock);
+}
+
+static void prefetch_asset(int resource_id, asset_type type) {
+    assert(resource_id >= 0 && resource_id < NUMBER_OF_RESOURCES);
+    cached_asset *asset = &assets[resource_id];
+    if(asset->type != ASSET_NONE) {
+        // Already here; make sure it is not the next one to go.
+        asset->last_use = ++use_counter;
+        return;
+    }
+    if(!start_loader()) {
+        return;
+    }
+    SDL_LockMutex(loader.lock);
+    adopt_prefetched();
+    if(asset->type == ASSET_NONE && asset->prefetch == PREFETCH_NONE && loader.count < NUMBER_OF_RESOURCES) {
+        asset->prefetch = PREFETCH_QUEUED;
+        asset->prefetch_type = type;
+        loader.queue[(loader.head + loader.count) % NUMBER_OF_RESOURCES] = resource_id;
+        loader.count++;
+        SDL_CondSignal(loader.work);
+    }
+    SDL_UnlockMutex(loader.lock);
+    trim_cache();
+}
+
+/**
+ * Find a file in the cache, or load it there, and take a reference to it.
+ */
+static cached_asset *acquire_asset(int resource_id, asset_type type) {
+    assert(resource_id >= 0 && resource_id < NUMBER_OF_RESOURCES);
+    cached_asset *asset = &assets[resource_id];
+    if(asset->type == ASSET_NONE) {
+        finish_prefetch(resource_id);
+    }
+    if(asset->type == ASSET_NONE) {
+        asset_data data;
+        if(!load_asset_data(&data, type, resource_id)) {
+            return NULL;
+        }
+        add_asset(asset, &data, type);
+        misses++;
+    } else if(asset->type != type) {
+        log_error("Resource %s is already cached as a different file type", get_resource_name(resource_id));
+        return NULL;
+    } else {
+        hits++;
+    }
+    asset->refs++;
+    asset->last_use = ++use_counter;
+    return asset;
+}
+
+void asset_cache_prefetch_bk(int resource_id) {
+    prefetch_asset(resource_id, ASSET_BK);
+}
+
+void asset_cache_prefetch_af(int resource_id) {
+    prefetch_asset(resource_id, ASSET_AF);
+}
+
+int asset_cache_load_bk(bk *b, int resource_id) {
+    cached_asset *asset = acquire_asset(resource_id, ASSET_BK);
+    if(asset == NULL) {
+        return 1;
+    }
+    bk_clone(&asset->data.bk, b);
+    trim_cache();
+    return 0;
+}
+
+int asset_cache_load_af(af *a, int resource_id) {
+    cached_asset *asset = acquire_asset(resource_id, ASSET_AF);
+    if(asset == NULL) {
+        return 1;
+    }
+    af_clone(&asset->data.af, a);
+    trim_cache();
+    return 0;
+}
+
+void asset_cache_release(int resource_id) {
+    assert(resource_id >= 0 && resource_id < NUMBER_OF_RESOURCES);
+    cached_asset *asset = &assets[resource_id];
+    if(asset->refs > 0) {
+        asset->refs--;
+    }
+    trim_cache();
+}
+
+void asset_cache_close(void) {
+    stop_loader();
+    log_debug("Asset cache: %zu bytes, %u hits, %u misses, %u dropped, %u prefetched, %u waited for", cache_bytes,
+              hits, misses, drops, prefetched, waits);
+    for(int i = 0; i < NUMBER_OF_RESOURCES; i++) {
+        drop_asset(&assets[i]);
+    }
+    hits = 0;
+    misses = 0;
+    drops = 0;
+    prefetched = 0;
+    waits = 0;
+    use_counter = 0;
+}
@@ -0,0 +1,51 @@
+#ifndef ASSET_CACHE_H
+#define ASSET_CACHE_H
+
+#include "resources/af.h"
+#include "resources/bk.h"
+
+/**
+ * Decoded BK and AF files, kept alive between scenes so that returning to a scene or rematching the same HARs
+ * does not parse and decode the files again.
+ *
+ * Scenes and HARs change the data they are given (animation strings, sound tables, decals on sprites), so callers
+ * always get their own copy of the cached file. Each load takes a reference that is given back with
+ * asset_cache_release. When the cache goes over its memory budget, the least recently used files that nobody
+ * holds a reference to are dropped.
+ */
+
+/**
+ * Load a BK file by resource id into b, from the cache if possible.
+ * @return 0 on success, 1 on failure. On failure no reference is taken.
+ */
+int asset_cache_load_bk(bk *b, int resource_id);
+
+/**
+ * Load an AF file by resource id into a, from the cache if possible.
+ * @return 0 on success, 1 on failure. On failure no reference is taken.
+ */
+int asset_cache_load_af(af *a, int resource_id);
+
+/**
+ * Start loading a BK file on the loader thread, so that a later asset_cache_load_bk finds it ready. Does nothing
+ * if the file is already cached or on its way. If the load is needed before the loader got to it, it happens on
+ * the spot instead.
+ */
+void asset_cache_prefetch_bk(int resource_id);
+
+/**
+ * Start loading an AF file on the loader thread. See asset_cache_prefetch_bk.
+ */
+void asset_cache_prefetch_af(int resource_id);
+
+/**
+ * Give back a reference taken by one of the load functions. The copy that was loaded is freed by the caller.
+ */
+void asset_cache_release(int resource_id);
+
+/**
+ * Stop the loader thread and free all cached files. Outstanding references are forgotten.
+ */
+void asset_cache_close(void);
+
+#endif // ASSET_CACHE_H
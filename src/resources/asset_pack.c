@@ -0,0 +1,122 @@
+#include "resources/asset_pack.h"
+#include "formats/error.h"
+#include "formats/internal/reader.h"
+#include "formats/pack.h"
+#include "resources/pathmanager.h"
+#include "utils/allocator.h"
+#include "utils/c_string_util.h"
+#include "utils/log.h"
+#include "utils/scandir.h"
+#include "utils/str.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+static sd_pack_file *pack = NULL;
+static char *pack_dir = NULL;
+
+/**
+ * Get the name of a file in the resource directory, or NULL if the file is somewhere else.
+ */
+static const char *resource_file_name(const char *file) {
+    size_t dir_len = strlen(pack_dir);
+    if(strncmp(file, pack_dir, dir_len) != 0) {
+        return NULL;
+    }
+    const char *name = file + dir_len;
+    if(*name == '/' || *name == pm_path_sep) {
+        name++;
+    }
+    if(strchr(name, '/') != NULL || strchr(name, pm_path_sep) != NULL) {
+        return NULL;
+    }
+    return name;
+}
+
+/**
+ * Check that an entry was made from the file as it is now. The entry is used as is if the file is not on disk.
+ */
+static bool source_matches(const sd_pack_entry *entry, const char *file) {
+    char path[256];
+    struct stat st;
+    if(strlen(file) >= sizeof(path)) {
+        return true;
+    }
+    strncpy_or_truncate(path, file, sizeof(path));
+    if(!scan_directory_for_file(path, sizeof(path)) || stat(path, &st) != 0) {
+        return true;
+    }
+    if((uint32_t)st.st_size != entry->source_size || (int64_t)st.st_mtime != entry->source_mtime) {
+        log_debug("Resource pack entry '%s' is out of date, using '%s' instead.", entry->name, path);
+        return false;
+    }
+    return true;
+}
+
+static const char *pack_source(const char *file, long *len) {
+    const char *name = resource_file_name(file);
+    if(name == NULL) {
+        return NULL;
+    }
+    const sd_pack_entry *entry = sd_pack_find(pack, name);
+    if(entry == NULL || !source_matches(entry, file)) {
+        return NULL;
+    }
+    *len = entry->len;
+    return pack->data + entry->offset;
+}
+
+bool asset_pack_init(void) {
+    str filename;
+    const char *dirname = pm_get_local_path(RESOURCE_PATH);
+    str_from_format(&filename, "%s%s", dirname, ASSET_PACK_FILE);
+
+    pack = omf_calloc(1, sizeof(sd_pack_file));
+    sd_pack_create(pack);
+    int ret = sd_pack_load(pack, str_c(&filename));
+    if(ret != SD_SUCCESS) {
+        if(ret != SD_FILE_OPEN_ERROR) {
+            log_warn("Unable to load resource pack '%s': %s. Using the original files.", str_c(&filename),
+                     sd_get_error(ret));
+        }
+        omf_free(pack);
+        str_free(&filename);
+        return false;
+    }
+
+    pack_dir = omf_strdup(dirname);
+    sd_reader_set_source(pack_source);
+    log_info("Loaded resource pack '%s' with %u entries.", str_c(&filename), pack->count);
+    str_free(&filename);
+    return true;
+}
+
+bool asset_pack_get_pixels(const char *filename, sprite_pixels *pixels) {
+    if(pack == NULL) {
+        return false;
+    }
+    const char *name = resource_file_name(filename);
+    if(name == NULL) {
+        return false;
+    }
+    char entry_name[SD_PACK_NAME_LENGTH];
+    if(snprintf(entry_name, sizeof(entry_name), "%s%s", name, SD_PACK_PIXELS_SUFFIX) >= (int)sizeof(entry_name)) {
+        return false;
+    }
+    const sd_pack_entry *entry = sd_pack_find(pack, entry_name);
+    if(entry == NULL || !source_matches(entry, filename)) {
+        return false;
+    }
+    pixels->pos = (const unsigned char *)pack->data + entry->offset;
+    pixels->end = pixels->pos + entry->len;
+    return true;
+}
+
+void asset_pack_close(void) {
+    if(pack != NULL) {
+        sd_reader_set_source(NULL);
+        sd_pack_free(pack);
+        omf_free(pack);
+        omf_free(pack_dir);
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include "resources/sprite.h"
+#include <stdbool.h>
+
+#define ASSET_PACK_FILE "OPENOMF.PAK"
+
+/**
+ * Resource pack made by packtool from the game data files. When the pack is found in the resource directory,
+ * files from that directory are read from the pack instead, and BK and AF sprites come already decoded. When it
+ * is not there, everything is loaded from the original files. Entries made from a file that has since changed
+ * on disk are ignored, and that file is loaded as it is.
+ */
+
+/**
+ * Load the resource pack, if there is one. Must be called before any files are loaded.
+ * @return true if the pack is in use.
+ */
+bool asset_pack_init(void);
+
+/**
+ * Get the decoded sprites of a BK or AF file from the pack.
+ * @param filename Path to the file, as given to the loader.
+ * @param pixels Set to the sprites of the file, to be passed on to af_create or bk_create.
+ * @return true if the pack has them, false if the sprites need to be decoded.
+ */
+bool asset_pack_get_pixels(const char *filename, sprite_pixels *pixels);
+
+/**
+ * Free the resource pack. Must be called after all loading has stopped.
+ */
+void asset_pack_close(void);
+
+#endif // ASSET_PACK_H
@@ -3,7 +3,7 @@
 #include "utils/allocator.h"
 #include <string.h>
 
-void bk_create(bk *b, void *src) {
+void bk_create(bk *b, void *src, sprite_pixels *pixels) {
     sd_bk_file *sdbk = (sd_bk_file *)src;
 
     // File ID
@@ -31,7 +31,7 @@ void bk_create(bk *b, void *src) {
     bk_info tmp_bk_info;
     for(int i = 0; i < 50; i++) {
         if(sdbk->anims[i] != NULL) {
-            bk_info_create(&tmp_bk_info, &b->sprites, (void *)sdbk->anims[i], i);
+            bk_info_create(&tmp_bk_info, &b->sprites, (void *)sdbk->anims[i], i, pixels);
             hashmap_put_int(&b->infos, i, &tmp_bk_info, sizeof(bk_info));
         }
     }
@@ -58,6 +58,43 @@ char *bk_get_stl(bk *b) {
     return b->sound_translation_table;
 }
 
+int bk_clone(bk *src, bk *dst) {
+    dst->file_id = src->file_id;
+    surface_create_from(&dst->background, &src->background);
+    memcpy(dst->sound_translation_table, src->sound_translation_table, 30);
+
+    iterator it;
+    vector_create_with_size(&dst->palettes, sizeof(vga_palette), vector_size(&src->palettes));
+    vector_iter_begin(&src->palettes, &it);
+    vga_palette *palette = NULL;
+    foreach(it, palette) {
+        vector_append(&dst->palettes, palette);
+    }
+    vector_create_with_size(&dst->remaps, sizeof(vga_remap_tables), vector_size(&src->remaps));
+    vector_iter_begin(&src->remaps, &it);
+    vga_remap_tables *remaps = NULL;
+    foreach(it, remaps) {
+        vector_append(&dst->remaps, remaps);
+    }
+
+    // The sprite table is only needed while creating the animations.
+    array_create(&dst->sprites);
+
+    hashmap surfaces;
+    hashmap_create(&surfaces);
+    hashmap_create(&dst->infos);
+    hashmap_iter_begin(&src->infos, &it);
+    hashmap_pair *pair = NULL;
+    bk_info tmp_bk_info;
+    foreach(it, pair) {
+        bk_info *info = (bk_info *)pair->value;
+        bk_info_clone(info, &tmp_bk_info, &surfaces);
+        hashmap_put_int(&dst->infos, info->ani.id, &tmp_bk_info, sizeof(bk_info));
+    }
+    hashmap_free(&surfaces);
+    return 0;
+}
+
 void bk_free(bk *b) {
     surface_free(&b->background);
     vector_free(&b->palettes);
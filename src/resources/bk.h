@@ -16,11 +16,19 @@ typedef struct bk_t {
     char sound_translation_table[30];
 } bk;
 
-void bk_create(bk *b, void *src);
+/**
+ * Create a BK from an sd_bk_file. pixels may hold the sprites decoded ahead of time, or be NULL.
+ */
+void bk_create(bk *b, void *src, sprite_pixels *pixels);
 bk_info *bk_get_info(bk *b, int id);
 vga_palette *bk_get_palette(bk *b, int id);
 vga_remap_tables *bk_get_remaps(bk *b, int id);
 char *bk_get_stl(bk *b);
+
+/**
+ * Make a deep copy of a BK, for a scene that is free to change it. Surfaces shared between sprites stay shared.
+ */
+int bk_clone(bk *src, bk *dst);
 void bk_free(bk *b);
 
 #endif // BK_H
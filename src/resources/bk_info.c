@@ -1,9 +1,10 @@
 #include "resources/bk_info.h"
 #include "formats/bkanim.h"
+#include <string.h>
 
-void bk_info_create(bk_info *info, array *sprites, void *src, int id) {
+void bk_info_create(bk_info *info, array *sprites, void *src, int id, sprite_pixels *pixels) {
     sd_bk_anim *sdinfo = (sd_bk_anim *)src;
-    animation_create(&info->ani, sprites, sdinfo->animation, id);
+    animation_create(&info->ani, sprites, sdinfo->animation, id, pixels);
     info->chain_hit = sdinfo->chain_hit;
     info->chain_no_hit = sdinfo->chain_no_hit;
     info->load_on_start = sdinfo->load_on_start;
@@ -12,6 +13,12 @@ void bk_info_create(bk_info *info, array *sprites, void *src, int id) {
     str_from_c(&info->footer_string, sdinfo->footer_string);
 }
 
+int bk_info_clone(bk_info *src, bk_info *dst, hashmap *surfaces) {
+    memcpy(dst, src, sizeof(bk_info));
+    str_from(&dst->footer_string, &src->footer_string);
+    return animation_clone_shared(&src->ani, &dst->ani, surfaces);
+}
+
 void bk_info_free(bk_info *info) {
     animation_free(&info->ani);
     str_free(&info->footer_string);
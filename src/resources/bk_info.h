@@ -13,7 +13,8 @@ typedef struct bk_info_t {
     animation ani;
 } bk_info;
 
-void bk_info_create(bk_info *info, array *sprites, void *src, int id);
+void bk_info_create(bk_info *info, array *sprites, void *src, int id, sprite_pixels *pixels);
+int bk_info_clone(bk_info *src, bk_info *dst, hashmap *surfaces);
 void bk_info_free(bk_info *info);
 
 #endif // BK_INFO_H
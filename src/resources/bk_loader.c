@@ -1,6 +1,7 @@
 #include "resources/bk_loader.h"
 #include "formats/bk.h"
 #include "formats/error.h"
+#include "resources/asset_pack.h"
 #include "resources/pathmanager.h"
 
 int load_bk_file(bk *b, char const *filename) {
@@ -14,8 +15,10 @@ int load_bk_file(bk *b, char const *filename) {
         return 1;
     }
 
-    // Convert
-    bk_create(b, &tmp);
+    // Convert, with the sprites from the resource pack if it has them
+    sprite_pixels pixels;
+    bool packed = asset_pack_get_pixels(filename, &pixels);
+    bk_create(b, &tmp, packed ? &pixels : NULL);
     sd_bk_free(&tmp);
     return 0;
 }
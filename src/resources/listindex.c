@@ -0,0 +1,196 @@
+#include "resources/listindex.h"
+#include "formats/internal/writer.h"
+#include "utils/allocator.h"
+#include "utils/c_string_util.h"
+#include "utils/log.h"
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define LISTINDEX_FORMAT_VERSION 1
+#define LISTINDEX_MAX_NAME 256
+
+static const char listindex_magic[8] = "OMFIDX";
+
+typedef struct listindex_entry {
+    char *name;
+    uint32_t size;
+    int64_t mtime;   // Modification time of the file when the record was made
+    int64_t indexed; // Time the record was made
+    char *data;
+    uint32_t len;
+    bool used; // Looked up or stored since the index was opened
+} listindex_entry;
+
+static void free_entry(void *data) {
+    listindex_entry *entry = data;
+    omf_free(entry->name);
+    omf_free(entry->data);
+}
+
+static bool file_stat(const char *path, uint32_t *size, int64_t *mtime) {
+    struct stat st;
+    if(stat(path, &st) != 0) {
+        return false;
+    }
+    *size = (uint32_t)st.st_size;
+    *mtime = (int64_t)st.st_mtime;
+    return true;
+}
+
+static int64_t read_time(sd_reader *r) {
+    uint32_t lo = sd_read_udword(r);
+    uint32_t hi = sd_read_udword(r);
+    return (int64_t)(((uint64_t)hi << 32) | lo);
+}
+
+static void write_time(sd_writer *w, int64_t t) {
+    sd_write_udword(w, (uint32_t)((uint64_t)t & 0xFFFFFFFF));
+    sd_write_udword(w, (uint32_t)((uint64_t)t >> 32));
+}
+
+static listindex_entry *find_entry(const listindex *index, const char *name) {
+    iterator it;
+    listindex_entry *entry;
+    vector_iter_begin(&index->entries, &it);
+    foreach(it, entry) {
+        if(strcmp(entry->name, name) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static bool load_entries(listindex *index, sd_reader *r) {
+    char magic[sizeof(listindex_magic)];
+    if(!sd_read_buf(r, magic, sizeof(magic)) || memcmp(magic, listindex_magic, sizeof(magic)) != 0) {
+        return false;
+    }
+    if(sd_read_udword(r) != LISTINDEX_FORMAT_VERSION || sd_read_udword(r) != index->version) {
+        return false;
+    }
+    uint32_t count = sd_read_udword(r);
+    for(uint32_t i = 0; i < count; i++) {
+        uint16_t name_len = sd_read_uword(r);
+        if(!sd_reader_ok(r) || name_len == 0 || name_len > LISTINDEX_MAX_NAME) {
+            return false;
+        }
+        listindex_entry *entry = vector_append_ptr(&index->entries);
+        memset(entry, 0, sizeof(listindex_entry));
+        entry->name = omf_calloc(1, name_len + 1);
+        sd_read_buf(r, entry->name, name_len);
+        entry->size = sd_read_udword(r);
+        entry->mtime = read_time(r);
+        entry->indexed = read_time(r);
+        entry->len = sd_read_udword(r);
+        if(!sd_reader_ok(r) || entry->len > sd_reader_filesize(r) - sd_reader_pos(r)) {
+            return false;
+        }
+        entry->data = omf_malloc(entry->len + 1);
+        sd_read_buf(r, entry->data, entry->len);
+    }
+    return sd_reader_ok(r);
+}
+
+void listindex_open(listindex *index, const char *path, uint32_t version) {
+    index->path = omf_strdup(path);
+    index->version = version;
+    index->dirty = false;
+    vector_create_cb(&index->entries, sizeof(listindex_entry), free_entry);
+
+    sd_reader *r = sd_reader_open(path);
+    if(r == NULL) {
+        return;
+    }
+    if(!load_entries(index, r)) {
+        log_info("Index '%s' is out of date, rebuilding it.", path);
+        vector_clear(&index->entries);
+        index->dirty = true;
+    }
+    sd_reader_close(r);
+}
+
+sd_reader *listindex_get(listindex *index, const char *path, const char *name) {
+    listindex_entry *entry = find_entry(index, name);
+    if(entry == NULL) {
+        return NULL;
+    }
+    entry->used = true;
+
+    // Files can change within a second without their time changing, so records made during the second the file
+    // was last modified are not trusted.
+    uint32_t size;
+    int64_t mtime;
+    if(!file_stat(path, &size, &mtime) || size != entry->size || mtime != entry->mtime || entry->indexed <= mtime) {
+        return NULL;
+    }
+    return sd_reader_open_from_buf(entry->data, entry->len);
+}
+
+void listindex_put(listindex *index, const char *path, const char *name, const char *data, uint32_t len) {
+    uint32_t size;
+    int64_t mtime;
+    if(strlen(name) > LISTINDEX_MAX_NAME || !file_stat(path, &size, &mtime)) {
+        return;
+    }
+
+    listindex_entry *entry = find_entry(index, name);
+    if(entry == NULL) {
+        entry = vector_append_ptr(&index->entries);
+        memset(entry, 0, sizeof(listindex_entry));
+        entry->name = omf_strdup(name);
+    }
+    omf_free(entry->data);
+    entry->data = omf_malloc(len + 1);
+    memcpy(entry->data, data, len);
+    entry->len = len;
+    entry->size = size;
+    entry->mtime = mtime;
+    entry->indexed = (int64_t)time(NULL);
+    entry->used = true;
+    index->dirty = true;
+}
+
+static void save_entries(const listindex *index) {
+    sd_writer *w = sd_writer_open(index->path);
+    if(w == NULL) {
+        log_warn("Unable to write index '%s'.", index->path);
+        return;
+    }
+    sd_write_buf(w, listindex_magic, sizeof(listindex_magic));
+    sd_write_udword(w, LISTINDEX_FORMAT_VERSION);
+    sd_write_udword(w, index->version);
+    sd_write_udword(w, vector_size(&index->entries));
+
+    iterator it;
+    listindex_entry *entry;
+    vector_iter_begin(&index->entries, &it);
+    foreach(it, entry) {
+        uint16_t name_len = strlen(entry->name);
+        sd_write_uword(w, name_len);
+        sd_write_buf(w, entry->name, name_len);
+        sd_write_udword(w, entry->size);
+        write_time(w, entry->mtime);
+        write_time(w, entry->indexed);
+        sd_write_udword(w, entry->len);
+        sd_write_buf(w, entry->data, entry->len);
+    }
+    sd_writer_close(w);
+}
+
+void listindex_close(listindex *index) {
+    // Drop the records of files that are gone
+    for(unsigned int i = vector_size(&index->entries); i > 0; i--) {
+        listindex_entry *entry = vector_get(&index->entries, i - 1);
+        if(!entry->used) {
+            free_entry(entry);
+            vector_delete_at(&index->entries, i - 1);
+            index->dirty = true;
+        }
+    }
+    if(index->dirty) {
+        save_entries(index);
+    }
+    vector_free(&index->entries);
+    omf_free(index->path);
+}
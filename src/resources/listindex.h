@@ -0,0 +1,54 @@
+#ifndef LISTINDEX_H
+#define LISTINDEX_H
+
+#include "formats/internal/reader.h"
+#include "utils/vector.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Persistent index of the header data that menus show for a directory of files, like tournaments or saved games,
+ * so that listing them does not need to load every file.
+ *
+ * Each entry holds a record written by the user of the index, along with the size and modification time of the
+ * file it was made from. An entry is only used while the file still has the same size and time. The record format
+ * is up to the user; bump the version given to listindex_open whenever it changes, and old indexes are dropped.
+ */
+typedef struct listindex {
+    char *path;       // Where the index is stored
+    uint32_t version; // Record format version
+    vector entries;   // listindex_entry
+    bool dirty;       // Entries changed since the index was loaded
+} listindex;
+
+/**
+ * Load the index from path. If there is no index, or it is unreadable or for another version, start empty.
+ */
+void listindex_open(listindex *index, const char *path, uint32_t version);
+
+/**
+ * Get the record for a file, if the index has an up-to-date one.
+ * @param index Index to look in
+ * @param path Path of the file, for checking its size and modification time
+ * @param name Name of the file in the index
+ * @return Reader over the record, to be closed by the caller, or NULL if there is no valid record.
+ */
+sd_reader *listindex_get(listindex *index, const char *path, const char *name);
+
+/**
+ * Store the record for a file, replacing any old record. The data is copied.
+ * @param index Index to store into
+ * @param path Path of the file, for checking its size and modification time
+ * @param name Name of the file in the index
+ * @param data Record data
+ * @param len Byte length of the record data
+ */
+void listindex_put(listindex *index, const char *path, const char *name, const char *data, uint32_t len);
+
+/**
+ * Save the index, if it changed, and free it. Entries for files that were not looked up or stored since the index
+ * was opened are dropped, so that the index does not keep records of removed files.
+ */
+void listindex_close(listindex *index);
+
+#endif // LISTINDEX_H
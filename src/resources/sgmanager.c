@@ -1,7 +1,10 @@
 #include "resources/sgmanager.h"
 #include "formats/chr.h"
 #include "formats/error.h"
+#include "formats/internal/memreader.h"
+#include "formats/internal/memwriter.h"
 #include "game/utils/settings.h"
+#include "resources/listindex.h"
 #include "resources/pathmanager.h"
 #include "utils/allocator.h"
 #include "utils/c_string_util.h"
@@ -12,6 +15,9 @@
 #include <stdio.h>
 #include <string.h>
 
+#define SG_INDEX_FILE "SAVEGAMES.IDX"
+#define SG_INDEX_VERSION 1
+
 int sg_init(void) {
     int ret;
     list dirlist;
@@ -69,6 +75,77 @@ int sg_count(void) {
     return ret;
 }
 
+// Fields of a saved game kept in the index: the pilot, and what sd_chr_load adds to it from other files.
+static void sg_header_write(memwriter *w, const sd_chr_file *chr) {
+    sd_pilot_save_to_mem(w, &chr->pilot); // PILOT_BLOCK_LENGTH bytes
+    memwrite_ubyte(w, chr->pilot.sex);
+    palette_msave_range(w, &chr->pal, 0, 48);
+    memwrite_udword(w, chr->unknown_b);
+    sd_sprite_msave(w, chr->photo);
+}
+
+static int sg_header_read(sd_reader *r, sd_chr_file *chr) {
+    sd_chr_create(chr);
+    memreader *mr = memreader_open_from_reader(r, PILOT_BLOCK_LENGTH);
+    sd_pilot_create(&chr->pilot);
+    sd_pilot_load_from_mem(mr, &chr->pilot);
+    memreader_close(mr);
+    chr->pilot.sex = sd_read_ubyte(r);
+    vga_palette_init(&chr->pal);
+    palette_load_range(r, &chr->pal, 0, 48);
+    chr->unknown_b = sd_read_udword(r);
+
+    // The photo was stored from a loaded file, so its size is already fixed up.
+    chr->photo = omf_calloc(1, sizeof(sd_sprite));
+    sd_sprite_create(chr->photo);
+    if(sd_sprite_load(r, chr->photo) != SD_SUCCESS || !sd_reader_ok(r)) {
+        return SD_FILE_PARSE_ERROR;
+    }
+    chr->pilot.photo = chr->photo;
+
+    sd_pilot_set_player_color(&chr->pilot, PRIMARY, chr->pilot.color_1);
+    sd_pilot_set_player_color(&chr->pilot, SECONDARY, chr->pilot.color_2);
+    sd_pilot_set_player_color(&chr->pilot, TERTIARY, chr->pilot.color_3);
+    return SD_SUCCESS;
+}
+
+// Get a saved game from the index, or load the file and add it to the index.
+static int sg_header_load(listindex *index, sd_chr_file *chr, const char *basename) {
+    str path;
+    str_from_c(&path, pm_get_local_path(SAVE_PATH));
+    str_append_c(&path, basename);
+
+    int ret = SD_FILE_PARSE_ERROR;
+    sd_reader *r = listindex_get(index, str_c(&path), basename);
+    if(r != NULL) {
+        ret = sg_header_read(r, chr);
+        sd_reader_close(r);
+        if(ret != SD_SUCCESS) {
+            sd_chr_free(chr);
+        }
+    }
+
+    if(ret != SD_SUCCESS) {
+        sd_chr_file full;
+        ret = sg_load(&full, basename);
+        if(ret == SD_SUCCESS) {
+            memwriter *w = memwriter_open();
+            sg_header_write(w, &full);
+            listindex_put(index, str_c(&path), basename, w->buf, w->data_len);
+            r = sd_reader_open_from_buf(w->buf, w->data_len);
+            ret = sg_header_read(r, chr);
+            sd_reader_close(r);
+            memwriter_close(w);
+            if(ret != SD_SUCCESS) {
+                sd_chr_free(chr);
+            }
+        }
+        sd_chr_free(&full);
+    }
+    str_free(&path);
+    return ret;
+}
+
 list *sg_load_all(void) {
     if(sg_init()) {
         return NULL;
@@ -82,26 +159,39 @@ list *sg_load_all(void) {
     }
     log_debug("Found %d savegames", list_size(&dirlist));
 
+    listindex index;
+    str index_path;
+    str_from_c(&index_path, dirname);
+    str_append_c(&index_path, SG_INDEX_FILE);
+    listindex_open(&index, str_c(&index_path), SG_INDEX_VERSION);
+    str_free(&index_path);
+
     list *chrlist = omf_calloc(1, sizeof(list));
     list_create(chrlist);
     iterator it;
     list_iter_begin(&dirlist, &it);
     char *chrfile;
     foreach(it, chrfile) {
-        sd_chr_file *chr = omf_calloc(1, sizeof(sd_chr_file));
-        if(sg_load(chr, chrfile) == SD_SUCCESS) {
-            list_append(chrlist, chr, sizeof(sd_chr_file));
+        sg_entry entry;
+        if(sg_header_load(&index, &entry.chr, chrfile) == SD_SUCCESS) {
+            entry.filename = omf_strdup(chrfile);
+            list_append(chrlist, &entry, sizeof(sg_entry));
             log_debug("Loaded %s", chrfile);
         } else {
             log_warn("Failed to load save %s", chrfile);
         }
-        omf_free(chr);
     }
+    listindex_close(&index);
 
     list_free(&dirlist);
     return chrlist;
 }
 
+void sg_entry_free(sg_entry *entry) {
+    sd_chr_free(&entry->chr);
+    omf_free(entry->filename);
+}
+
 int sg_load(sd_chr_file *chr, const char *basename) {
     str path;
     str_from_c(&path, pm_get_local_path(SAVE_PATH));
@@ -4,9 +4,24 @@
 #include "formats/chr.h"
 #include "utils/list.h"
 
+/**
+ * Saved game, as listed by sg_load_all. Only the pilot, palette and photo of the character are loaded; enemies and
+ * tournament data are not. Load the file with sg_load to get all of it.
+ */
+typedef struct sg_entry {
+    char *filename;  // Savegame file name, for sg_load
+    sd_chr_file chr; // Saved character, without enemies
+} sg_entry;
+
 int sg_init(void);
 int sg_count(void);
+
+/**
+ * List all saved games, reading them from an index when the files have not changed.
+ * @return List of sg_entry, or NULL if the savegame directory can not be read. Free entries with sg_entry_free.
+ */
 list *sg_load_all(void);
+void sg_entry_free(sg_entry *entry);
 int sg_load(sd_chr_file *chr, const char *pilotname);
 int sg_save(sd_chr_file *chr);
 int sg_delete(const char *pilotname);
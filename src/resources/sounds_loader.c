@@ -47,6 +47,10 @@ bool sounds_loader_get(int id, char **buffer, int *len, int *freq) {
     return true;
 }
 
+int sounds_loader_count(void) {
+    return sound_data != NULL ? SD_SOUNDS_MAX : 0;
+}
+
 void sounds_loader_close(void) {
     if(sound_data != NULL) {
         sd_sounds_free(sound_data);
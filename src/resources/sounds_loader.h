@@ -5,6 +5,11 @@
 
 bool sounds_loader_init(void);
 bool sounds_loader_get(int id, char **buffer, int *len, int *freq);
+
+/**
+ * Number of sound ids in the loaded sounds file, or 0 if nothing is loaded.
+ */
+int sounds_loader_count(void);
 void sounds_loader_close(void);
 
 #endif // SOUNDS_LOADER_H
@@ -9,7 +9,7 @@ void sprite_create_custom(sprite *sp, vec2i pos, surface *data) {
     sp->data = data;
 }
 
-void sprite_create(sprite *sp, void *src, int id) {
+void sprite_create_from_vga(sprite *sp, void *src, int id, const sd_vga_image *img) {
     sd_sprite *sdsprite = (sd_sprite *)src;
     sp->id = id;
     sp->pos = vec2i_create(sdsprite->pos_x, sdsprite->pos_y);
@@ -20,15 +20,57 @@ void sprite_create(sprite *sp, void *src, int id) {
         return;
     }
 
-    // Load data
     sp->data = omf_calloc(1, sizeof(surface));
     sp->owned = true;
+    surface_create_from_data(sp->data, img->w, img->h, (const unsigned char *)img->data);
+}
+
+void sprite_create(sprite *sp, void *src, int id) {
+    sd_sprite *sdsprite = (sd_sprite *)src;
+    if(sdsprite->width == 0 || sdsprite->height == 0) {
+        sprite_create_from_vga(sp, src, id, NULL);
+        return;
+    }
+
+    // Load data
     sd_vga_image raw;
     sd_sprite_vga_decode(&raw, sdsprite);
-    surface_create_from_data(sp->data, raw.w, raw.h, (unsigned char *)raw.data);
+    sprite_create_from_vga(sp, src, id, &raw);
     sd_vga_image_free(&raw);
 }
 
+static uint16_t pixels_uword(const unsigned char *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+void sprite_create_from_pixels(sprite *sp, void *src, int id, sprite_pixels *pixels) {
+    sd_sprite *sdsprite = (sd_sprite *)src;
+    if(pixels == NULL || sdsprite->width == 0 || sdsprite->height == 0) {
+        sprite_create(sp, src, id);
+        return;
+    }
+
+    // Sprite width and height, decoded width and height, then the decoded pixels.
+    const unsigned char *p = pixels->pos;
+    if(pixels->end - p >= 8 && pixels_uword(p) == sdsprite->width && pixels_uword(p + 2) == sdsprite->height) {
+        int w = pixels_uword(p + 4);
+        int h = pixels_uword(p + 6);
+        if(pixels->end - p - 8 >= w * h) {
+            sp->id = id;
+            sp->pos = vec2i_create(sdsprite->pos_x, sdsprite->pos_y);
+            sp->data = omf_calloc(1, sizeof(surface));
+            sp->owned = true;
+            surface_create_from_data(sp->data, w, h, p + 8);
+            pixels->pos = p + 8 + w * h;
+            return;
+        }
+    }
+
+    // Out of step with the sprites, so the rest of the entries would not match either.
+    pixels->pos = pixels->end;
+    sprite_create(sp, src, id);
+}
+
 void sprite_create_reference(sprite *sp, void *src, int id, void *data) {
     sd_sprite *sdsprite = (sd_sprite *)src;
     sp->id = id;
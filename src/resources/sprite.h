@@ -11,7 +11,28 @@ typedef struct sprite_t {
     bool owned; // if we own the `data` surface
 } sprite;
 
+/**
+ * Sprite pixels that were decoded ahead of time, as stored in a resource pack. Entries are used up in the order
+ * the sprites are created.
+ */
+typedef struct sprite_pixels_t {
+    const unsigned char *pos;
+    const unsigned char *end;
+} sprite_pixels;
+
 void sprite_create(sprite *sp, void *src, int id);
+
+/**
+ * Create a sprite from an sd_sprite whose pixels have already been decoded to img. img may be NULL for sprites
+ * without a size, which get no surface.
+ */
+void sprite_create_from_vga(sprite *sp, void *src, int id, const sd_vga_image *img);
+
+/**
+ * Create a sprite from the next entry of pixels instead of decoding it. If the entry does not belong to this
+ * sprite, the sprite is decoded as usual, and the rest of pixels is skipped. pixels may be NULL.
+ */
+void sprite_create_from_pixels(sprite *sp, void *src, int id, sprite_pixels *pixels);
 void sprite_create_custom(sprite *sp, vec2i pos, surface *sur);
 void sprite_create_reference(sprite *sp, void *src, int id, void *data);
 int sprite_clone(sprite *src, sprite *dst);
@@ -1,6 +1,8 @@
 #include "resources/trnmanager.h"
 #include "formats/error.h"
+#include "formats/internal/memwriter.h"
 #include "formats/tournament.h"
+#include "resources/listindex.h"
 #include "resources/pathmanager.h"
 #include "utils/allocator.h"
 #include "utils/log.h"
@@ -9,12 +11,106 @@
 #include <stdio.h>
 #include <string.h>
 
+#define TRN_INDEX_FILE "TOURNAMENTS.IDX"
+#define TRN_INDEX_VERSION 1
+
 static int trn_sort_compare_fn(const void *a, const void *b) {
     sd_tournament_file const *trn_a = a;
     sd_tournament_file const *trn_b = b;
     return (trn_a->registration_fee > trn_b->registration_fee) - (trn_a->registration_fee < trn_b->registration_fee);
 }
 
+// Header fields kept in the index: everything the tournament menu shows, and the fields it sorts by.
+static void trn_header_write(memwriter *w, const sd_tournament_file *trn) {
+    const sd_tournament_locale *locale = trn->locales[0];
+    memwrite_buf(w, trn->filename, sizeof(trn->filename));
+    memwrite_uword(w, trn->enemy_count);
+    memwrite_buf(w, trn->bk_name, sizeof(trn->bk_name));
+    memwrite_float(w, trn->winnings_multiplier);
+    memwrite_dword(w, trn->registration_fee);
+    memwrite_dword(w, trn->assumed_initial_value);
+    memwrite_dword(w, trn->tournament_id);
+    memwrite_variable_str(w, trn->pic_file);
+    palette_msave_range(w, &trn->pal, 128, 40);
+    sd_sprite_msave(w, locale->logo);
+    memwrite_variable_str(w, locale->title);
+    memwrite_variable_str(w, locale->stripped_description);
+    memwrite_dword(w, locale->desc_width);
+    memwrite_dword(w, locale->desc_center);
+    memwrite_dword(w, locale->desc_vmove);
+    memwrite_dword(w, locale->desc_size);
+    memwrite_dword(w, locale->desc_color);
+}
+
+static int trn_header_read(sd_reader *r, sd_tournament_file *trn) {
+    sd_tournament_create(trn);
+    sd_read_buf(r, trn->filename, sizeof(trn->filename));
+    trn->filename[sizeof(trn->filename) - 1] = 0;
+    trn->enemy_count = sd_read_uword(r);
+    sd_read_buf(r, trn->bk_name, sizeof(trn->bk_name));
+    trn->bk_name[sizeof(trn->bk_name) - 1] = 0;
+    trn->winnings_multiplier = sd_read_float(r);
+    trn->registration_fee = sd_read_dword(r);
+    trn->assumed_initial_value = sd_read_dword(r);
+    trn->tournament_id = sd_read_dword(r);
+    trn->pic_file = sd_read_variable_str(r);
+    vga_palette_init(&trn->pal);
+    palette_load_range(r, &trn->pal, 128, 40);
+
+    sd_tournament_locale *locale = omf_calloc(1, sizeof(sd_tournament_locale));
+    trn->locales[0] = locale;
+    locale->logo = omf_calloc(1, sizeof(sd_sprite));
+    sd_sprite_create(locale->logo);
+    if(sd_sprite_load(r, locale->logo) != SD_SUCCESS) {
+        return SD_FILE_PARSE_ERROR;
+    }
+    locale->title = sd_read_variable_str(r);
+    locale->stripped_description = sd_read_variable_str(r);
+    locale->desc_width = sd_read_dword(r);
+    locale->desc_center = sd_read_dword(r);
+    locale->desc_vmove = sd_read_dword(r);
+    locale->desc_size = sd_read_dword(r);
+    locale->desc_color = sd_read_dword(r);
+    if(!sd_reader_ok(r) || locale->stripped_description == NULL) {
+        return SD_FILE_PARSE_ERROR;
+    }
+    return SD_SUCCESS;
+}
+
+// Get the header of a tournament from the index, or load the file and add it to the index.
+static int trn_header_load(listindex *index, sd_tournament_file *trn, const char *path, const char *name) {
+    sd_reader *r = listindex_get(index, path, name);
+    if(r != NULL) {
+        int ret = trn_header_read(r, trn);
+        sd_reader_close(r);
+        if(ret == SD_SUCCESS) {
+            return ret;
+        }
+        sd_tournament_free(trn);
+    }
+
+    sd_tournament_file full;
+    sd_tournament_create(&full);
+    int ret = sd_tournament_load(&full, path);
+    if(ret == SD_SUCCESS && full.locales[0] == NULL) {
+        ret = SD_FILE_PARSE_ERROR;
+    }
+    if(ret == SD_SUCCESS) {
+        memwriter *w = memwriter_open();
+        trn_header_write(w, &full);
+        listindex_put(index, path, name, w->buf, w->data_len);
+        r = sd_reader_open_from_buf(w->buf, w->data_len);
+        ret = trn_header_read(r, trn);
+        sd_reader_close(r);
+        memwriter_close(w);
+        if(ret != SD_SUCCESS) {
+            sd_tournament_free(trn);
+        }
+    }
+    sd_tournament_free(&full);
+    return ret;
+}
+
 void trnlist_init(vector *trnlist) {
     trnlist_free(trnlist);
 
@@ -39,21 +135,26 @@ void trnlist_init(vector *trnlist) {
 
     vector_create(trnlist, sizeof(sd_tournament_file));
 
+    // The index lives with the savegames, as the resource directory may not be writable.
+    listindex index;
+    char tmp[1024];
+    snprintf(tmp, 1024, "%s%s", pm_get_local_path(SAVE_PATH), TRN_INDEX_FILE);
+    listindex_open(&index, tmp, TRN_INDEX_VERSION);
+
     iterator it;
     list_iter_begin(&dirlist, &it);
     char *trn_file;
-    char tmp[1024];
     foreach(it, trn_file) {
         sd_tournament_file trn;
-        sd_tournament_create(&trn);
         snprintf(tmp, 1024, "%s%s", dirname, trn_file);
-        if(SD_SUCCESS == sd_tournament_load(&trn, tmp)) {
+        if(SD_SUCCESS == trn_header_load(&index, &trn, tmp, trn_file)) {
             vector_append(trnlist, &trn);
         } else {
             log_error("Could not load tournament %s", trn_file);
         }
     }
     list_iter_end(&dirlist, &it);
+    listindex_close(&index);
 
     // sort the tournaments by ascending registration fee
     vector_sort(trnlist, trn_sort_compare_fn);
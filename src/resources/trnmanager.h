@@ -4,6 +4,11 @@
 #include "formats/tournament.h"
 #include "utils/vector.h"
 
+/**
+ * Fill trnlist with the tournaments in the resource directory, sorted by registration fee. Only the header fields
+ * and the first locale (logo, title and description) are loaded, from an index when the files have not changed.
+ * Use trn_load with the filename of the tournament to load all of it.
+ */
 void trnlist_init(vector *trnlist);
 void trnlist_free(vector *trnlist);
 int trn_load(sd_tournament_file *trn, const char *trnname);
@@ -0,0 +1,114 @@
+#include "utils/idmap.h"
+#include "utils/allocator.h"
+#include <assert.h>
+
+#define IDMAP_INITIAL_CAPACITY 64
+
+static inline uint32_t idmap_hash(uint32_t id) {
+    // ids are mostly sequential, so mix them up before masking
+    return id * 2654435761U;
+}
+
+static void idmap_resize(idmap *map, uint32_t capacity) {
+    idmap_slot *old = map->slots;
+    uint32_t old_capacity = map->capacity;
+    map->slots = omf_calloc(capacity, sizeof(idmap_slot));
+    map->capacity = capacity;
+    map->count = 0;
+    for(uint32_t i = 0; i < old_capacity; i++) {
+        if(old[i].id != 0) {
+            idmap_put(map, old[i].id, old[i].value);
+        }
+    }
+    omf_free(old);
+}
+
+void idmap_create(idmap *map) {
+    map->slots = omf_calloc(IDMAP_INITIAL_CAPACITY, sizeof(idmap_slot));
+    map->capacity = IDMAP_INITIAL_CAPACITY;
+    map->count = 0;
+}
+
+void idmap_free(idmap *map) {
+    omf_free(map->slots);
+    map->capacity = 0;
+    map->count = 0;
+}
+
+void idmap_clear(idmap *map) {
+    for(uint32_t i = 0; i < map->capacity; i++) {
+        map->slots[i].id = 0;
+        map->slots[i].value = NULL;
+    }
+    map->count = 0;
+}
+
+void idmap_put(idmap *map, uint32_t id, void *value) {
+    assert(id != 0);
+    // keep the table at most 3/4 full, so that probe runs stay short
+    if((map->count + 1) * 4 > map->capacity * 3) {
+        idmap_resize(map, map->capacity * 2);
+    }
+    uint32_t mask = map->capacity - 1;
+    uint32_t i = idmap_hash(id) & mask;
+    while(map->slots[i].id != 0) {
+        if(map->slots[i].id == id) {
+            map->slots[i].value = value;
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+    map->slots[i].id = id;
+    map->slots[i].value = value;
+    map->count++;
+}
+
+void *idmap_get(const idmap *map, uint32_t id) {
+    if(id == 0) {
+        return NULL;
+    }
+    uint32_t mask = map->capacity - 1;
+    uint32_t i = idmap_hash(id) & mask;
+    while(map->slots[i].id != 0) {
+        if(map->slots[i].id == id) {
+            return map->slots[i].value;
+        }
+        i = (i + 1) & mask;
+    }
+    return NULL;
+}
+
+bool idmap_del(idmap *map, uint32_t id) {
+    if(id == 0) {
+        return false;
+    }
+    uint32_t mask = map->capacity - 1;
+    uint32_t i = idmap_hash(id) & mask;
+    while(map->slots[i].id != id) {
+        if(map->slots[i].id == 0) {
+            return false;
+        }
+        i = (i + 1) & mask;
+    }
+
+    // Shift the following entries of the probe run back into the hole, so that lookups
+    // never have to step over deleted slots.
+    uint32_t hole = i;
+    uint32_t j = i;
+    while(1) {
+        j = (j + 1) & mask;
+        if(map->slots[j].id == 0) {
+            break;
+        }
+        uint32_t home = idmap_hash(map->slots[j].id) & mask;
+        // the entry can move to the hole only if its home slot is not between the hole and itself
+        if(((j - home) & mask) >= ((j - hole) & mask)) {
+            map->slots[hole] = map->slots[j];
+            hole = j;
+        }
+    }
+    map->slots[hole].id = 0;
+    map->slots[hole].value = NULL;
+    map->count--;
+    return true;
+}
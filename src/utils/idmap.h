@@ -0,0 +1,49 @@
+#ifndef IDMAP_H
+#define IDMAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Map of nonzero 32bit ids to pointers, for fast lookups of things by their id.
+ * Entries are stored inline in an open addressed table, so only growing the table allocates.
+ */
+typedef struct idmap_slot_t {
+    uint32_t id; // 0 marks an empty slot
+    void *value;
+} idmap_slot;
+
+typedef struct idmap_t {
+    idmap_slot *slots;
+    uint32_t capacity; // always a power of two
+    uint32_t count;
+} idmap;
+
+void idmap_create(idmap *map);
+void idmap_free(idmap *map);
+
+/**
+ * Remove all entries, keeping the allocated table.
+ */
+void idmap_clear(idmap *map);
+
+/**
+ * Set the value for an id, replacing the old one if the id is already in the map.
+ */
+void idmap_put(idmap *map, uint32_t id, void *value);
+
+/**
+ * @return the value for an id, or NULL if it is not in the map
+ */
+void *idmap_get(const idmap *map, uint32_t id);
+
+/**
+ * @return true if the id was in the map
+ */
+bool idmap_del(idmap *map, uint32_t id);
+
+static inline uint32_t idmap_size(const idmap *map) {
+    return map->count;
+}
+
+#endif // IDMAP_H
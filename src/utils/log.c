@@ -8,6 +8,7 @@
 #include <time.h>
 
 #include "utils/allocator.h"
+#include "utils/time_fmt.h"
 
 #define MAX_TARGETS 3
 #define LOG_LEVELS 4
@@ -127,9 +128,9 @@ void log_add_file(const char *filename, log_level level) {
 }
 
 static void format_timestamp(char *buffer, size_t len) {
-    time_t t = time(NULL);
-    struct tm *tm = localtime(&t);
-    strftime(buffer, len, "%H:%M:%S", tm);
+    struct tm tm;
+    local_time(time(NULL), &tm);
+    strftime(buffer, len, "%H:%M:%S", &tm);
     buffer[len - 1] = 0;
 }
 
@@ -8,8 +8,13 @@
 #if defined(_WIN32) || defined(WIN32)
 #include <windows.h>
 #else
+#include "utils/hashmap.h"
+#include <SDL_atomic.h>
+#include <ctype.h>
 #include <dirent.h>
 #include <libgen.h>
+#include <sys/stat.h>
+#include <time.h>
 #endif
 
 int scan_directory(list *dir_list, const char *dir) {
@@ -46,6 +51,109 @@ int scan_directory(list *dir_list, const char *dir) {
 #endif
 }
 
+#if !defined(_WIN32) && !defined(WIN32)
+
+/**
+ * Lowercased file names of one directory, mapped to their real names. The index is rebuilt when the directory's
+ * mtime changes. Since mtime only has a resolution of a second, an index built in the same second as the last
+ * change may miss files added later in that second. Such an index is rebuilt once a later second has started, or
+ * when a lookup in it fails.
+ */
+typedef struct dir_index {
+    time_t mtime;
+    time_t scanned;
+    hashmap names;
+} dir_index;
+
+// Directory path -> dir_index. Lookups come from both the main thread and the asset loader thread. The lock is only
+// held for hashmap access; directories are read without it.
+static hashmap dir_indexes;
+static bool dir_indexes_created = false;
+static SDL_SpinLock dir_indexes_lock = 0;
+
+static void lowercase_copy(char *dst, const char *src, size_t size) {
+    size_t i = 0;
+    for(; src[i] != '\0' && i + 1 < size; i++) {
+        dst[i] = tolower((unsigned char)src[i]);
+    }
+    dst[i] = '\0';
+}
+
+static void free_dir_index(void *value) {
+    dir_index *index = value;
+    hashmap_free(&index->names);
+}
+
+static bool build_dir_index(dir_index *index, const char *directory, time_t mtime) {
+    DIR *dp;
+    struct dirent *entry;
+    // Take the time before reading, so that changes made during the read count as newer than the index.
+    index->scanned = time(NULL);
+    index->mtime = mtime;
+    if((dp = opendir(directory)) == NULL) {
+        return false;
+    }
+    hashmap_create(&index->names);
+    char key[256];
+    void *existing;
+    while((entry = readdir(dp)) != NULL) {
+        lowercase_copy(key, entry->d_name, sizeof(key));
+        // Like the linear scan before this, the first of several names differing only in case wins.
+        if(hashmap_get_str(&index->names, key, &existing, NULL) != 0) {
+            hashmap_put_str(&index->names, key, entry->d_name, strlen(entry->d_name) + 1);
+        }
+    }
+    closedir(dp);
+    return true;
+}
+
+/**
+ * Look up a file in the index of a directory. Must hold dir_indexes_lock.
+ * @return 1 if found, 0 if not found, -1 if the index is missing or must be rebuilt first.
+ */
+static int find_in_dir_index(const char *directory, time_t mtime, const char *key, char *path, size_t path_size) {
+    dir_index *index;
+    if(!dir_indexes_created || hashmap_get_str(&dir_indexes, directory, (void **)&index, NULL) != 0 ||
+       index->mtime != mtime) {
+        return -1;
+    }
+    bool ambiguous = index->scanned <= index->mtime;
+    if(ambiguous && time(NULL) > index->scanned) {
+        return -1;
+    }
+    const char *real_name;
+    if(hashmap_get_str(&index->names, key, (void **)&real_name, NULL) == 0) {
+        snprintf(path, path_size, "%s/%s", directory, real_name);
+        return 1;
+    }
+    return ambiguous ? -1 : 0;
+}
+
+/**
+ * Replace the index of a directory with a freshly built one. Must hold dir_indexes_lock.
+ */
+static void store_dir_index(const char *directory, const dir_index *fresh) {
+    if(!dir_indexes_created) {
+        hashmap_create_cb(&dir_indexes, free_dir_index);
+        dir_indexes_created = true;
+    }
+    dir_index *index;
+    if(hashmap_get_str(&dir_indexes, directory, (void **)&index, NULL) == 0) {
+        hashmap_free(&index->names);
+        *index = *fresh;
+    } else {
+        hashmap_put(&dir_indexes, directory, strlen(directory) + 1, fresh, sizeof(dir_index));
+    }
+}
+
+static void drop_dir_index(const char *directory) {
+    if(dir_indexes_created) {
+        hashmap_del_str(&dir_indexes, directory);
+    }
+}
+
+#endif
+
 bool scan_directory_for_file(char *path, size_t path_size) {
 #if defined(_WIN32) || defined(WIN32)
     return true;
@@ -55,30 +163,62 @@ bool scan_directory_for_file(char *path, size_t path_size) {
     char *fn = basename(path_dup);
     char *directory = dirname(path_dup2);
 
-    list dir_list;
-    list_create(&dir_list);
-    if(scan_directory(&dir_list, directory) != 0) {
-        list_free(&dir_list);
-        omf_free(path_dup);
-        omf_free(path_dup2);
-        return false;
+    char key[256];
+    lowercase_copy(key, fn, sizeof(key));
+    int found = 0;
+
+    struct stat st;
+    if(stat(directory, &st) != 0) {
+        SDL_AtomicLock(&dir_indexes_lock);
+        drop_dir_index(directory);
+        SDL_AtomicUnlock(&dir_indexes_lock);
+        goto exit_0;
+    }
+
+    SDL_AtomicLock(&dir_indexes_lock);
+    found = find_in_dir_index(directory, st.st_mtime, key, path, path_size);
+    SDL_AtomicUnlock(&dir_indexes_lock);
+    if(found >= 0) {
+        goto exit_0;
     }
-    iterator it;
-    list_iter_begin(&dir_list, &it);
-    const char *iter_fn;
-    size_t fn_len = strlen(fn);
-    bool found = false;
-    foreach(it, iter_fn) {
-        if(strlen(iter_fn) == fn_len && omf_strncasecmp(fn, iter_fn, fn_len) == 0) {
-            snprintf(path, path_size, "%s/%s", directory, iter_fn);
-            found = true;
-            break;
+
+    // Read the directory without holding the lock. If two threads do this at once, the last index stored wins;
+    // both are up to date.
+    dir_index fresh;
+    bool built = build_dir_index(&fresh, directory, st.st_mtime);
+    if(built) {
+        // The index was just read, so look in it directly. Going through find_in_dir_index would call it stale if
+        // the clock moved on to the next second while reading the directory.
+        const char *real_name;
+        found = hashmap_get_str(&fresh.names, key, (void **)&real_name, NULL) == 0;
+        if(found) {
+            snprintf(path, path_size, "%s/%s", directory, real_name);
         }
     }
+    SDL_AtomicLock(&dir_indexes_lock);
+    if(built) {
+        store_dir_index(directory, &fresh);
+    } else {
+        drop_dir_index(directory);
+        found = 0;
+    }
+    SDL_AtomicUnlock(&dir_indexes_lock);
+
+exit_0:
     omf_free(path_dup);
     omf_free(path_dup2);
-    list_free(&dir_list);
-    return found;
+    return found > 0;
+#endif
+}
+
+void scan_directory_index_free(void) {
+#if !defined(_WIN32) && !defined(WIN32)
+    SDL_AtomicLock(&dir_indexes_lock);
+    if(dir_indexes_created) {
+        hashmap_free(&dir_indexes);
+        dir_indexes_created = false;
+    }
+    SDL_AtomicUnlock(&dir_indexes_lock);
 #endif
 }
 
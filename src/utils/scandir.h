@@ -5,9 +5,13 @@
 
 int scan_directory(list *dir_list, const char *dir);
 
-/* Case insensitive scan for the file in path, modify the argument path. */
+/* Case insensitive scan for the file in path, modify the argument path.
+ * Directories are indexed on first use, and only read again after they change. */
 bool scan_directory_for_file(char *path, size_t path_size);
 
+/* Free the directory indexes kept by scan_directory_for_file. */
+void scan_directory_index_free(void);
+
 int scan_directory_prefix(list *dir_list, const char *dir, const char *prefix);
 int scan_directory_suffix(list *dir_list, const char *dir, const char *suffix);
 
@@ -2,10 +2,18 @@
 #include "utils/allocator.h"
 #include <time.h>
 
+void local_time(time_t t, struct tm *tm) {
+#if defined(_WIN32) || defined(WIN32)
+    localtime_s(tm, &t);
+#else
+    localtime_r(&t, tm);
+#endif
+}
+
 char *format_time(void) {
-    time_t t = time(NULL);
-    struct tm *tm = localtime(&t);
+    struct tm tm;
+    local_time(time(NULL), &tm);
     char *buffer = omf_malloc(32);
-    strftime(buffer, 32, "%Y%m%d_%H%M%S", tm);
+    strftime(buffer, 32, "%Y%m%d_%H%M%S", &tm);
     return buffer;
 }
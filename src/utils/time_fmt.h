@@ -2,7 +2,13 @@
 #define TIME_FMT_H
 
 #include <string.h>
+#include <time.h>
 
 char *format_time(void);
 
+/**
+ * Thread safe localtime(). Fills tm with the local time of t.
+ */
+void local_time(time_t t, struct tm *tm);
+
 #endif // TIME_FMT_H
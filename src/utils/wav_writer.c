@@ -0,0 +1,93 @@
+#include "utils/wav_writer.h"
+#include "utils/allocator.h"
+#include "utils/log.h"
+#include "utils/miscmath.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+#define WAV_HEADER_SIZE 44
+#define WRITE_BLOCK 1024
+
+typedef struct wav_writer {
+    FILE *handle;
+    unsigned sample_rate;
+    unsigned channels;
+    uint32_t data_bytes;
+    bool failed;
+} wav_writer;
+
+static void put_u16(unsigned char *dst, uint16_t value) {
+    dst[0] = value & 0xFF;
+    dst[1] = value >> 8;
+}
+
+static void put_u32(unsigned char *dst, uint32_t value) {
+    put_u16(dst, value & 0xFFFF);
+    put_u16(dst + 2, value >> 16);
+}
+
+static bool write_header(FILE *handle, unsigned sample_rate, unsigned channels, uint32_t data_bytes) {
+    unsigned char header[WAV_HEADER_SIZE] = "RIFF....WAVEfmt ....................data....";
+    put_u32(header + 4, WAV_HEADER_SIZE - 8 + data_bytes);
+    put_u32(header + 16, 16);                         // fmt chunk size
+    put_u16(header + 20, 1);                          // PCM
+    put_u16(header + 22, channels);                   // Channels
+    put_u32(header + 24, sample_rate);                // Sample rate
+    put_u32(header + 28, sample_rate * channels * 2); // Bytes per second
+    put_u16(header + 32, channels * 2);               // Bytes per frame
+    put_u16(header + 34, 16);                         // Bits per sample
+    put_u32(header + 40, data_bytes);                 // Data chunk size
+    return fwrite(header, WAV_HEADER_SIZE, 1, handle) == 1;
+}
+
+wav_writer *wav_writer_open(const char *filename, unsigned sample_rate, unsigned channels) {
+    assert(filename != NULL);
+    FILE *handle = fopen(filename, "wb");
+    if(handle == NULL) {
+        log_error("Unable to write WAV file: Could not open %s for writing", filename);
+        return NULL;
+    }
+    wav_writer *wav = omf_calloc(1, sizeof(wav_writer));
+    wav->handle = handle;
+    wav->sample_rate = sample_rate;
+    wav->channels = channels;
+    wav->failed = !write_header(handle, sample_rate, channels, 0);
+    return wav;
+}
+
+bool wav_writer_write(wav_writer *wav, const int16_t *samples, unsigned frames) {
+    // Samples are stored little-endian regardless of the host.
+    unsigned char block[WRITE_BLOCK * 2];
+    unsigned count = frames * wav->channels;
+    for(unsigned done = 0; done < count;) {
+        unsigned n = min2(count - done, WRITE_BLOCK);
+        for(unsigned i = 0; i < n; i++) {
+            put_u16(block + i * 2, (uint16_t)samples[done + i]);
+        }
+        if(fwrite(block, 2, n, wav->handle) != n) {
+            wav->failed = true;
+            return false;
+        }
+        done += n;
+    }
+    wav->data_bytes += count * 2;
+    return true;
+}
+
+bool wav_writer_close(wav_writer **wav) {
+    wav_writer *obj = *wav;
+    if(obj == NULL) {
+        return false;
+    }
+    // Rewrite the header, now that the sizes are known.
+    bool success = !obj->failed && fseek(obj->handle, 0, SEEK_SET) == 0 &&
+                   write_header(obj->handle, obj->sample_rate, obj->channels, obj->data_bytes);
+    success = fclose(obj->handle) == 0 && success;
+    if(!success) {
+        log_error("Unable to write WAV file: Write failed");
+    }
+    omf_free(obj);
+    *wav = NULL;
+    return success;
+}
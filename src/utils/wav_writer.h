@@ -0,0 +1,25 @@
+#ifndef WAV_WRITER_H
+#define WAV_WRITER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Streaming writer for 16-bit PCM WAV files. The header sizes are filled in when the file is closed.
+ */
+typedef struct wav_writer wav_writer;
+
+wav_writer *wav_writer_open(const char *filename, unsigned sample_rate, unsigned channels);
+
+/**
+ * Append frames of interleaved samples.
+ */
+bool wav_writer_write(wav_writer *wav, const int16_t *samples, unsigned frames);
+
+/**
+ * Finish the header and close the file.
+ * @return false if anything failed to write along the way.
+ */
+bool wav_writer_close(wav_writer **wav);
+
+#endif // WAV_WRITER_H
@@ -0,0 +1,137 @@
+#include "video/renderers/capture_queue.h"
+
+#include <SDL_mutex.h>
+#include <SDL_thread.h>
+
+#include "utils/allocator.h"
+#include "utils/log.h"
+
+typedef struct capture_job {
+    video_screenshot_signal signal;
+    SDL_Rect rect;
+    unsigned char *data;
+    bool flipped;
+} capture_job;
+
+typedef struct capture_queue {
+    SDL_Thread *thread;
+    SDL_mutex *lock;
+    SDL_cond *cond;
+    capture_job *jobs;
+    int capacity;
+    int head;
+    int count;
+    bool closing;
+    unsigned int handled;
+    unsigned int dropped;
+    unsigned int unreported; // Frames dropped since the last capture_queue_report_drops
+} capture_queue;
+
+static void run_job(capture_job *job) {
+    job->signal(&job->rect, job->data, job->flipped);
+    omf_free(job->data);
+}
+
+static int capture_thread(void *userdata) {
+    capture_queue *queue = userdata;
+    SDL_LockMutex(queue->lock);
+    while(true) {
+        while(queue->count == 0 && !queue->closing) {
+            SDL_CondWait(queue->cond, queue->lock);
+        }
+        if(queue->count == 0) {
+            break; // Closing, and everything has been handled.
+        }
+        capture_job job = queue->jobs[queue->head];
+        queue->head = (queue->head + 1) % queue->capacity;
+        queue->count--;
+
+        // Don't hold the lock while encoding, so that the render thread can keep pushing.
+        SDL_UnlockMutex(queue->lock);
+        run_job(&job);
+        SDL_LockMutex(queue->lock);
+        queue->handled++;
+    }
+    SDL_UnlockMutex(queue->lock);
+    return 0;
+}
+
+capture_queue *capture_queue_create(int capacity) {
+    capture_queue *queue = omf_calloc(1, sizeof(capture_queue));
+    queue->jobs = omf_calloc(capacity, sizeof(capture_job));
+    queue->capacity = capacity;
+    queue->lock = SDL_CreateMutex();
+    queue->cond = SDL_CreateCond();
+    if(queue->lock != NULL && queue->cond != NULL) {
+        queue->thread = SDL_CreateThread(capture_thread, "capture", queue);
+    }
+    if(queue->thread == NULL) {
+        log_error("Unable to start capture thread, frames are handled on the render thread: %s", SDL_GetError());
+    }
+    return queue;
+}
+
+void capture_queue_free(capture_queue **queue) {
+    capture_queue *obj = *queue;
+    if(obj != NULL) {
+        if(obj->thread != NULL) {
+            SDL_LockMutex(obj->lock);
+            obj->closing = true;
+            SDL_CondSignal(obj->cond);
+            SDL_UnlockMutex(obj->lock);
+            SDL_WaitThread(obj->thread, NULL);
+        }
+        capture_queue_report_drops(obj);
+        if(obj->handled > 0 || obj->dropped > 0) {
+            log_debug("Capture queue closed: %u frames handled, %u dropped", obj->handled, obj->dropped);
+        }
+        if(obj->cond != NULL) {
+            SDL_DestroyCond(obj->cond);
+        }
+        if(obj->lock != NULL) {
+            SDL_DestroyMutex(obj->lock);
+        }
+        omf_free(obj->jobs);
+        omf_free(obj);
+        *queue = NULL;
+    }
+}
+
+bool capture_queue_push(capture_queue *queue, video_screenshot_signal signal, const SDL_Rect *rect,
+                        unsigned char *data, bool flipped) {
+    capture_job job = {signal, *rect, data, flipped};
+    if(queue->thread == NULL) {
+        run_job(&job);
+        queue->handled++;
+        return true;
+    }
+
+    SDL_LockMutex(queue->lock);
+    if(queue->count == queue->capacity) {
+        // Only warn about the first frame; the rest are counted and reported by capture_queue_report_drops.
+        bool first = queue->unreported == 0;
+        queue->dropped++;
+        queue->unreported++;
+        SDL_UnlockMutex(queue->lock);
+        if(first) {
+            log_warn("Capture queue is full, dropping %dx%d frames", rect->w, rect->h);
+        }
+        omf_free(data);
+        return false;
+    }
+    queue->jobs[(queue->head + queue->count) % queue->capacity] = job;
+    queue->count++;
+    SDL_CondSignal(queue->cond);
+    SDL_UnlockMutex(queue->lock);
+    return true;
+}
+
+void capture_queue_report_drops(capture_queue *queue) {
+    SDL_LockMutex(queue->lock);
+    unsigned int count = queue->unreported;
+    queue->unreported = 0;
+    SDL_UnlockMutex(queue->lock);
+    if(count > 0) {
+        log_warn("Capture queue was full, %u frames were dropped", count);
+    }
+}
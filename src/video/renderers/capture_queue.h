@@ -0,0 +1,37 @@
+#ifndef CAPTURE_QUEUE_H
+#define CAPTURE_QUEUE_H
+
+#include "video/renderers/renderer.h"
+
+/**
+ * Bounded queue of captured frames, and a thread that hands them over to their screenshot signals. This keeps
+ * image encoding and file writes out of the render thread.
+ */
+typedef struct capture_queue capture_queue;
+
+/**
+ * Create the queue and start its thread. If the thread cannot be started, frames are handed over right away
+ * from the calling thread instead.
+ * @param capacity Maximum number of frames waiting to be handled
+ */
+capture_queue *capture_queue_create(int capacity);
+
+/**
+ * Wait until all queued frames have been handled, and stop the thread.
+ */
+void capture_queue_free(capture_queue **queue);
+
+/**
+ * Queue a frame for the signal. The queue takes ownership of data, and frees it after the signal returns.
+ * @return false if the queue was full. The frame is then dropped, and data freed.
+ */
+bool capture_queue_push(capture_queue *queue, video_screenshot_signal signal, const SDL_Rect *rect,
+                        unsigned char *data, bool flipped);
+
+/**
+ * Log how many frames were dropped since the last report, if any. Only the first dropped frame is logged when it
+ * happens, so call this when a capture ends.
+ */
+void capture_queue_report_drops(capture_queue *queue);
+
+#endif // CAPTURE_QUEUE_H
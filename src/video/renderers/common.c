@@ -1,5 +1,6 @@
 #include "video/renderers/common.h"
 #include "utils/miscmath.h"
+#include <math.h>
 
 void find_resolution_for_aspect_ratio(SDL_Rect *view, const SDL_Rect *window, unsigned x_ratio, unsigned y_ratio) {
     float rx = (float)x_ratio / y_ratio;
@@ -9,3 +10,13 @@ void find_resolution_for_aspect_ratio(SDL_Rect *view, const SDL_Rect *window, un
     view->x = (window->w - view->w) / 2;
     view->y = (window->h - view->h) / 2;
 }
+
+void build_opacity_noise(int *rows) {
+    // OMF had a fairly random offset for each row, because they applied their noise row by row.
+    // They then changed the threshold by 0x6b for each subsequent X, which is the 107 * (2 * x + 1) / 512 part.
+    const double phi = 1.61803398874989484820459;
+    for(int y = 0; y < OPACITY_NOISE_ROWS; y++) {
+        double value = tan(10.0 * phi * (y + 0.5));
+        rows[y] = (int)((value - floor(value)) * OPACITY_NOISE_STEPS) % OPACITY_NOISE_STEPS;
+    }
+}
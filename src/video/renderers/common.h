@@ -5,4 +5,15 @@
 
 void find_resolution_for_aspect_ratio(SDL_Rect *view, const SDL_Rect *window, unsigned ratio_w, unsigned ratio_h);
 
+#define OPACITY_NOISE_ROWS 200 ///< One noise offset for every row of the 320x200 framebuffer
+#define OPACITY_NOISE_STEPS 512
+
+/**
+ * Build the per-row offsets of the opacity noise, in 1/OPACITY_NOISE_STEPS steps. Rows are counted from the bottom,
+ * as in gl_FragCoord. Pixel x of row y is dropped when
+ * ((rows[y] + 107 * (2 * x + 1)) % OPACITY_NOISE_STEPS) * 255 > opacity * OPACITY_NOISE_STEPS.
+ * This is integer math, so every renderer drops the same pixels.
+ */
+void build_opacity_noise(int *rows);
+
 #endif // VIDEO_COMMON_H
@@ -1,8 +1,10 @@
 #include "video/renderers/opengl3/gl3_renderer.h"
+#include "video/renderers/capture_queue.h"
 #include "video/renderers/common.h"
 #include "video/renderers/opengl3/sdl_window.h"
 
 #include "video/renderers/opengl3/helpers/object_array.h"
+#include "video/renderers/opengl3/helpers/readback.h"
 #include "video/renderers/opengl3/helpers/remaps.h"
 #include "video/renderers/opengl3/helpers/render_target.h"
 #include "video/renderers/opengl3/helpers/shaders.h"
@@ -21,6 +23,9 @@
 #define PAL_BLOCK_BINDING 0
 #define NATIVE_W 320
 #define NATIVE_H 200
+#define ATLAS_PAGE_SIZE 2048
+#define ATLAS_MAX_PAGES 4
+#define CAPTURE_QUEUE_SIZE 8
 
 typedef struct gl3_context {
     SDL_Window *window;
@@ -30,6 +35,8 @@ typedef struct gl3_context {
     shared *shared;
     render_target *target;
     remaps *remaps;
+    capture_queue *captures;
+    readback *readback;
 
     int viewport_w;
     int viewport_h;
@@ -51,6 +58,9 @@ typedef struct gl3_context {
     GLuint rgba_prog_id;
 
     video_screenshot_signal screenshot_cb;
+    video_screenshot_signal stream_cb;
+    unsigned stream_interval;
+    unsigned stream_frame;
 } gl3_context;
 
 static bool is_available(void) {
@@ -115,11 +125,13 @@ static bool setup_context(void *userdata, int window_w, int window_h, bool fulls
     glPixelStorei(GL_PACK_ALIGNMENT, 1);
 
     // Create the rest of the graphics objects
-    ctx->atlas = atlas_create(TEX_UNIT_ATLAS, 2048, 2048);
-    ctx->objects = object_array_create(2048.0f, 2048.0f);
+    ctx->atlas = atlas_create(TEX_UNIT_ATLAS, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, ATLAS_MAX_PAGES);
+    ctx->objects = object_array_create(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE);
     ctx->shared = shared_create();
     ctx->target = render_target_create(TEX_UNIT_FBO, NATIVE_W, NATIVE_H, GL_RGBA8, GL_RGBA);
     ctx->remaps = remaps_create(TEX_UNIT_REMAPS);
+    ctx->captures = capture_queue_create(CAPTURE_QUEUE_SIZE);
+    ctx->readback = readback_create(ctx->captures);
 
     vga_state_mark_dirty();
 
@@ -132,6 +144,9 @@ static bool setup_context(void *userdata, int window_w, int window_h, bool fulls
     bind_uniform_4fv(ctx->palette_prog_id, "projection", projection_matrix);
     bind_uniform_1i(ctx->palette_prog_id, "atlas", TEX_UNIT_ATLAS);
     bind_uniform_1i(ctx->palette_prog_id, "remaps", TEX_UNIT_REMAPS);
+    GLint noise_rows[OPACITY_NOISE_ROWS];
+    build_opacity_noise(noise_rows);
+    bind_uniform_1iv(ctx->palette_prog_id, "noise_rows", noise_rows, OPACITY_NOISE_ROWS);
 
     // Activate RGBA conversion program, and bind palette etc.
     activate_program(ctx->rgba_prog_id);
@@ -197,6 +212,8 @@ static void reset_context(void *userdata) {
 
 static void close_context(void *userdata) {
     gl3_context *ctx = userdata;
+    readback_free(&ctx->readback);
+    capture_queue_free(&ctx->captures);
     remaps_free(&ctx->remaps);
     render_target_free(&ctx->target);
     shared_free(&ctx->shared);
@@ -213,9 +230,9 @@ static void draw_surface(void *userdata, const surface *src_surface, SDL_Rect *d
                          int palette_offset, int palette_limit, int opacity, unsigned int flip_mode,
                          unsigned int options) {
     gl3_context *ctx = userdata;
-    uint16_t tx, ty, tw, th;
-    if(atlas_get(ctx->atlas, src_surface, &tx, &ty, &tw, &th)) {
-        object_array_add(ctx->objects, dst->x, dst->y, dst->w, dst->h, tx, ty, tw, th, flip_mode,
+    uint16_t page, tx, ty, tw, th;
+    if(atlas_get(ctx->atlas, src_surface, &page, &tx, &ty, &tw, &th)) {
+        object_array_add(ctx->objects, dst->x, dst->y, dst->w, dst->h, page, tx, ty, tw, th, flip_mode,
                          src_surface->transparent, remap_offset, remap_rounds, palette_offset, palette_limit, opacity,
                          options);
     }
@@ -230,6 +247,7 @@ static void move_target(void *userdata, int x, int y) {
 static void render_prepare(void *userdata, unsigned framebuffer_options) {
     gl3_context *ctx = userdata;
     object_array_prepare(ctx->objects);
+    atlas_next_frame(ctx->atlas);
 
     bind_uniform_1u(ctx->rgba_prog_id, "framebuffer_options", framebuffer_options);
 }
@@ -262,14 +280,22 @@ static inline void video_set_blend_mode(gl3_context *ctx, object_array_blend_mod
     ctx->current_blend_mode = request_mode;
 }
 
-// TODO: Use asynchronous capture + PBO here.
-static void capture_screenshot(void *userdata) {
-    gl3_context *ctx = userdata;
+/**
+ * Start reading back the freshly rendered screen, if a screenshot was requested or a capture stream is due.
+ * The pixels reach the signal a frame or two later, through the capture thread.
+ */
+static void capture_screenshots(gl3_context *ctx) {
     SDL_Rect r = {0, 0, ctx->screen_w, ctx->screen_h};
-    unsigned char *buffer = omf_malloc(r.w * r.h * 3);
-    glReadPixels(r.x, r.y, r.w, r.h, GL_RGB, GL_UNSIGNED_BYTE, buffer);
-    ctx->screenshot_cb(&r, buffer, true); // TODO: should preferably happen in a thread.
-    omf_free(buffer);
+    if(ctx->screenshot_cb) {
+        readback_start(ctx->readback, &r, ctx->screenshot_cb);
+        ctx->screenshot_cb = NULL;
+    }
+    if(ctx->stream_cb) {
+        if(ctx->stream_frame == 0) {
+            readback_start(ctx->readback, &r, ctx->stream_cb);
+        }
+        ctx->stream_frame = (ctx->stream_frame + 1) % ctx->stream_interval;
+    }
 }
 
 #define ASPECT_X (4.0f / 3.0f)
@@ -328,8 +354,10 @@ static inline void finish_offscreen(gl3_context *ctx) {
     render_target_activate(ctx->target);
 
     object_array_blend_mode mode;
-    while(object_array_get_batch(ctx->objects, &batch, &mode)) {
+    int page;
+    while(object_array_get_batch(ctx->objects, &batch, &mode, &page)) {
         video_set_blend_mode(ctx, mode);
+        atlas_bind_page(ctx->atlas, page);
         object_array_draw(ctx->objects, &batch);
     }
 }
@@ -343,6 +371,7 @@ static inline void finish_onscreen(gl3_context *ctx) {
     video_set_blend_mode(ctx, MODE_SET);
     activate_program(ctx->rgba_prog_id);
     if(ctx->draw_atlas) {
+        atlas_bind_page(ctx->atlas, 0);
         bind_uniform_1i(ctx->rgba_prog_id, "framebuffer", TEX_UNIT_ATLAS);
     } else {
         bind_uniform_1i(ctx->rgba_prog_id, "framebuffer", TEX_UNIT_FBO);
@@ -359,15 +388,15 @@ static void render_finish(void *userdata) {
     finish_onscreen(ctx);
 
     // Snap screenshot from the freshly rendered state.
-    if(ctx->screenshot_cb) {
-        capture_screenshot(ctx);
-        ctx->screenshot_cb = NULL;
-    }
+    capture_screenshots(ctx);
 
     // Flip buffers. If vsync is off, we should sleep here
     // so hat our main loop doesn't eat up all cpu :)
     SDL_GL_SwapWindow(ctx->window);
 
+    // Pick up the screenshots of earlier frames that the GPU is done with.
+    readback_poll(ctx->readback, false);
+
     // Limit framerate if requested.
     if(ctx->framerate_limit != 0) {
         uint64_t frame_time = SDL_GetPerformanceCounter() - ctx->last_tick;
@@ -383,6 +412,7 @@ static void render_finish(void *userdata) {
 static void render_area_prepare(void *userdata, const SDL_Rect *area) {
     gl3_context *ctx = userdata;
     object_array_prepare(ctx->objects);
+    atlas_next_frame(ctx->atlas);
     ctx->culling_area = *area;
 }
 
@@ -402,6 +432,17 @@ static void capture_screen(void *userdata, video_screenshot_signal screenshot_cb
     ctx->screenshot_cb = screenshot_cb;
 }
 
+static void capture_stream(void *userdata, video_screenshot_signal screenshot_cb, unsigned interval) {
+    gl3_context *ctx = userdata;
+    if(ctx->stream_cb != NULL) {
+        // Previous capture ends here. Frames still being read back are reported when the queue is freed.
+        capture_queue_report_drops(ctx->captures);
+    }
+    ctx->stream_cb = (interval > 0) ? screenshot_cb : NULL;
+    ctx->stream_interval = interval;
+    ctx->stream_frame = 0;
+}
+
 static void signal_scene_change(void *userdata) {
     gl3_context *ctx = userdata;
     atlas_reset(ctx->atlas);
@@ -442,6 +483,7 @@ void gl3_renderer_set_callbacks(renderer *gl3_renderer) {
     gl3_renderer->render_area_finish = render_area_finish;
 
     gl3_renderer->capture_screen = capture_screen;
+    gl3_renderer->capture_stream = capture_stream;
     gl3_renderer->signal_scene_change = signal_scene_change;
     gl3_renderer->signal_draw_atlas = signal_draw_atlas;
 }
@@ -26,6 +26,8 @@ typedef struct {
     GLint palette_limit;
     GLint opacity;
     GLuint options;
+    GLfloat tex_top;    // Top edge of the sprite in the atlas
+    GLfloat tex_bottom; // Bottom edge of the sprite in the atlas
 } object_data;
 static_assert(4 == alignof(object_data), "object_data alignment is expected to be 4");
 
@@ -40,6 +42,7 @@ typedef struct object_array {
     GLint fans_starts[MAX_FANS];
     GLsizei fans_sizes[MAX_FANS];
     object_array_blend_mode modes[MAX_FANS];
+    int pages[MAX_FANS]; // Texture atlas page of each object
 } object_array;
 
 #define ATTRIB(index, stride, step, size, type, normalize)                                                             \
@@ -55,7 +58,7 @@ typedef struct object_array {
     index++
 
 static void setup_vao_layout(void) {
-    int stride = 4 * sizeof(GLfloat) + 7 * sizeof(GLint);
+    int stride = 6 * sizeof(GLfloat) + 7 * sizeof(GLint);
     int index = 0;
     unsigned char *step = 0;
     ATTRIB(index, stride, step, 2, GL_FLOAT, GL_FALSE);
@@ -67,6 +70,7 @@ static void setup_vao_layout(void) {
     ATTRIB_I(index, stride, step, 1, GL_INT);
     ATTRIB_I(index, stride, step, 1, GL_INT);
     ATTRIB_I(index, stride, step, 1, GL_UNSIGNED_INT);
+    ATTRIB(index, stride, step, 2, GL_FLOAT, GL_FALSE);
 }
 
 object_array *object_array_create(GLfloat src_w, GLfloat src_h) {
@@ -109,22 +113,28 @@ void object_array_begin(const object_array *array, object_array_batch *state) {
     state->start = 0;
     state->end = 0;
     state->mode = (array->item_count > 0) ? array->modes[0] : MODE_SET;
+    state->page = (array->item_count > 0) ? array->pages[0] : 0;
 }
 
-bool object_array_get_batch(const object_array *array, object_array_batch *state, object_array_blend_mode *mode) {
+bool object_array_get_batch(const object_array *array, object_array_batch *state, object_array_blend_mode *mode,
+                            int *page) {
     if(state->end >= array->item_count) {
         return false;
     }
     state->start = state->end;
     object_array_blend_mode next;
+    int next_page;
     do {
         next = array->modes[state->end];
-        if(next != state->mode)
+        next_page = array->pages[state->end];
+        if(next != state->mode || next_page != state->page)
             break;
         state->end++;
     } while(state->end < array->item_count);
     *mode = state->mode;
+    *page = state->page;
     state->mode = next;
+    state->page = next_page;
     return true;
 }
 
@@ -146,8 +156,8 @@ void object_array_draw(const object_array *array, object_array_batch *state) {
     ptr.opacity = opacity;                                                                                             \
     ptr.options = options;
 
-static void add_item(object_array *array, float dx, float dy, int x, int y, int w, int h, int tx, int ty, int tw,
-                     int th, int flags, int transparency, int remap_offset, int remap_rounds, int pal_offset,
+static void add_item(object_array *array, float dx, float dy, int x, int y, int w, int h, int page, int tx, int ty,
+                     int tw, int th, int flags, int transparency, int remap_offset, int remap_rounds, int pal_offset,
                      int pal_limit, int opacity, unsigned int options) {
     float tx0, tx1;
     if(flags & FLIP_HORIZONTAL) {
@@ -158,6 +168,8 @@ static void add_item(object_array *array, float dx, float dy, int x, int y, int
         tx1 = (tx + tw) * dx;
     }
 
+    float tex_top = ty * dy;
+    float tex_bottom = (ty + th) * dy;
     float ty0, ty1;
     if(flags & FLIP_VERTICAL) {
         ty0 = (ty + th) * dy;
@@ -177,9 +189,14 @@ static void add_item(object_array *array, float dx, float dy, int x, int y, int
            options);
     COORDS(data[row + 3], x + w, y, tx1, ty0, transparency, remap_offset, remap_rounds, pal_offset, pal_limit, opacity,
            options);
+    for(int i = 0; i < 4; i++) {
+        data[row + i].tex_top = tex_top;
+        data[row + i].tex_bottom = tex_bottom;
+    }
 
     array->fans_starts[array->item_count] = array->item_count * 4;
     array->fans_sizes[array->item_count] = 4;
+    array->pages[array->item_count] = page;
     if(options & SPRITE_DARK_TINT) {
         array->modes[array->item_count] = MODE_DARK_TINT;
     } else if(options & SPRITE_SHADOW) {
@@ -194,15 +211,15 @@ static void add_item(object_array *array, float dx, float dy, int x, int y, int
     array->item_count++;
 }
 
-void object_array_add(object_array *array, int x, int y, int w, int h, int tx, int ty, int tw, int th, int flags,
-                      int transparency, int remap_offset, int remap_rounds, int pal_offset, int pal_limit, int opacity,
-                      unsigned int options) {
+void object_array_add(object_array *array, int x, int y, int w, int h, int page, int tx, int ty, int tw, int th,
+                      int flags, int transparency, int remap_offset, int remap_rounds, int pal_offset, int pal_limit,
+                      int opacity, unsigned int options) {
     if(array->item_count >= MAX_FANS) {
         log_error("Too many objects!");
         return;
     }
     float dx = 1.0f / array->src_w;
     float dy = 1.0f / array->src_h;
-    add_item(array, dx, dy, x, y, w, h, tx, ty, tw, th, flags, transparency, remap_offset, remap_rounds, pal_offset,
-             pal_limit, opacity, options);
+    add_item(array, dx, dy, x, y, w, h, page, tx, ty, tw, th, flags, transparency, remap_offset, remap_rounds,
+             pal_offset, pal_limit, opacity, options);
 }
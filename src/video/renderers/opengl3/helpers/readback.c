@@ -0,0 +1,115 @@
+#include <string.h>
+
+#include "utils/allocator.h"
+#include "utils/log.h"
+#include "video/renderers/opengl3/helpers/readback.h"
+
+// Two buffers are enough to keep reading while the previous frame is still in flight.
+#define READBACK_SLOTS 2
+#define READBACK_WAIT_NS 100000000
+
+typedef struct readback_slot {
+    GLuint pbo_id;
+    GLsizeiptr capacity;
+    GLsync fence; // NULL when the slot is free
+    SDL_Rect area;
+    video_screenshot_signal signal;
+} readback_slot;
+
+typedef struct readback {
+    readback_slot slots[READBACK_SLOTS];
+    int next; // Next slot to start; also the oldest one, if it is in use.
+    capture_queue *queue;
+} readback;
+
+readback *readback_create(capture_queue *queue) {
+    readback *rb = omf_calloc(1, sizeof(readback));
+    GLuint ids[READBACK_SLOTS];
+    glGenBuffers(READBACK_SLOTS, ids);
+    for(int i = 0; i < READBACK_SLOTS; i++) {
+        rb->slots[i].pbo_id = ids[i];
+    }
+    rb->queue = queue;
+    return rb;
+}
+
+/**
+ * Copy the pixels of a finished read out of its pixel buffer, and queue them.
+ */
+static void slot_collect(readback *rb, readback_slot *slot) {
+    GLsizeiptr size = slot->area.w * slot->area.h * 3;
+    unsigned char *data = omf_malloc(size);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo_id);
+    const void *mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    if(mapped != NULL) {
+        memcpy(data, mapped, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glDeleteSync(slot->fence);
+    slot->fence = NULL;
+
+    if(mapped == NULL) {
+        log_error("Unable to map pixel buffer for a %dx%d capture", slot->area.w, slot->area.h);
+        omf_free(data);
+        return;
+    }
+    capture_queue_push(rb->queue, slot->signal, &slot->area, data, true);
+}
+
+static bool slot_ready(readback_slot *slot, bool wait) {
+    GLenum status;
+    do {
+        status = glClientWaitSync(slot->fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? READBACK_WAIT_NS : 0);
+    } while(wait && status == GL_TIMEOUT_EXPIRED);
+    // On GL_WAIT_FAILED there is nothing more to wait for; collect whatever the buffer has.
+    return status != GL_TIMEOUT_EXPIRED;
+}
+
+void readback_poll(readback *rb, bool wait) {
+    for(int i = 0; i < READBACK_SLOTS; i++) {
+        readback_slot *slot = &rb->slots[(rb->next + i) % READBACK_SLOTS];
+        if(slot->fence == NULL) {
+            continue;
+        }
+        if(!slot_ready(slot, wait)) {
+            return; // Keep frames in order; the newer ones can wait for this one.
+        }
+        slot_collect(rb, slot);
+    }
+}
+
+void readback_start(readback *rb, const SDL_Rect *area, video_screenshot_signal signal) {
+    readback_slot *slot = &rb->slots[rb->next];
+    if(slot->fence != NULL) {
+        slot_ready(slot, true);
+        slot_collect(rb, slot);
+    }
+    rb->next = (rb->next + 1) % READBACK_SLOTS;
+
+    GLsizeiptr size = area->w * area->h * 3;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo_id);
+    if(slot->capacity < size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+        slot->capacity = size;
+    }
+    glReadPixels(area->x, area->y, area->w, area->h, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot->area = *area;
+    slot->signal = signal;
+}
+
+void readback_free(readback **rb) {
+    readback *obj = *rb;
+    if(obj != NULL) {
+        readback_poll(obj, true);
+        GLuint ids[READBACK_SLOTS];
+        for(int i = 0; i < READBACK_SLOTS; i++) {
+            ids[i] = obj->slots[i].pbo_id;
+        }
+        glDeleteBuffers(READBACK_SLOTS, ids);
+        omf_free(obj);
+        *rb = NULL;
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef READBACK_H
+#define READBACK_H
+
+#include "video/renderers/capture_queue.h"
+#include <epoxy/gl.h>
+
+/**
+ * Asynchronous framebuffer reads through a ring of pixel buffers. glReadPixels into a pixel buffer returns
+ * without waiting for the GPU; the pixels are mapped on a later frame, once a fence says they are ready, and
+ * handed over to the capture queue.
+ */
+typedef struct readback readback;
+
+readback *readback_create(capture_queue *queue);
+void readback_free(readback **rb);
+
+/**
+ * Start reading an area of the current read framebuffer as RGB. If every pixel buffer is still busy, this waits
+ * for the oldest one to finish first.
+ */
+void readback_start(readback *rb, const SDL_Rect *area, video_screenshot_signal signal);
+
+/**
+ * Hand finished reads over to the capture queue, oldest first.
+ * @param wait Block until all started reads have finished.
+ */
+void readback_poll(readback *rb, bool wait);
+
+#endif // READBACK_H
@@ -157,6 +157,15 @@ void bind_uniform_1u(GLuint program_id, const char *name, GLuint value) {
     glUniform1ui(ref, value);
 }
 
+void bind_uniform_1iv(GLuint program_id, const char *name, const GLint *values, GLsizei count) {
+    GLint ref = glGetUniformLocation(program_id, name);
+    if(ref == -1) {
+        log_error("Unable to find uniform '%s'; glGetUniformLocation() returned -1", name);
+        return;
+    }
+    glUniform1iv(ref, count, values);
+}
+
 void bind_uniform_block(GLuint program_id, const char *name, GLuint binding_id, GLuint buffer) {
     GLuint ref = glGetUniformBlockIndex(program_id, name);
     if(ref == GL_INVALID_INDEX) {
@@ -9,6 +9,7 @@ void activate_program(GLuint program_id);
 void bind_uniform_4fv(GLuint program_id, const char *name, GLfloat *data);
 void bind_uniform_1i(GLuint program_id, const char *name, GLint value);
 void bind_uniform_1u(GLuint program_id, const char *name, GLuint value);
+void bind_uniform_1iv(GLuint program_id, const char *name, const GLint *values, GLsizei count);
 void bind_uniform_block(GLuint program_id, const char *name, GLuint binding_id, GLuint buffer);
 
 #endif // SHADERS_H
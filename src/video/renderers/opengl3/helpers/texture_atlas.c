@@ -1,172 +1,297 @@
 #include <assert.h>
+#include <limits.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "utils/allocator.h"
 #include "utils/hashmap.h"
 #include "utils/log.h"
 #include "utils/vector.h"
+#include "video/renderers/opengl3/helpers/bindings.h"
 #include "video/renderers/opengl3/helpers/texture.h"
 #include "video/renderers/opengl3/helpers/texture_atlas.h"
 
-// WIP
-
 typedef struct {
     uint16_t x;
     uint16_t y;
     uint16_t w;
     uint16_t h;
-} zone;
-static_assert(8 == sizeof(zone), "zone should pack into 8 bytes");
+    uint16_t page;
+} atlas_item;
+static_assert(10 == sizeof(atlas_item), "atlas_item should pack into 10 bytes");
+
+// One segment of the skyline: the top edge of everything packed below it.
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+} skyline_node;
+
+typedef struct {
+    GLuint texture_id;
+    skyline_node *skyline; // Left to right, covering the whole page width
+    int node_count;
+    vector guids; // unsigned int, surfaces stored on this page
+    uint32_t last_used;
+    uint64_t used_texels;
+} atlas_page;
 
 typedef struct texture_atlas {
     hashmap items;
-    vector free_space;
-    GLuint texture_id;
+    atlas_page *pages;
+    int page_count;
+    int page_capacity;
+    int max_pages;
     uint16_t w;
     uint16_t h;
     GLuint tex_unit;
+    uint32_t frame;
+    texture_atlas_stats stats;
 } texture_atlas;
 
-static inline int zone_perimeter(zone *zone) {
-    return zone->w * 2 + zone->h * 2;
+static void page_reset(const texture_atlas *atlas, atlas_page *page) {
+    page->skyline[0].x = 0;
+    page->skyline[0].y = 0;
+    page->skyline[0].w = atlas->w;
+    page->node_count = 1;
+    page->used_texels = 0;
+    vector_clear(&page->guids);
 }
 
-texture_atlas *atlas_create(GLuint tex_unit, uint16_t width, uint16_t height) {
+static atlas_page *page_add(texture_atlas *atlas) {
+    if(atlas->page_count == atlas->page_capacity) {
+        atlas->page_capacity *= 2;
+        atlas->pages = omf_realloc(atlas->pages, atlas->page_capacity * sizeof(atlas_page));
+    }
+    atlas_page *page = &atlas->pages[atlas->page_count++];
+    page->texture_id = texture_create(atlas->tex_unit, atlas->w, atlas->h, GL_R8, GL_RED);
+    // The skyline never has more segments than the page has columns, plus one while inserting.
+    page->skyline = omf_calloc(atlas->w + 1, sizeof(skyline_node));
+    vector_create(&page->guids, sizeof(unsigned int));
+    page_reset(atlas, page);
+    log_debug("Texture atlas page %d (%dx%d) created", atlas->page_count - 1, atlas->w, atlas->h);
+    return page;
+}
+
+texture_atlas *atlas_create(GLuint tex_unit, uint16_t width, uint16_t height, int max_pages) {
     texture_atlas *atlas = omf_calloc(1, sizeof(texture_atlas));
     hashmap_create(&atlas->items);
-    vector_create(&atlas->free_space, sizeof(zone));
     atlas->w = width;
     atlas->h = height;
     atlas->tex_unit = tex_unit;
-    atlas->texture_id = texture_create(tex_unit, width, height, GL_R8, GL_RED);
-    zone item = {0, 0, width, height};
-    vector_append(&atlas->free_space, &item);
-    log_debug("Texture atlas %dx%d created", width, height);
+    atlas->max_pages = max_pages;
+    atlas->page_capacity = max_pages;
+    atlas->pages = omf_calloc(max_pages, sizeof(atlas_page));
+    page_add(atlas);
     return atlas;
 }
 
 void atlas_free(texture_atlas **atlas) {
     texture_atlas *obj = *atlas;
     if(obj != NULL) {
+        for(int i = 0; i < obj->page_count; i++) {
+            texture_free(obj->tex_unit, obj->pages[i].texture_id);
+            vector_free(&obj->pages[i].guids);
+            omf_free(obj->pages[i].skyline);
+        }
+        omf_free(obj->pages);
         hashmap_free(&obj->items);
-        vector_free(&obj->free_space);
-        texture_free(obj->tex_unit, obj->texture_id);
         omf_free(obj);
         *atlas = NULL;
         log_debug("Texture atlas freed");
     }
 }
 
+void atlas_next_frame(texture_atlas *atlas) {
+    atlas->frame++;
+}
+
 /**
- * Finds the first free area that matches our minimum requirements.
+ * Find the lowest y where a w x h area fits, with its left edge at the start of the given skyline segment.
+ * @return y coordinate, or -1 if the area does not fit there.
  */
-static bool find_free_space(const texture_atlas *atlas, uint16_t w, uint16_t h, int *got_index, zone *got_zone) {
-    unsigned int vec_size = vector_size(&atlas->free_space);
-    zone *best_item = NULL, *item;
-    int seek_limit = 10;
-    int best_index = -1, index;
-    int best_perimeter = 4 * 4096 + 1, perimeter;
-    for(int i = 0; i < (int)vec_size; i++) {
-        index = vec_size - i - 1;
-        item = vector_get(&atlas->free_space, index);
-        if(item->w >= w && item->h >= h) {
-            perimeter = zone_perimeter(item);
-            if(perimeter < best_perimeter) {
-                best_index = index;
-                best_perimeter = perimeter;
-                best_item = item;
-            }
+static int skyline_fit(const texture_atlas *atlas, const atlas_page *page, int index, uint16_t w, uint16_t h) {
+    const skyline_node *node = &page->skyline[index];
+    if(node->x + w > atlas->w) {
+        return -1;
+    }
+    int width_left = w;
+    int y = 0;
+    for(int i = index; width_left > 0; i++) {
+        if(page->skyline[i].y > y) {
+            y = page->skyline[i].y;
+        }
+        if(y + h > atlas->h) {
+            return -1;
+        }
+        width_left -= page->skyline[i].w;
+    }
+    return y;
+}
+
+/**
+ * Bottom-left search: pick the position where the top of the area ends up lowest.
+ */
+static bool skyline_find(const texture_atlas *atlas, const atlas_page *page, uint16_t w, uint16_t h, int *got_index,
+                         atlas_item *got_zone) {
+    int best_index = -1;
+    int best_bottom = INT_MAX;
+    int best_width = INT_MAX;
+    for(int i = 0; i < page->node_count; i++) {
+        int y = skyline_fit(atlas, page, i, w, h);
+        if(y < 0) {
+            continue;
+        }
+        if(y + h < best_bottom || (y + h == best_bottom && page->skyline[i].w < best_width)) {
+            best_index = i;
+            best_bottom = y + h;
+            best_width = page->skyline[i].w;
+            got_zone->x = page->skyline[i].x;
+            got_zone->y = y;
         }
-        if(best_index >= 0)
-            seek_limit--;
-        if(!seek_limit)
-            break;
     }
     if(best_index == -1) {
         return false;
     }
+    got_zone->w = w;
+    got_zone->h = h;
     *got_index = best_index;
-    memcpy(got_zone, best_item, sizeof(zone));
     return true;
 }
 
+static void skyline_remove(atlas_page *page, int index) {
+    memmove(&page->skyline[index], &page->skyline[index + 1], (page->node_count - index - 1) * sizeof(skyline_node));
+    page->node_count--;
+}
+
 /**
- * Split found space into smaller pieces.
+ * Raise the skyline over a newly packed area.
  */
-static void split_space(const zone *src, uint16_t w, uint16_t h, zone *a, zone *b) {
-    uint16_t rw = src->w - w;
-    uint16_t rh = src->h - h;
-    if(rh > rw) {
-        a->x = src->x + w;
-        a->y = src->y;
-        a->w = rw;
-        a->h = h;
-        b->x = src->x;
-        b->y = src->y + h;
-        b->w = src->w;
-        b->h = rh;
-    } else {
-        a->x = src->x + w;
-        a->y = src->y;
-        a->w = rw;
-        a->h = src->h;
-        b->x = src->x;
-        b->y = src->y + h;
-        b->w = w;
-        b->h = rh;
-    }
-}
-
-static int space_sort(const void *a_ptr, const void *b_ptr) {
-    zone *a = (zone *)a_ptr;
-    zone *b = (zone *)b_ptr;
-    int a_size = a->w + a->h;
-    int b_size = b->w + b->h;
-    return b_size - a_size;
-}
-
-bool atlas_insert(texture_atlas *atlas, const char *bytes, uint16_t w, uint16_t h, uint16_t *nx, uint16_t *ny) {
-    zone free;
-    int index;
-    if(!find_free_space(atlas, w, h, &index, &free)) {
-        log_error("Texture atlas has no room for %dx%d area", w, h);
-        return false;
+static void skyline_add(atlas_page *page, int index, const atlas_item *area) {
+    memmove(&page->skyline[index + 1], &page->skyline[index], (page->node_count - index) * sizeof(skyline_node));
+    page->node_count++;
+    page->skyline[index].x = area->x;
+    page->skyline[index].y = area->y + area->h;
+    page->skyline[index].w = area->w;
+
+    // Cut away the segments that are now below the new one.
+    for(int i = index + 1; i < page->node_count;) {
+        const skyline_node *prev = &page->skyline[i - 1];
+        skyline_node *node = &page->skyline[i];
+        int overlap = prev->x + prev->w - node->x;
+        if(overlap <= 0) {
+            break;
+        }
+        if(node->w <= overlap) {
+            skyline_remove(page, i);
+            continue;
+        }
+        node->x += overlap;
+        node->w -= overlap;
+        break;
     }
 
-    // Try to split the found space into smaller areas, and add those to the end of the list.
-    // Note that if the found area exactly matches the wanted one, we just clear out the found block.
-    if(free.w == w && free.h == h) {
-        vector_delete_at(&atlas->free_space, index);
-    } else {
-        zone split_a, split_b;
-        split_space(&free, w, h, &split_a, &split_b);
-        int size_a = split_a.w * split_a.h;
-        int size_b = split_b.w * split_b.h;
-        if(size_a == 0) {
-            vector_set(&atlas->free_space, index, &split_b);
-        } else if(size_b == 0) {
-            vector_set(&atlas->free_space, index, &split_a);
-        } else if(size_a < size_b) {
-            vector_set(&atlas->free_space, index, &split_b);
-            vector_append(&atlas->free_space, &split_a);
+    // Merge neighbours of the same height.
+    for(int i = 0; i < page->node_count - 1;) {
+        if(page->skyline[i].y == page->skyline[i + 1].y) {
+            page->skyline[i].w += page->skyline[i + 1].w;
+            skyline_remove(page, i + 1);
         } else {
-            vector_set(&atlas->free_space, index, &split_a);
-            vector_append(&atlas->free_space, &split_b);
+            i++;
+        }
+    }
+}
+
+/**
+ * Drop everything on a page, so that it can be packed again.
+ */
+static void page_evict(texture_atlas *atlas, atlas_page *page) {
+    iterator it;
+    unsigned int *guid;
+    vector_iter_begin(&page->guids, &it);
+    foreach(it, guid) {
+        hashmap_del_int(&atlas->items, *guid);
+    }
+    atlas->stats.evictions++;
+    atlas->stats.evicted_items += vector_size(&page->guids);
+    page_reset(atlas, page);
+}
+
+/**
+ * Find a page with room for the area. Existing pages are tried first, then a new page is added if we still may,
+ * and finally the least recently used page is evicted. Pages used during this frame are never evicted, since
+ * the draws that refer to them have not been flushed yet; if all of them are, we go over the page limit
+ * rather than drop the draw.
+ * @return Page index, or -1 if there was no room anywhere.
+ */
+static int find_page(texture_atlas *atlas, uint16_t w, uint16_t h, int *got_index, atlas_item *got_zone) {
+    for(int i = 0; i < atlas->page_count; i++) {
+        if(skyline_find(atlas, &atlas->pages[i], w, h, got_index, got_zone)) {
+            return i;
+        }
+    }
+    int victim = -1;
+    if(atlas->page_count >= atlas->max_pages) {
+        for(int i = 0; i < atlas->page_count; i++) {
+            const atlas_page *page = &atlas->pages[i];
+            if(page->last_used != atlas->frame && (victim < 0 || page->last_used < atlas->pages[victim].last_used)) {
+                victim = i;
+            }
+        }
+    }
+    if(victim < 0) {
+        if(atlas->page_count >= atlas->max_pages) {
+            log_info("Texture atlas is full of sprites drawn this frame, going over the limit of %d pages",
+                     atlas->max_pages);
         }
-        vector_sort(&atlas->free_space, space_sort);
+        atlas_page *page = page_add(atlas);
+        if(skyline_find(atlas, page, w, h, got_index, got_zone)) {
+            return atlas->page_count - 1;
+        }
+        return -1;
+    }
+    log_debug("Texture atlas evicting page %d with %d items", victim, vector_size(&atlas->pages[victim].guids));
+    page_evict(atlas, &atlas->pages[victim]);
+    if(skyline_find(atlas, &atlas->pages[victim], w, h, got_index, got_zone)) {
+        return victim;
+    }
+    return -1;
+}
+
+bool atlas_insert(texture_atlas *atlas, const char *bytes, uint16_t w, uint16_t h, uint16_t *page, uint16_t *nx,
+                  uint16_t *ny) {
+    atlas_item free;
+    int index;
+    int found = -1;
+    if(w <= atlas->w && h <= atlas->h) {
+        found = find_page(atlas, w, h, &index, &free);
+    }
+    if(found < 0) {
+        log_error("Texture atlas has no room for %dx%d area", w, h);
+        atlas->stats.failures++;
+        return false;
     }
 
-    // Split found, add the area to the atlas.
-    texture_update(atlas->tex_unit, atlas->texture_id, free.x, free.y, w, h, GL_RED, bytes);
+    atlas_page *dst = &atlas->pages[found];
+    skyline_add(dst, index, &free);
+    dst->used_texels += w * h;
+    dst->last_used = atlas->frame;
+    atlas->stats.inserts++;
+
+    texture_update(atlas->tex_unit, dst->texture_id, free.x, free.y, w, h, GL_RED, bytes);
+    *page = found;
     *nx = free.x;
     *ny = free.y;
     return true;
 }
 
-bool atlas_get(texture_atlas *atlas, const surface *surface, uint16_t *x, uint16_t *y, uint16_t *w, uint16_t *h) {
+bool atlas_get(texture_atlas *atlas, const surface *surface, uint16_t *page, uint16_t *x, uint16_t *y, uint16_t *w,
+               uint16_t *h) {
     // First, check if item is already in the texture atlas. If it is, return coords immediately.
-    zone *coords;
+    atlas_item *coords;
     if(hashmap_get_int(&atlas->items, surface->guid, (void **)&coords, NULL) == 0) {
+        atlas->pages[coords->page].last_used = atlas->frame;
+        *page = coords->page;
         *x = coords->x;
         *y = coords->y;
         *w = surface->w;
@@ -175,14 +300,16 @@ bool atlas_get(texture_atlas *atlas, const surface *surface, uint16_t *x, uint16
     }
 
     // If item is NOT in the texture atlas, add it now.
-    uint16_t nx, ny;
-    if(atlas_insert(atlas, (const char *)surface->data, surface->w, surface->h, &nx, &ny)) {
+    uint16_t np, nx, ny;
+    if(atlas_insert(atlas, (const char *)surface->data, surface->w, surface->h, &np, &nx, &ny)) {
+        *page = np;
         *x = nx;
         *y = ny;
         *w = surface->w;
         *h = surface->h;
-        zone cached = {nx, ny, surface->w, surface->h};
-        hashmap_put_int(&atlas->items, surface->guid, &cached, sizeof(zone));
+        atlas_item cached = {nx, ny, surface->w, surface->h, np};
+        hashmap_put_int(&atlas->items, surface->guid, &cached, sizeof(atlas_item));
+        vector_append(&atlas->pages[np].guids, &surface->guid);
         return true;
     }
 
@@ -190,9 +317,30 @@ bool atlas_get(texture_atlas *atlas, const surface *surface, uint16_t *x, uint16
 }
 
 void atlas_reset(texture_atlas *atlas) {
+    texture_atlas_stats stats;
+    atlas_get_stats(atlas, &stats);
+    log_debug("Texture atlas reset: %u pages, %u items, %u%% occupied, %u inserts, %u evictions (%u items), "
+              "%u failures",
+              stats.pages, stats.items, (unsigned)(stats.used_texels * 100 / stats.total_texels), stats.inserts,
+              stats.evictions, stats.evicted_items, stats.failures);
+
     hashmap_clear(&atlas->items);
-    vector_clear(&atlas->free_space);
-    zone item = {0, 0, atlas->w, atlas->h};
-    vector_append(&atlas->free_space, &item);
-    log_debug("Texture atlas reset");
+    for(int i = 0; i < atlas->page_count; i++) {
+        page_reset(atlas, &atlas->pages[i]);
+    }
+}
+
+void atlas_bind_page(const texture_atlas *atlas, uint16_t page) {
+    bindings_bind_tex(atlas->tex_unit, atlas->pages[page].texture_id);
+}
+
+void atlas_get_stats(const texture_atlas *atlas, texture_atlas_stats *stats) {
+    *stats = atlas->stats;
+    stats->pages = atlas->page_count;
+    stats->items = hashmap_size(&atlas->items);
+    stats->used_texels = 0;
+    for(int i = 0; i < atlas->page_count; i++) {
+        stats->used_texels += atlas->pages[i].used_texels;
+    }
+    stats->total_texels = (uint64_t)atlas->page_count * atlas->w * atlas->h;
 }
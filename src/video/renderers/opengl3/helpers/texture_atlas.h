@@ -7,11 +7,40 @@
 
 typedef struct texture_atlas texture_atlas;
 
-texture_atlas *atlas_create(GLuint tex_unit, uint16_t width, uint16_t height);
+typedef struct texture_atlas_stats {
+    unsigned int pages;
+    unsigned int items;
+    uint64_t used_texels;
+    uint64_t total_texels;
+    unsigned int inserts;
+    unsigned int evictions;     // Pages cleared to make room
+    unsigned int evicted_items; // Items dropped along with those pages
+    unsigned int failures;      // Items that could not be inserted at all
+} texture_atlas_stats;
+
+/**
+ * Create a texture atlas. Pages of width x height are added as needed, up to max_pages. When all of them are
+ * full, the page that was least recently drawn from is cleared and reused.
+ */
+texture_atlas *atlas_create(GLuint tex_unit, uint16_t width, uint16_t height, int max_pages);
 void atlas_free(texture_atlas **atlas);
 
-bool atlas_insert(texture_atlas *atlas, const char *bytes, uint16_t w, uint16_t h, uint16_t *nx, uint16_t *ny);
-bool atlas_get(texture_atlas *atlas, const surface *surface, uint16_t *x, uint16_t *y, uint16_t *w, uint16_t *h);
+/**
+ * Start a new frame. Pages drawn from during the current frame are never evicted.
+ */
+void atlas_next_frame(texture_atlas *atlas);
+
+bool atlas_insert(texture_atlas *atlas, const char *bytes, uint16_t w, uint16_t h, uint16_t *page, uint16_t *nx,
+                  uint16_t *ny);
+bool atlas_get(texture_atlas *atlas, const surface *surface, uint16_t *page, uint16_t *x, uint16_t *y, uint16_t *w,
+               uint16_t *h);
 void atlas_reset(texture_atlas *atlas);
 
+/**
+ * Bind the texture of a page to the atlas texture unit.
+ */
+void atlas_bind_page(const texture_atlas *atlas, uint16_t page);
+
+void atlas_get_stats(const texture_atlas *atlas, texture_atlas_stats *stats);
+
 #endif // TEXTURE_ATLAS_H
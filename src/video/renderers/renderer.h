@@ -5,7 +5,8 @@
 
 typedef struct renderer renderer;
 
-// Asynchronous screenshot signal, renderer must call this when it has the screenshot data.
+// Asynchronous screenshot signal, renderer must call this when it has the screenshot data. This may be called from
+// another thread, on a later frame.
 typedef void (*video_screenshot_signal)(const SDL_Rect *rect, unsigned char *data, bool flipped);
 
 // Metadata functions, all must be implemented. These must NOT require context or renderer state to be initialized!
@@ -43,6 +44,8 @@ typedef void (*render_area_finish_fn)(void *ctx, surface *dst);
 
 // Screenshotting, this /should/ be implemented (but is not required).
 typedef void (*capture_screen_fn)(void *ctx, video_screenshot_signal screenshot_cb);
+// Continuous capture of every interval'th rendered frame, this may be implemented. Interval 0 stops the capture.
+typedef void (*capture_stream_fn)(void *ctx, video_screenshot_signal screenshot_cb, unsigned interval);
 
 // Extra signals, implemented only if renderer implementation supports and/or requires it
 typedef void (*signal_scene_change_fn)(void *ctx);
@@ -71,6 +74,7 @@ struct renderer {
     render_area_finish_fn render_area_finish;
 
     capture_screen_fn capture_screen;
+    capture_stream_fn capture_stream;
 
     signal_scene_change_fn signal_scene_change;
     signal_draw_atlas_fn signal_draw_atlas;
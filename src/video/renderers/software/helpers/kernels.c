@@ -0,0 +1,245 @@
+#include "video/renderers/software/helpers/kernels.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+void kernel_opaque_mask(uint8_t *mask, const uint8_t *src, int n, int transparent) {
+    int i = 0;
+    if(transparent < 0 || transparent > 255) {
+        for(; i < n; i++) {
+            mask[i] = 0xFF;
+        }
+        return;
+    }
+#if defined(__SSE2__)
+    const __m128i t = _mm_set1_epi8((char)transparent);
+    const __m128i ones = _mm_set1_epi8(-1);
+    for(; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(mask + i), _mm_xor_si128(_mm_cmpeq_epi8(v, t), ones));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t t = vdupq_n_u8(transparent);
+    for(; i + 16 <= n; i += 16) {
+        vst1q_u8(mask + i, vmvnq_u8(vceqq_u8(vld1q_u8(src + i), t)));
+    }
+#endif
+    for(; i < n; i++) {
+        mask[i] = (src[i] != transparent) ? 0xFF : 0;
+    }
+}
+
+void kernel_add_coverage(uint8_t *coverage, const uint8_t *src, int n, int transparent) {
+    int i = 0;
+    if(transparent < 0 || transparent > 255) {
+        for(; i < n; i++) {
+            coverage[i]++;
+        }
+        return;
+    }
+#if defined(__SSE2__)
+    const __m128i t = _mm_set1_epi8((char)transparent);
+    const __m128i ones = _mm_set1_epi8(-1);
+    for(; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i c = _mm_loadu_si128((const __m128i *)(coverage + i));
+        // Opaque lanes are -1, so subtracting the mask counts them.
+        __m128i opaque = _mm_xor_si128(_mm_cmpeq_epi8(v, t), ones);
+        _mm_storeu_si128((__m128i *)(coverage + i), _mm_sub_epi8(c, opaque));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t t = vdupq_n_u8(transparent);
+    for(; i + 16 <= n; i += 16) {
+        uint8x16_t opaque = vmvnq_u8(vceqq_u8(vld1q_u8(src + i), t));
+        vst1q_u8(coverage + i, vsubq_u8(vld1q_u8(coverage + i), opaque));
+    }
+#endif
+    for(; i < n; i++) {
+        coverage[i] += (src[i] != transparent);
+    }
+}
+
+void kernel_reverse(uint8_t *dst, const uint8_t *src, int n) {
+    int i = 0;
+#if defined(__SSE2__)
+    for(; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + n - 16 - i));
+        // Reverse the dwords, then the words in each dword, then the bytes in each word.
+        v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+        v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128((__m128i *)(dst + i), v);
+    }
+#elif defined(__ARM_NEON)
+    for(; i + 16 <= n; i += 16) {
+        uint8x16_t v = vrev64q_u8(vld1q_u8(src + n - 16 - i));
+        vst1q_u8(dst + i, vextq_u8(v, v, 8));
+    }
+#endif
+    for(; i < n; i++) {
+        dst[i] = src[n - 1 - i];
+    }
+}
+
+bool kernel_all_zero(const uint8_t *a, const uint8_t *b, const uint8_t *c, int n) {
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for(; i + 16 <= n; i += 16) {
+        __m128i v = _mm_or_si128(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i)));
+        v = _mm_or_si128(v, _mm_loadu_si128((const __m128i *)(c + i)));
+        if(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) != 0xFFFF) {
+            return false;
+        }
+    }
+#elif defined(__ARM_NEON)
+    for(; i + 16 <= n; i += 16) {
+        uint8x16_t v = vorrq_u8(vorrq_u8(vld1q_u8(a + i), vld1q_u8(b + i)), vld1q_u8(c + i));
+        uint8x8_t folded = vorr_u8(vget_low_u8(v), vget_high_u8(v));
+        if(vget_lane_u64(vreinterpret_u64_u8(folded), 0) != 0) {
+            return false;
+        }
+    }
+#endif
+    for(; i < n; i++) {
+        if(a[i] | b[i] | c[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void kernel_palette_shift(uint8_t *row, int n, int offset, int limit) {
+    if(limit < 0 || offset == 0) {
+        return;
+    }
+    // Anything past these bounds clamps to the same result.
+    if(limit > 255) {
+        limit = 255;
+    }
+    if(offset > 255) {
+        offset = 255;
+    }
+    if(offset < -255) {
+        offset = -255;
+    }
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i lim = _mm_set1_epi8((char)limit);
+    const __m128i off = _mm_set1_epi8((char)(offset < 0 ? -offset : offset));
+    for(; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(row + i));
+        __m128i inside = _mm_cmpeq_epi8(_mm_min_epu8(v, lim), v);
+        __m128i moved = (offset < 0) ? _mm_subs_epu8(v, off) : _mm_adds_epu8(v, off);
+        moved = _mm_min_epu8(moved, lim);
+        _mm_storeu_si128((__m128i *)(row + i), _mm_or_si128(_mm_and_si128(inside, moved), _mm_andnot_si128(inside, v)));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t lim = vdupq_n_u8(limit);
+    const uint8x16_t off = vdupq_n_u8(offset < 0 ? -offset : offset);
+    for(; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8(row + i);
+        uint8x16_t inside = vcleq_u8(v, lim);
+        uint8x16_t moved = (offset < 0) ? vqsubq_u8(v, off) : vqaddq_u8(v, off);
+        vst1q_u8(row + i, vbslq_u8(inside, vminq_u8(moved, lim), v));
+    }
+#endif
+    for(; i < n; i++) {
+        if(row[i] <= limit) {
+            int v = row[i] + offset;
+            row[i] = (v < 0) ? 0 : (v > limit) ? limit : v;
+        }
+    }
+}
+
+void kernel_lookup(uint8_t *row, int n, const uint8_t *table) {
+    // Byte tables are faster to walk with plain loads than with SSE2 or NEON shuffles.
+    int i = 0;
+    for(; i + 4 <= n; i += 4) {
+        row[i + 0] = table[row[i + 0]];
+        row[i + 1] = table[row[i + 1]];
+        row[i + 2] = table[row[i + 2]];
+        row[i + 3] = table[row[i + 3]];
+    }
+    for(; i < n; i++) {
+        row[i] = table[row[i]];
+    }
+}
+
+void kernel_masked_store(uint8_t *dst, const uint8_t *src, uint8_t add, const uint8_t *mask, int n) {
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i a = _mm_set1_epi8((char)add);
+    for(; i + 16 <= n; i += 16) {
+        __m128i m = _mm_loadu_si128((const __m128i *)(mask + i));
+        __m128i v = _mm_adds_epu8(_mm_loadu_si128((const __m128i *)(src + i)), a);
+        __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(_mm_and_si128(m, v), _mm_andnot_si128(m, d)));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t a = vdupq_n_u8(add);
+    for(; i + 16 <= n; i += 16) {
+        uint8x16_t v = vqaddq_u8(vld1q_u8(src + i), a);
+        vst1q_u8(dst + i, vbslq_u8(vld1q_u8(mask + i), v, vld1q_u8(dst + i)));
+    }
+#endif
+    for(; i < n; i++) {
+        if(mask[i]) {
+            int v = src[i] + add;
+            dst[i] = (v > 255) ? 255 : v;
+        }
+    }
+}
+
+void kernel_masked_fill(uint8_t *dst, uint8_t value, const uint8_t *mask, int n) {
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i v = _mm_set1_epi8((char)value);
+    for(; i + 16 <= n; i += 16) {
+        __m128i m = _mm_loadu_si128((const __m128i *)(mask + i));
+        __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(_mm_and_si128(m, v), _mm_andnot_si128(m, d)));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t v = vdupq_n_u8(value);
+    for(; i + 16 <= n; i += 16) {
+        vst1q_u8(dst + i, vbslq_u8(vld1q_u8(mask + i), v, vld1q_u8(dst + i)));
+    }
+#endif
+    for(; i < n; i++) {
+        if(mask[i]) {
+            dst[i] = value;
+        }
+    }
+}
+
+void kernel_masked_max(uint8_t *dst, const uint8_t *src, uint8_t add, const uint8_t *mask, int n) {
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i a = _mm_set1_epi8((char)add);
+    for(; i + 16 <= n; i += 16) {
+        __m128i m = _mm_loadu_si128((const __m128i *)(mask + i));
+        __m128i v = _mm_and_si128(m, _mm_adds_epu8(_mm_loadu_si128((const __m128i *)(src + i)), a));
+        __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_max_epu8(d, v));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t a = vdupq_n_u8(add);
+    for(; i + 16 <= n; i += 16) {
+        uint8x16_t v = vandq_u8(vld1q_u8(mask + i), vqaddq_u8(vld1q_u8(src + i), a));
+        vst1q_u8(dst + i, vmaxq_u8(vld1q_u8(dst + i), v));
+    }
+#endif
+    for(; i < n; i++) {
+        if(mask[i]) {
+            int v = src[i] + add;
+            v = (v > 255) ? 255 : v;
+            if(v > dst[i]) {
+                dst[i] = v;
+            }
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef SOFTWARE_KERNELS_H
+#define SOFTWARE_KERNELS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Row kernels for the software renderer. All of them work on n bytes, and have SSE2 and NEON
+ * versions with a scalar fallback for other targets and for the tail of the row.
+ */
+
+/**
+ * Set mask to 0xFF where src is not the transparent index, and to 0 where it is.
+ * A transparent index outside 0-255 means that nothing is transparent.
+ */
+void kernel_opaque_mask(uint8_t *mask, const uint8_t *src, int n, int transparent);
+
+/**
+ * Increment coverage by one where src is not the transparent index.
+ */
+void kernel_add_coverage(uint8_t *coverage, const uint8_t *src, int n, int transparent);
+
+/**
+ * dst[i] = src[n - 1 - i], for horizontally flipped rows.
+ */
+void kernel_reverse(uint8_t *dst, const uint8_t *src, int n);
+
+/**
+ * Check if a, b and c are all zero.
+ */
+bool kernel_all_zero(const uint8_t *a, const uint8_t *b, const uint8_t *c, int n);
+
+/**
+ * Palette offset and limit, as done for fonts: indexes at or below the limit are moved by the offset
+ * and clamped to 0 .. limit. Indexes above the limit are left alone.
+ */
+void kernel_palette_shift(uint8_t *row, int n, int offset, int limit);
+
+/**
+ * Replace each byte with its entry in a 256 byte table.
+ */
+void kernel_lookup(uint8_t *row, int n, const uint8_t *table);
+
+/**
+ * dst = min(src + add, 255) where mask is set.
+ */
+void kernel_masked_store(uint8_t *dst, const uint8_t *src, uint8_t add, const uint8_t *mask, int n);
+
+/**
+ * dst = value where mask is set.
+ */
+void kernel_masked_fill(uint8_t *dst, uint8_t value, const uint8_t *mask, int n);
+
+/**
+ * dst = max(dst, min(src + add, 255)) where mask is set.
+ */
+void kernel_masked_max(uint8_t *dst, const uint8_t *src, uint8_t add, const uint8_t *mask, int n);
+
+#endif // SOFTWARE_KERNELS_H
@@ -0,0 +1,302 @@
+#include <assert.h>
+#include <string.h>
+
+#include "utils/allocator.h"
+#include "video/enums.h"
+#include "video/renderers/common.h"
+#include "video/renderers/software/helpers/kernels.h"
+#include "video/renderers/software/helpers/raster.h"
+
+#define PLANE_SIZE (RASTER_W * RASTER_H)
+static_assert(RASTER_H == OPACITY_NOISE_ROWS, "opacity noise must have a row for every raster row");
+
+// Remap rounds that mark an untouched SPRITE_DARK_TINT pixel. See palette.frag and rgba.frag.
+#define MAGIC_REMAP_ROUNDS 12
+
+typedef enum
+{
+    MODE_SET = 0,
+    MODE_REMAP,
+    MODE_ADD,
+    MODE_DARK_TINT,
+    MODE_SPRITE_SHADOW,
+} raster_blend_mode;
+
+typedef struct raster {
+    uint8_t index[PLANE_SIZE]; // Palette index
+    uint8_t remap[PLANE_SIZE]; // remap_offset + remap_rounds * 19
+    uint8_t tint[PLANE_SIZE];  // SPRITE_DARK_TINT index
+    uint8_t add[PLANE_SIZE];   // SPRITE_INDEX_ADD index
+    vga_remap_tables remaps;
+    uint32_t palette[256]; // RGBA bytes, in memory order
+    uint8_t add_table[256];
+    int noise[OPACITY_NOISE_ROWS]; // See build_opacity_noise; counted from the bottom row
+} raster;
+
+raster *raster_create(void) {
+    raster *obj = omf_calloc(1, sizeof(raster));
+
+    // The palette starts out white, like the OpenGL3 palette buffer does.
+    memset(obj->palette, 0xFF, sizeof(obj->palette));
+    vga_remaps_init(&obj->remaps);
+
+    // SPRITE_INDEX_ADD stores the index multiplied by 60, saturated to a byte.
+    for(int i = 0; i < 256; i++) {
+        obj->add_table[i] = (i * 60 > 255) ? 255 : i * 60;
+    }
+
+    build_opacity_noise(obj->noise);
+    return obj;
+}
+
+void raster_free(raster **raster) {
+    omf_free(*raster);
+}
+
+void raster_set_palette(raster *raster, const vga_palette *palette, vga_index first, vga_index last) {
+    for(int i = first; i <= last; i++) {
+        uint8_t *color = (uint8_t *)&raster->palette[i];
+        color[0] = palette->colors[i].r;
+        color[1] = palette->colors[i].g;
+        color[2] = palette->colors[i].b;
+        color[3] = 0xFF;
+    }
+}
+
+void raster_set_remaps(raster *raster, const vga_remap_tables *remaps) {
+    memcpy(&raster->remaps, remaps, sizeof(vga_remap_tables));
+}
+
+static inline int clamp_byte(int value) {
+    return (value < 0) ? 0 : (value > 255) ? 255 : value;
+}
+
+static raster_blend_mode get_blend_mode(int remap_rounds, unsigned int options) {
+    if(options & SPRITE_DARK_TINT) {
+        return MODE_DARK_TINT;
+    } else if(options & SPRITE_SHADOW) {
+        return MODE_SPRITE_SHADOW;
+    } else if(remap_rounds > 0) {
+        return MODE_REMAP;
+    } else if(options & SPRITE_INDEX_ADD) {
+        return MODE_ADD;
+    }
+    return MODE_SET;
+}
+
+/**
+ * Nearest neighbour sampling, at the center of the destination pixel.
+ */
+static inline int source_coord(int d, int dst_size, int src_size, bool flip) {
+    int s = ((2 * d + 1) * src_size) / (2 * dst_size);
+    return flip ? src_size - 1 - s : s;
+}
+
+typedef enum
+{
+    FETCH_COPY = 0, // Same size, not flipped: use the surface row as is
+    FETCH_REVERSE,  // Same size, flipped horizontally
+    FETCH_SCALE,    // Anything else, sample through the column table
+} fetch_method;
+
+static const uint8_t *fetch_row(const surface *src, int sy, const int *columns, int n, fetch_method method,
+                                uint8_t *buf) {
+    const uint8_t *line = src->data + sy * src->w;
+    switch(method) {
+        case FETCH_COPY:
+            return line + columns[0];
+        case FETCH_REVERSE:
+            kernel_reverse(buf, line + columns[n - 1], n);
+            return buf;
+        case FETCH_SCALE:
+            break;
+    }
+    for(int i = 0; i < n; i++) {
+        buf[i] = line[columns[i]];
+    }
+    return buf;
+}
+
+/**
+ * Drop pixels that are decimated due to opacity.
+ */
+static void apply_opacity(const raster *raster, uint8_t *mask, int x0, int y, int n, int opacity) {
+    int limit = opacity * OPACITY_NOISE_STEPS;
+    int row = raster->noise[RASTER_H - 1 - y];
+    for(int i = 0; i < n; i++) {
+        int value = (row + 107 * (2 * (x0 + i) + 1)) % OPACITY_NOISE_STEPS;
+        if(value * 255 > limit) {
+            mask[i] = 0;
+        }
+    }
+}
+
+void raster_draw(raster *raster, const surface *src, const SDL_Rect *dst, int remap_offset, int remap_rounds,
+                 int palette_offset, int palette_limit, int opacity, unsigned int flip_mode, unsigned int options) {
+    if(src->data == NULL || src->w <= 0 || src->h <= 0 || dst->w <= 0 || dst->h <= 0) {
+        return;
+    }
+    int x0 = (dst->x < 0) ? 0 : dst->x;
+    int y0 = (dst->y < 0) ? 0 : dst->y;
+    int x1 = (dst->x + dst->w > RASTER_W) ? RASTER_W : dst->x + dst->w;
+    int y1 = (dst->y + dst->h > RASTER_H) ? RASTER_H : dst->y + dst->h;
+    if(x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    raster_blend_mode mode = get_blend_mode(remap_rounds, options);
+    bool shadow = options & SPRITE_SHADOW;
+    if(mode == MODE_SPRITE_SHADOW && remap_rounds <= 0) {
+        return; // Only the remap channel is written, and there is nothing to write to it.
+    }
+
+    // Source columns are the same for every row.
+    int n = x1 - x0;
+    int columns[RASTER_W];
+    for(int i = 0; i < n; i++) {
+        columns[i] = source_coord(x0 + i - dst->x, dst->w, src->w, flip_mode & FLIP_HORIZONTAL);
+    }
+    fetch_method method = FETCH_SCALE;
+    if(dst->w == src->w) {
+        method = (flip_mode & FLIP_HORIZONTAL) ? FETCH_REVERSE : FETCH_COPY;
+    }
+
+    int remap_base = clamp_byte(remap_offset + remap_rounds * 19);
+    int tint_remap = clamp_byte(remap_offset + MAGIC_REMAP_ROUNDS * 19);
+    int remap_row = (remap_offset < 0) ? 0 : (remap_offset >= VGA_REMAP_COUNT) ? VGA_REMAP_COUNT - 1 : remap_offset;
+    const uint8_t *remap_table = raster->remaps.tables[remap_row].data;
+
+    uint8_t buf[RASTER_W];
+    uint8_t mask[RASTER_W];
+    uint8_t values[RASTER_W];
+    for(int y = y0; y < y1; y++) {
+        int sy = source_coord(y - dst->y, dst->h, src->h, flip_mode & FLIP_VERTICAL);
+        if(shadow) {
+            // Make four samples to generate coverage. Samples outside the sprite count as transparent, as in
+            // palette.frag.
+            memset(values, 0, n);
+            for(int k = sy - 1; k <= sy + 2; k++) {
+                if(k >= 0 && k < src->h) {
+                    kernel_add_coverage(values, fetch_row(src, k, columns, n, method, buf), n, src->transparent);
+                }
+            }
+            kernel_opaque_mask(mask, values, n, 0);
+        } else {
+            const uint8_t *pixels = fetch_row(src, sy, columns, n, method, buf);
+            kernel_opaque_mask(mask, pixels, n, src->transparent);
+            memcpy(values, pixels, n);
+            kernel_palette_shift(values, n, palette_offset, palette_limit);
+            if((options & SPRITE_REMAP) && (options & SPRITE_HAR_QUIRKS)) {
+                // Electra electricity and pyros fire keep their colors.
+                for(int i = 0; i < n; i++) {
+                    if(pixels[i] <= 0x30) {
+                        values[i] = remap_table[values[i]];
+                    }
+                }
+            } else if(options & SPRITE_REMAP) {
+                kernel_lookup(values, n, remap_table);
+            }
+        }
+        if(opacity < 255) {
+            apply_opacity(raster, mask, x0, y, n, opacity);
+        }
+
+        int offset = y * RASTER_W + x0;
+        switch(mode) {
+            case MODE_SET:
+                kernel_masked_store(raster->index + offset, values, 0, mask, n);
+                kernel_masked_fill(raster->remap + offset, 0, mask, n);
+                kernel_masked_fill(raster->tint + offset, 0, mask, n);
+                kernel_masked_fill(raster->add + offset, 0, mask, n);
+                break;
+            case MODE_REMAP:
+                kernel_masked_store(raster->remap + offset, values, remap_base, mask, n);
+                break;
+            case MODE_ADD:
+                kernel_lookup(values, n, raster->add_table);
+                kernel_masked_store(raster->add + offset, values, 0, mask, n);
+                break;
+            case MODE_DARK_TINT:
+                kernel_masked_fill(raster->remap + offset, tint_remap, mask, n);
+                kernel_masked_store(raster->tint + offset, values, 0, mask, n);
+                kernel_masked_fill(raster->add + offset, 0, mask, n);
+                break;
+            case MODE_SPRITE_SHADOW:
+                kernel_masked_max(raster->remap + offset, values, remap_base, mask, n);
+                break;
+        }
+    }
+}
+
+static inline uint8_t resolve_index(const raster *raster, int i) {
+    int index = raster->index[i] + raster->add[i];
+    index = (index > 255) ? 255 : index;
+    int remap = raster->remap[i];
+    int tint = raster->tint[i];
+    if((remap | tint) == 0) {
+        return index;
+    }
+
+    const vga_remap_table *tables = raster->remaps.tables;
+    int remap_rounds = remap / 19;
+    if(tint > 0 && remap_rounds != MAGIC_REMAP_ROUNDS) {
+        // DARK_TINT's remap got trampled by the pause menu, so the HAR's color with the pause menu remap.
+        index = tint;
+    } else if(tint >= 0x60) {
+        // pyros flames draw opaque, no remaps.
+        index = tint;
+        remap_rounds = 0;
+    } else if(tint > 0) {
+        // lookup color we're drawing ontop in fifth remap to get brightness
+        int brightness = tables[4].data[index] - 0xA8;
+        int behind = 1 + ((brightness < 0) ? 0 : (brightness > 7) ? 7 : brightness) * 2;
+        index = (tint & 0xF0) + ((tint & 0x0F) * 3 + behind * 2) / 5;
+    }
+
+    const uint8_t *table = tables[remap % 19].data;
+    for(int r = 0; r < remap_rounds; r++) {
+        index = table[index];
+    }
+    return index;
+}
+
+void raster_resolve(const raster *raster, unsigned framebuffer_options, uint32_t *rgba) {
+    if(framebuffer_options & FBUFOPT_CREDITS) {
+        // SPRITE_INDEX_ADD only
+        for(int i = 0; i < PLANE_SIZE; i++) {
+            int index = raster->index[i] + raster->add[i];
+            rgba[i] = raster->palette[(index > 255) ? 255 : index];
+        }
+        return;
+    }
+    for(int i = 0; i < PLANE_SIZE; i += 16) {
+        // Most of the screen is plain palette indexes.
+        if(kernel_all_zero(raster->remap + i, raster->tint + i, raster->add + i, 16)) {
+            for(int k = i; k < i + 16; k++) {
+                rgba[k] = raster->palette[raster->index[k]];
+            }
+        } else {
+            for(int k = i; k < i + 16; k++) {
+                rgba[k] = raster->palette[resolve_index(raster, k)];
+            }
+        }
+    }
+}
+
+void raster_read_area(const raster *raster, const SDL_Rect *area, unsigned char *dst) {
+    // The OpenGL3 renderer reads the area with glReadPixels, where y grows upwards from the bottom row.
+    // Read the same pixels, but top row first.
+    int top = RASTER_H - area->y - area->h;
+    memset(dst, 0, area->w * area->h);
+    for(int row = 0; row < area->h; row++) {
+        int y = top + row;
+        if(y < 0 || y >= RASTER_H) {
+            continue;
+        }
+        int x0 = (area->x < 0) ? 0 : area->x;
+        int x1 = (area->x + area->w > RASTER_W) ? RASTER_W : area->x + area->w;
+        if(x0 < x1) {
+            memcpy(dst + row * area->w + (x0 - area->x), raster->index + y * RASTER_W + x0, x1 - x0);
+        }
+    }
+}
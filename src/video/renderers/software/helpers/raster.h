@@ -0,0 +1,47 @@
+#ifndef SOFTWARE_RASTER_H
+#define SOFTWARE_RASTER_H
+
+#include "video/surface.h"
+#include "video/vga_palette.h"
+#include "video/vga_remap.h"
+#include <SDL_rect.h>
+#include <stdint.h>
+
+#define RASTER_W 320
+#define RASTER_H 200
+
+/**
+ * Indexed 320x200 framebuffer for the software renderer. It keeps the same four channels as the offscreen
+ * target of the OpenGL3 renderer (palette index, remap selector, dark tint and added index), one byte plane
+ * each, and resolves them to RGBA exactly like the rgba.frag shader does.
+ */
+typedef struct raster raster;
+
+raster *raster_create(void);
+void raster_free(raster **raster);
+
+/**
+ * Copy palette colors first .. last (inclusive) over to the RGBA lookup table.
+ */
+void raster_set_palette(raster *raster, const vga_palette *palette, vga_index first, vga_index last);
+void raster_set_remaps(raster *raster, const vga_remap_tables *remaps);
+
+/**
+ * Draw a surface to the indexed framebuffer. Arguments are the same as for the renderer draw_surface callback.
+ */
+void raster_draw(raster *raster, const surface *src, const SDL_Rect *dst, int remap_offset, int remap_rounds,
+                 int palette_offset, int palette_limit, int opacity, unsigned int flip_mode, unsigned int options);
+
+/**
+ * Convert the indexed framebuffer to RASTER_W * RASTER_H RGBA pixels, top row first.
+ *
+ * @param framebuffer_options Flags from renderer_framebuffer_options
+ */
+void raster_resolve(const raster *raster, unsigned framebuffer_options, uint32_t *rgba);
+
+/**
+ * Read palette indexes of an area, as area->w * area->h bytes. Pixels outside the framebuffer read as 0.
+ */
+void raster_read_area(const raster *raster, const SDL_Rect *area, unsigned char *dst);
+
+#endif // SOFTWARE_RASTER_H
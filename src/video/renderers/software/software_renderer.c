@@ -0,0 +1,363 @@
+#include "video/renderers/software/software_renderer.h"
+#include "video/renderers/common.h"
+#include "video/renderers/software/helpers/raster.h"
+
+#include "game/utils/version.h"
+#include "utils/allocator.h"
+#include "utils/log.h"
+#include "video/vga_state.h"
+
+#include <stdio.h>
+#include <string.h>
+
+typedef struct sw_context {
+    SDL_Window *window;
+    SDL_Renderer *sdl_renderer;
+    SDL_Texture *texture;
+    raster *raster;
+    uint32_t rgba[RASTER_W * RASTER_H];
+
+    int screen_w;
+    int screen_h;
+    bool fullscreen;
+    bool vsync;
+    int aspect;
+    int target_move_x;
+    int target_move_y;
+    unsigned framebuffer_options;
+    SDL_Rect culling_area;
+
+    uint64_t framerate_limit;
+    uint64_t last_tick;
+
+    video_screenshot_signal screenshot_cb;
+} sw_context;
+
+static bool is_available(void) {
+    return true;
+}
+
+static const char *get_description(void) {
+    return "Software renderer, no GPU required";
+}
+
+static const char *get_name(void) {
+    return "Software";
+}
+
+static void set_framerate_limit(sw_context *ctx, int framerate_limit) {
+    if(framerate_limit == 0) {
+        ctx->framerate_limit = 0;
+    } else {
+        ctx->framerate_limit = (1.0 / framerate_limit) * SDL_GetPerformanceFrequency();
+    }
+}
+
+static void set_fullscreen(SDL_Window *window, bool fullscreen) {
+    if(SDL_SetWindowFullscreen(window, fullscreen ? SDL_WINDOW_FULLSCREEN : 0) != 0) {
+        log_error("Could not set fullscreen mode: %s", SDL_GetError());
+    }
+}
+
+/**
+ * Create the SDL renderer and the streaming texture the framebuffer is uploaded to.
+ */
+static bool create_presenter(sw_context *ctx) {
+    Uint32 flags = ctx->vsync ? SDL_RENDERER_PRESENTVSYNC : 0;
+    ctx->sdl_renderer = SDL_CreateRenderer(ctx->window, -1, flags);
+    if(ctx->sdl_renderer == NULL) {
+        log_error("Could not create SDL renderer: %s", SDL_GetError());
+        return false;
+    }
+    ctx->texture = SDL_CreateTexture(ctx->sdl_renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, RASTER_W,
+                                     RASTER_H);
+    if(ctx->texture == NULL) {
+        log_error("Could not create framebuffer texture: %s", SDL_GetError());
+        SDL_DestroyRenderer(ctx->sdl_renderer);
+        ctx->sdl_renderer = NULL;
+        return false;
+    }
+    return true;
+}
+
+static void free_presenter(sw_context *ctx) {
+    if(ctx->texture != NULL) {
+        SDL_DestroyTexture(ctx->texture);
+        ctx->texture = NULL;
+    }
+    if(ctx->sdl_renderer != NULL) {
+        SDL_DestroyRenderer(ctx->sdl_renderer);
+        ctx->sdl_renderer = NULL;
+    }
+}
+
+static bool setup_context(void *userdata, int window_w, int window_h, bool fullscreen, bool vsync, int aspect,
+                          int framerate_limit) {
+    sw_context *ctx = userdata;
+    ctx->screen_w = window_w;
+    ctx->screen_h = window_h;
+    ctx->fullscreen = fullscreen;
+    ctx->vsync = vsync;
+    ctx->aspect = aspect;
+    ctx->target_move_x = 0;
+    ctx->target_move_y = 0;
+    ctx->last_tick = SDL_GetPerformanceCounter();
+    set_framerate_limit(ctx, framerate_limit);
+
+    // Without a window we still render, there is just nothing to present to. Screenshots keep working.
+    // The dummy video driver (used by headless tools) would only give us a window that goes nowhere.
+    const char *driver = SDL_GetCurrentVideoDriver();
+    if(driver != NULL && strcmp(driver, "dummy") == 0) {
+        log_info("Dummy video driver in use, running headless");
+    } else {
+        char title[32];
+        snprintf(title, 32, "OpenOMF v%s", get_version_string());
+        ctx->window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, window_w, window_h,
+                                       SDL_WINDOW_SHOWN);
+        if(ctx->window == NULL) {
+            log_info("Could not create window, running headless: %s", SDL_GetError());
+        }
+    }
+    if(ctx->window != NULL) {
+        if(!create_presenter(ctx)) {
+            SDL_DestroyWindow(ctx->window);
+            ctx->window = NULL;
+            return false;
+        }
+        set_fullscreen(ctx->window, fullscreen);
+        SDL_DisableScreenSaver();
+    }
+
+    ctx->raster = raster_create();
+    vga_state_mark_dirty();
+
+    log_info("Software Renderer initialized!");
+    return true;
+}
+
+static void get_context_state(void *userdata, int *window_w, int *window_h, bool *fullscreen, bool *vsync,
+                              int *aspect) {
+    sw_context *ctx = userdata;
+    if(window_w != NULL)
+        *window_w = ctx->screen_w;
+    if(window_h != NULL)
+        *window_h = ctx->screen_h;
+    if(fullscreen != NULL)
+        *fullscreen = ctx->fullscreen;
+    if(vsync != NULL)
+        *vsync = ctx->vsync;
+    if(aspect != NULL)
+        *aspect = ctx->aspect;
+}
+
+static bool reset_context_with(void *userdata, int window_w, int window_h, bool fullscreen, bool vsync, int aspect,
+                               int framerate_limit) {
+    sw_context *ctx = userdata;
+    bool success = true;
+    ctx->screen_w = window_w;
+    ctx->screen_h = window_h;
+    ctx->fullscreen = fullscreen;
+    ctx->aspect = aspect;
+    set_framerate_limit(ctx, framerate_limit);
+    if(ctx->window != NULL) {
+        SDL_SetWindowSize(ctx->window, window_w, window_h);
+        set_fullscreen(ctx->window, fullscreen);
+        if(ctx->vsync != vsync) {
+            // Vsync is a renderer creation flag, so the renderer has to be made again.
+            ctx->vsync = vsync;
+            free_presenter(ctx);
+            success = create_presenter(ctx);
+        }
+    }
+    ctx->vsync = vsync;
+
+    log_info("Software renderer reset.");
+    return success;
+}
+
+static void reset_context(void *userdata) {
+    return;
+}
+
+static void close_context(void *userdata) {
+    sw_context *ctx = userdata;
+    raster_free(&ctx->raster);
+    free_presenter(ctx);
+    if(ctx->window != NULL) {
+        SDL_DestroyWindow(ctx->window);
+        ctx->window = NULL;
+    }
+    log_info("Software renderer closed.");
+}
+
+/**
+ * If palette is dirty, flush it to the lookup table. Note that the range is inclusive (start <= x <= end).
+ */
+static inline void flush_palettes(sw_context *ctx) {
+    vga_index first, last;
+    vga_palette *palette;
+    if(vga_state_is_palette_dirty(&palette, &first, &last)) {
+        raster_set_palette(ctx->raster, palette, first, last);
+        vga_state_mark_palette_flushed();
+    }
+}
+
+/**
+ * If remaps are dirty, do the flush. This should be pretty rare (once per scene change)
+ */
+static inline void flush_remaps(sw_context *ctx) {
+    vga_remap_tables *tables;
+    if(vga_state_is_remap_dirty(&tables)) {
+        raster_set_remaps(ctx->raster, tables);
+        vga_state_mark_remaps_flushed();
+    }
+}
+
+static void draw_surface(void *userdata, const surface *src_surface, SDL_Rect *dst, int remap_offset, int remap_rounds,
+                         int palette_offset, int palette_limit, int opacity, unsigned int flip_mode,
+                         unsigned int options) {
+    sw_context *ctx = userdata;
+    // Sprites are rasterized right away, so SPRITE_REMAP needs the remaps that are current now.
+    flush_remaps(ctx);
+    raster_draw(ctx->raster, src_surface, dst, remap_offset, remap_rounds, palette_offset, palette_limit, opacity,
+                flip_mode, options);
+}
+
+static void move_target(void *userdata, int x, int y) {
+    sw_context *ctx = userdata;
+    ctx->target_move_x = x;
+    ctx->target_move_y = y;
+}
+
+static void render_prepare(void *userdata, unsigned framebuffer_options) {
+    sw_context *ctx = userdata;
+    ctx->framebuffer_options = framebuffer_options;
+}
+
+static void capture_screenshot(sw_context *ctx) {
+    SDL_Rect r = {0, 0, RASTER_W, RASTER_H};
+    unsigned char *buffer = omf_malloc(r.w * r.h * 3);
+    const unsigned char *src = (const unsigned char *)ctx->rgba;
+    for(int i = 0; i < r.w * r.h; i++) {
+        buffer[i * 3 + 0] = src[i * 4 + 0];
+        buffer[i * 3 + 1] = src[i * 4 + 1];
+        buffer[i * 3 + 2] = src[i * 4 + 2];
+    }
+    ctx->screenshot_cb(&r, buffer, false);
+    omf_free(buffer);
+}
+
+/**
+ * Scale the framebuffer to the window, and do screen-shakes here.
+ */
+static void present(sw_context *ctx) {
+    int output_w, output_h;
+    SDL_GetRendererOutputSize(ctx->sdl_renderer, &output_w, &output_h);
+    SDL_Rect viewport = {0, 0, output_w, output_h};
+
+    // aspect == 0 means 4:3
+    // aspect == 1 means stretch to window
+    if(ctx->aspect == 0) {
+        const SDL_Rect window = viewport;
+        find_resolution_for_aspect_ratio(&viewport, &window, 4, 3);
+    }
+
+    float move_ratio = viewport.w / RASTER_W;
+    viewport.x += ctx->target_move_x * move_ratio; // This is used for screen shakes on x-axis
+    viewport.y += ctx->target_move_y * move_ratio; // This is used for screen shakes on y-axis
+
+    SDL_UpdateTexture(ctx->texture, NULL, ctx->rgba, RASTER_W * sizeof(uint32_t));
+    SDL_SetRenderDrawColor(ctx->sdl_renderer, 0, 0, 0, 255);
+    SDL_RenderClear(ctx->sdl_renderer);
+    SDL_RenderCopy(ctx->sdl_renderer, ctx->texture, NULL, &viewport);
+    SDL_RenderPresent(ctx->sdl_renderer);
+}
+
+static void render_finish(void *userdata) {
+    sw_context *ctx = userdata;
+    flush_palettes(ctx);
+    flush_remaps(ctx);
+    raster_resolve(ctx->raster, ctx->framebuffer_options, ctx->rgba);
+
+    // Snap screenshot from the freshly rendered state.
+    if(ctx->screenshot_cb) {
+        capture_screenshot(ctx);
+        ctx->screenshot_cb = NULL;
+    }
+
+    if(ctx->window != NULL) {
+        present(ctx);
+    }
+
+    // Limit framerate if requested.
+    if(ctx->framerate_limit != 0) {
+        uint64_t frame_time = SDL_GetPerformanceCounter() - ctx->last_tick;
+        if(frame_time < ctx->framerate_limit) {
+            double wait = ctx->framerate_limit - frame_time;
+            double ms_conv = SDL_GetPerformanceFrequency() / 1000;
+            SDL_Delay(wait / ms_conv);
+        }
+        ctx->last_tick = SDL_GetPerformanceCounter();
+    }
+}
+
+static void render_area_prepare(void *userdata, const SDL_Rect *area) {
+    sw_context *ctx = userdata;
+    ctx->culling_area = *area;
+}
+
+static void render_area_finish(void *userdata, surface *dst) {
+    sw_context *ctx = userdata;
+    SDL_Rect *r = &ctx->culling_area;
+    unsigned char *buffer = omf_malloc(r->w * r->h);
+    raster_read_area(ctx->raster, r, buffer);
+    surface_create_from_data(dst, r->w, r->h, buffer);
+    surface_set_transparency(dst, -1);
+    omf_free(buffer);
+}
+
+static void capture_screen(void *userdata, video_screenshot_signal screenshot_cb) {
+    sw_context *ctx = userdata;
+    ctx->screenshot_cb = screenshot_cb;
+}
+
+static void signal_scene_change(void *userdata) {
+}
+
+static void signal_draw_atlas(void *userdata, bool toggle) {
+    // Sprites are drawn straight from their surfaces, there is no atlas to show.
+}
+
+static void renderer_create(renderer *sw_renderer) {
+    sw_renderer->ctx = omf_calloc(1, sizeof(sw_context));
+}
+
+static void renderer_destroy(renderer *sw_renderer) {
+    omf_free(sw_renderer->ctx);
+}
+
+void software_renderer_set_callbacks(renderer *sw_renderer) {
+    sw_renderer->is_available = is_available;
+    sw_renderer->get_description = get_description;
+    sw_renderer->get_name = get_name;
+
+    sw_renderer->create = renderer_create;
+    sw_renderer->destroy = renderer_destroy;
+
+    sw_renderer->setup_context = setup_context;
+    sw_renderer->get_context_state = get_context_state;
+    sw_renderer->reset_context_with = reset_context_with;
+    sw_renderer->reset_context = reset_context;
+    sw_renderer->close_context = close_context;
+
+    sw_renderer->draw_surface = draw_surface;
+    sw_renderer->move_target = move_target;
+    sw_renderer->render_prepare = render_prepare;
+    sw_renderer->render_finish = render_finish;
+    sw_renderer->render_area_prepare = render_area_prepare;
+    sw_renderer->render_area_finish = render_area_finish;
+
+    sw_renderer->capture_screen = capture_screen;
+    sw_renderer->signal_scene_change = signal_scene_change;
+    sw_renderer->signal_draw_atlas = signal_draw_atlas;
+}
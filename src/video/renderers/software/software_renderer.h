@@ -0,0 +1,8 @@
+#ifndef SOFTWARE_RENDERER_H
+#define SOFTWARE_RENDERER_H
+
+#include "video/renderers/renderer.h"
+
+void software_renderer_set_callbacks(renderer *sw_renderer);
+
+#endif // SOFTWARE_RENDERER_H
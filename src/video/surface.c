@@ -5,12 +5,12 @@
 #include <stdlib.h>
 
 // Each surface is tagged with a unique key. This is then used for texture atlas.
-// This keeps track of the last index used.
-static unsigned int guid = 0;
+// This keeps track of the last index used. Surfaces are also created by the asset loader thread, hence the atomic.
+static SDL_atomic_t guid;
 
 void surface_create(surface *sur, int w, int h) {
     sur->data = omf_calloc(1, w * h);
-    sur->guid = guid++;
+    sur->guid = SDL_AtomicAdd(&guid, 1);
     sur->w = w;
     sur->h = h;
     sur->transparent = 0;
@@ -62,7 +62,7 @@ void surface_free(surface *sur) {
 
 void surface_clear(surface *sur) {
     memset(sur->data, 0, sur->w * sur->h);
-    sur->guid = guid++;
+    sur->guid = SDL_AtomicAdd(&guid, 1);
 }
 
 void surface_create_from(surface *dst, const surface *src) {
@@ -99,7 +99,7 @@ void surface_multiply_decal(surface *src, const surface *decal, int dst_x, int d
             src->data[src_offset] = color | value;
         }
     }
-    src->guid = guid++;
+    src->guid = SDL_AtomicAdd(&guid, 1);
 }
 
 // Copies a an area of old surface to an entirely new surface
@@ -120,7 +120,7 @@ void surface_sub(surface *dst, const surface *src, int dst_x, int dst_y, int src
             dst->data[dst_offset] = src->data[src_offset];
         }
     }
-    dst->guid = guid++;
+    dst->guid = SDL_AtomicAdd(&guid, 1);
 }
 
 static uint8_t find_closest_gray(const vga_palette *pal, int range_start, int range_end, int ref) {
@@ -154,7 +154,7 @@ void surface_flatten_to_mask(surface *sur, uint8_t value) {
             continue;
         sur->data[i] = value;
     }
-    sur->guid = guid++;
+    sur->guid = SDL_AtomicAdd(&guid, 1);
 }
 
 void surface_convert_to_grayscale(surface *sur, const vga_palette *pal, int range_start, int range_end,
@@ -182,7 +182,7 @@ void surface_convert_to_grayscale(surface *sur, const vga_palette *pal, int rang
             continue;
         sur->data[i] = mapping[idx];
     }
-    sur->guid = guid++;
+    sur->guid = SDL_AtomicAdd(&guid, 1);
 }
 
 void surface_convert_har_to_grayscale(surface *sur, uint8_t brightness) {
@@ -193,7 +193,7 @@ void surface_convert_har_to_grayscale(surface *sur, uint8_t brightness) {
             sur->data[i] = 0xD0 + brightness * (idx % 0x10) / 0x0F;
         }
     }
-    sur->guid = guid++;
+    sur->guid = SDL_AtomicAdd(&guid, 1);
 }
 
 void surface_compress_index_blocks(surface *sur, int range_start, int range_end, int block_size, int amount) {
@@ -207,7 +207,7 @@ void surface_compress_index_blocks(surface *sur, int range_start, int range_end,
             sur->data[i] = idx - old_idx + new_idx;
         }
     }
-    sur->guid = guid++;
+    sur->guid = SDL_AtomicAdd(&guid, 1);
 }
 
 void surface_compress_remap(surface *sur, int range_start, int range_end, int remap_to, int amount) {
@@ -222,7 +222,7 @@ void surface_compress_remap(surface *sur, int range_start, int range_end, int re
             }
         }
     }
-    sur->guid = guid++;
+    sur->guid = SDL_AtomicAdd(&guid, 1);
 }
 
 bool surface_write_png(const surface *sur, const vga_palette *pal, const char *filename) {
@@ -9,6 +9,9 @@
 #ifdef ENABLE_OPENGL3_RENDERER
 #include "video/renderers/opengl3/gl3_renderer.h"
 #endif
+#ifdef ENABLE_SOFTWARE_RENDERER
+#include "video/renderers/software/software_renderer.h"
+#endif
 #ifdef ENABLE_NULL_RENDERER
 #include "video/renderers/null/null_renderer.h"
 #endif
@@ -23,6 +26,9 @@ static renderer_init all_renderers[] = {
 #ifdef ENABLE_OPENGL3_RENDERER
     gl3_renderer_set_callbacks,
 #endif
+#ifdef ENABLE_SOFTWARE_RENDERER
+    software_renderer_set_callbacks,
+#endif
 #ifdef ENABLE_NULL_RENDERER
     null_renderer_set_callbacks,
 #endif
@@ -197,6 +203,15 @@ void video_schedule_screenshot(video_screenshot_signal callback) {
     current_renderer.capture_screen(current_renderer.ctx, callback);
 }
 
+bool video_schedule_capture(video_screenshot_signal callback, unsigned interval) {
+    if(current_renderer.capture_stream == NULL) {
+        log_error("Renderer '%s' does not support continuous capture", current_renderer.get_name());
+        return false;
+    }
+    current_renderer.capture_stream(current_renderer.ctx, callback, callback != NULL ? interval : 0);
+    return true;
+}
+
 static inline void draw_args(const surface *sur, SDL_Rect *dst, int remap_offset, int remap_rounds, int palette_offset,
                              int palette_limit, int opacity, unsigned int flip_mode, unsigned int options) {
     current_renderer.draw_surface(current_renderer.ctx, sur, dst, remap_offset, remap_rounds, palette_offset,
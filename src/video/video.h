@@ -103,6 +103,14 @@ void video_render_area_finish(surface *dst);
 void video_close(void);
 void video_schedule_screenshot(video_screenshot_signal callback);
 
+/**
+ * Capture every interval'th rendered frame until stopped. Callback may be called from a background thread.
+ * @param callback Frame callback, or NULL to stop capturing
+ * @param interval Frames between captures
+ * @return false if the renderer does not support continuous capture.
+ */
+bool video_schedule_capture(video_screenshot_signal callback, unsigned interval);
+
 void video_draw_atlas(bool draw_atlas);
 
 #endif // VIDEO_H
@@ -1,5 +1,7 @@
 #include "formats/af.h"
 #include "formats/error.h"
+#include "formats/sprite.h"
+#include "utils/allocator.h"
 #include <CUnit/Basic.h>
 #include <CUnit/CUnit.h>
 
@@ -98,6 +100,64 @@ void test_af_roundtrip(void) {
     sd_af_free(&loaded);
 }
 
+static void make_test_sprite(sd_sprite *sprite, sd_vga_image *img, int w, int h) {
+    sd_vga_image_create(img, w, h);
+    // A few rows with gaps, so that the sprite gets runs of different lengths
+    for(int y = 0; y < h; y++) {
+        for(int x = 0; x < w; x++) {
+            img->data[y * w + x] = (x + y) % 5 == 0 ? 0 : (char)(1 + (x * 7 + y) % 250);
+        }
+    }
+    sd_sprite_create(sprite);
+    sd_sprite_vga_encode(sprite, img);
+}
+
+void test_sprite_vga_decode(void) {
+    sd_sprite sprite;
+    sd_vga_image img;
+    sd_vga_image decoded;
+    make_test_sprite(&sprite, &img, 13, 7);
+
+    CU_ASSERT(sd_sprite_vga_decode(&decoded, &sprite) == SD_SUCCESS);
+    CU_ASSERT_EQUAL(decoded.w, img.w);
+    CU_ASSERT_EQUAL(decoded.h, img.h);
+    CU_ASSERT(memcmp(decoded.data, img.data, img.len) == 0);
+
+    sd_vga_image_free(&decoded);
+    sd_vga_image_free(&img);
+    sd_sprite_free(&sprite);
+}
+
+void test_sprite_vga_decode_batch(void) {
+    sd_sprite sprites[3];
+    sd_vga_image images[2];
+    sd_vga_image decoded[4];
+    char *arena = NULL;
+    make_test_sprite(&sprites[0], &images[0], 13, 7);
+    make_test_sprite(&sprites[2], &images[1], 40, 3);
+    sd_sprite_create(&sprites[1]);
+    sprites[1].missing = 1;
+    sd_sprite *src[4] = {&sprites[0], &sprites[1], NULL, &sprites[2]};
+
+    CU_ASSERT(sd_sprite_vga_decode_batch(decoded, src, 4, &arena) == SD_SUCCESS);
+    CU_ASSERT_PTR_NOT_NULL(arena);
+    CU_ASSERT(decoded[0].w == 13 && decoded[0].h == 7);
+    CU_ASSERT(memcmp(decoded[0].data, images[0].data, images[0].len) == 0);
+    CU_ASSERT_PTR_NULL(decoded[1].data);
+    CU_ASSERT_PTR_NULL(decoded[2].data);
+    CU_ASSERT(decoded[3].w == 40 && decoded[3].h == 3);
+    CU_ASSERT(memcmp(decoded[3].data, images[1].data, images[1].len) == 0);
+    CU_ASSERT(decoded[3].data == decoded[0].data + decoded[0].len);
+
+    omf_free(arena);
+    for(int i = 0; i < 2; i++) {
+        sd_vga_image_free(&images[i]);
+    }
+    for(int i = 0; i < 3; i++) {
+        sd_sprite_free(&sprites[i]);
+    }
+}
+
 void af_test_suite(CU_pSuite suite) {
     if(CU_add_test(suite, "test of sd_af_create", test_sd_af_create) == NULL) {
         return;
@@ -105,6 +165,12 @@ void af_test_suite(CU_pSuite suite) {
     if(CU_add_test(suite, "test of AF empty roundtripping", test_af_roundtrip) == NULL) {
         return;
     }
+    if(CU_add_test(suite, "test of sd_sprite_vga_decode", test_sprite_vga_decode) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of sd_sprite_vga_decode_batch", test_sprite_vga_decode_batch) == NULL) {
+        return;
+    }
     if(CU_add_test(suite, "test of sd_af_free", test_sd_af_free) == NULL) {
         return;
     }
@@ -0,0 +1,101 @@
+#include <CUnit/CUnit.h>
+#include <utils/idmap.h>
+
+static int values[4] = {1, 2, 3, 4};
+
+void test_idmap_create(void) {
+    idmap map;
+    idmap_create(&map);
+    CU_ASSERT_PTR_NOT_NULL(map.slots);
+    CU_ASSERT(idmap_size(&map) == 0);
+    CU_ASSERT_PTR_NULL(idmap_get(&map, 1));
+    idmap_free(&map);
+    CU_ASSERT_PTR_NULL(map.slots);
+}
+
+void test_idmap_put_get(void) {
+    idmap map;
+    idmap_create(&map);
+    idmap_put(&map, 1, &values[0]);
+    idmap_put(&map, 2, &values[1]);
+    CU_ASSERT(idmap_size(&map) == 2);
+    CU_ASSERT(idmap_get(&map, 1) == &values[0]);
+    CU_ASSERT(idmap_get(&map, 2) == &values[1]);
+    CU_ASSERT_PTR_NULL(idmap_get(&map, 3));
+    CU_ASSERT_PTR_NULL(idmap_get(&map, 0));
+
+    // Putting an existing id replaces the value
+    idmap_put(&map, 1, &values[2]);
+    CU_ASSERT(idmap_size(&map) == 2);
+    CU_ASSERT(idmap_get(&map, 1) == &values[2]);
+    idmap_free(&map);
+}
+
+void test_idmap_del(void) {
+    idmap map;
+    idmap_create(&map);
+    idmap_put(&map, 1, &values[0]);
+    idmap_put(&map, 2, &values[1]);
+    CU_ASSERT(idmap_del(&map, 1) == true);
+    CU_ASSERT(idmap_del(&map, 1) == false);
+    CU_ASSERT(idmap_del(&map, 5) == false);
+    CU_ASSERT(idmap_size(&map) == 1);
+    CU_ASSERT_PTR_NULL(idmap_get(&map, 1));
+    CU_ASSERT(idmap_get(&map, 2) == &values[1]);
+    idmap_free(&map);
+}
+
+void test_idmap_grow(void) {
+    // Enough entries to grow the table a few times, then delete every other one
+    idmap map;
+    idmap_create(&map);
+    for(uint32_t id = 1; id <= 1000; id++) {
+        idmap_put(&map, id, &values[id % 4]);
+    }
+    CU_ASSERT(idmap_size(&map) == 1000);
+    for(uint32_t id = 1; id <= 1000; id += 2) {
+        CU_ASSERT(idmap_del(&map, id) == true);
+    }
+    CU_ASSERT(idmap_size(&map) == 500);
+    for(uint32_t id = 1; id <= 1000; id++) {
+        if(id % 2) {
+            CU_ASSERT_PTR_NULL(idmap_get(&map, id));
+        } else {
+            CU_ASSERT(idmap_get(&map, id) == &values[id % 4]);
+        }
+    }
+    idmap_free(&map);
+}
+
+void test_idmap_clear(void) {
+    idmap map;
+    idmap_create(&map);
+    idmap_put(&map, 10, &values[0]);
+    idmap_put(&map, 20, &values[1]);
+    idmap_clear(&map);
+    CU_ASSERT(idmap_size(&map) == 0);
+    CU_ASSERT_PTR_NULL(idmap_get(&map, 10));
+    CU_ASSERT_PTR_NULL(idmap_get(&map, 20));
+    idmap_put(&map, 20, &values[2]);
+    CU_ASSERT(idmap_get(&map, 20) == &values[2]);
+    idmap_free(&map);
+}
+
+void idmap_test_suite(CU_pSuite suite) {
+    // Add tests
+    if(CU_add_test(suite, "Test for idmap create", test_idmap_create) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for idmap put and get", test_idmap_put_get) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for idmap delete", test_idmap_del) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for idmap growing", test_idmap_grow) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for idmap clear", test_idmap_clear) == NULL) {
+        return;
+    }
+}
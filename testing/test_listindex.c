@@ -0,0 +1,198 @@
+#include "resources/listindex.h"
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32) || defined(WIN32)
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+
+#define INDEX_FILE "test_listindex.idx"
+#define FILE_A "test_listindex_a.dat"
+#define FILE_B "test_listindex_b.dat"
+#define VERSION 3
+
+static void write_file(const char *path, const char *content, const char *mode) {
+    FILE *f = fopen(path, mode);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(f);
+    fputs(content, f);
+    fclose(f);
+}
+
+// Records made during the second a file was modified are not trusted, so move the files into the past.
+static void set_mtime(const char *path, time_t mtime) {
+#if defined(_WIN32) || defined(WIN32)
+    struct _utimbuf times = {mtime, mtime};
+    CU_ASSERT(_utime(path, &times) == 0);
+#else
+    struct utimbuf times = {mtime, mtime};
+    CU_ASSERT(utime(path, &times) == 0);
+#endif
+}
+
+// Checks that the index has the given record for the file.
+static bool has_record(listindex *index, const char *path, const char *name, const char *record) {
+    sd_reader *r = listindex_get(index, path, name);
+    if(r == NULL) {
+        return false;
+    }
+    char buf[32] = {0};
+    bool match = sd_reader_filesize(r) == (long)strlen(record) && sd_read_buf(r, buf, strlen(record)) &&
+                 strcmp(buf, record) == 0;
+    sd_reader_close(r);
+    return match;
+}
+
+// Creates an index with records for both test files.
+static void make_index(void) {
+    listindex index;
+    remove(INDEX_FILE);
+    write_file(FILE_A, "file a", "wb");
+    write_file(FILE_B, "file b", "wb");
+    set_mtime(FILE_A, time(NULL) - 100);
+    set_mtime(FILE_B, time(NULL) - 100);
+
+    listindex_open(&index, INDEX_FILE, VERSION);
+    listindex_put(&index, FILE_A, "a", "record a", 8);
+    listindex_put(&index, FILE_B, "b", "record b", 8);
+    listindex_close(&index);
+}
+
+void test_listindex_roundtrip(void) {
+    listindex index;
+    make_index();
+
+    listindex_open(&index, INDEX_FILE, VERSION);
+    CU_ASSERT(has_record(&index, FILE_A, "a", "record a"));
+    CU_ASSERT(has_record(&index, FILE_B, "b", "record b"));
+    CU_ASSERT_PTR_NULL(listindex_get(&index, FILE_A, "c"));
+    listindex_close(&index);
+}
+
+void test_listindex_recent_file(void) {
+    listindex index;
+    make_index();
+
+    // A record made within the second the file was last written may be stale
+    listindex_open(&index, INDEX_FILE, VERSION);
+    write_file(FILE_A, "file a", "wb");
+    listindex_put(&index, FILE_A, "a", "record a", 8);
+    CU_ASSERT_PTR_NULL(listindex_get(&index, FILE_A, "a"));
+    listindex_close(&index);
+}
+
+void test_listindex_size_changed(void) {
+    listindex index;
+    make_index();
+
+    time_t mtime = time(NULL) - 100;
+    write_file(FILE_A, " grown", "ab");
+    set_mtime(FILE_A, mtime);
+
+    listindex_open(&index, INDEX_FILE, VERSION);
+    CU_ASSERT(!has_record(&index, FILE_A, "a", "record a"));
+    CU_ASSERT(has_record(&index, FILE_B, "b", "record b"));
+    listindex_close(&index);
+}
+
+void test_listindex_mtime_changed(void) {
+    listindex index;
+    make_index();
+
+    set_mtime(FILE_A, time(NULL) - 50);
+
+    listindex_open(&index, INDEX_FILE, VERSION);
+    CU_ASSERT(!has_record(&index, FILE_A, "a", "record a"));
+    CU_ASSERT(has_record(&index, FILE_B, "b", "record b"));
+    listindex_close(&index);
+}
+
+void test_listindex_drop_unused(void) {
+    listindex index;
+    make_index();
+
+    // Only look up a, so the record of b is dropped when closing
+    listindex_open(&index, INDEX_FILE, VERSION);
+    CU_ASSERT(has_record(&index, FILE_A, "a", "record a"));
+    listindex_close(&index);
+
+    listindex_open(&index, INDEX_FILE, VERSION);
+    CU_ASSERT(has_record(&index, FILE_A, "a", "record a"));
+    CU_ASSERT_PTR_NULL(listindex_get(&index, FILE_B, "b"));
+    listindex_close(&index);
+}
+
+void test_listindex_other_version(void) {
+    listindex index;
+    make_index();
+
+    listindex_open(&index, INDEX_FILE, VERSION + 1);
+    CU_ASSERT(vector_size(&index.entries) == 0);
+    CU_ASSERT_PTR_NULL(listindex_get(&index, FILE_A, "a"));
+    listindex_close(&index);
+}
+
+void test_listindex_corrupt(void) {
+    listindex index;
+    make_index();
+
+    // Cut the index short in the middle of the records
+    FILE *f = fopen(INDEX_FILE, "rb");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(f);
+    char buf[256];
+    size_t len = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+    CU_ASSERT_FATAL(len > 40);
+    f = fopen(INDEX_FILE, "wb");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(f);
+    fwrite(buf, 1, len - 4, f);
+    fclose(f);
+
+    listindex_open(&index, INDEX_FILE, VERSION);
+    CU_ASSERT(vector_size(&index.entries) == 0);
+    CU_ASSERT(index.dirty);
+    listindex_close(&index);
+
+    // Garbage instead of an index
+    write_file(INDEX_FILE, "this is not an index file", "wb");
+    listindex_open(&index, INDEX_FILE, VERSION);
+    CU_ASSERT(vector_size(&index.entries) == 0);
+    listindex_close(&index);
+}
+
+void test_listindex_cleanup(void) {
+    remove(INDEX_FILE);
+    remove(FILE_A);
+    remove(FILE_B);
+}
+
+void listindex_test_suite(CU_pSuite suite) {
+    if(CU_add_test(suite, "test of put and get roundtripping", test_listindex_roundtrip) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of recently modified file", test_listindex_recent_file) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of changed file size", test_listindex_size_changed) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of changed file time", test_listindex_mtime_changed) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of dropping unused entries", test_listindex_drop_unused) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of other index version", test_listindex_other_version) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of corrupt index", test_listindex_corrupt) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of cleanup", test_listindex_cleanup) == NULL) {
+        return;
+    }
+}
@@ -6,12 +6,17 @@ void bk_test_suite(CU_pSuite suite);
 void palette_test_suite(CU_pSuite suite);
 void rec_test_suite(CU_pSuite suite);
 void trn_test_suite(CU_pSuite suite);
+void pack_test_suite(CU_pSuite suite);
+void listindex_test_suite(CU_pSuite suite);
+void mixer_test_suite(CU_pSuite suite);
 void script_test_suite(CU_pSuite suite);
 void str_test_suite(CU_pSuite suite);
 void hashmap_test_suite(CU_pSuite suite);
 void vector_test_suite(CU_pSuite suite);
 void list_test_suite(CU_pSuite suite);
 void array_test_suite(CU_pSuite suite);
+void idmap_test_suite(CU_pSuite suite);
+void snapshot_test_suite(CU_pSuite suite);
 void text_layout_test_suite(CU_pSuite suite);
 void text_markup_test_suite(CU_pSuite suite);
 void video_common_test_suite(CU_pSuite suite);
@@ -53,6 +58,16 @@ int main(int argc, char **argv) {
         goto end;
     array_test_suite(array_suite);
 
+    suite = CU_add_suite("Idmap", NULL, NULL);
+    if(suite == NULL)
+        goto end;
+    idmap_test_suite(suite);
+
+    suite = CU_add_suite("Snapshot", NULL, NULL);
+    if(suite == NULL)
+        goto end;
+    snapshot_test_suite(suite);
+
     suite = CU_add_suite("Common renderer utils", NULL, NULL);
     if(suite == NULL)
         goto end;
@@ -98,6 +113,21 @@ int main(int argc, char **argv) {
         goto end;
     trn_test_suite(suite);
 
+    suite = CU_add_suite("Resource packs", NULL, NULL);
+    if(suite == NULL)
+        goto end;
+    pack_test_suite(suite);
+
+    suite = CU_add_suite("List index", NULL, NULL);
+    if(suite == NULL)
+        goto end;
+    listindex_test_suite(suite);
+
+    suite = CU_add_suite("Mixer", NULL, NULL);
+    if(suite == NULL)
+        goto end;
+    mixer_test_suite(suite);
+
     suite = CU_add_suite("Script", NULL, NULL);
     if(suite == NULL)
         goto end;
@@ -0,0 +1,65 @@
+#include "audio/mixer.h"
+#include "utils/miscmath.h"
+#include <CUnit/CUnit.h>
+#include <string.h>
+
+#define RATE 8000
+
+// 13 frames do not fill a whole number of vector blocks, so the last ones go through the scalar code
+#define FRAMES 13
+
+// Plays a constant sample over dst filled with fill, and checks that every frame of the result is the same as
+// what the scalar code gives.
+static void check_constant(unsigned char value, float volume, float panning, unsigned channels, int16_t fill) {
+    char buf[64];
+    int16_t dst[FRAMES * 2];
+    mixer m;
+    memset(buf, value, sizeof(buf));
+    for(int i = 0; i < FRAMES * 2; i++) {
+        dst[i] = fill;
+    }
+
+    mixer_init(&m, RATE, channels);
+    CU_ASSERT_FATAL(mixer_play(&m, 1, buf, sizeof(buf), RATE, volume, panning, 0, 0, 1.0f));
+    mixer_render(&m, dst, FRAMES);
+
+    float sample = (float)(value - 128) * (1.0f / 128.0f);
+    float gains[2] = {volume * ((panning > 0) ? 1.0f - panning : 1.0f),
+                      volume * ((panning < 0) ? 1.0f + panning : 1.0f)};
+    for(unsigned c = 0; c < channels; c++) {
+        int scaled = (int)clampf(sample * gains[c] * 32767.0f, -32768.0f, 32767.0f);
+        int16_t expected = clamp(fill + scaled, -32768, 32767);
+        for(unsigned i = 0; i < FRAMES; i++) {
+            CU_ASSERT_EQUAL(dst[i * channels + c], expected);
+        }
+    }
+}
+
+void test_mixer_store_mono(void) {
+    check_constant(200, 0.3f, 0.0f, 1, 0);
+    check_constant(50, 0.7f, 0.0f, 1, 1000);
+    check_constant(127, 0.9f, 0.0f, 1, 5);
+}
+
+void test_mixer_store_stereo(void) {
+    check_constant(200, 0.3f, 0.5f, 2, 0);
+    check_constant(30, 0.6f, -0.25f, 2, -200);
+}
+
+void test_mixer_store_saturation(void) {
+    check_constant(255, 1.0f, 0.0f, 1, 30000);
+    check_constant(0, 1.0f, 0.0f, 1, -30000);
+    check_constant(0, 1.0f, 0.0f, 2, 30000);
+}
+
+void mixer_test_suite(CU_pSuite suite) {
+    if(CU_add_test(suite, "test of mono sample conversion", test_mixer_store_mono) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of stereo sample conversion", test_mixer_store_stereo) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of saturating sample conversion", test_mixer_store_saturation) == NULL) {
+        return;
+    }
+}
@@ -0,0 +1,82 @@
+#include "formats/error.h"
+#include "formats/pack.h"
+#include "utils/c_string_util.h"
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PACK_FILE "test_pack.pak"
+
+// Checks that the pack has an entry with the given contents and source file stamp.
+static bool has_entry(const sd_pack_file *pack, const char *name, const char *content, uint32_t source_size,
+                      int64_t source_mtime) {
+    const sd_pack_entry *entry = sd_pack_find(pack, name);
+    if(entry == NULL) {
+        return false;
+    }
+    return entry->len == strlen(content) && memcmp(pack->data + entry->offset, content, entry->len) == 0 &&
+           entry->source_size == source_size && entry->source_mtime == source_mtime;
+}
+
+static void make_pack(sd_pack_file *pack) {
+    sd_pack_create(pack);
+    CU_ASSERT(sd_pack_add(pack, "FIGHTR1.AF", "fighter", 7, 1000, 1700000000) == SD_SUCCESS);
+    CU_ASSERT(sd_pack_add(pack, "ARENA0.BK", "arena", 5, 2000, 1700000001) == SD_SUCCESS);
+    CU_ASSERT(sd_pack_add(pack, "ARENA0.BK.PIX", "pixels", 6, 2000, 1700000001) == SD_SUCCESS);
+    CU_ASSERT(sd_pack_add(pack, "english.dat", "strings", 7, 3000, 5000000000LL) == SD_SUCCESS);
+    CU_ASSERT(sd_pack_add(pack, "CHARSMAL.DAT", "", 0, 0, 0) == SD_SUCCESS);
+}
+
+void test_pack_find(void) {
+    sd_pack_file pack;
+    make_pack(&pack);
+
+    CU_ASSERT(pack.count == 5);
+    for(unsigned int i = 1; i < pack.count; i++) {
+        CU_ASSERT(omf_strncasecmp(pack.entries[i - 1].name, pack.entries[i].name, SD_PACK_NAME_LENGTH) < 0);
+    }
+    CU_ASSERT(has_entry(&pack, "fightr1.af", "fighter", 1000, 1700000000));
+    CU_ASSERT(has_entry(&pack, "arena0.bk", "arena", 2000, 1700000001));
+    CU_ASSERT(has_entry(&pack, "ARENA0.BK.PIX", "pixels", 2000, 1700000001));
+    CU_ASSERT(has_entry(&pack, "CHARSMAL.DAT", "", 0, 0));
+    CU_ASSERT_PTR_NULL(sd_pack_find(&pack, "ARENA1.BK"));
+    CU_ASSERT_PTR_NULL(sd_pack_find(&pack, "AAA"));
+    CU_ASSERT_PTR_NULL(sd_pack_find(&pack, "ZZZ"));
+
+    // Names differing only in case are the same entry
+    CU_ASSERT(sd_pack_add(&pack, "Arena0.bk", "again", 5, 0, 0) == SD_INVALID_INPUT);
+    CU_ASSERT(pack.count == 5);
+
+    sd_pack_free(&pack);
+}
+
+void test_pack_roundtrip(void) {
+    sd_pack_file pack;
+    make_pack(&pack);
+    CU_ASSERT_FATAL(sd_pack_save(&pack, PACK_FILE) == SD_SUCCESS);
+    sd_pack_free(&pack);
+
+    sd_pack_create(&pack);
+    CU_ASSERT_FATAL(sd_pack_load(&pack, PACK_FILE) == SD_SUCCESS);
+    CU_ASSERT(pack.count == 5);
+    CU_ASSERT(has_entry(&pack, "FIGHTR1.AF", "fighter", 1000, 1700000000));
+    CU_ASSERT(has_entry(&pack, "ARENA0.BK.PIX", "pixels", 2000, 1700000001));
+    CU_ASSERT(has_entry(&pack, "ENGLISH.DAT", "strings", 3000, 5000000000LL));
+    sd_pack_free(&pack);
+}
+
+void test_pack_cleanup(void) {
+    remove(PACK_FILE);
+}
+
+void pack_test_suite(CU_pSuite suite) {
+    if(CU_add_test(suite, "test of finding entries", test_pack_find) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of save and load roundtripping", test_pack_roundtrip) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of cleanup", test_pack_cleanup) == NULL) {
+        return;
+    }
+}
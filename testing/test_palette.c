@@ -72,6 +72,51 @@ void test_gimp_roundtrip(void) {
     CU_ASSERT_NSTRING_EQUAL(pal.colors, new.colors, 256 * 3);
 }
 
+void test_palette_lookup_exact(void) {
+    palette_lookup lookup;
+    palette_lookup_create(&lookup, &pal, 0, 256);
+    for(int i = 0; i < 256; i++) {
+        vga_color *c = &pal.colors[i];
+        CU_ASSERT(palette_lookup_exact(&lookup, c->r, c->g, c->b) == palette_resolve_color(c->r, c->g, c->b, &pal));
+    }
+    CU_ASSERT(palette_lookup_exact(&lookup, 1, 2, 3) == -1);
+
+    // Colors outside the given range are not found
+    palette_lookup_create(&lookup, &pal, 16, 32);
+    CU_ASSERT(palette_lookup_exact(&lookup, pal.colors[15].r, pal.colors[15].g, pal.colors[15].b) == -1);
+    CU_ASSERT(palette_lookup_exact(&lookup, pal.colors[16].r, pal.colors[16].g, pal.colors[16].b) == 16);
+    CU_ASSERT(palette_lookup_exact(&lookup, pal.colors[47].r, pal.colors[47].g, pal.colors[47].b) == 47);
+    CU_ASSERT(palette_lookup_exact(&lookup, pal.colors[48].r, pal.colors[48].g, pal.colors[48].b) == -1);
+}
+
+void test_palette_lookup_nearest(void) {
+    palette_lookup lookup;
+    palette_lookup_create(&lookup, &pal, 0, 256);
+    for(int r = 0; r < 256; r += 5) {
+        for(int b = 0; b < 256; b += 51) {
+            // Compare against a plain search over the whole palette
+            int best = 0;
+            int best_dist = 256 * 256 * 3;
+            for(int i = 0; i < 256; i++) {
+                int dr = pal.colors[i].r - r;
+                int dg = pal.colors[i].g - 100;
+                int db = pal.colors[i].b - b;
+                int dist = dr * dr + dg * dg + db * db;
+                if(dist < best_dist) {
+                    best_dist = dist;
+                    best = i;
+                }
+            }
+            CU_ASSERT(palette_lookup_nearest(&lookup, r, 100, b) == best);
+        }
+    }
+
+    // Only indexes in the range are returned
+    palette_lookup_create(&lookup, &pal, 200, 10);
+    CU_ASSERT(palette_lookup_nearest(&lookup, 0, 255, 128) == 200);
+    CU_ASSERT(palette_lookup_nearest(&lookup, 255, 0, 128) == 209);
+}
+
 void palette_test_suite(CU_pSuite suite) {
     if(CU_add_test(suite, "test of palette_create", test_palette_create) == NULL) {
         return;
@@ -85,4 +130,10 @@ void palette_test_suite(CU_pSuite suite) {
     if(CU_add_test(suite, "test of palette roundtripping", test_gimp_roundtrip) == NULL) {
         return;
     }
+    if(CU_add_test(suite, "test of palette_lookup_exact", test_palette_lookup_exact) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of palette_lookup_nearest", test_palette_lookup_nearest) == NULL) {
+        return;
+    }
 }
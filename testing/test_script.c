@@ -186,6 +186,21 @@ void test_script_get(void) {
     CU_ASSERT(sd_script_get(sd_script_get_frame(&script, 0), "mp") == 0);
 }
 
+void test_script_isset_id(void) {
+    CU_ASSERT(sd_script_isset_id(NULL, SD_TAG_BPS) == 0);
+    CU_ASSERT(sd_script_isset_id(sd_script_get_frame(&script, 0), SD_TAG_BPS) == 1);
+    CU_ASSERT(sd_script_isset_id(sd_script_get_frame(&script, 0), SD_TAG_BPD) == 1);
+    CU_ASSERT(sd_script_isset_id(sd_script_get_frame(&script, 0), SD_TAG_MP) == 0);
+}
+
+void test_script_get_id(void) {
+    CU_ASSERT(sd_script_get_id(NULL, SD_TAG_BPS) == 0);
+    CU_ASSERT(sd_script_get_id(sd_script_get_frame(&script, 0), SD_TAG_BPS) == 1);
+    CU_ASSERT(sd_script_get_id(sd_script_get_frame(&script, 0), SD_TAG_BPD) == 1);
+    CU_ASSERT(sd_script_get_id(sd_script_get_frame(&script, 0), SD_TAG_BPN) == 64);
+    CU_ASSERT(sd_script_get_id(sd_script_get_frame(&script, 0), SD_TAG_MP) == 0);
+}
+
 void test_script_tag_vars(void) {
     CU_ASSERT(sd_script_get(sd_script_get_frame(&script, 0), "s") == 5); // 05 -> 5 should work
 }
@@ -235,6 +250,8 @@ void test_next_frame_with_tag(void) {
     CU_ASSERT(sd_script_next_frame_with_tag(&script, "sf", 0) == 1);    // Just test any tag
     CU_ASSERT(sd_script_next_frame_with_tag(&script, "sf", 99) == 1);   // Border case 1
     CU_ASSERT(sd_script_next_frame_with_tag(&script, "sf", 100) == -1); // Border case 2
+    CU_ASSERT(sd_script_next_frame_with_tag_id(&script, SD_TAG_SF, 99) == 1);
+    CU_ASSERT(sd_script_next_frame_with_tag_id(&script, SD_TAG_SF, 100) == -1);
 }
 
 void test_set_tag(void) {
@@ -245,6 +262,7 @@ void test_set_tag(void) {
     // Test creating new tag and make sure nothing got overwritten
     CU_ASSERT(sd_script_set_tag(&script, 1, "bpd", 50) == SD_SUCCESS);
     CU_ASSERT(sd_script_get(sd_script_get_frame(&script, 1), "bpd") == 50);
+    CU_ASSERT(sd_script_get_id(sd_script_get_frame(&script, 1), SD_TAG_BPD) == 50);
     CU_ASSERT(sd_script_get(sd_script_get_frame(&script, 1), "s") == 1);
     CU_ASSERT(sd_script_get(sd_script_get_frame(&script, 1), "sf") == 3);
 
@@ -285,6 +303,7 @@ void test_clear_tags(void) {
     // Real tests
     CU_ASSERT(sd_script_clear_tags(&s, 0) == SD_SUCCESS);
     CU_ASSERT(sd_script_get(sd_script_get_frame(&s, 0), "bpd") == 0);
+    CU_ASSERT(sd_script_isset_id(sd_script_get_frame(&s, 0), SD_TAG_BPD) == 0);
 
     sd_script_free(&s);
 }
@@ -305,6 +324,8 @@ void test_delete_tag(void) {
     // Real tests
     CU_ASSERT(sd_script_delete_tag(&s, 0, "bpn") == SD_SUCCESS);
     CU_ASSERT(sd_script_get(sd_script_get_frame(&s, 0), "bpn") == 0);
+    CU_ASSERT(sd_script_isset_id(sd_script_get_frame(&s, 0), SD_TAG_BPN) == 0);
+    CU_ASSERT(sd_script_get_id(sd_script_get_frame(&s, 0), SD_TAG_S) == 15);
     CU_ASSERT(sd_script_get(sd_script_get_frame(&s, 0), "s") == 15);
     CU_ASSERT(sd_script_get(sd_script_get_frame(&s, 0), "sf") == 100);
     CU_ASSERT(get_tag_count(&s, 0) == 2);
@@ -421,6 +442,12 @@ void script_test_suite(CU_pSuite suite) {
     if(CU_add_test(suite, "test of sd_script_get", test_script_get) == NULL) {
         return;
     }
+    if(CU_add_test(suite, "test of sd_script_isset_id", test_script_isset_id) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of sd_script_get_id", test_script_get_id) == NULL) {
+        return;
+    }
     if(CU_add_test(suite, "test of sd_script_next_frame_with_sprite", test_next_frame_with_sprite) == NULL) {
         return;
     }
@@ -0,0 +1,151 @@
+#include "game/common_defines.h"
+#include "game/game_player.h"
+#include "game/game_state.h"
+#include "game/protos/object.h"
+#include "game/protos/scene.h"
+#include "game/utils/snapshot.h"
+#include "game/utils/ticktimer.h"
+#include "utils/allocator.h"
+#include <CUnit/CUnit.h>
+#include <string.h>
+
+// Builds just enough of a game state for snapshots, without loading any resources
+static game_state *create_state(void) {
+    game_state *gs = omf_calloc(1, sizeof(game_state));
+    vector_create(&gs->objects, sizeof(render_obj));
+    idmap_create(&gs->object_index);
+    vector_create(&gs->sounds, sizeof(playing_sound));
+    random_seed(&gs->rand, 1234);
+    gs->tick = 10;
+
+    gs->sc = omf_calloc(1, sizeof(scene));
+    gs->sc->gs = gs;
+    gs->sc->id = SCENE_ARENA0;
+    ticktimer_init(&gs->sc->tick_timer);
+
+    for(int i = 0; i < 2; i++) {
+        gs->players[i] = omf_calloc(1, sizeof(game_player));
+        gs->players[i]->score.total = text_create_from_c("0");
+        list_create(&gs->players[i]->score.texts);
+    }
+    return gs;
+}
+
+static void free_state(game_state *gs) {
+    iterator it;
+    render_obj *robj;
+    vector_iter_begin(&gs->objects, &it);
+    foreach(it, robj) {
+        object_free(robj->obj);
+        omf_free(robj->obj);
+    }
+    vector_free(&gs->objects);
+    idmap_free(&gs->object_index);
+    vector_free(&gs->sounds);
+    ticktimer_close(&gs->sc->tick_timer);
+    omf_free(gs->sc);
+    for(int i = 0; i < 2; i++) {
+        chr_score_free(&gs->players[i]->score);
+        omf_free(gs->players[i]);
+    }
+    omf_free(gs);
+}
+
+static object *add_object(game_state *gs, int x, const char *animation) {
+    object *obj = omf_calloc(1, sizeof(object));
+    object_create(obj, gs, vec2i_create(x, 100), vec2f_create(1.0f, -2.0f));
+    object_set_custom_string(obj, animation);
+    game_state_add_object(gs, obj, RENDER_LAYER_MIDDLE, 0, 0);
+    return obj;
+}
+
+void test_snapshot_restore(void) {
+    char diff[128];
+    snapshot saved;
+    snapshot current;
+    snapshot_create(&saved);
+    snapshot_create(&current);
+
+    game_state *gs = create_state();
+    object *kept = add_object(gs, 10, "A5-B5");
+    object *removed = add_object(gs, 20, "C3-D3");
+    uint32_t kept_id = kept->id;
+    uint32_t removed_id = removed->id;
+    gs->players[0]->score.score = 100;
+
+    game_state_snapshot(gs, &saved);
+    game_state_snapshot(gs, &current);
+    CU_ASSERT(!snapshot_diff(&saved, &current, diff, sizeof(diff)));
+
+    // Change things in place, and remove and add objects
+    gs->tick = 20;
+    random_int(&gs->rand, 10);
+    gs->players[0]->score.score = 200;
+    text_set_from_c(gs->players[1]->score.total, "1234");
+    kept->pos = vec2f_create(50.0f, 60.0f);
+    object_set_custom_string(kept, "A1-B1-C1");
+    game_state_del_object(gs, removed);
+    object *added = add_object(gs, 30, "E2");
+    uint32_t added_id = added->id;
+
+    game_state_snapshot(gs, &current);
+    CU_ASSERT(snapshot_diff(&saved, &current, diff, sizeof(diff)));
+
+    CU_ASSERT_FATAL(game_state_restore(gs, &saved) == 0);
+    game_state_snapshot(gs, &current);
+    CU_ASSERT(!snapshot_diff(&saved, &current, diff, sizeof(diff)));
+
+    CU_ASSERT(gs->tick == 10);
+    CU_ASSERT(random_get_seed(&gs->rand) == 1234);
+    CU_ASSERT(gs->players[0]->score.score == 100);
+    CU_ASSERT_STRING_EQUAL(text_c(gs->players[1]->score.total), "0");
+    CU_ASSERT(vector_size(&gs->objects) == 2);
+    CU_ASSERT(game_state_find_object(gs, kept_id) == kept);
+    CU_ASSERT(kept->pos.x == 10.0f);
+
+    // The removed object is built back up, and the added one is gone
+    object *restored = game_state_find_object(gs, removed_id);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(restored);
+    CU_ASSERT(restored->pos.x == 20.0f);
+    CU_ASSERT(restored->gs == gs);
+    CU_ASSERT(vector_size(&player_get_script(restored)->frames) == 2);
+    CU_ASSERT_PTR_NULL(game_state_find_object(gs, added_id));
+
+    free_state(gs);
+    snapshot_free(&saved);
+    snapshot_free(&current);
+}
+
+void test_snapshot_diff(void) {
+    char diff[128];
+    snapshot a;
+    snapshot b;
+    snapshot_create(&a);
+    snapshot_create(&b);
+
+    game_state *gs = create_state();
+    object *obj = add_object(gs, 10, "A5");
+    game_state_snapshot(gs, &a);
+
+    obj->vel = vec2f_create(3.0f, 3.0f);
+    game_state_snapshot(gs, &b);
+    CU_ASSERT(snapshot_diff(&a, &b, diff, sizeof(diff)));
+    CU_ASSERT_PTR_NOT_NULL(strstr(diff, "object"));
+
+    add_object(gs, 20, "B5");
+    game_state_snapshot(gs, &b);
+    CU_ASSERT(snapshot_diff(&a, &b, diff, sizeof(diff)));
+
+    free_state(gs);
+    snapshot_free(&a);
+    snapshot_free(&b);
+}
+
+void snapshot_test_suite(CU_pSuite suite) {
+    if(CU_add_test(suite, "test of snapshot and restore", test_snapshot_restore) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of snapshot_diff", test_snapshot_diff) == NULL) {
+        return;
+    }
+}
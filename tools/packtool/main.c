@@ -0,0 +1,218 @@
+/** @file main.c
+ * @brief Resource pack builder
+ * @license MIT
+ */
+
+#include "formats/af.h"
+#include "formats/bk.h"
+#include "formats/error.h"
+#include "formats/internal/memwriter.h"
+#include "formats/internal/reader.h"
+#include "formats/pack.h"
+#include "utils/allocator.h"
+#include "utils/c_array_util.h"
+#include "utils/c_string_util.h"
+#include <argtable3.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+static const char *file_name(const char *path) {
+    const char *name = path;
+    for(const char *c = path; *c; c++) {
+        if(*c == '/' || *c == '\\') {
+            name = c + 1;
+        }
+    }
+    return name;
+}
+
+static bool has_extension(const char *name, const char *ext) {
+    size_t name_len = strlen(name);
+    size_t ext_len = strlen(ext);
+    return name_len > ext_len && omf_strncasecmp(name + name_len - ext_len, ext, ext_len) == 0;
+}
+
+static void write_animation_pixels(memwriter *w, const sd_animation *ani, unsigned int *count) {
+    if(ani == NULL) {
+        return;
+    }
+    // Same sprites, in the same order, as the game creates them; see sprite_create_from_pixels.
+    for(int i = 0; i < ani->sprite_count; i++) {
+        const sd_sprite *sprite = ani->sprites[i];
+        if(sprite->missing || sprite->width == 0 || sprite->height == 0) {
+            continue;
+        }
+        sd_vga_image img;
+        sd_sprite_vga_decode(&img, sprite);
+        memwrite_uword(w, sprite->width);
+        memwrite_uword(w, sprite->height);
+        memwrite_uword(w, img.w);
+        memwrite_uword(w, img.h);
+        memwrite_buf(w, img.data, img.w * img.h);
+        sd_vga_image_free(&img);
+        (*count)++;
+    }
+}
+
+static int add_pixels(sd_pack_file *pack, const char *path, const char *name, const struct stat *st) {
+    memwriter *w = memwriter_open();
+    unsigned int count = 0;
+    int ret;
+    if(has_extension(name, ".AF")) {
+        sd_af_file af;
+        sd_af_create(&af);
+        if((ret = sd_af_load(&af, path)) == SD_SUCCESS) {
+            for(int i = 0; i < MAX_AF_MOVES; i++) {
+                if(af.moves[i] != NULL) {
+                    write_animation_pixels(w, af.moves[i]->animation, &count);
+                }
+            }
+        }
+        sd_af_free(&af);
+    } else {
+        sd_bk_file bk;
+        sd_bk_create(&bk);
+        if((ret = sd_bk_load(&bk, path)) == SD_SUCCESS) {
+            for(int i = 0; i < MAX_BK_ANIMS; i++) {
+                if(bk.anims[i] != NULL) {
+                    write_animation_pixels(w, bk.anims[i]->animation, &count);
+                }
+            }
+        }
+        sd_bk_free(&bk);
+    }
+
+    if(ret == SD_SUCCESS) {
+        char pixels_name[SD_PACK_NAME_LENGTH];
+        snprintf(pixels_name, sizeof(pixels_name), "%s%s", name, SD_PACK_PIXELS_SUFFIX);
+        ret = sd_pack_add(pack, pixels_name, w->buf, w->data_len, (uint32_t)st->st_size, (int64_t)st->st_mtime);
+        if(ret == SD_SUCCESS) {
+            printf("  %u sprites decoded, %ld bytes\n", count, w->data_len);
+        }
+    }
+    memwriter_close(w);
+    return ret;
+}
+
+static int add_file(sd_pack_file *pack, const char *path) {
+    const char *name = file_name(path);
+    if(strlen(name) + strlen(SD_PACK_PIXELS_SUFFIX) >= SD_PACK_NAME_LENGTH) {
+        return SD_INVALID_INPUT;
+    }
+
+    // The game ignores entries once the size or modification time of their file no longer matches
+    struct stat st;
+    if(stat(path, &st) != 0) {
+        return SD_FILE_OPEN_ERROR;
+    }
+    sd_reader *r = sd_reader_open(path);
+    if(!r) {
+        return SD_FILE_OPEN_ERROR;
+    }
+    long len = sd_reader_filesize(r);
+    char *buf = omf_malloc(len + 1);
+    int ret = sd_read_buf(r, buf, len)
+                  ? sd_pack_add(pack, name, buf, len, (uint32_t)st.st_size, (int64_t)st.st_mtime)
+                  : SD_FILE_READ_ERROR;
+    omf_free(buf);
+    sd_reader_close(r);
+    if(ret != SD_SUCCESS) {
+        return ret;
+    }
+    printf("%s: %ld bytes\n", name, len);
+
+    if(has_extension(name, ".AF") || has_extension(name, ".BK")) {
+        return add_pixels(pack, path, name, &st);
+    }
+    return SD_SUCCESS;
+}
+
+int main(int argc, char *argv[]) {
+    // commandline argument parser options
+    struct arg_lit *help = arg_lit0("h", "help", "print this help and exit");
+    struct arg_lit *vers = arg_lit0("v", "version", "print version information and exit");
+    struct arg_file *file = arg_file0("f", "file", "<file>", "Resource pack to list");
+    struct arg_file *output = arg_file0("o", "output", "<file>", "Resource pack to create");
+    struct arg_file *inputs = arg_filen(NULL, NULL, "<file>", 0, 256, "Game data files to pack");
+    struct arg_end *end = arg_end(20);
+    void *argtable[] = {help, vers, file, output, inputs, end};
+    const char *progname = "packtool";
+
+    // Make sure everything got allocated
+    if(arg_nullcheck(argtable) != 0) {
+        printf("%s: insufficient memory\n", progname);
+        goto exit_0;
+    }
+
+    // Parse arguments
+    int nerrors = arg_parse(argc, argv, argtable);
+
+    // Handle help
+    if(help->count > 0) {
+        printf("Usage: %s", progname);
+        arg_print_syntax(stdout, argtable, "\n");
+        printf("\nArguments:\n");
+        arg_print_glossary(stdout, argtable, "%-25s %s\n");
+        goto exit_0;
+    }
+
+    // Handle version
+    if(vers->count > 0) {
+        printf("%s v0.1\n", progname);
+        printf("Command line OpenOMF resource pack builder.\n");
+        printf("Source code is available at https://github.com/omf2097 under MIT license.\n");
+        goto exit_0;
+    }
+
+    // Handle errors
+    if(nerrors > 0) {
+        arg_print_errors(stdout, end, progname);
+        printf("Try '%s --help' for more information.\n", progname);
+        goto exit_0;
+    }
+
+    // Need either a pack to list, or files to pack
+    if((file->count > 0) == (output->count > 0) || (output->count > 0 && inputs->count == 0)) {
+        printf("Define either --file, or --output with files to pack.\n");
+        goto exit_0;
+    }
+
+    sd_pack_file pack;
+    sd_pack_create(&pack);
+    int ret;
+    if(file->count > 0) {
+        ret = sd_pack_load(&pack, file->filename[0]);
+        if(ret != SD_SUCCESS) {
+            printf("Unable to load resource pack %s: %s.\n", file->filename[0], sd_get_error(ret));
+            goto exit_1;
+        }
+        printf("Version %d, %u entries, %u bytes of data\n", SD_PACK_VERSION, pack.count, pack.data_len);
+        for(unsigned int i = 0; i < pack.count; i++) {
+            const sd_pack_entry *entry = &pack.entries[i];
+            printf("%-32s %10u %10u %10u %12lld\n", entry->name, entry->offset, entry->len, entry->source_size,
+                   (long long)entry->source_mtime);
+        }
+        goto exit_1;
+    }
+
+    for(int i = 0; i < inputs->count; i++) {
+        ret = add_file(&pack, inputs->filename[i]);
+        if(ret != SD_SUCCESS) {
+            printf("Unable to pack %s: %s.\n", inputs->filename[i], sd_get_error(ret));
+            goto exit_1;
+        }
+    }
+    ret = sd_pack_save(&pack, output->filename[0]);
+    if(ret != SD_SUCCESS) {
+        printf("Failed saving resource pack to %s: %s\n", output->filename[0], sd_get_error(ret));
+    } else {
+        printf("Saved %u entries to %s.\n", pack.count, output->filename[0]);
+    }
+
+exit_1:
+    sd_pack_free(&pack);
+exit_0:
+    arg_freetable(argtable, N_ELEMENTS(argtable));
+    return 0;
+}
@@ -0,0 +1,346 @@
+/** @file main.c
+ * @brief Headless .REC to video exporter
+ * @license MIT
+ *
+ * Plays a REC file through the normal REC controllers on a virtual clock, as fast as the machine allows,
+ * and writes out what would have been on screen and in the speakers. The clock advances one static tick
+ * (10 ms) at a time, and every step produces one 320x200 RGB24 video frame and 10 ms of audio. The video
+ * is a raw stream at 100 frames per second; the audio is a WAV file of the music and sound effects.
+ *
+ * Rendering is done with the software renderer on the dummy SDL video driver, so no window or GPU is
+ * needed. Both random number generators are seeded with a fixed value (see --seed) instead of the clock,
+ * so exporting the same REC file twice gives the same output. For example, to encode a match:
+ *
+ *     recexport --video - --audio match.wav match.rec |
+ *         ffmpeg -f rawvideo -pix_fmt rgb24 -s 320x200 -r 100 -i - -i match.wav match.mp4
+ */
+
+#include "audio/backends/offline/offline_backend.h"
+#include "engine.h"
+#include "game/game_state.h"
+#include "game/utils/settings.h"
+#include "resources/pathmanager.h"
+#include "utils/allocator.h"
+#include "utils/c_array_util.h"
+#include "utils/c_string_util.h"
+#include "utils/log.h"
+#include "utils/miscmath.h"
+#include "utils/random.h"
+#include "utils/wav_writer.h"
+#include "video/vga_state.h"
+#include "video/video.h"
+#include <SDL.h>
+#include <argtable3.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32) || defined(WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+// One video frame per static tick.
+#define FRAME_MS STATIC_TICKS
+#define FRAMES_PER_SECOND (1000 / FRAME_MS)
+
+// REC files do not record random seeds, so any fixed value gives a reproducible export.
+#define DEFAULT_SEED 2097
+
+typedef struct {
+    FILE *video;
+    wav_writer *audio;
+    int16_t *samples;
+    unsigned sample_rate;
+    unsigned channels;
+    unsigned frames;
+    uint32_t dynamic_ticks;
+    bool failed;
+} export_state;
+
+// The screenshot signal carries no userdata, so it writes to this.
+static export_state state;
+
+static double ticks_to_ms(uint64_t ticks) {
+    return (double)ticks * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static void write_video_frame(const SDL_Rect *r, unsigned char *data, bool flipped) {
+    size_t row = r->w * 3;
+    for(int y = 0; y < r->h && !state.failed; y++) {
+        int src_y = flipped ? r->h - y - 1 : y;
+        if(fwrite(data + src_y * row, 1, row, state.video) != row) {
+            log_error("Unable to write video frame %u", state.frames);
+            state.failed = true;
+        }
+    }
+}
+
+static void write_audio_frame(void) {
+    // Sample rates like 44100Hz do not split evenly into 10ms blocks, so spread the remainder over the frames.
+    uint64_t start = (uint64_t)state.frames * state.sample_rate / FRAMES_PER_SECOND;
+    uint64_t end = (uint64_t)(state.frames + 1) * state.sample_rate / FRAMES_PER_SECOND;
+    unsigned count = end - start;
+    offline_audio_backend_render(state.samples, count);
+    if(!wav_writer_write(state.audio, state.samples, count)) {
+        log_error("Unable to write audio frame %u", state.frames);
+        state.failed = true;
+    }
+}
+
+/*
+ * Static and dynamic ticks are interleaved exactly like engine_run() does it, but the clock only moves
+ * forward by one video frame per step, instead of following the wall clock.
+ */
+static bool export_file(const char *filename, int speed, uint32_t max_ticks, uint32_t seed) {
+    engine_init_flags init_flags;
+    memset(&init_flags, 0, sizeof(init_flags));
+    init_flags.playback = 1;
+    init_flags.speed = speed;
+    strncpy_or_truncate(init_flags.rec_file, filename, sizeof(init_flags.rec_file));
+
+    game_state *gs = omf_calloc(1, sizeof(game_state));
+    if(game_state_create(gs, &init_flags)) {
+        game_state_free(&gs);
+        return false;
+    }
+    // game_state_create() seeds from the clock
+    random_seed(&gs->rand, seed);
+
+    int dynamic_wait = 0;
+    int static_wait = 0;
+    while(game_state_is_running(gs) && !state.failed) {
+        static_wait += FRAME_MS;
+        dynamic_wait += FRAME_MS;
+
+        bool has_dynamic;
+        bool has_static;
+        do {
+            int dyntick_ms = game_state_ms_per_dyntick(gs);
+            has_static = static_wait > STATIC_TICKS;
+            if(has_static) {
+                game_state_static_tick(gs, false);
+                if(gs->new_state) {
+                    game_state *old_gs = gs;
+                    gs = gs->new_state;
+                    game_state_clone_free(old_gs);
+                    omf_free(old_gs);
+                }
+                static_wait -= STATIC_TICKS;
+            }
+
+            has_dynamic = dynamic_wait > dyntick_ms;
+            if(has_dynamic) {
+                game_state_dynamic_tick(gs, false);
+                dynamic_wait -= dyntick_ms;
+                if(gs->delay > 0) {
+                    gs->delay--;
+                    dynamic_wait -= 4;
+                }
+                state.dynamic_ticks++;
+            }
+
+            if(has_dynamic || has_static) {
+                game_state_palette_transform(gs);
+                vga_state_render();
+            }
+        } while(has_dynamic || has_static);
+
+        video_render_prepare(game_state_get_framebuffer_options(gs));
+        game_state_render(gs);
+        if(state.video != NULL) {
+            // The software renderer hands the frame over before video_render_finish() returns.
+            video_schedule_screenshot(write_video_frame);
+        }
+        video_render_finish();
+        if(state.audio != NULL) {
+            write_audio_frame();
+        }
+        state.frames++;
+
+        if(max_ticks > 0 && state.dynamic_ticks >= max_ticks) {
+            log_warn("Tick limit reached, stopping the export");
+            break;
+        }
+    }
+
+    game_state_free(&gs);
+    return !state.failed;
+}
+
+static FILE *open_video_output(const char *filename) {
+    if(strcmp(filename, "-") == 0) {
+#if defined(_WIN32) || defined(WIN32)
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        return stdout;
+    }
+    FILE *handle = fopen(filename, "wb");
+    if(handle == NULL) {
+        log_error("Unable to open %s for writing", filename);
+    }
+    return handle;
+}
+
+int main(int argc, char *argv[]) {
+    struct arg_lit *help = arg_lit0("h", "help", "print this help and exit");
+    struct arg_lit *vers = arg_lit0("v", "version", "print version information and exit");
+    struct arg_file *video =
+        arg_file0(NULL, "video", "<file>", "write raw 320x200 RGB24 frames at 100 fps ('-' for stdout)");
+    struct arg_file *audio = arg_file0(NULL, "audio", "<file>", "write the audio as a 16-bit PCM WAV file");
+    struct arg_int *resampler =
+        arg_int0(NULL, "resampler", "<n>", "music resampler to use: 0-2 (default: from settings)");
+    struct arg_int *speed = arg_int0(NULL, "speed", "<speed>", "game speed to use: 1-10 (default: from settings)");
+    struct arg_int *max_ticks =
+        arg_int0(NULL, "max-ticks", "<ticks>", "stop after this many dynamic ticks (default: 100000)");
+    struct arg_int *seed =
+        arg_int0(NULL, "seed", "<seed>", "seed for the random number generators (default: 2097)");
+    struct arg_str *log_level = arg_str0(NULL, "log-level", "<level>", "Log level (DEBUG, INFO, WARN, ERROR)");
+    struct arg_file *file = arg_file1(NULL, NULL, "<file>", "REC file to export");
+    struct arg_end *end = arg_end(20);
+    void *argtable[] = {help, vers, video, audio, resampler, speed, max_ticks, seed, log_level, file, end};
+    const char *progname = "recexport";
+    int ret = 1;
+
+    // Make sure everything got allocated
+    if(arg_nullcheck(argtable) != 0) {
+        fprintf(stderr, "%s: insufficient memory\n", progname);
+        goto exit_0;
+    }
+
+    // Parse arguments
+    int nerrors = arg_parse(argc, argv, argtable);
+
+    // Handle help. Video may go to stdout, so everything else goes to stderr.
+    if(help->count > 0) {
+        fprintf(stderr, "Usage: %s", progname);
+        arg_print_syntax(stderr, argtable, "\n");
+        fprintf(stderr, "\nArguments:\n");
+        arg_print_glossary(stderr, argtable, "%-25s %s\n");
+        ret = 0;
+        goto exit_0;
+    }
+
+    // Handle version
+    if(vers->count > 0) {
+        fprintf(stderr, "%s v0.1\n", progname);
+        fprintf(stderr, "Headless One Must Fall 2097 REC to video exporter.\n");
+        fprintf(stderr, "Source code is available at https://github.com/omf2097 under MIT license.\n");
+        ret = 0;
+        goto exit_0;
+    }
+
+    // Handle errors
+    if(nerrors > 0) {
+        arg_print_errors(stderr, end, progname);
+        fprintf(stderr, "Try '%s --help' for more information.\n", progname);
+        goto exit_0;
+    }
+    if(video->count == 0 && audio->count == 0) {
+        fprintf(stderr, "Nothing to do; give --video, --audio or both.\n");
+        goto exit_0;
+    }
+
+    if(pm_init() != 0) {
+        fprintf(stderr, "Error: %s.\n", pm_get_errormsg());
+        goto exit_0;
+    }
+
+    log_init();
+    log_add_stderr(LOG_DEBUG, false);
+    log_set_level(LOG_WARN);
+    if(log_level->count > 0) {
+        if(!is_log_level(log_level->sval[0])) {
+            fprintf(stderr, "Invalid loging level value %s\n", log_level->sval[0]);
+            goto exit_1;
+        }
+        log_set_level(log_level_text_to_enum(log_level->sval[0], LOG_WARN));
+    }
+    uint32_t seed_value = seed->count > 0 ? (uint32_t)seed->ival[0] : DEFAULT_SEED;
+    rand_seed(seed_value);
+
+    if(settings_init(pm_get_local_path(CONFIG_PATH))) {
+        fprintf(stderr, "Failed to initialize settings file\n");
+        goto exit_1;
+    }
+    settings_load();
+    // Run uncapped; these are never saved back.
+    settings_get()->video.framerate_limit = 0;
+    settings_get()->video.vsync = 0;
+    if(resampler->count > 0) {
+        settings_get()->sound.music_resampler = resampler->ival[0];
+    }
+
+    // No window and no audio device; the software renderer and offline audio backend do all the work.
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    if(SDL_Init(SDL_INIT_TIMER | SDL_INIT_VIDEO)) {
+        fprintf(stderr, "SDL2 Initialization failed: %s\n", SDL_GetError());
+        goto exit_2;
+    }
+
+    engine_init_flags init_flags;
+    memset(&init_flags, 0, sizeof(init_flags));
+    strncpy_or_truncate(init_flags.force_renderer, "Software", sizeof(init_flags.force_renderer));
+    strncpy_or_truncate(init_flags.force_audio_backend, "Offline", sizeof(init_flags.force_audio_backend));
+    if(engine_init(&init_flags)) {
+        fprintf(stderr, "Failed to initialize game engine: %s\n", log_last_error());
+        goto exit_3;
+    }
+
+    memset(&state, 0, sizeof(state));
+    if(video->count > 0 && (state.video = open_video_output(video->filename[0])) == NULL) {
+        goto exit_4;
+    }
+    if(audio->count > 0) {
+        if(!offline_audio_backend_get_format(&state.sample_rate, &state.channels)) {
+            fprintf(stderr, "Offline audio backend is not available\n");
+            goto exit_5;
+        }
+        if((state.audio = wav_writer_open(audio->filename[0], state.sample_rate, state.channels)) == NULL) {
+            goto exit_5;
+        }
+        unsigned max_frame = state.sample_rate / FRAMES_PER_SECOND + 1;
+        state.samples = omf_calloc(max_frame * state.channels, sizeof(int16_t));
+    }
+
+    uint64_t start = SDL_GetPerformanceCounter();
+    bool success = export_file(file->filename[0], speed->count > 0 ? speed->ival[0] : -1,
+                               max_ticks->count > 0 ? (uint32_t)max2(max_ticks->ival[0], 0) : 100000, seed_value);
+    double wall_ms = ticks_to_ms(SDL_GetPerformanceCounter() - start);
+
+    if(state.audio != NULL && !wav_writer_close(&state.audio)) {
+        success = false;
+    }
+    if(state.video != NULL && fflush(state.video) != 0) {
+        success = false;
+    }
+    double video_ms = state.frames * (double)FRAME_MS;
+    fprintf(stderr, "%s %s: %u frames, %u dynamic ticks, %.2f s of video in %.2f s (%.1fx real time)\n",
+            success ? "Exported" : "Failed to export", file->filename[0], state.frames, state.dynamic_ticks,
+            video_ms / 1000.0, wall_ms / 1000.0, wall_ms > 0.0 ? video_ms / wall_ms : 0.0);
+    offline_audio_stats stats;
+    if(audio->count > 0 && offline_audio_backend_get_stats(&stats)) {
+        fprintf(stderr, "Audio: music %.1f us, effects %.1f us per 10 ms block (resampler %u)\n",
+                offline_audio_stats_us_per_block(&stats, stats.music_ticks),
+                offline_audio_stats_us_per_block(&stats, stats.mix_ticks), stats.resampler);
+    }
+    ret = success ? 0 : 1;
+
+exit_5:
+    omf_free(state.samples);
+    wav_writer_close(&state.audio);
+    if(state.video != NULL && state.video != stdout) {
+        fclose(state.video);
+    }
+exit_4:
+    engine_close();
+exit_3:
+    SDL_Quit();
+exit_2:
+    settings_free();
+exit_1:
+    log_close();
+    pm_free();
+exit_0:
+    arg_freetable(argtable, N_ELEMENTS(argtable));
+    return ret;
+}
@@ -0,0 +1,417 @@
+/** @file main.c
+ * @brief Headless batch .REC replay runner
+ * @license MIT
+ *
+ * Replays any number of REC files, ticking the game state on a virtual clock instead of the
+ * wall clock. Renderer and audio output are forced to the NULL backends, so this requires a
+ * debug build (same as run_rectests.sh). With --audio, the offline audio backend is used
+ * instead, and the time spent rendering music and sound effects is reported for every file.
+ *
+ * With --jobs, the files are spread over worker processes. The engine is initialized once before
+ * forking, so every worker starts with sounds, fonts and language data already loaded. Workers
+ * pull the next file from a shared queue that is ordered longest recording first, which keeps
+ * long destruct recordings from being picked up last and leaving one worker as a straggler.
+ */
+
+#include "engine.h"
+#include "game/utils/settings.h"
+#include "replay.h"
+#include "report.h"
+#include "resources/pathmanager.h"
+#include "utils/allocator.h"
+#include "utils/c_array_util.h"
+#include "utils/c_string_util.h"
+#include "utils/io.h"
+#include "utils/log.h"
+#include "utils/miscmath.h"
+#include "utils/random.h"
+#include <SDL.h>
+#include <argtable3.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if !defined(_WIN32) && !defined(WIN32)
+#define RECRUNNER_FORK
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+enum
+{
+    SLOT_PENDING = 0,
+    SLOT_RUNNING,
+    SLOT_DONE,
+};
+
+typedef struct {
+#ifdef RECRUNNER_FORK
+    atomic_int state;
+    pid_t worker;
+#else
+    int state;
+#endif
+    replay_result result;
+} job_slot;
+
+// Shared between all worker processes when running in parallel.
+typedef struct {
+#ifdef RECRUNNER_FORK
+    atomic_int next;
+#else
+    int next;
+#endif
+    int count;
+    size_t size;
+    job_slot slots[];
+} job_queue;
+
+typedef struct {
+    const char **filenames;
+    int *order;
+    int count;
+    int speed;
+    uint32_t max_ticks;
+    bool audio;
+} job_list;
+
+static job_queue *queue_create(int count, bool shared) {
+    size_t size = sizeof(job_queue) + sizeof(job_slot) * count;
+    job_queue *queue;
+#ifdef RECRUNNER_FORK
+    if(shared) {
+        queue = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if(queue == MAP_FAILED) {
+            return NULL;
+        }
+        memset(queue, 0, size);
+    } else {
+        queue = omf_calloc(1, size);
+    }
+#else
+    queue = omf_calloc(1, size);
+#endif
+    queue->count = count;
+    queue->size = size;
+    return queue;
+}
+
+static void queue_free(job_queue *queue, bool shared) {
+#ifdef RECRUNNER_FORK
+    if(shared) {
+        munmap(queue, queue->size);
+        return;
+    }
+#endif
+    omf_free(queue);
+}
+
+static long rec_file_size(const char *filename) {
+    FILE *fp = fopen(filename, "rb");
+    if(fp == NULL) {
+        return 0;
+    }
+    long size = file_size(fp);
+    fclose(fp);
+    return size;
+}
+
+// REC size grows with the number of recorded moves, so it is a decent guess for replay length.
+static int *order_longest_first(const char **filenames, int count) {
+    int *order = omf_calloc(count, sizeof(int));
+    long *sizes = omf_calloc(count, sizeof(long));
+    for(int i = 0; i < count; i++) {
+        order[i] = i;
+        sizes[i] = rec_file_size(filenames[i]);
+    }
+    // Insertion sort, stable so equal sizes keep the command line order.
+    for(int i = 1; i < count; i++) {
+        int key = order[i];
+        int j = i - 1;
+        while(j >= 0 && sizes[order[j]] < sizes[key]) {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = key;
+    }
+    omf_free(sizes);
+    return order;
+}
+
+static int queue_take(job_queue *queue) {
+#ifdef RECRUNNER_FORK
+    return atomic_fetch_add(&queue->next, 1);
+#else
+    return queue->next++;
+#endif
+}
+
+static void run_jobs(job_queue *queue, const job_list *jobs) {
+    int job;
+    while((job = queue_take(queue)) < jobs->count) {
+        int index = jobs->order[job];
+        job_slot *slot = &queue->slots[index];
+#ifdef RECRUNNER_FORK
+        slot->worker = getpid();
+#endif
+        slot->state = SLOT_RUNNING;
+        replay_file(jobs->filenames[index], jobs->speed, jobs->max_ticks, jobs->audio, &slot->result);
+        slot->state = SLOT_DONE;
+        replay_print_result(jobs->filenames[index], &slot->result);
+    }
+}
+
+#ifdef RECRUNNER_FORK
+static pid_t spawn_worker(job_queue *queue, const job_list *jobs) {
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if(pid == 0) {
+        run_jobs(queue, jobs);
+        fflush(stdout);
+        // Skip atexit handlers; the parent owns all engine resources.
+        _exit(0);
+    }
+    return pid;
+}
+
+static void run_jobs_parallel(job_queue *queue, const job_list *jobs, int worker_count) {
+    int live = 0;
+    for(int i = 0; i < worker_count; i++) {
+        if(spawn_worker(queue, jobs) > 0) {
+            live++;
+        }
+    }
+    if(live == 0) {
+        log_warn("Unable to fork workers, running serially");
+        run_jobs(queue, jobs);
+        return;
+    }
+
+    while(live > 0) {
+        int status;
+        pid_t pid = wait(&status);
+        if(pid < 0) {
+            break;
+        }
+        live--;
+        if(WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            continue;
+        }
+
+        // Worker died in the middle of a replay; blame that file and replace the worker.
+        for(int i = 0; i < queue->count; i++) {
+            job_slot *slot = &queue->slots[i];
+            if(slot->state == SLOT_RUNNING && slot->worker == pid) {
+                slot->result.crashed = true;
+                slot->state = SLOT_DONE;
+                replay_print_result(jobs->filenames[i], &slot->result);
+            }
+        }
+        if(atomic_load(&queue->next) < jobs->count && spawn_worker(queue, jobs) > 0) {
+            live++;
+        }
+    }
+}
+#endif
+
+static int default_job_count(void) {
+    return max2(SDL_GetCPUCount(), 1);
+}
+
+int main(int argc, char *argv[]) {
+    struct arg_lit *help = arg_lit0("h", "help", "print this help and exit");
+    struct arg_lit *vers = arg_lit0("v", "version", "print version information and exit");
+    struct arg_int *speed = arg_int0(NULL, "speed", "<speed>", "game speed to use: 1-10 (default: 10)");
+    struct arg_int *max_ticks =
+        arg_int0(NULL, "max-ticks", "<ticks>", "fail a replay after this many dynamic ticks (default: 100000)");
+    struct arg_int *jobs_arg =
+        arg_int0("j", "jobs", "<n>", "replay with n worker processes (default: 1, 0 = one per CPU core)");
+    struct arg_lit *audio = arg_lit0(NULL, "audio", "render audio with the offline backend and time it");
+    struct arg_int *resampler =
+        arg_int0(NULL, "resampler", "<n>", "music resampler for --audio: 0-2 (default: from settings)");
+    struct arg_file *junit = arg_file0(NULL, "junit", "<file>", "write a JUnit XML report");
+    struct arg_file *tap = arg_file0(NULL, "tap", "<file>", "write a TAP report");
+    struct arg_str *log_level = arg_str0(NULL, "log-level", "<level>", "Log level (DEBUG, INFO, WARN, ERROR)");
+    struct arg_file *files = arg_filen(NULL, NULL, "<file>", 1, 4096, "REC files to replay");
+    struct arg_end *end = arg_end(20);
+    void *argtable[] = {help, vers, speed, max_ticks, jobs_arg, audio, resampler, junit, tap, log_level, files, end};
+    const char *progname = "recrunner";
+    int fail_count = 0;
+
+    // Make sure everything got allocated
+    if(arg_nullcheck(argtable) != 0) {
+        printf("%s: insufficient memory\n", progname);
+        goto exit_0;
+    }
+
+    // Parse arguments
+    int nerrors = arg_parse(argc, argv, argtable);
+
+    // Handle help
+    if(help->count > 0) {
+        printf("Usage: %s", progname);
+        arg_print_syntax(stdout, argtable, "\n");
+        printf("\nArguments:\n");
+        arg_print_glossary(stdout, argtable, "%-25s %s\n");
+        goto exit_0;
+    }
+
+    // Handle version
+    if(vers->count > 0) {
+        printf("%s v0.1\n", progname);
+        printf("Headless One Must Fall 2097 REC replay runner.\n");
+        printf("Source code is available at https://github.com/omf2097 under MIT license.\n");
+        goto exit_0;
+    }
+
+    // Handle errors
+    if(nerrors > 0) {
+        arg_print_errors(stdout, end, progname);
+        printf("Try '%s --help' for more information.\n", progname);
+        goto exit_0;
+    }
+
+    if(pm_init() != 0) {
+        fprintf(stderr, "Error: %s.\n", pm_get_errormsg());
+        fail_count = 1;
+        goto exit_0;
+    }
+
+    log_init();
+    log_add_stderr(LOG_DEBUG, false);
+    log_set_level(LOG_WARN);
+    if(log_level->count > 0) {
+        if(!is_log_level(log_level->sval[0])) {
+            fprintf(stderr, "Invalid loging level value %s\n", log_level->sval[0]);
+            fail_count = 1;
+            goto exit_1;
+        }
+        log_set_level(log_level_text_to_enum(log_level->sval[0], LOG_WARN));
+    }
+    rand_seed(time(NULL));
+
+    if(settings_init(pm_get_local_path(CONFIG_PATH))) {
+        fprintf(stderr, "Failed to initialize settings file\n");
+        fail_count = 1;
+        goto exit_1;
+    }
+    settings_load();
+    if(resampler->count > 0) {
+        // Never saved back, so this does not touch the user's settings.
+        settings_get()->sound.music_resampler = resampler->ival[0];
+    }
+
+    if(SDL_Init(SDL_INIT_TIMER)) {
+        fprintf(stderr, "SDL2 Initialization failed: %s\n", SDL_GetError());
+        fail_count = 1;
+        goto exit_2;
+    }
+
+    if(!replay_has_null_renderer()) {
+        fprintf(stderr, "%s requires the NULL renderer; use a debug build.\n", progname);
+        fail_count = 1;
+        goto exit_3;
+    }
+
+    engine_init_flags init_flags;
+    memset(&init_flags, 0, sizeof(init_flags));
+    strncpy_or_truncate(init_flags.force_renderer, "NULL", sizeof(init_flags.force_renderer));
+    strncpy_or_truncate(init_flags.force_audio_backend, audio->count > 0 ? "Offline" : "NULL",
+                        sizeof(init_flags.force_audio_backend));
+    if(engine_init(&init_flags)) {
+        fprintf(stderr, "Failed to initialize game engine: %s\n", log_last_error());
+        fail_count = 1;
+        goto exit_3;
+    }
+
+    int worker_count = 1;
+    if(jobs_arg->count > 0) {
+        worker_count = jobs_arg->ival[0] > 0 ? jobs_arg->ival[0] : default_job_count();
+    }
+    worker_count = min2(worker_count, files->count);
+#ifndef RECRUNNER_FORK
+    if(worker_count > 1) {
+        log_warn("Parallel replay is not supported on this platform, running serially");
+        worker_count = 1;
+    }
+#endif
+    bool shared = worker_count > 1;
+
+    job_list jobs;
+    jobs.filenames = files->filename;
+    jobs.count = files->count;
+    jobs.order = order_longest_first(files->filename, files->count);
+    jobs.speed = speed->count > 0 ? speed->ival[0] : 10;
+    jobs.max_ticks = max_ticks->count > 0 ? (uint32_t)max2(max_ticks->ival[0], 0) : 100000;
+    jobs.audio = audio->count > 0;
+
+    job_queue *queue = queue_create(files->count, shared);
+    if(queue == NULL) {
+        fprintf(stderr, "Unable to allocate shared job queue\n");
+        fail_count = 1;
+        goto exit_4;
+    }
+
+    uint64_t run_start = SDL_GetPerformanceCounter();
+#ifdef RECRUNNER_FORK
+    if(shared) {
+        run_jobs_parallel(queue, &jobs, worker_count);
+    } else {
+        run_jobs(queue, &jobs);
+    }
+#else
+    run_jobs(queue, &jobs);
+#endif
+    double wall_ms = replay_ticks_to_ms(SDL_GetPerformanceCounter() - run_start);
+
+    // Gather the results in command line order for the summary and reports.
+    replay_result *results = omf_calloc(files->count, sizeof(replay_result));
+    uint64_t total_dynamic_ticks = 0;
+    double total_tick_ms = 0.0;
+    for(int i = 0; i < files->count; i++) {
+        results[i] = queue->slots[i].result;
+        if(queue->slots[i].state != SLOT_DONE) {
+            // The worker that took this file died before it could even start.
+            results[i].crashed = true;
+        }
+        if(!replay_passed(&results[i])) {
+            fail_count++;
+        }
+        total_dynamic_ticks += results[i].dynamic_ticks;
+        total_tick_ms += results[i].tick_ms;
+    }
+
+    printf("\nReplayed %d files with %d workers in %.2f ms wall time, %" PRIu64
+           " dynamic ticks (%.0f ticks/s per worker): %d passed, %d failed\n",
+           files->count, worker_count, wall_ms, total_dynamic_ticks,
+           total_tick_ms > 0.0 ? total_dynamic_ticks * 1000.0 / total_tick_ms : 0.0, files->count - fail_count,
+           fail_count);
+
+    if(junit->count > 0 && !report_write_junit(junit->filename[0], files->filename, results, files->count, wall_ms)) {
+        fprintf(stderr, "Unable to write JUnit report %s\n", junit->filename[0]);
+    }
+    if(tap->count > 0 && !report_write_tap(tap->filename[0], files->filename, results, files->count)) {
+        fprintf(stderr, "Unable to write TAP report %s\n", tap->filename[0]);
+    }
+
+    omf_free(results);
+    queue_free(queue, shared);
+exit_4:
+    omf_free(jobs.order);
+    engine_close();
+exit_3:
+    SDL_Quit();
+exit_2:
+    settings_free();
+exit_1:
+    log_close();
+    pm_free();
+exit_0:
+    arg_freetable(argtable, N_ELEMENTS(argtable));
+    return fail_count;
+}
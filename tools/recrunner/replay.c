@@ -0,0 +1,214 @@
+#include "replay.h"
+#include "audio/backends/offline/offline_backend.h"
+#include "audio/sources/psm_source.h"
+#include "controller/rec_controller.h"
+#include "engine.h"
+#include "game/game_player.h"
+#include "game/game_state.h"
+#include "utils/allocator.h"
+#include "utils/c_string_util.h"
+#include "utils/log.h"
+#include "utils/miscmath.h"
+#include "video/video.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <string.h>
+
+double replay_ticks_to_ms(uint64_t ticks) {
+    return (double)ticks * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+bool replay_has_null_renderer(void) {
+    const char *name;
+    video_scan_renderers();
+    for(int i = 0; i < video_get_renderer_count(); i++) {
+        if(video_get_renderer_info(i, &name, NULL) && strcmp(name, "NULL") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void collect_assertions(game_state *gs, replay_result *res) {
+    for(int i = 0; i < game_state_num_players(gs); i++) {
+        controller *ctrl = game_player_get_ctrl(game_state_get_player(gs, i));
+        if(ctrl != NULL && ctrl->type == CTRL_TYPE_REC) {
+            int passed, failed;
+            rec_controller_get_assertion_counts(ctrl, &passed, &failed);
+            res->assertions_passed += passed;
+            res->assertions_failed += failed;
+        }
+    }
+}
+
+typedef struct {
+    int16_t *samples;
+    unsigned sample_rate;
+    unsigned channels;
+    unsigned blocks;
+} audio_output;
+
+static bool audio_output_open(audio_output *out) {
+    memset(out, 0, sizeof(audio_output));
+    if(!offline_audio_backend_get_format(&out->sample_rate, &out->channels)) {
+        return false;
+    }
+    out->samples = omf_calloc((out->sample_rate / 100 + 1) * out->channels, sizeof(int16_t));
+    offline_audio_backend_reset_stats();
+    return true;
+}
+
+// One static tick is 10 ms; spread any remainder of the sample rate over the blocks.
+static void audio_output_render(audio_output *out) {
+    uint64_t start = (uint64_t)out->blocks * out->sample_rate / 100;
+    uint64_t end = (uint64_t)(out->blocks + 1) * out->sample_rate / 100;
+    offline_audio_backend_render(out->samples, end - start);
+    out->blocks++;
+}
+
+static void audio_output_close(audio_output *out, replay_result *res) {
+    offline_audio_stats stats;
+    if(offline_audio_backend_get_stats(&stats)) {
+        res->audio = true;
+        res->resampler = stats.resampler;
+        res->music_us = offline_audio_stats_us_per_block(&stats, stats.music_ticks);
+        res->mix_us = offline_audio_stats_us_per_block(&stats, stats.mix_ticks);
+    }
+    omf_free(out->samples);
+}
+
+/*
+ * Static and dynamic ticks are interleaved exactly like engine_run() does it, but the clock is
+ * advanced straight to the next due tick instead of waiting for it, and nothing is rendered.
+ * Audio is rendered if asked to, 10 ms for every static tick, and thrown away.
+ */
+void replay_file(const char *filename, int speed, uint32_t max_ticks, bool audio, replay_result *res) {
+    engine_init_flags init_flags;
+    memset(&init_flags, 0, sizeof(init_flags));
+    memset(res, 0, sizeof(replay_result));
+    init_flags.playback = 1;
+    init_flags.speed = speed;
+    init_flags.nonfatal_assertions = 1;
+    strncpy_or_truncate(init_flags.rec_file, filename, sizeof(init_flags.rec_file));
+    strncpy_or_truncate(init_flags.force_renderer, "NULL", sizeof(init_flags.force_renderer));
+    strncpy_or_truncate(init_flags.force_audio_backend, audio ? "Offline" : "NULL",
+                        sizeof(init_flags.force_audio_backend));
+
+    uint64_t start = SDL_GetPerformanceCounter();
+
+    game_state *gs = omf_calloc(1, sizeof(game_state));
+    if(game_state_create(gs, &init_flags)) {
+        game_state_free(&gs);
+        res->load_ms = replay_ticks_to_ms(SDL_GetPerformanceCounter() - start);
+        return;
+    }
+    res->loaded = true;
+    res->load_ms = replay_ticks_to_ms(SDL_GetPerformanceCounter() - start);
+    audio_output out;
+    if(audio && !audio_output_open(&out)) {
+        log_warn("Offline audio backend is not in use, skipping audio");
+        audio = false;
+    }
+    start = SDL_GetPerformanceCounter();
+
+    int dynamic_wait = 0;
+    int static_wait = 0;
+    while(game_state_is_running(gs)) {
+        // Jump the virtual clock forward to whichever tick is due first.
+        int dyntick_ms = game_state_ms_per_dyntick(gs);
+        int step = min2(STATIC_TICKS - static_wait, dyntick_ms - dynamic_wait) + 1;
+        step = max2(step, 1);
+        static_wait += step;
+        dynamic_wait += step;
+
+        if(static_wait > STATIC_TICKS) {
+            game_state_static_tick(gs, false);
+            if(gs->new_state) {
+                game_state *old_gs = gs;
+                gs = gs->new_state;
+                game_state_clone_free(old_gs);
+                omf_free(old_gs);
+            }
+            static_wait -= STATIC_TICKS;
+            res->static_ticks++;
+            if(audio) {
+                audio_output_render(&out);
+            }
+        }
+
+        if(dynamic_wait > dyntick_ms) {
+            game_state_dynamic_tick(gs, false);
+            dynamic_wait -= dyntick_ms;
+            if(gs->delay > 0) {
+                gs->delay--;
+                dynamic_wait -= 4;
+            }
+            res->dynamic_ticks++;
+        }
+
+        if(max_ticks > 0 && res->dynamic_ticks >= max_ticks) {
+            res->timed_out = true;
+            break;
+        }
+    }
+
+    res->tick_ms = replay_ticks_to_ms(SDL_GetPerformanceCounter() - start);
+    if(audio) {
+        audio_output_close(&out, res);
+    }
+    collect_assertions(gs, res);
+    game_state_free(&gs);
+}
+
+bool replay_passed(const replay_result *res) {
+    return res->loaded && !res->crashed && !res->timed_out && res->assertions_failed == 0;
+}
+
+const char *replay_failure_reason(const replay_result *res) {
+    if(res->crashed)
+        return "worker crashed";
+    if(!res->loaded)
+        return "could not be loaded";
+    if(res->timed_out)
+        return "tick limit reached";
+    return "assertion failed";
+}
+
+const char *replay_resampler_name(unsigned resampler) {
+    const music_resampler *resamplers;
+    unsigned count = psm_get_resamplers(&resamplers);
+    for(unsigned i = 0; i < count; i++) {
+        if(resamplers[i].internal_id == (int)resampler) {
+            return resamplers[i].name;
+        }
+    }
+    return "unknown";
+}
+
+const char *replay_basename(const char *path) {
+    const char *base = path;
+    for(const char *p = path; *p != '\0'; p++) {
+        if(*p == '/' || *p == '\\') {
+            base = p + 1;
+        }
+    }
+    return base;
+}
+
+void replay_print_result(const char *filename, const replay_result *res) {
+    // Load time is reported separately so that the tick rate only reflects the simulation itself.
+    double rate = res->tick_ms > 0.0 ? res->dynamic_ticks * 1000.0 / res->tick_ms : 0.0;
+    if(replay_passed(res)) {
+        printf("PASS  %-40s %7u ticks %9.2f ms %10.0f ticks/s  load %7.2f ms  (%d assertions)\n",
+               replay_basename(filename), res->dynamic_ticks, res->tick_ms, rate, res->load_ms,
+               res->assertions_passed);
+    } else {
+        printf("FAIL  %-40s %7u ticks %9.2f ms %10.0f ticks/s  load %7.2f ms  (%s)\n", replay_basename(filename),
+               res->dynamic_ticks, res->tick_ms, rate, res->load_ms, replay_failure_reason(res));
+    }
+    if(res->audio) {
+        printf("      audio: music %.1f us, effects %.1f us per 10 ms block (resampler %s)\n", res->music_us,
+               res->mix_us, replay_resampler_name(res->resampler));
+    }
+    fflush(stdout);
+}
@@ -0,0 +1,43 @@
+#ifndef RECRUNNER_REPLAY_H
+#define RECRUNNER_REPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    bool loaded;
+    bool timed_out;
+    bool crashed;
+    uint32_t dynamic_ticks;
+    uint32_t static_ticks;
+    int assertions_passed;
+    int assertions_failed;
+    double load_ms;
+    double tick_ms;
+    bool audio;
+    unsigned resampler;
+    double music_us; // Per 10 ms block of audio
+    double mix_us;   // Per 10 ms block of audio
+} replay_result;
+
+double replay_ticks_to_ms(uint64_t ticks);
+bool replay_has_null_renderer(void);
+
+/**
+ * Run a single REC file to completion without rendering. Engine must already be initialized.
+ *
+ * @param filename REC file to play
+ * @param speed Game speed 1-10
+ * @param max_ticks Give up after this many dynamic ticks (0 for no limit)
+ * @param audio Render 10 ms of audio every static tick; the engine must use the offline audio backend
+ * @param res Result is written here
+ */
+void replay_file(const char *filename, int speed, uint32_t max_ticks, bool audio, replay_result *res);
+
+bool replay_passed(const replay_result *res);
+const char *replay_failure_reason(const replay_result *res);
+void replay_print_result(const char *filename, const replay_result *res);
+const char *replay_basename(const char *path);
+const char *replay_resampler_name(unsigned resampler);
+
+#endif // RECRUNNER_REPLAY_H
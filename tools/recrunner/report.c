@@ -0,0 +1,84 @@
+#include "report.h"
+#include <stdio.h>
+
+static void write_xml_escaped(FILE *fp, const char *text) {
+    for(const char *p = text; *p != '\0'; p++) {
+        switch(*p) {
+            case '&':
+                fputs("&amp;", fp);
+                break;
+            case '<':
+                fputs("&lt;", fp);
+                break;
+            case '>':
+                fputs("&gt;", fp);
+                break;
+            case '"':
+                fputs("&quot;", fp);
+                break;
+            default:
+                fputc(*p, fp);
+                break;
+        }
+    }
+}
+
+bool report_write_junit(const char *path, const char **filenames, const replay_result *results, int count,
+                        double wall_ms) {
+    FILE *fp = fopen(path, "w");
+    if(fp == NULL) {
+        return false;
+    }
+
+    int failures = 0;
+    for(int i = 0; i < count; i++) {
+        if(!replay_passed(&results[i])) {
+            failures++;
+        }
+    }
+
+    fprintf(fp, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    fprintf(fp, "<testsuites>\n");
+    fprintf(fp, "  <testsuite name=\"rectests\" tests=\"%d\" failures=\"%d\" errors=\"0\" time=\"%.3f\">\n", count,
+            failures, wall_ms / 1000.0);
+    for(int i = 0; i < count; i++) {
+        const replay_result *res = &results[i];
+        fprintf(fp, "    <testcase classname=\"rectests\" name=\"");
+        write_xml_escaped(fp, replay_basename(filenames[i]));
+        fprintf(fp, "\" time=\"%.3f\">\n", (res->load_ms + res->tick_ms) / 1000.0);
+        if(!replay_passed(res)) {
+            fprintf(fp, "      <failure message=\"%s\"/>\n", replay_failure_reason(res));
+        }
+        fprintf(fp, "      <system-out>dynamic_ticks=%u static_ticks=%u assertions_passed=%d "
+                    "assertions_failed=%d</system-out>\n",
+                res->dynamic_ticks, res->static_ticks, res->assertions_passed, res->assertions_failed);
+        fprintf(fp, "    </testcase>\n");
+    }
+    fprintf(fp, "  </testsuite>\n");
+    fprintf(fp, "</testsuites>\n");
+    return fclose(fp) == 0;
+}
+
+bool report_write_tap(const char *path, const char **filenames, const replay_result *results, int count) {
+    FILE *fp = fopen(path, "w");
+    if(fp == NULL) {
+        return false;
+    }
+
+    fprintf(fp, "TAP version 13\n");
+    fprintf(fp, "1..%d\n", count);
+    for(int i = 0; i < count; i++) {
+        const replay_result *res = &results[i];
+        if(replay_passed(res)) {
+            fprintf(fp, "ok %d - %s\n", i + 1, replay_basename(filenames[i]));
+        } else {
+            fprintf(fp, "not ok %d - %s # %s\n", i + 1, replay_basename(filenames[i]), replay_failure_reason(res));
+        }
+        fprintf(fp, "  ---\n");
+        fprintf(fp, "  dynamic_ticks: %u\n", res->dynamic_ticks);
+        fprintf(fp, "  duration_ms: %.3f\n", res->load_ms + res->tick_ms);
+        fprintf(fp, "  assertions_failed: %d\n", res->assertions_failed);
+        fprintf(fp, "  ...\n");
+    }
+    return fclose(fp) == 0;
+}
@@ -0,0 +1,19 @@
+#ifndef RECRUNNER_REPORT_H
+#define RECRUNNER_REPORT_H
+
+#include "replay.h"
+
+/**
+ * Write replay results as a JUnit XML test suite.
+ * @return true on success, false if the file could not be written.
+ */
+bool report_write_junit(const char *path, const char **filenames, const replay_result *results, int count,
+                        double wall_ms);
+
+/**
+ * Write replay results in TAP version 13 format.
+ * @return true on success, false if the file could not be written.
+ */
+bool report_write_tap(const char *path, const char **filenames, const replay_result *results, int count);
+
+#endif // RECRUNNER_REPORT_H
@@ -0,0 +1,145 @@
+/** @file main.c
+ * @brief Sprite decoding benchmark
+ * @license MIT
+ */
+
+#include "formats/af.h"
+#include "formats/error.h"
+#include "formats/sprite.h"
+#include "utils/allocator.h"
+#include "utils/c_array_util.h"
+#include <SDL.h>
+#include <argtable3.h>
+#include <stdio.h>
+
+typedef struct {
+    uint64_t ticks;
+    uint64_t bytes;
+} bench_result;
+
+static void bench_single(const sd_animation *ani, bench_result *res) {
+    uint64_t start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < ani->sprite_count; i++) {
+        const sd_sprite *sprite = ani->sprites[i];
+        if(sprite->missing || sprite->width == 0 || sprite->height == 0) {
+            continue;
+        }
+        sd_vga_image img;
+        sd_sprite_vga_decode(&img, sprite);
+        res->bytes += img.len;
+        sd_vga_image_free(&img);
+    }
+    res->ticks += SDL_GetPerformanceCounter() - start;
+}
+
+static void bench_batch(const sd_animation *ani, bench_result *res) {
+    if(ani->sprite_count == 0) {
+        return;
+    }
+    sd_vga_image *images = omf_calloc(ani->sprite_count, sizeof(sd_vga_image));
+    char *arena = NULL;
+    uint64_t start = SDL_GetPerformanceCounter();
+    sd_sprite_vga_decode_batch(images, ani->sprites, ani->sprite_count, &arena);
+    res->ticks += SDL_GetPerformanceCounter() - start;
+    for(int i = 0; i < ani->sprite_count; i++) {
+        res->bytes += images[i].len;
+    }
+    omf_free(arena);
+    omf_free(images);
+}
+
+static void print_result(const char *name, const bench_result *res) {
+    double secs = (double)res->ticks / SDL_GetPerformanceFrequency();
+    double mbytes = (double)res->bytes / (1024.0 * 1024.0);
+    printf("%-8s %10.2f MB in %8.3f s: %10.2f MB/s\n", name, mbytes, secs, secs > 0 ? mbytes / secs : 0.0);
+}
+
+int main(int argc, char *argv[]) {
+    // commandline argument parser options
+    struct arg_lit *help = arg_lit0("h", "help", "print this help and exit");
+    struct arg_lit *vers = arg_lit0("v", "version", "print version information and exit");
+    struct arg_int *rounds = arg_int0("r", "rounds", "<number>", "Times to decode every sprite (default 100)");
+    struct arg_file *files = arg_filen(NULL, NULL, "<file>", 1, 64, "HAR files (FIGHTR*.AF) to decode");
+    struct arg_end *end = arg_end(20);
+    void *argtable[] = {help, vers, rounds, files, end};
+    const char *progname = "spritebench";
+
+    // Make sure everything got allocated
+    if(arg_nullcheck(argtable) != 0) {
+        printf("%s: insufficient memory\n", progname);
+        goto exit_0;
+    }
+
+    // Parse arguments
+    int nerrors = arg_parse(argc, argv, argtable);
+
+    // Handle help
+    if(help->count > 0) {
+        printf("Usage: %s", progname);
+        arg_print_syntax(stdout, argtable, "\n");
+        printf("\nArguments:\n");
+        arg_print_glossary(stdout, argtable, "%-25s %s\n");
+        goto exit_0;
+    }
+
+    // Handle version
+    if(vers->count > 0) {
+        printf("%s v0.1\n", progname);
+        printf("Command line OpenOMF sprite decoding benchmark.\n");
+        printf("Source code is available at https://github.com/omf2097 under MIT license.\n");
+        goto exit_0;
+    }
+
+    // Handle errors
+    if(nerrors > 0) {
+        arg_print_errors(stdout, end, progname);
+        printf("Try '%s --help' for more information.\n", progname);
+        goto exit_0;
+    }
+
+    int round_count = rounds->count > 0 ? rounds->ival[0] : 100;
+    if(round_count <= 0) {
+        printf("Rounds must be a positive number.\n");
+        goto exit_0;
+    }
+
+    // Load all files first, so that only decoding is measured.
+    sd_af_file *afs = omf_calloc(files->count, sizeof(sd_af_file));
+    int loaded = 0;
+    for(int i = 0; i < files->count; i++) {
+        sd_af_create(&afs[loaded]);
+        int ret = sd_af_load(&afs[loaded], files->filename[i]);
+        if(ret != SD_SUCCESS) {
+            printf("Unable to load AF file %s: %s.\n", files->filename[i], sd_get_error(ret));
+            sd_af_free(&afs[loaded]);
+            continue;
+        }
+        loaded++;
+    }
+
+    bench_result single = {0, 0};
+    bench_result batch = {0, 0};
+    for(int r = 0; r < round_count; r++) {
+        for(int i = 0; i < loaded; i++) {
+            for(int m = 0; m < MAX_AF_MOVES; m++) {
+                if(afs[i].moves[m] != NULL && afs[i].moves[m]->animation != NULL) {
+                    bench_single(afs[i].moves[m]->animation, &single);
+                    bench_batch(afs[i].moves[m]->animation, &batch);
+                }
+            }
+        }
+    }
+
+    printf("Decoded %d files %d times\n", loaded, round_count);
+    print_result("single", &single);
+    print_result("batch", &batch);
+
+    for(int i = 0; i < loaded; i++) {
+        sd_af_free(&afs[i]);
+    }
+    omf_free(afs);
+
+exit_0:
+    arg_freetable(argtable, N_ELEMENTS(argtable));
+    return 0;
+}